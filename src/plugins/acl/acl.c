@@ -1969,11 +1969,17 @@ vl_api_acl_dump_t_handler (vl_api_acl_dump_t * mp)
 
   if (mp->acl_index == ~0)
     {
-    /* Just dump all ACLs */
-    pool_foreach (acl, am->acls)
-     {
-      send_acl_details(am, reg, acl, mp->context);
-    }
+      /* Just dump all ACLs, by index as the pool may move while the
+       * handler yields on an api thread */
+      for (acl_index = 0; acl_index < pool_len (am->acls); acl_index++)
+	{
+	  if (pool_is_free_index (am->acls, acl_index))
+	    continue;
+	  acl = pool_elt_at_index (am->acls, acl_index);
+	  send_acl_details (am, reg, acl, mp->context);
+	  if (vl_api_thread_may_yield ())
+	    return;
+	}
     }
   else
     {
@@ -2212,10 +2218,15 @@ vl_api_macip_acl_dump_t_handler (vl_api_macip_acl_dump_t * mp)
   if (mp->acl_index == ~0)
     {
       /* Just dump all ACLs for now, with sw_if_index = ~0 */
-      pool_foreach (acl, am->macip_acls)
-         {
-          send_macip_acl_details (am, reg, acl, mp->context);
-        }
+      for (u32 i = 0; i < pool_len (am->macip_acls); i++)
+	{
+	  if (pool_is_free_index (am->macip_acls, i))
+	    continue;
+	  acl = pool_elt_at_index (am->macip_acls, i);
+	  send_macip_acl_details (am, reg, acl, mp->context);
+	  if (vl_api_thread_may_yield ())
+	    return;
+	}
     }
   else
     {
@@ -3942,6 +3953,12 @@ acl_init (vlib_main_t * vm)
   /* Ask for a correctly-sized block of API message decode slots */
   am->msg_id_base = setup_message_id_table ();
 
+  /* The acl pools only change under the worker barrier */
+  vl_api_set_msg_read_only (vlibapi_get_main (),
+			    am->msg_id_base + VL_API_ACL_DUMP, 1);
+  vl_api_set_msg_read_only (vlibapi_get_main (),
+			    am->msg_id_base + VL_API_MACIP_ACL_DUMP, 1);
+
   error = acl_plugin_exports_init (&acl_plugin);
 
   if (error)
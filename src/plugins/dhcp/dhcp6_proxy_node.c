@@ -312,7 +312,7 @@ dhcpv6_proxy_to_server_input (vlib_main_t * vm,
 
 	  if ((b0->current_data + b0->current_length + sizeof (*id1) +
 	       sizeof (*vss1) + sizeof (*cmac)) >
-	      vlib_buffer_get_default_data_size (vm))
+	      vlib_buffer_get_pool_data_size (vm, b0->buffer_pool_index))
 	    {
 	      error0 = DHCPV6_PROXY_ERROR_PKT_TOO_BIG;
 	      next0 = DHCPV6_PROXY_TO_SERVER_INPUT_NEXT_DROP;
@@ -59,6 +59,9 @@
 #define VCL_TEST_CTRL_LISTENER		(~0 - 1)
 #define VCL_TEST_DATA_LISTENER		(~0)
 #define VCL_TEST_DELAY_DISCONNECT	1
+#define VCL_TEST_MMSG_MAX_BATCH		64
+#define VCL_TEST_RING_MAX_DEPTH		64
+#define VCL_TEST_RING_MAX_CQES		256
 
 typedef struct
 {
@@ -70,6 +73,8 @@ typedef struct
   uint64_t tx_bytes;
   uint32_t tx_eagain;
   uint32_t tx_incomp;
+  uint64_t tx_dgrams;
+  uint64_t ring_ops;
   struct timespec start;
   struct timespec stop;
 } vcl_test_stats_t;
@@ -80,6 +85,8 @@ typedef struct vcl_test_session
   uint8_t is_alloc : 1;
   uint8_t is_open : 1;
   uint8_t noblk_connect : 1;
+  uint8_t mmsg_batch;
+  uint32_t ring_tx_inflight;
   int fd;
   int (*read) (struct vcl_test_session *ts, void *buf, uint32_t buflen);
   int (*write) (struct vcl_test_session *ts, void *buf, uint32_t buflen);
@@ -149,6 +156,8 @@ vcl_test_stats_accumulate (vcl_test_stats_t * accum, vcl_test_stats_t * incr)
   accum->tx_bytes += incr->tx_bytes;
   accum->tx_eagain += incr->tx_eagain;
   accum->tx_incomp += incr->tx_incomp;
+  accum->tx_dgrams += incr->tx_dgrams;
+  accum->ring_ops += incr->ring_ops;
 }
 
 static inline void
@@ -232,6 +241,9 @@ vcl_test_stats_dump (char *header, vcl_test_stats_t * stats,
 	      (void *) stats, stats->tx_xacts, stats->tx_xacts,
 	      stats->tx_bytes, stats->tx_bytes, stats->tx_eagain,
 	      stats->tx_eagain, stats->tx_incomp, stats->tx_incomp);
+      if (stats->tx_dgrams)
+	printf ("      tx dgrams:  %lu (%.3lf Mpps)\n", stats->tx_dgrams,
+		(double) stats->tx_dgrams / duration / 1e6);
     }
   if (show_rx)
     {
@@ -245,6 +257,9 @@ vcl_test_stats_dump (char *header, vcl_test_stats_t * stats,
 	      stats->rx_bytes, stats->rx_bytes, stats->rx_eagain,
 	      stats->rx_eagain, stats->rx_incomp, stats->rx_incomp);
     }
+  if (stats->ring_ops)
+    printf ("       ring ops:  %lu (%.3lf Mops/s)\n", stats->ring_ops,
+	    (double) stats->ring_ops / duration / 1e6);
   if (verbose)
     printf ("   start.tv_sec:  %ld\n"
 	    "  start.tv_nsec:  %ld\n"
@@ -420,6 +435,58 @@ vcl_test_write (vcl_test_session_t *ts, void *buf, uint32_t nbytes)
   return (tx_bytes);
 }
 
+/**
+ * Write buffer as a batch of ts->mmsg_batch equally sized datagrams with
+ * vppcom_session_sendmmsg, retrying until all datagrams are sent.
+ */
+static inline int
+vcl_test_write_mmsg (vcl_test_session_t *ts, void *buf, uint32_t nbytes)
+{
+  vppcom_mmsg_t msgs[VCL_TEST_MMSG_MAX_BATCH];
+  vcl_test_stats_t *stats = &ts->stats;
+  uint32_t i, n_msgs, n_sent = 0, dgram_size;
+  int tx_bytes = 0, rv;
+
+  n_msgs = ts->mmsg_batch;
+  dgram_size = nbytes / n_msgs;
+  for (i = 0; i < n_msgs; i++)
+    {
+      msgs[i].buf = buf + i * dgram_size;
+      msgs[i].len = dgram_size;
+      msgs[i].ep = 0;
+    }
+
+  do
+    {
+      stats->tx_xacts++;
+      rv = vppcom_session_sendmmsg (ts->fd, msgs + n_sent, n_msgs - n_sent,
+				    0);
+      if (rv < 0)
+	{
+	  errno = -rv;
+	  if (errno == EAGAIN || errno == EWOULDBLOCK)
+	    {
+	      stats->tx_eagain++;
+	      continue;
+	    }
+	  vterr ("vppcom_session_sendmmsg", rv);
+	  break;
+	}
+
+      for (i = n_sent; i < n_sent + rv; i++)
+	tx_bytes += msgs[i].n_bytes;
+      n_sent += rv;
+      if (n_sent < n_msgs)
+	stats->tx_incomp++;
+    }
+  while (n_sent < n_msgs);
+
+  stats->tx_dgrams += n_sent;
+  stats->tx_bytes += tx_bytes;
+
+  return (tx_bytes);
+}
+
 static inline void
 dump_help (void)
 {
@@ -65,6 +65,8 @@ typedef struct
   hs_test_t post_test;
   uint8_t proto;
   uint8_t incremental_stats;
+  uint8_t mmsg_batch;
+  uint32_t ring_depth;
   uint32_t n_workers;
   volatile int active_workers;
   volatile int test_running;
@@ -320,6 +322,18 @@ vtc_session_check_is_done (vcl_test_session_t *ts, uint8_t check_rx)
   return 0;
 }
 
+static void
+vtc_session_set_mmsg (vcl_test_session_t *ts)
+{
+  vcl_test_client_main_t *vcm = &vcl_client_main;
+
+  if (!vcm->mmsg_batch || vcm->proto != VPPCOM_PROTO_UDP)
+    return;
+
+  ts->mmsg_batch = vcm->mmsg_batch;
+  ts->write = vcl_test_write_mmsg;
+}
+
 static int
 vtc_worker_connect_sessions_select (vcl_test_client_worker_t *wrk)
 {
@@ -342,6 +356,7 @@ vtc_worker_connect_sessions_select (vcl_test_client_worker_t *wrk)
       rv = tp->open (&wrk->sessions[i], &vcm->server_endpt);
       if (rv < 0)
 	return rv;
+      vtc_session_set_mmsg (ts);
 
       FD_SET (vppcom_session_index (ts->fd), &wrk->wr_fdset);
       FD_SET (vppcom_session_index (ts->fd), &wrk->rd_fdset);
@@ -496,6 +511,7 @@ vtc_worker_connect_sessions_epoll (vcl_test_client_worker_t *wrk)
 	      vtwrn ("open: %d", rv);
 	      return rv;
 	    }
+	  vtc_session_set_mmsg (ts);
 
 	  ev.data.u64 = ci;
 	  rv = vppcom_epoll_ctl (wrk->epoll_sh, EPOLL_CTL_ADD, ts->fd, &ev);
@@ -686,6 +702,183 @@ vtc_worker_run_epoll (vcl_test_client_worker_t *wrk)
   return 0;
 }
 
+static int
+vtc_worker_ring_post (vcl_test_client_worker_t *wrk, int ring, uint32_t si,
+		      uint8_t is_read)
+{
+  vcl_test_session_t *ts = &wrk->sessions[si];
+  vppcom_ring_sqe_t *sqe;
+
+  sqe = vppcom_ring_get_sqe (ring);
+  if (!sqe)
+    return -1;
+
+  sqe->op = is_read ? VPPCOM_RING_OP_READ : VPPCOM_RING_OP_WRITE;
+  sqe->session_handle = ts->fd;
+  sqe->buf = ts->txbuf;
+  sqe->len = is_read ? ts->rxbuf_size : ts->cfg.txbuf_size;
+  sqe->user_data = (uint64_t) si << 1 | is_read;
+  if (!is_read)
+    ts->ring_tx_inflight += 1;
+
+  return 0;
+}
+
+static void
+vtc_worker_ring_post_writes (vcl_test_client_worker_t *wrk, int ring,
+			     uint32_t si)
+{
+  vcl_test_client_main_t *vcm = &vcl_client_main;
+  vcl_test_session_t *ts = &wrk->sessions[si];
+
+  while (ts->ring_tx_inflight < vcm->ring_depth &&
+	 ts->stats.tx_bytes +
+	     (uint64_t) ts->ring_tx_inflight * ts->cfg.txbuf_size <
+	   ts->cfg.total_bytes)
+    {
+      if (vtc_worker_ring_post (wrk, ring, si, 0 /* is_read */))
+	break;
+    }
+}
+
+/**
+ * Check that echoed data continues the stream of txbufs written so far.
+ * Writes that complete short or out of order show up as a mismatch.
+ */
+static int
+vtc_ring_check_rx (vcl_test_session_t *ts, vppcom_ring_cqe_t *cqe,
+		   uint64_t *bad_offset)
+{
+  uint64_t offset = ts->stats.rx_bytes;
+  uint32_t i, j;
+
+  for (i = 0; i < 2; i++)
+    for (j = 0; j < cqe->ds[i].len; j++, offset++)
+      if (cqe->ds[i].data[j] != (unsigned char)
+	  ts->txbuf[offset % ts->cfg.txbuf_size])
+	{
+	  *bad_offset = offset;
+	  return -1;
+	}
+
+  return 0;
+}
+
+/**
+ * Run test with submission/completion ring. Each session keeps up to
+ * ring_depth writes and, if data is echoed, one zero-copy read in flight.
+ */
+static int
+vtc_worker_run_ring (vcl_test_client_worker_t *wrk)
+{
+  vcl_test_client_main_t *vcm = &vcl_client_main;
+  vppcom_ring_cqe_t *cqes[VCL_TEST_RING_MAX_CQES], *cqe;
+  vcl_test_main_t *vt = &vcl_test_main;
+  uint32_t n_active_sessions, si, ring_size = 1;
+  int i, rv, ring, n_cqes, check_rx;
+  const vcl_test_proto_vft_t *tp;
+  vcl_test_session_t *ts;
+  uint64_t bad_offset;
+  uint8_t is_read;
+
+  tp = vt->protos[vcm->proto];
+  for (i = 0; i < wrk->cfg.num_test_sessions; i++)
+    {
+      rv = tp->open (&wrk->sessions[i], &vcm->server_endpt);
+      if (rv < 0)
+	{
+	  vterr ("vtc_worker_connect_sessions()", rv);
+	  return rv;
+	}
+    }
+  vtinf ("All test sessions (%d) connected!", wrk->cfg.num_test_sessions);
+
+  while (ring_size < wrk->cfg.num_test_sessions * (vcm->ring_depth + 1))
+    ring_size <<= 1;
+  ring = vppcom_ring_create (ring_size);
+  if (ring < 0)
+    {
+      vterr ("vppcom_ring_create()", ring);
+      return ring;
+    }
+
+  check_rx = wrk->cfg.test != HS_TEST_TYPE_UNI;
+  n_active_sessions = wrk->cfg.num_test_sessions;
+
+  vtc_worker_start_transfer (wrk);
+
+  for (si = 0; si < wrk->cfg.num_test_sessions; si++)
+    {
+      if (check_rx)
+	vtc_worker_ring_post (wrk, ring, si, 1 /* is_read */);
+      vtc_worker_ring_post_writes (wrk, ring, si);
+    }
+  vppcom_ring_submit (ring);
+
+  while (n_active_sessions && vcm->test_running)
+    {
+      n_cqes = vppcom_ring_wait_cqes (ring, cqes, VCL_TEST_RING_MAX_CQES,
+				      0 /* wait_for_time */);
+      if (n_cqes < 0)
+	{
+	  vterr ("vppcom_ring_wait_cqes()", n_cqes);
+	  break;
+	}
+
+      for (i = 0; i < n_cqes; i++)
+	{
+	  cqe = cqes[i];
+	  si = cqe->user_data >> 1;
+	  is_read = cqe->user_data & 1;
+	  ts = &wrk->sessions[si];
+
+	  if (cqe->result < 0)
+	    {
+	      vterr ("ring op", cqe->result);
+	      vppcom_ring_destroy (ring);
+	      return -1;
+	    }
+
+	  ts->stats.ring_ops++;
+	  if (is_read)
+	    {
+	      if (vtc_ring_check_rx (ts, cqe, &bad_offset))
+		{
+		  vtwrn ("session %u: rx data mismatch at offset %lu", si,
+			 bad_offset);
+		  exit (1);
+		}
+	      vppcom_session_free_segments (ts->fd, cqe->result);
+	      ts->stats.rx_xacts++;
+	      ts->stats.rx_bytes += cqe->result;
+	      if (ts->stats.rx_bytes < ts->cfg.total_bytes)
+		vtc_worker_ring_post (wrk, ring, si, 1 /* is_read */);
+	    }
+	  else
+	    {
+	      ts->ring_tx_inflight -= 1;
+	      ts->stats.tx_xacts++;
+	      ts->stats.tx_bytes += cqe->result;
+	      if (cqe->result < ts->cfg.txbuf_size)
+		ts->stats.tx_incomp++;
+	      vtc_worker_ring_post_writes (wrk, ring, si);
+	      if (vcm->incremental_stats)
+		vtc_inc_stats_check (ts);
+	    }
+
+	  if (!ts->is_done && vtc_session_check_is_done (ts, check_rx))
+	    n_active_sessions -= 1;
+	}
+
+      vppcom_ring_cqes_seen (ring, n_cqes);
+      vppcom_ring_submit (ring);
+    }
+
+  vppcom_ring_destroy (ring);
+
+  return 0;
+}
+
 static inline int
 vtc_worker_run (vcl_test_client_worker_t *wrk)
 {
@@ -1017,6 +1210,8 @@ print_usage_and_exit (void)
     "  -I <N>           Use N sessions.\n"
     "  -s <N>           Use N sessions.\n"
     "  -S	       	Print incremental stats per session.\n"
+    "  -m <n>           UDP : send each write as a batch of n dgrams\n"
+    "  -a <n>           Use vcl ring api with n writes in flight per session\n"
     "  -q <n>           QUIC : use N Ssessions on top of n Qsessions\n");
   exit (1);
 }
@@ -1028,7 +1223,7 @@ vtc_process_opts (vcl_test_client_main_t * vcm, int argc, char **argv)
   int c, v;
 
   opterr = 0;
-  while ((c = getopt (argc, argv, "chnp:w:xXE:I:N:R:T:b:UBV6DLs:q:S")) != -1)
+  while ((c = getopt (argc, argv, "chnp:w:xXE:I:N:R:T:b:UBV6DLs:q:Sm:a:")) != -1)
     switch (c)
       {
       case 'c':
@@ -1206,6 +1401,28 @@ vtc_process_opts (vcl_test_client_main_t * vcm, int argc, char **argv)
 	vcm->incremental_stats = 1;
 	break;
 
+      case 'm':
+	v = atoi (optarg);
+	if (v <= 0 || v > VCL_TEST_MMSG_MAX_BATCH)
+	  {
+	    vtwrn ("Invalid mmsg batch size %d, must be in [1, %u]", v,
+		   VCL_TEST_MMSG_MAX_BATCH);
+	    print_usage_and_exit ();
+	  }
+	vcm->mmsg_batch = v;
+	break;
+
+      case 'a':
+	v = atoi (optarg);
+	if (v <= 0 || v > VCL_TEST_RING_MAX_DEPTH)
+	  {
+	    vtwrn ("Invalid ring depth %d, must be in [1, %u]", v,
+		   VCL_TEST_RING_MAX_DEPTH);
+	    print_usage_and_exit ();
+	  }
+	vcm->ring_depth = v;
+	break;
+
       case '?':
 	switch (optopt)
 	  {
@@ -1217,6 +1434,8 @@ vtc_process_opts (vcl_test_client_main_t * vcm, int argc, char **argv)
 	  case 'w':
 	  case 'p':
 	  case 'q':
+	  case 'm':
+	  case 'a':
 	    vtwrn ("Option -%c requires an argument.", optopt);
 	    break;
 
@@ -1377,7 +1596,10 @@ vtc_alloc_workers (vcl_test_client_main_t *vcm)
   vcm->workers = calloc (vcm->n_workers, sizeof (vcl_test_client_worker_t));
   vt->wrk = calloc (vcm->n_workers, sizeof (vcl_test_wrk_t));
 
-  if (vcm->ctrl_session.cfg.num_test_sessions > VCL_TEST_CFG_MAX_SELECT_SESS)
+  if (vcm->ring_depth)
+    run_fn = vtc_worker_run_ring;
+  else if (vcm->ctrl_session.cfg.num_test_sessions >
+	   VCL_TEST_CFG_MAX_SELECT_SESS)
     run_fn = vtc_worker_run_epoll;
   else
     run_fn = vtc_worker_run_select;
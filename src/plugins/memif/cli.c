@@ -312,6 +312,11 @@ format_memif_queue (u8 * s, va_list * args)
 		mq->ring->head, mq->ring->tail, mq->ring->flags,
 		mq->int_count);
 
+  /* rx queues only, when small buffer pools are configured */
+  if (mq->size_class.small_pool_index != mq->size_class.default_pool_index)
+    s = format (s, "%Ubuffer-pool %u\n", format_white_space, indent + 4,
+		mq->size_class.pool_index);
+
   return s;
 }
 
@@ -235,9 +235,9 @@ memif_validate_desc_data (memif_per_thread_data_t *ptd, memif_if_t *mif,
 
 static_always_inline u32
 memif_process_desc (vlib_main_t *vm, vlib_node_runtime_t *node,
-		    memif_per_thread_data_t *ptd, memif_if_t *mif)
+		    memif_per_thread_data_t *ptd, memif_if_t *mif,
+		    u16 buffer_size)
 {
-  u16 buffer_size = vlib_buffer_get_default_data_size (vm);
   int is_ip = mif->mode == MEMIF_INTERFACE_MODE_IP;
   i16 start_offset = (is_ip) ? MEMIF_IP_OFFSET : 0;
   memif_packet_op_t *po = ptd->packet_ops;
@@ -379,9 +379,8 @@ memif_fill_buffer_mdata_simple (vlib_node_runtime_t *node,
 static_always_inline void
 memif_fill_buffer_mdata (vlib_main_t *vm, vlib_node_runtime_t *node,
 			 memif_per_thread_data_t *ptd, memif_if_t *mif,
-			 u32 *bi, u16 *next, int is_ip)
+			 u32 *bi, u16 *next, u16 buffer_size, int is_ip)
 {
-  u16 buffer_size = vlib_buffer_get_default_data_size (vm);
   vlib_buffer_t *b0, *b1, *b2, *b3, bt;
   memif_packet_op_t *po;
   /* process buffer metadata */
@@ -497,7 +496,7 @@ memif_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   memif_main_t *mm = &memif_main;
   memif_ring_t *ring;
   memif_queue_t *mq;
-  u16 buffer_size = vlib_buffer_get_default_data_size (vm);
+  u16 buffer_size;
   uword n_trace;
   u16 nexts[MEMIF_RX_VECTOR_SZ], *next = nexts;
   u32 _to_next_bufs[MEMIF_RX_VECTOR_SZ], *to_next_bufs = _to_next_bufs, *bi;
@@ -513,6 +512,8 @@ memif_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   memif_copy_op_t *co;
   int is_slave = (mif->flags & MEMIF_IF_FLAG_IS_SLAVE) != 0;
   int is_simple = 1;
+  u8 buffer_pool_index;
+  u32 n_small;
   int i;
 
   mq = vec_elt_at_index (mif->rx_queues, qid);
@@ -551,6 +552,16 @@ memif_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   else
     memif_validate_desc_data (ptd, mif, n_desc, /* is_ethernet */ 0);
 
+  /* pick buffer size class from observed packet sizes, batches with only
+   * single descriptor packets fitting into small buffers count as small */
+  n_small = 0;
+  if (n_desc == ptd->n_packets &&
+      ptd->max_desc_len + start_offset <= mq->size_class.small_data_size)
+    n_small = ptd->n_packets;
+  buffer_pool_index =
+    vlib_buffer_size_class_update (&mq->size_class, ptd->n_packets, n_small);
+  buffer_size = vlib_buffer_get_pool_data_size (vm, buffer_pool_index);
+
   if (ptd->max_desc_len > buffer_size - start_offset)
     is_simple = 0;
 
@@ -560,7 +571,7 @@ memif_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   if (is_simple)
     n_buffers = ptd->n_packets;
   else
-    n_buffers = memif_process_desc (vm, node, ptd, mif);
+    n_buffers = memif_process_desc (vm, node, ptd, mif, buffer_size);
 
   if (PREDICT_FALSE (n_buffers == 0))
     {
@@ -572,7 +583,7 @@ memif_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   /* allocate free buffers */
   vec_validate_aligned (ptd->buffers, n_buffers - 1, CLIB_CACHE_LINE_BYTES);
   n_alloc = vlib_buffer_alloc_from_pool (vm, ptd->buffers, n_buffers,
-					 mq->buffer_pool_index);
+					 buffer_pool_index);
   if (PREDICT_FALSE (n_alloc != n_buffers))
     {
       if (n_alloc)
@@ -631,7 +642,7 @@ memif_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   vnet_buffer (&ptd->buffer_template)->feature_arc_index = 0;
   ptd->buffer_template.current_data = start_offset;
   ptd->buffer_template.current_config_index = 0;
-  ptd->buffer_template.buffer_pool_index = mq->buffer_pool_index;
+  ptd->buffer_template.buffer_pool_index = buffer_pool_index;
   ptd->buffer_template.ref_count = 1;
 
   if (mode == MEMIF_INTERFACE_MODE_ETHERNET)
@@ -672,9 +683,11 @@ memif_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   else
     {
       if (mode == MEMIF_INTERFACE_MODE_IP)
-	memif_fill_buffer_mdata (vm, node, ptd, mif, to_next_bufs, nexts, 1);
+	memif_fill_buffer_mdata (vm, node, ptd, mif, to_next_bufs, nexts,
+				 buffer_size, 1);
       else
-	memif_fill_buffer_mdata (vm, node, ptd, mif, to_next_bufs, nexts, 0);
+	memif_fill_buffer_mdata (vm, node, ptd, mif, to_next_bufs, nexts,
+				 buffer_size, 0);
     }
 
   /* packet trace if enabled */
@@ -782,7 +795,8 @@ memif_device_input_zc_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   /* asume that somebody will want to add ethernet header on the packet
      so start with IP header at offset 14 */
   start_offset = (mode == MEMIF_INTERFACE_MODE_IP) ? 14 : 0;
-  buffer_length = vlib_buffer_get_default_data_size (vm) - start_offset;
+  buffer_length =
+    vlib_buffer_get_pool_data_size (vm, mq->buffer_pool_index) - start_offset;
 
   cur_slot = mq->last_tail;
   last_slot = __atomic_load_n (&ring->tail, __ATOMIC_ACQUIRE);
@@ -1070,6 +1084,7 @@ CLIB_MARCH_FN (memif_dma_completion_cb, void, vlib_main_t *vm,
   dma_info = mq->dma_info + mq->dma_info_head;
   memif_per_thread_data_t *ptd = &dma_info->data;
   vnet_main_t *vnm = vnet_get_main ();
+  u32 buffer_size;
 
   u32 next_index = VNET_DEVICE_INPUT_NEXT_ETHERNET_INPUT;
 
@@ -1115,12 +1130,13 @@ CLIB_MARCH_FN (memif_dma_completion_cb, void, vlib_main_t *vm,
 
   vec_reset_length (ptd->buffers);
 
+  buffer_size = vlib_buffer_get_pool_data_size (vm, mq->buffer_pool_index);
   if (dma_info->mode == MEMIF_INTERFACE_MODE_IP)
     memif_fill_buffer_mdata (vm, dma_info->node, ptd, mif, to_next_bufs, nexts,
-			     1);
+			     buffer_size, 1);
   else
     memif_fill_buffer_mdata (vm, dma_info->node, ptd, mif, to_next_bufs, nexts,
-			     0);
+			     buffer_size, 0);
 
   /* packet trace if enabled */
   if (PREDICT_FALSE ((n_trace = vlib_get_trace_count (vm, dma_info->node))))
@@ -1235,7 +1251,9 @@ memif_device_input_inline_dma (vlib_main_t *vm, vlib_node_runtime_t *node,
     memif_validate_desc_data (&dma_info->data, mif, n_desc,
 			      /* is_ethernet */ 0);
 
-  n_buffers = memif_process_desc (vm, node, ptd, mif);
+  n_buffers = memif_process_desc (
+    vm, node, ptd, mif,
+    vlib_buffer_get_pool_data_size (vm, mq->buffer_pool_index));
 
   if (PREDICT_FALSE (n_buffers == 0))
     {
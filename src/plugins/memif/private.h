@@ -140,6 +140,7 @@ typedef struct
   u16 last_tail;
   u32 *buffers;
   u8 buffer_pool_index;
+  vlib_buffer_size_class_t size_class;
 
   /* dma data */
   u16 dma_head;
@@ -0,0 +1,61 @@
+/* SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <vnet/vnet.h>
+#include <perfmon/perfmon.h>
+#include <perfmon/intel/core.h>
+
+/* Per thread counters only run while the thread is scheduled, so time spent
+   sleeping is not in time_running. Residency is relative to wall clock time
+   since the bundle was started. */
+static f64
+core_power_elapsed (void)
+{
+  perfmon_main_t *pm = &perfmon_main;
+
+  if (pm->is_running)
+    return vlib_time_now (vlib_get_main ()) - pm->sample_time;
+  return pm->sample_time;
+}
+
+static u8 *
+format_core_power (u8 *s, va_list *args)
+{
+  perfmon_reading_t *r = va_arg (*args, perfmon_reading_t *);
+  int row = va_arg (*args, int);
+  f64 tsc_hz = vlib_get_main ()->clib_time.clocks_per_second;
+  f64 elapsed = core_power_elapsed ();
+
+  switch (row)
+    {
+    case 0:
+      s = format (s, "%.2f", elapsed);
+      break;
+    case 1:
+      if (elapsed > 0)
+	s = format (s, "%.2f", r->value[1] / (elapsed * tsc_hz) * 100);
+      break;
+    case 2:
+      if (r->value[1])
+	s = format (s, "%.2f", r->value[0] / (f64) r->value[1] * tsc_hz * 1e-9);
+      break;
+    case 3:
+      if (r->value[0])
+	s = format (s, "%.2f", r->value[2] / (f64) r->value[0] * 100);
+      break;
+    }
+  return s;
+}
+
+PERFMON_REGISTER_BUNDLE (core_power) = {
+  .name = "core-power",
+  .description = "Thread unhalted residency, frequency and power throttling",
+  .source = "intel-core",
+  .type = PERFMON_BUNDLE_TYPE_THREAD,
+  .events[0] = INTEL_CORE_E_CPU_CLK_UNHALTED_THREAD_P,
+  .events[1] = INTEL_CORE_E_CPU_CLK_UNHALTED_REF_TSC,
+  .events[2] = INTEL_CORE_E_CORE_POWER_THROTTLE,
+  .n_events = 3,
+  .format_fn = format_core_power,
+  .column_headers = PERFMON_STRINGS ("RunTime", "C0%", "GHz", "Throttle%"),
+};
@@ -648,17 +648,34 @@ quic_connection_closed (quic_ctx_t * ctx)
     }
 }
 
+/**
+ * Enqueue packets to udp session as one dgram
+ *
+ * All packets but the last must be of equal size and the last must not be
+ * larger. If more than one, the session layer uses the gso size to
+ * segment the dgram back into individual udp packets.
+ */
 static int
-quic_send_datagram (session_t *udp_session, struct iovec *packet,
-		    quicly_address_t *dest, quicly_address_t *src)
+quic_send_datagrams (session_t *udp_session, struct iovec *packets,
+		     u32 n_packets, quicly_address_t *dest,
+		     quicly_address_t *src)
 {
-  u32 max_enqueue, len;
+  svm_fifo_seg_t segs[1 + QUIC_SEND_PACKET_VEC_SIZE];
+  u32 max_enqueue, len = 0, i;
   session_dgram_hdr_t hdr;
   svm_fifo_t *f;
   transport_connection_t *tc;
   int ret;
 
-  len = packet->iov_len;
+  ASSERT (n_packets && n_packets <= QUIC_SEND_PACKET_VEC_SIZE);
+
+  for (i = 0; i < n_packets; i++)
+    {
+      segs[i + 1].data = packets[i].iov_base;
+      segs[i + 1].len = packets[i].iov_len;
+      len += packets[i].iov_len;
+    }
+
   f = udp_session->tx_fifo;
   tc = session_get_transport (udp_session);
   max_enqueue = svm_fifo_max_enqueue (f);
@@ -675,7 +692,7 @@ quic_send_datagram (session_t *udp_session, struct iovec *packet,
   hdr.is_ip4 = tc->is_ip4;
   clib_memcpy (&hdr.lcl_ip, &tc->lcl_ip, sizeof (ip46_address_t));
   hdr.lcl_port = tc->lcl_port;
-  hdr.gso_size = 0;
+  hdr.gso_size = n_packets > 1 ? packets[0].iov_len : 0;
 
   /*  Read dest address from quicly-provided sockaddr */
   if (hdr.is_ip4)
@@ -693,21 +710,31 @@ quic_send_datagram (session_t *udp_session, struct iovec *packet,
       clib_memcpy_fast (&hdr.rmt_ip.ip6, &sa6->sin6_addr, 16);
     }
 
-  svm_fifo_seg_t segs[2] = { { (u8 *) &hdr, sizeof (hdr) },
-			     { packet->iov_base, len } };
+  segs[0].data = (u8 *) &hdr;
+  segs[0].len = sizeof (hdr);
 
-  ret = svm_fifo_enqueue_segments (f, segs, 2, 0 /* allow partial */);
+  ret = svm_fifo_enqueue_segments (f, segs, n_packets + 1,
+				   0 /* allow partial */);
   if (PREDICT_FALSE (ret < 0))
     {
       QUIC_ERR ("Not enough space to enqueue dgram");
       return QUIC_ERROR_FULL_FIFO;
     }
 
-  quic_increment_counter (QUIC_ERROR_TX_PACKETS, 1);
+  quic_increment_counter (QUIC_ERROR_TX_PACKETS, n_packets);
+  if (n_packets > 1)
+    quic_increment_counter (QUIC_ERROR_TX_GSO_DGRAMS, 1);
 
   return 0;
 }
 
+static int
+quic_send_datagram (session_t *udp_session, struct iovec *packet,
+		    quicly_address_t *dest, quicly_address_t *src)
+{
+  return quic_send_datagrams (udp_session, packet, 1, dest, src);
+}
+
 static int
 quic_send_packets (quic_ctx_t * ctx)
 {
@@ -717,7 +744,7 @@ quic_send_packets (quic_ctx_t * ctx)
 				      ->transport_params.max_udp_payload_size];
   session_t *udp_session;
   quicly_conn_t *conn;
-  size_t num_packets, i, max_packets;
+  size_t num_packets, i, n_train, max_packets;
   quicly_address_t dest, src;
   u32 n_sent = 0;
   int err = 0;
@@ -748,13 +775,19 @@ quic_send_packets (quic_ctx_t * ctx)
 			      sizeof (buf))))
 	goto quicly_error;
 
-      for (i = 0; i != num_packets; ++i)
+      for (i = 0; i != num_packets; i += n_train)
 	{
-
-	  if ((err =
-		 quic_send_datagram (udp_session, &packets[i], &dest, &src)))
+	  /* Send runs of full sized packets, and possibly a shorter last
+	   * one, as a single gso dgram */
+	  n_train = 1;
+	  while (i + n_train < num_packets &&
+		 packets[i + n_train - 1].iov_len == packets[i].iov_len &&
+		 packets[i + n_train].iov_len <= packets[i].iov_len)
+	    n_train++;
+
+	  if ((err = quic_send_datagrams (udp_session, &packets[i], n_train,
+					  &dest, &src)))
 	    goto quicly_error;
-
 	}
       n_sent += num_packets;
     }
@@ -2277,11 +2310,29 @@ quic_process_one_rx_packet (u64 udp_session_handle, svm_fifo_t * f,
   return 1;
 }
 
+static inline int
+quic_rx_packet_is_last_for_ctx (quic_rx_packet_ctx_t *packets_ctx, u32 i,
+				u32 n_packets)
+{
+  u32 j;
+
+  for (j = i + 1; j < n_packets; j++)
+    {
+      if (packets_ctx[j].ptype != QUIC_PACKET_TYPE_RECEIVE &&
+	  packets_ctx[j].ptype != QUIC_PACKET_TYPE_ACCEPT)
+	continue;
+      if (packets_ctx[j].ctx_index == packets_ctx[i].ctx_index &&
+	  packets_ctx[j].thread_index == packets_ctx[i].thread_index)
+	return 0;
+    }
+  return 1;
+}
+
 static int
 quic_udp_session_rx_callback (session_t * udp_session)
 {
   /*  Read data from UDP rx_fifo and pass it to the quicly conn. */
-  quic_ctx_t *ctx = NULL, *prev_ctx = NULL;
+  quic_ctx_t *ctx = NULL;
   svm_fifo_t *f = udp_session->rx_fifo;
   u32 max_deq;
   u64 udp_session_handle = session_handle (udp_session);
@@ -2361,10 +2412,8 @@ rx_start:
 	  break;
 	}
     }
-  ctx = prev_ctx = NULL;
   for (i = 0; i < max_packets; i++)
     {
-      prev_ctx = ctx;
       switch (packets_ctx[i].ptype)
 	{
 	case QUIC_PACKET_TYPE_RECEIVE:
@@ -2382,7 +2431,9 @@ rx_start:
 	  continue;		/* this exits the for loop since other packet types are
 				   necessarily the last in the batch */
 	}
-      if (ctx != prev_ctx)
+      /* Flush connection once per batch, after its last packet, so acks
+       * and data are coalesced even if connections are interleaved */
+      if (quic_rx_packet_is_last_for_ctx (packets_ctx, i, max_packets))
 	quic_send_packets (ctx);
     }
 
@@ -2513,7 +2564,7 @@ quic_init (vlib_main_t * vm)
   vnet_app_attach_args_t _a, *a = &_a;
   u64 options[APP_OPTIONS_N_OPTIONS];
   quic_main_t *qm = &quic_main;
-  u32 num_threads, i;
+  u32 num_threads, i, j;
   u8 seed[32];
 
   if (syscall (SYS_getrandom, &seed, sizeof (seed), 0) != sizeof (seed))
@@ -2589,11 +2640,13 @@ quic_init (vlib_main_t * vm)
       quic_register_cipher_suite (CRYPTO_ENGINE_VPP,
 				  quic_crypto_cipher_suites);
       qm->default_crypto_engine = CRYPTO_ENGINE_VPP;
-      vec_validate (qm->per_thread_crypto_key_indices, num_threads);
+      vec_validate (qm->per_thread_crypto_key_cache, num_threads);
       for (i = 0; i < num_threads; i++)
 	{
-	  qm->per_thread_crypto_key_indices[i] = vnet_crypto_key_add (
-	    vm, VNET_CRYPTO_ALG_AES_256_CTR, empty_key, 32);
+	  quic_crypto_key_cache_t *kc = &qm->per_thread_crypto_key_cache[i];
+	  for (j = 0; j < QUIC_CRYPTO_N_CACHED_KEYS; j++)
+	    kc->key_indices[j] = vnet_crypto_key_add (
+	      vm, VNET_CRYPTO_ALG_AES_256_CTR, empty_key, 32);
 	}
     }
 
@@ -2749,6 +2802,8 @@ quic_show_aggregated_stats (vlib_main_t * vm)
 		   quic_get_counter_value (QUIC_ERROR_ONE_RTT_RX_PACKETS));
   vlib_cli_output (vm, "TX Total:        %d",
 		   quic_get_counter_value (QUIC_ERROR_TX_PACKETS));
+  vlib_cli_output (vm, "TX GSO dgrams:   %d",
+		   quic_get_counter_value (QUIC_ERROR_TX_GSO_DGRAMS));
   vlib_cli_output (vm, "----------- Stats -----------");
   vlib_cli_output (vm, "Min      RTT     %f",
 		   nconn > 0 ? agg_stats.rtt.minimum / nconn : 0);
@@ -49,6 +49,8 @@
 
 #define QUIC_RCV_MAX_PACKETS 16
 
+#define QUIC_CRYPTO_N_CACHED_KEYS 4
+
 #define QUIC_DEFAULT_CONN_TIMEOUT (30 * 1000)	/* 30 seconds */
 
 /* Taken from quicly.c */
@@ -241,6 +243,15 @@ typedef struct quic_rx_packet_ctx_
   session_dgram_hdr_t ph;
 } quic_rx_packet_ctx_t;
 
+/* Vnet crypto keys are expensive to (re)program, as engines expand the
+ * key schedule, so keep a few per thread and reuse them while the
+ * connection keys they hold are in use */
+typedef struct quic_crypto_key_cache_
+{
+  u32 key_indices[QUIC_CRYPTO_N_CACHED_KEYS];
+  u8 next;
+} quic_crypto_key_cache_t;
+
 typedef struct quic_main_
 {
   u32 app_index;
@@ -263,7 +274,7 @@ typedef struct quic_main_
   u32 connection_timeout;
 
   u8 vnet_crypto_enabled;
-  u32 *per_thread_crypto_key_indices;
+  quic_crypto_key_cache_t *per_thread_crypto_key_cache;
 } quic_main_t;
 
 #endif /* __included_quic_h__ */
@@ -128,10 +128,29 @@ static u32
 quic_crypto_set_key (crypto_key_t *key)
 {
   u8 thread_index = vlib_get_thread_index ();
-  u32 key_id = quic_main.per_thread_crypto_key_indices[thread_index];
-  vnet_crypto_key_t *vnet_key = vnet_crypto_get_key (key_id);
-  vlib_main_t *vm = vlib_get_main ();
+  quic_crypto_key_cache_t *kc;
+  vnet_crypto_key_t *vnet_key;
+  vlib_main_t *vm;
   vnet_crypto_engine_t *engine;
+  u32 key_id;
+  int i;
+
+  kc = vec_elt_at_index (quic_main.per_thread_crypto_key_cache, thread_index);
+
+  /* Packet protection and header protection keys alternate for every
+   * packet, so reprogram a key only if none of the cached ones match */
+  for (i = 0; i < QUIC_CRYPTO_N_CACHED_KEYS; i++)
+    {
+      vnet_key = vnet_crypto_get_key (kc->key_indices[i]);
+      if (vnet_key->alg == key->algo &&
+	  !clib_memcmp (vnet_key->data, key->key, key->key_len))
+	return kc->key_indices[i];
+    }
+
+  key_id = kc->key_indices[kc->next];
+  kc->next = (kc->next + 1) % QUIC_CRYPTO_N_CACHED_KEYS;
+  vnet_key = vnet_crypto_get_key (key_id);
+  vm = vlib_get_main ();
 
   vec_foreach (engine, cm->engines)
     if (engine->key_op_handler)
@@ -27,6 +27,55 @@ typedef void (*ptls_vpp_do_transform_fn) (ptls_cipher_context_t *, void *,
 vnet_crypto_main_t *cm = &crypto_main;
 extern picotls_main_t picotls_main;
 
+#define PTLS_VPP_CRYPTO_BATCH_SIZE 32
+#define PTLS_VPP_CRYPTO_MAX_AAD	   16
+#define PTLS_VPP_CRYPTO_MAX_INLINE 16
+#define PTLS_VPP_CRYPTO_MAX_CHUNKS 8
+#define PTLS_VPP_CRYPTO_MAX_SEGS   4
+
+/* Op data that picotls only provides on the stack, or in the aead context,
+ * and must be kept until the batch is processed */
+typedef struct ptls_vpp_crypto_op_data_
+{
+  u8 iv[PTLS_MAX_IV_SIZE];
+  u8 aad[PTLS_VPP_CRYPTO_MAX_AAD];
+  u8 src[2][PTLS_VPP_CRYPTO_MAX_INLINE];
+} ptls_vpp_crypto_op_data_t;
+
+/* Per thread batch of deferred record encryption ops. While active, record
+ * sealing is postponed until the batch is flushed so that all records
+ * of a write are handed to the crypto engine at once */
+typedef struct ptls_vpp_crypto_batch_
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  u8 is_active;
+  u32 n_ops;
+  u32 n_chunks;
+
+  /* Records built by picotls in the remap buffer are sealed directly into
+   * the remap segments. Only what is not written by the crypto engine, i.e.,
+   * record headers, is later copied. Offsets of bytes to copy are kept as
+   * [start, end) pairs */
+  u8 *remap_base;
+  u32 remap_len;
+  u32 remap_cursor;
+  u32 n_remap_segs;
+  u32 *remap_copy;
+  svm_fifo_seg_t remap_segs[PTLS_VPP_CRYPTO_MAX_SEGS];
+
+  /* Records picotls decrypts into the remap buffer are opened into the
+   * remap segments instead. The first remap_done bytes are in segments */
+  u8 remap_is_rx;
+  u32 remap_done;
+
+  vnet_crypto_op_t ops[PTLS_VPP_CRYPTO_BATCH_SIZE];
+  vnet_crypto_op_chunk_t
+    chunks[PTLS_VPP_CRYPTO_MAX_CHUNKS * PTLS_VPP_CRYPTO_BATCH_SIZE];
+  ptls_vpp_crypto_op_data_t data[PTLS_VPP_CRYPTO_BATCH_SIZE];
+} ptls_vpp_crypto_batch_t;
+
+static ptls_vpp_crypto_batch_t *ptls_vpp_crypto_batches;
+
 struct cipher_context_t
 {
   ptls_cipher_context_t super;
@@ -120,6 +169,158 @@ ptls_vpp_crypto_cipher_setup_crypto (ptls_cipher_context_t * _ctx, int is_enc,
   return 0;
 }
 
+static void
+ptls_vpp_crypto_aead_encrypt_init (ptls_aead_context_t *_ctx, uint64_t seq,
+				   const void *aad, size_t aadlen)
+{
+  struct vpp_aead_context_t *ctx = (struct vpp_aead_context_t *) _ctx;
+
+  vnet_crypto_op_init (&ctx->op, ctx->id);
+  ctx->op.aad = (void *) aad;
+  ctx->op.aad_len = aadlen;
+  ctx->op.iv = ctx->iv;
+  ptls_aead__build_iv (ctx->super.algo, ctx->op.iv, ctx->static_iv, seq);
+  ctx->op.key_index = ctx->key_index;
+  ctx->op.n_chunks = 0;
+  ctx->op.chunk_index = 0;
+  ctx->chunk_index = 0;
+
+  ctx->op.flags |= VNET_CRYPTO_OP_FLAG_CHAINED_BUFFERS;
+}
+
+static size_t
+ptls_vpp_crypto_aead_encrypt_update (ptls_aead_context_t * _ctx, void *output,
+				     const void *input, size_t inlen)
+{
+  struct vpp_aead_context_t *ctx = (struct vpp_aead_context_t *) _ctx;
+
+  /* Picotls passes the record payload and then its content type */
+  ASSERT (ctx->chunk_index < ARRAY_LEN (ctx->chunks));
+  ctx->chunks[ctx->chunk_index].dst = output;
+  ctx->chunks[ctx->chunk_index].src = (void *) input;
+  ctx->chunks[ctx->chunk_index].len = inlen;
+  ctx->chunk_index += 1;
+  ctx->op.n_chunks = ctx->chunk_index;
+
+  return inlen;
+}
+
+static void
+ptls_vpp_crypto_batch_process (vlib_main_t *vm, ptls_vpp_crypto_batch_t *b)
+{
+  u32 i;
+
+  if (!b->n_ops)
+    return;
+
+  vnet_crypto_process_chained_ops (vm, b->ops, b->chunks, b->n_ops);
+  for (i = 0; i < b->n_ops; i++)
+    assert (b->ops[i].status == VNET_CRYPTO_OP_STATUS_COMPLETED);
+  b->n_ops = 0;
+  b->n_chunks = 0;
+}
+
+/**
+ * Map range of remap buffer that starts at dst to remap segments
+ *
+ * @return number of chunks the range was split into or 0 if it cannot be
+ * remapped, in which case it's left in the remap buffer
+ */
+static u32
+ptls_vpp_crypto_remap (ptls_vpp_crypto_batch_t *b, u8 *dst, u8 *src, u32 len,
+		       vnet_crypto_op_chunk_t *chunks, u32 max_chunks)
+{
+  u32 offset, seg_offset, left, n_bytes, i = 0, n_chunks = 0;
+
+  if (!b->remap_base || !len || dst < b->remap_base ||
+      dst + len > b->remap_base + b->remap_len)
+    return 0;
+
+  offset = dst - b->remap_base;
+  if (offset < b->remap_cursor)
+    return 0;
+
+  seg_offset = offset;
+  while (i < b->n_remap_segs && seg_offset >= b->remap_segs[i].len)
+    seg_offset -= b->remap_segs[i++].len;
+
+  left = len;
+  while (left)
+    {
+      if (i == b->n_remap_segs || n_chunks == max_chunks)
+	return 0;
+      n_bytes = clib_min (left, b->remap_segs[i].len - seg_offset);
+      chunks[n_chunks].src = src;
+      chunks[n_chunks].dst = b->remap_segs[i].data + seg_offset;
+      chunks[n_chunks].len = n_bytes;
+      src += n_bytes;
+      left -= n_bytes;
+      seg_offset = 0;
+      n_chunks += 1;
+      i += 1;
+    }
+
+  /* Bytes between last remapped range and this one must be copied */
+  if (offset > b->remap_cursor)
+    {
+      vec_add1 (b->remap_copy, b->remap_cursor);
+      vec_add1 (b->remap_copy, offset);
+    }
+  b->remap_cursor = offset + len;
+
+  return n_chunks;
+}
+
+static void
+ptls_vpp_crypto_remap_copy (ptls_vpp_crypto_batch_t *b, u8 *buf, u32 start,
+			    u32 end, u8 to_buf)
+{
+  u32 seg_offset = start, n_bytes, i = 0;
+  u8 *seg_data;
+
+  while (i < b->n_remap_segs && seg_offset >= b->remap_segs[i].len)
+    seg_offset -= b->remap_segs[i++].len;
+
+  while (start < end && i < b->n_remap_segs)
+    {
+      n_bytes = clib_min (end - start, b->remap_segs[i].len - seg_offset);
+      seg_data = b->remap_segs[i].data + seg_offset;
+      if (to_buf)
+	clib_memcpy_fast (buf + start, seg_data, n_bytes);
+      else
+	clib_memcpy_fast (seg_data, buf + start, n_bytes);
+      start += n_bytes;
+      seg_offset = 0;
+      i += 1;
+    }
+}
+
+/**
+ * Picotls looks for the content type at the end of the plaintext and
+ * parses the plaintext of anything but app data. Copy the type byte to the
+ * remap buffer. If that is not enough, i.e., for other records or padded
+ * app data, copy the whole record and stop remapping
+ */
+static void
+ptls_vpp_crypto_rx_remap_check (ptls_vpp_crypto_batch_t *b, u8 *output,
+				u32 len)
+{
+  u32 offset = output - b->remap_base;
+
+  ptls_vpp_crypto_remap_copy (b, b->remap_base, offset + len - 1,
+			      offset + len, 1 /* to_buf */);
+  if (output[len - 1] == PTLS_CONTENT_TYPE_APPDATA)
+    {
+      /* Type byte is overwritten by next record's plaintext */
+      b->remap_cursor = b->remap_done = offset + len - 1;
+      return;
+    }
+
+  ptls_vpp_crypto_remap_copy (b, b->remap_base, offset, offset + len - 1,
+			      1 /* to_buf */);
+  b->remap_is_rx = 0;
+}
+
 size_t
 ptls_vpp_crypto_aead_decrypt (ptls_aead_context_t *_ctx, void *_output,
 			      const void *input, size_t inlen, uint64_t seq,
@@ -127,7 +328,10 @@ ptls_vpp_crypto_aead_decrypt (ptls_aead_context_t *_ctx, void *_output,
 {
   vlib_main_t *vm = vlib_get_main ();
   struct vpp_aead_context_t *ctx = (struct vpp_aead_context_t *) _ctx;
+  vnet_crypto_op_chunk_t chunks[PTLS_VPP_CRYPTO_MAX_SEGS];
   int tag_size = ctx->super.algo->tag_size;
+  ptls_vpp_crypto_batch_t *b;
+  u32 n_chunks = 0;
 
   vnet_crypto_op_init (&ctx->op, ctx->id);
   ctx->op.aad = (u8 *) aad;
@@ -141,42 +345,87 @@ ptls_vpp_crypto_aead_decrypt (ptls_aead_context_t *_ctx, void *_output,
   ctx->op.tag_len = tag_size;
   ctx->op.tag = ctx->op.src + ctx->op.len;
 
+  /* Plaintext must continue what is already in the segments */
+  b = vec_elt_at_index (ptls_vpp_crypto_batches, vm->thread_index);
+  if (b->remap_is_rx && (u8 *) _output == b->remap_base + b->remap_cursor)
+    n_chunks = ptls_vpp_crypto_remap (b, _output, ctx->op.src, ctx->op.len,
+				      chunks, ARRAY_LEN (chunks));
+
+  if (n_chunks)
+    {
+      ctx->op.flags |= VNET_CRYPTO_OP_FLAG_CHAINED_BUFFERS;
+      ctx->op.chunk_index = 0;
+      ctx->op.n_chunks = n_chunks;
+      vnet_crypto_process_chained_ops (vm, &(ctx->op), chunks, 1);
+      assert (ctx->op.status == VNET_CRYPTO_OP_STATUS_COMPLETED);
+      ptls_vpp_crypto_rx_remap_check (b, _output, ctx->op.len);
+      return ctx->op.len;
+    }
+
   vnet_crypto_process_ops (vm, &(ctx->op), 1);
   assert (ctx->op.status == VNET_CRYPTO_OP_STATUS_COMPLETED);
 
   return ctx->op.len;
 }
 
-static void
-ptls_vpp_crypto_aead_encrypt_init (ptls_aead_context_t *_ctx, uint64_t seq,
-				   const void *aad, size_t aadlen)
+static int
+ptls_vpp_crypto_batch_add (ptls_vpp_crypto_batch_t *b,
+			   struct vpp_aead_context_t *ctx)
 {
-  struct vpp_aead_context_t *ctx = (struct vpp_aead_context_t *) _ctx;
+  vnet_crypto_op_chunk_t chunk, tag;
+  ptls_vpp_crypto_op_data_t *data;
+  vnet_crypto_op_t *op;
+  u32 n_chunks;
+  int i;
 
-  vnet_crypto_op_init (&ctx->op, ctx->id);
-  ctx->op.aad = (void *) aad;
-  ctx->op.aad_len = aadlen;
-  ctx->op.iv = ctx->iv;
-  ptls_aead__build_iv (ctx->super.algo, ctx->op.iv, ctx->static_iv, seq);
-  ctx->op.key_index = ctx->key_index;
-  ctx->op.n_chunks = 2;
-  ctx->op.chunk_index = 0;
+  if (ctx->op.aad_len > PTLS_VPP_CRYPTO_MAX_AAD)
+    return -1;
 
-  ctx->op.flags |= VNET_CRYPTO_OP_FLAG_CHAINED_BUFFERS;
-}
+  ASSERT (ctx->op.n_chunks <= ARRAY_LEN (data->src));
 
-static size_t
-ptls_vpp_crypto_aead_encrypt_update (ptls_aead_context_t * _ctx, void *output,
-				     const void *input, size_t inlen)
-{
-  struct vpp_aead_context_t *ctx = (struct vpp_aead_context_t *) _ctx;
-  ctx->chunks[ctx->chunk_index].dst = output;
-  ctx->chunks[ctx->chunk_index].src = (void *) input;
-  ctx->chunks[ctx->chunk_index].len = inlen;
+  if (b->n_ops == PTLS_VPP_CRYPTO_BATCH_SIZE)
+    ptls_vpp_crypto_batch_process (vlib_get_main (), b);
 
-  ctx->chunk_index = ctx->chunk_index == 0 ? 1 : 0;
+  op = &b->ops[b->n_ops];
+  data = &b->data[b->n_ops];
 
-  return inlen;
+  *op = ctx->op;
+  clib_memcpy_fast (data->iv, ctx->iv, sizeof (data->iv));
+  clib_memcpy_fast (data->aad, ctx->op.aad, ctx->op.aad_len);
+  op->iv = data->iv;
+  op->aad = data->aad;
+  op->chunk_index = b->n_chunks;
+  op->n_chunks = 0;
+
+  for (i = 0; i < ctx->op.n_chunks; i++)
+    {
+      chunk = ctx->chunks[i];
+      /* Small chunks, like the record content type, may be on the stack */
+      if (chunk.len <= PTLS_VPP_CRYPTO_MAX_INLINE)
+	{
+	  clib_memcpy_fast (data->src[i], chunk.src, chunk.len);
+	  chunk.src = data->src[i];
+	}
+      /* Keep room for the chunks that follow */
+      n_chunks = ptls_vpp_crypto_remap (
+	b, chunk.dst, chunk.src, chunk.len, &b->chunks[b->n_chunks],
+	PTLS_VPP_CRYPTO_MAX_CHUNKS - op->n_chunks -
+	  (ctx->op.n_chunks - i - 1));
+      if (!n_chunks)
+	{
+	  b->chunks[b->n_chunks] = chunk;
+	  n_chunks = 1;
+	}
+      b->n_chunks += n_chunks;
+      op->n_chunks += n_chunks;
+    }
+
+  /* Tag must be contiguous, otherwise it's copied with the headers */
+  if (ptls_vpp_crypto_remap (b, op->tag, 0, op->tag_len, &tag, 1))
+    op->tag = tag.dst;
+
+  b->n_ops += 1;
+  return 0;
 }
 
 static size_t
@@ -184,22 +433,144 @@ ptls_vpp_crypto_aead_encrypt_final (ptls_aead_context_t * _ctx, void *_output)
 {
   struct vlib_main_t *vm = vlib_get_main ();
   struct vpp_aead_context_t *ctx = (struct vpp_aead_context_t *) _ctx;
+  ptls_vpp_crypto_batch_t *b;
 
   ctx->op.tag = _output;
   ctx->op.tag_len = ctx->super.algo->tag_size;
 
+  b = vec_elt_at_index (ptls_vpp_crypto_batches, vm->thread_index);
+  if (b->is_active && !ptls_vpp_crypto_batch_add (b, ctx))
+    return ctx->super.algo->tag_size;
+
   vnet_crypto_process_chained_ops (vm, &(ctx->op), ctx->chunks, 1);
   assert (ctx->op.status == VNET_CRYPTO_OP_STATUS_COMPLETED);
 
   return ctx->super.algo->tag_size;
 }
 
+void
+ptls_vpp_crypto_batch_begin (void)
+{
+  u32 thread_index = vlib_get_thread_index ();
+  ptls_vpp_crypto_batch_t *b;
+
+  b = vec_elt_at_index (ptls_vpp_crypto_batches, thread_index);
+  ASSERT (!b->n_ops);
+  b->is_active = 1;
+}
+
+void
+ptls_vpp_crypto_batch_flush (void)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  ptls_vpp_crypto_batch_t *b;
+
+  b = vec_elt_at_index (ptls_vpp_crypto_batches, vm->thread_index);
+  ptls_vpp_crypto_batch_process (vm, b);
+}
+
+void
+ptls_vpp_crypto_batch_end (void)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  ptls_vpp_crypto_batch_t *b;
+
+  b = vec_elt_at_index (ptls_vpp_crypto_batches, vm->thread_index);
+  ptls_vpp_crypto_batch_process (vm, b);
+  b->is_active = 0;
+}
+
+void
+ptls_vpp_crypto_remap_begin (u8 *buf, u32 len, svm_fifo_seg_t *segs,
+			     u32 n_segs)
+{
+  u32 thread_index = vlib_get_thread_index ();
+  ptls_vpp_crypto_batch_t *b;
+
+  b = vec_elt_at_index (ptls_vpp_crypto_batches, thread_index);
+  ASSERT (b->is_active && !b->remap_base);
+
+  b->remap_base = buf;
+  b->remap_len = len;
+  b->remap_cursor = 0;
+  b->n_remap_segs = clib_min (n_segs, PTLS_VPP_CRYPTO_MAX_SEGS);
+  clib_memcpy_fast (b->remap_segs, segs,
+		    b->n_remap_segs * sizeof (svm_fifo_seg_t));
+  vec_reset_length (b->remap_copy);
+}
+
+void
+ptls_vpp_crypto_remap_end (u8 *buf, u32 len)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  ptls_vpp_crypto_batch_t *b;
+  u32 i;
+
+  b = vec_elt_at_index (ptls_vpp_crypto_batches, vm->thread_index);
+  ptls_vpp_crypto_batch_process (vm, b);
+
+  if (b->remap_cursor < len)
+    {
+      vec_add1 (b->remap_copy, b->remap_cursor);
+      vec_add1 (b->remap_copy, len);
+    }
+
+  for (i = 0; i < vec_len (b->remap_copy); i += 2)
+    ptls_vpp_crypto_remap_copy (b, buf, b->remap_copy[i],
+				b->remap_copy[i + 1], 0 /* to_buf */);
+
+  b->remap_base = 0;
+}
+
+void
+ptls_vpp_crypto_rx_remap_begin (u8 *buf, u32 len, svm_fifo_seg_t *segs,
+				u32 n_segs)
+{
+  u32 thread_index = vlib_get_thread_index ();
+  ptls_vpp_crypto_batch_t *b;
+
+  b = vec_elt_at_index (ptls_vpp_crypto_batches, thread_index);
+  ASSERT (!b->remap_base);
+
+  b->remap_base = buf;
+  b->remap_len = len;
+  b->remap_cursor = 0;
+  b->remap_done = 0;
+  b->remap_is_rx = 1;
+  b->n_remap_segs = clib_min (n_segs, PTLS_VPP_CRYPTO_MAX_SEGS);
+  clib_memcpy_fast (b->remap_segs, segs,
+		    b->n_remap_segs * sizeof (svm_fifo_seg_t));
+}
+
+u32
+ptls_vpp_crypto_rx_remap_end (void)
+{
+  u32 thread_index = vlib_get_thread_index ();
+  ptls_vpp_crypto_batch_t *b;
+
+  b = vec_elt_at_index (ptls_vpp_crypto_batches, thread_index);
+  b->remap_base = 0;
+  b->remap_is_rx = 0;
+
+  return b->remap_done;
+}
+
+void
+ptls_vpp_crypto_init (u32 n_threads)
+{
+  vec_validate_aligned (ptls_vpp_crypto_batches, n_threads - 1,
+			CLIB_CACHE_LINE_BYTES);
+}
+
 static void
 ptls_vpp_crypto_aead_dispose_crypto (ptls_aead_context_t * _ctx)
 {
   vlib_main_t *vm = vlib_get_main ();
   struct vpp_aead_context_t *ctx = (struct vpp_aead_context_t *) _ctx;
 
+  /* Key might be in use by deferred ops, e.g., on key update */
+  ptls_vpp_crypto_batch_flush ();
+
   clib_rwlock_writer_lock (&picotls_main.crypto_keys_rw_lock);
   vnet_crypto_key_del (vm, ctx->key_index);
   clib_rwlock_writer_unlock (&picotls_main.crypto_keys_rw_lock);
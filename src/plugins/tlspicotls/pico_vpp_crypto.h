@@ -20,6 +20,31 @@
 
 extern ptls_cipher_suite_t *ptls_vpp_crypto_cipher_suites[];
 
+void ptls_vpp_crypto_init (u32 n_threads);
+/**
+ * Defer record encryption on current thread until flushed. Output buffers
+ * and plaintext must not be reused until then
+ */
+void ptls_vpp_crypto_batch_begin (void);
+void ptls_vpp_crypto_batch_flush (void);
+void ptls_vpp_crypto_batch_end (void);
+/**
+ * Seal records picotls builds in buf directly into fifo segments. Must be
+ * called with an active batch. Header bytes are copied to the segments and
+ * the batch is flushed on remap end
+ */
+void ptls_vpp_crypto_remap_begin (u8 *buf, u32 len, svm_fifo_seg_t *segs,
+				  u32 n_segs);
+void ptls_vpp_crypto_remap_end (u8 *buf, u32 len);
+/**
+ * Open app data records picotls decrypts into buf directly into fifo
+ * segments, as long as they fit. On end, returns the number of plaintext
+ * bytes at the start of buf that are already in the segments
+ */
+void ptls_vpp_crypto_rx_remap_begin (u8 *buf, u32 len, svm_fifo_seg_t *segs,
+				     u32 n_segs);
+u32 ptls_vpp_crypto_rx_remap_end (void);
+
 #endif /* __included_pico_vpp_crypto_h__ */
 
 /*
@@ -317,11 +317,36 @@ ptls_copy_buf_to_fs (ptls_buffer_t *buf, u32 to_copy, svm_fifo_seg_t *fs,
   return to_copy;
 }
 
+static inline int
+ptls_advance_fs (u32 len, svm_fifo_seg_t *fs, u32 *fs_idx, u32 max_fs)
+{
+  u32 idx = *fs_idx;
+
+  while (len && idx < max_fs)
+    {
+      if (fs[idx].len <= len)
+	{
+	  len -= fs[idx].len;
+	  idx += 1;
+	}
+      else
+	{
+	  fs[idx].len -= len;
+	  fs[idx].data += len;
+	  len = 0;
+	}
+    }
+
+  *fs_idx = idx;
+
+  return len;
+}
+
 static u32
 ptls_tcp_to_app_write (picotls_ctx_t *ptls_ctx, svm_fifo_t *app_rx_fifo,
 		       svm_fifo_t *tcp_rx_fifo)
 {
-  u32 ai = 0, thread_index, min_buf_len, to_copy, left, wrote = 0;
+  u32 ai = 0, thread_index, min_buf_len, to_copy, left, wrote = 0, in_fifo;
   ptls_buffer_t *buf = &ptls_ctx->read_buffer;
   int ret, i = 0, read = 0, tcp_len, n_fs_app;
   u32 n_segs = 4, max_len = 1 << 16;
@@ -379,10 +404,17 @@ ptls_tcp_to_app_write (picotls_ctx_t *ptls_ctx, svm_fifo_t *app_rx_fifo,
 	{
 	  vec_validate (pm->rx_bufs[thread_index], min_buf_len);
 	  ptls_buffer_init (buf, pm->rx_bufs[thread_index], min_buf_len);
+	  /* Records that span app fifo chunks are still opened in place,
+	   * only what does not fit is copied */
+	  ptls_vpp_crypto_rx_remap_begin (buf->base, min_buf_len, &app_fs[ai],
+					  n_fs_app - ai);
 	  ret = ptls_receive (ptls_ctx->tls, buf, tcp_fs[i].data, &deq_now);
+	  in_fifo = ptls_vpp_crypto_rx_remap_end ();
 	  assert (ret == 0 || ret == PTLS_ERROR_IN_PROGRESS);
 
-	  left = ptls_copy_buf_to_fs (buf, buf->off, app_fs, &ai, n_fs_app);
+	  ptls_advance_fs (in_fifo, app_fs, &ai, n_fs_app);
+	  left = ptls_copy_buf_to_fs (buf, buf->off - in_fifo, app_fs, &ai,
+				      n_fs_app);
 	  if (!left)
 	    {
 	      ptls_ctx->read_buffer_offset = 0;
@@ -472,18 +504,18 @@ picotls_ctx_read (tls_ctx_t *ctx, session_t *tcp_session)
 
 static inline u32
 ptls_compute_deq_len (picotls_ctx_t *ptls_ctx, u32 dst_chunk, u32 src_chunk,
-		      u32 dst_space, u8 *is_nocopy)
+		      u32 dst_space, u32 extra, u8 *is_nocopy)
 {
   int record_overhead = ptls_get_record_overhead (ptls_ctx->tls);
   int num_records;
   u32 deq_len, total_overhead;
 
-  if (dst_chunk >= clib_min (8192, src_chunk + record_overhead))
+  if (dst_chunk >= clib_min (8192, src_chunk + record_overhead + extra))
     {
       *is_nocopy = 1;
       deq_len = clib_min (src_chunk, dst_chunk);
       num_records = ceil ((f64) deq_len / PTLS_MAX_PLAINTEXT_RECORD_SIZE);
-      total_overhead = num_records * record_overhead;
+      total_overhead = num_records * record_overhead + extra;
       if (deq_len + total_overhead > dst_chunk)
 	deq_len = dst_chunk - total_overhead;
     }
@@ -491,7 +523,7 @@ ptls_compute_deq_len (picotls_ctx_t *ptls_ctx, u32 dst_chunk, u32 src_chunk,
     {
       deq_len = clib_min (src_chunk, dst_space);
       num_records = ceil ((f64) deq_len / PTLS_MAX_PLAINTEXT_RECORD_SIZE);
-      total_overhead = num_records * record_overhead;
+      total_overhead = num_records * record_overhead + extra;
       if (deq_len + total_overhead > dst_space)
 	deq_len = dst_space - total_overhead;
     }
@@ -499,6 +531,27 @@ ptls_compute_deq_len (picotls_ctx_t *ptls_ctx, u32 dst_chunk, u32 src_chunk,
   return deq_len;
 }
 
+/**
+ * Update the send key if enough app data was sealed with it. Returns the
+ * space needed for the KeyUpdate record, which is written by the next
+ * ptls_send before the app data
+ */
+static inline u32
+ptls_maybe_update_key (picotls_ctx_t *ptls_ctx)
+{
+  picotls_main_t *pm = &picotls_main;
+
+  if (!pm->key_update_bytes ||
+      ptls_ctx->tx_since_key_update < pm->key_update_bytes)
+    return 0;
+
+  if (ptls_update_key (ptls_ctx->tls, 0 /* request_update */))
+    return 0;
+
+  ptls_ctx->tx_since_key_update = 0;
+  return ptls_get_record_overhead (ptls_ctx->tls) + TLSP_KEY_UPDATE_MSG_LEN;
+}
+
 static u32
 ptls_app_to_tcp_write (picotls_ctx_t *ptls_ctx, session_t *app_session,
 		       svm_fifo_t *tcp_tx_fifo, u32 max_len)
@@ -511,7 +564,7 @@ ptls_app_to_tcp_write (picotls_ctx_t *ptls_ctx, session_t *app_session,
   ptls_buffer_t _buf, *buf = &_buf;
   svm_fifo_t *app_tx_fifo;
   u8 is_nocopy, *app_buf;
-  u32 first_chunk_len;
+  u32 first_chunk_len, key_update_len;
 
   thread_index = app_session->thread_index;
   app_tx_fifo = app_session->tx_fifo;
@@ -525,6 +578,9 @@ ptls_app_to_tcp_write (picotls_ctx_t *ptls_ctx, session_t *app_session,
   if (n_tcp_segs <= 0)
     return 0;
 
+  /* Seal all records of this write with one call into the crypto engine */
+  ptls_vpp_crypto_batch_begin ();
+
   while ((left = len - read) && ti < n_tcp_segs)
     {
       /* If we wrote something and are left with few bytes, postpone write
@@ -536,8 +592,8 @@ ptls_app_to_tcp_write (picotls_ctx_t *ptls_ctx, session_t *app_session,
       if (app_fs[i].len < min_chunk && min_chunk < left)
 	{
 	  app_buf_len = app_fs[i].len + app_fs[i + 1].len;
-	  app_buf = pm->rx_bufs[thread_index];
 	  vec_validate (pm->rx_bufs[thread_index], app_buf_len);
+	  app_buf = pm->rx_bufs[thread_index];
 	  clib_memcpy_fast (pm->rx_bufs[thread_index], app_fs[i].data,
 			    app_fs[i].len);
 	  clib_memcpy_fast (pm->rx_bufs[thread_index] + app_fs[i].len,
@@ -556,8 +612,9 @@ ptls_app_to_tcp_write (picotls_ctx_t *ptls_ctx, session_t *app_session,
       max_enq = tcp_fs[ti].len;
       max_enq += ti < (n_tcp_segs - 1) ? tcp_fs[ti + 1].len : 0;
 
+      key_update_len = ptls_maybe_update_key (ptls_ctx);
       deq_len = ptls_compute_deq_len (ptls_ctx, tcp_fs[ti].len, app_buf_len,
-				      max_enq, &is_nocopy);
+				      max_enq, key_update_len, &is_nocopy);
       if (is_nocopy)
 	{
 	  ptls_buffer_init (buf, tcp_fs[ti].data, tcp_fs[ti].len);
@@ -573,18 +630,28 @@ ptls_app_to_tcp_write (picotls_ctx_t *ptls_ctx, session_t *app_session,
 	}
       else
 	{
+	  /* Records span fifo chunks. Let picotls lay them out in the scratch
+	   * buffer but seal them directly into the fifo chunks */
 	  vec_validate (pm->tx_bufs[thread_index], max_enq);
 	  ptls_buffer_init (buf, pm->tx_bufs[thread_index], max_enq);
+	  ptls_vpp_crypto_remap_begin (buf->base, max_enq, &tcp_fs[ti],
+				       n_tcp_segs - ti);
 	  rv = ptls_send (ptls_ctx->tls, buf, app_buf, deq_len);
+	  ptls_vpp_crypto_remap_end (buf->base, buf->off);
 
 	  assert (rv == 0);
 	  wrote += buf->off;
 
-	  left = ptls_copy_buf_to_fs (buf, buf->off, tcp_fs, &ti, n_tcp_segs);
+	  left = ptls_advance_fs (buf->off, tcp_fs, &ti, n_tcp_segs);
 	  assert (left == 0);
 	}
 
+      /* Plaintext was copied to a buffer reused by next iteration */
+      if (first_chunk_len)
+	ptls_vpp_crypto_batch_flush ();
+
       read += deq_len;
+      ptls_ctx->tx_since_key_update += deq_len;
       ASSERT (deq_len >= first_chunk_len);
 
       if (deq_len == app_buf_len)
@@ -598,6 +665,8 @@ ptls_app_to_tcp_write (picotls_ctx_t *ptls_ctx, session_t *app_session,
 	}
     }
 
+  ptls_vpp_crypto_batch_end ();
+
   if (read)
     {
       svm_fifo_dequeue_drop (app_tx_fifo, read);
@@ -763,6 +832,30 @@ const static tls_engine_vft_t picotls_engine = {
   .ctx_reinit_cachain = picotls_reinit_ca_chain,
 };
 
+static clib_error_t *
+picotls_set_key_update_fn (vlib_main_t *vm, unformat_input_t *input,
+			   vlib_cli_command_t *cmd)
+{
+  picotls_main_t *pm = &picotls_main;
+  uword n_bytes;
+
+  if (unformat (input, "off"))
+    pm->key_update_bytes = 0;
+  else if (unformat (input, "%U", unformat_memory_size, &n_bytes) && n_bytes)
+    pm->key_update_bytes = n_bytes;
+  else
+    return clib_error_return (0, "unknown input `%U'", format_unformat_error,
+			      input);
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (picotls_set_key_update_command, static) = {
+  .path = "tls picotls set key-update",
+  .short_help = "tls picotls set key-update <bytes>|off",
+  .function = picotls_set_key_update_fn,
+};
+
 static clib_error_t *
 tls_picotls_init (vlib_main_t * vm)
 {
@@ -776,6 +869,7 @@ tls_picotls_init (vlib_main_t * vm)
   vec_validate (pm->ctx_pool, num_threads - 1);
   vec_validate (pm->rx_bufs, num_threads - 1);
   vec_validate (pm->tx_bufs, num_threads - 1);
+  ptls_vpp_crypto_init (num_threads);
 
   clib_rwlock_init (&picotls_main.crypto_keys_rw_lock);
 
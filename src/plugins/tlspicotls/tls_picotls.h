@@ -18,6 +18,9 @@
 
 #define TLSP_MIN_ENQ_SPACE (1 << 16)
 
+/* KeyUpdate handshake message, header and request_update byte */
+#define TLSP_KEY_UPDATE_MSG_LEN 5
+
 typedef struct tls_ctx_picotls_
 {
   tls_ctx_t ctx;
@@ -28,6 +31,7 @@ typedef struct tls_ctx_picotls_
   int rx_len;
   ptls_buffer_t read_buffer;
   int read_buffer_offset;
+  u64 tx_since_key_update;
 } picotls_ctx_t;
 
 typedef struct tls_listen_ctx_picotls_
@@ -44,6 +48,8 @@ typedef struct picotls_main_
   u8 **rx_bufs;
   ptls_context_t *client_ptls_ctx;
   clib_rwlock_t crypto_keys_rw_lock;
+  /* App bytes sent before the send key is updated, 0 to never update */
+  uword key_update_bytes;
 } picotls_main_t;
 
 #endif /* __included_quic_certs_h__ */
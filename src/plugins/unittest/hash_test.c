@@ -9,6 +9,10 @@
 #include <vppinfra/error.h>
 #include <vnet/hash/hash.h>
 #include <vnet/ethernet/ethernet.h>
+#include <vnet/ip/ip46_address.h>
+#include <vnet/ip/format.h>
+#include <vnet/ip/ip4_packet.h>
+#include <vnet/ip/ip6_packet.h>
 
 #define HASH_TEST_DATA_SIZE 2048
 
@@ -170,6 +174,118 @@ HASH_TEST_REGISTER_DATA (ipv6_icmp6, static) = {
   .ftype = VNET_HASH_FN_TYPE_IP,
 };
 
+/* RSS verification vectors, from
+ * https://docs.microsoft.com/en-us/windows-hardware/drivers/network/verifying-the-rss-hash-calculation
+ */
+typedef struct
+{
+  char *src, *dst;
+  u16 sport, dport;
+  u32 hash_2t, hash_4t;
+} hash_test_rss_vector_t;
+
+static hash_test_rss_vector_t hash_test_rss_vectors[] = {
+  { "66.9.149.187", "161.142.100.80", 2794, 1766, 0x323e8fc2, 0x51ccc178 },
+  { "199.92.111.2", "65.69.140.83", 14230, 4739, 0xd718262a, 0xc626b0ea },
+  { "24.19.198.95", "12.22.207.184", 12898, 38024, 0xd2d0a5de, 0x5c2b394a },
+  { "38.27.205.30", "209.142.163.6", 48228, 2217, 0x82989176, 0xafc7327f },
+  { "153.39.163.191", "202.188.127.2", 44251, 1303, 0x5d1809c5,
+    0x10e828a2 },
+  { "3ffe:2501:200:1fff::7", "3ffe:2501:200:3::1", 2794, 1766, 0x2cc18cd5,
+    0x40207d3d },
+  { "3ffe:501:8::260:97ff:fe40:efab", "ff02::1", 14230, 4739, 0x0f0c461c,
+    0xdde51bbf },
+  { "3ffe:1900:4545:3:200:f8ff:fe21:67cf", "fe80::200:f8ff:fe21:67cf", 44251,
+    38024, 0x4b61e985, 0x02d1feef },
+};
+
+static void
+hash_test_rss_packet (u8 *pkt, char *src, char *dst, u16 sport, u16 dport,
+		      u8 protocol)
+{
+  ethernet_header_t *eh = (ethernet_header_t *) pkt;
+  ip46_address_t sa, da;
+  u16 *ports;
+
+  unformat_input_t in;
+  unformat_init_string (&in, src, strlen (src));
+  unformat (&in, "%U", unformat_ip46_address, &sa, IP46_TYPE_ANY);
+  unformat_free (&in);
+  unformat_init_string (&in, dst, strlen (dst));
+  unformat (&in, "%U", unformat_ip46_address, &da, IP46_TYPE_ANY);
+  unformat_free (&in);
+
+  if (ip46_address_is_ip4 (&sa))
+    {
+      ip4_header_t *ip = (ip4_header_t *) (eh + 1);
+      eh->type = clib_host_to_net_u16 (ETHERNET_TYPE_IP4);
+      ip->ip_version_and_header_length = 0x45;
+      ip->protocol = protocol;
+      ip->src_address = sa.ip4;
+      ip->dst_address = da.ip4;
+      ports = (u16 *) (ip + 1);
+    }
+  else
+    {
+      ip6_header_t *ip = (ip6_header_t *) (eh + 1);
+      eh->type = clib_host_to_net_u16 (ETHERNET_TYPE_IP6);
+      ip->ip_version_traffic_class_and_flow_label =
+	clib_host_to_net_u32 (0x6 << 28);
+      ip->protocol = protocol;
+      ip->src_address = sa.ip6;
+      ip->dst_address = da.ip6;
+      ports = (u16 *) (ip + 1);
+    }
+
+  ports[0] = clib_host_to_net_u16 (sport);
+  ports[1] = clib_host_to_net_u16 (dport);
+}
+
+static clib_error_t *
+test_hash_toeplitz (vlib_main_t *vm)
+{
+  u32 n = 2 * ARRAY_LEN (hash_test_rss_vectors);
+  u8 pkts[n][128];
+  void *p[n];
+  u32 h[n], expected[n];
+  vnet_hash_fn_t hf;
+
+  hf = vnet_hash_function_from_name ("toeplitz", VNET_HASH_FN_TYPE_ETHERNET);
+  if (!hf)
+    return clib_error_return (0, "toeplitz hash not registered");
+
+  /* TCP packets hash addresses and ports, ICMP ones addresses only */
+  for (int i = 0; i < ARRAY_LEN (hash_test_rss_vectors); i++)
+    {
+      hash_test_rss_vector_t *v = hash_test_rss_vectors + i;
+      clib_memset (pkts[i], 0, sizeof (pkts[i]));
+      clib_memset (pkts[i + n / 2], 0, sizeof (pkts[i]));
+      hash_test_rss_packet (pkts[i], v->src, v->dst, v->sport, v->dport,
+			    IP_PROTOCOL_TCP);
+      hash_test_rss_packet (pkts[i + n / 2], v->src, v->dst, v->sport,
+			    v->dport, IP_PROTOCOL_ICMP);
+      expected[i] = v->hash_4t;
+      expected[i + n / 2] = v->hash_2t;
+    }
+
+  for (int i = 0; i < n; i++)
+    p[i] = pkts[i];
+
+  hf (p, h, n);
+
+  for (int i = 0; i < n; i++)
+    {
+      if (h[i] != expected[i])
+	return clib_error_return (0,
+				  "toeplitz hash of packet %u is 0x%08x, "
+				  "expected 0x%08x",
+				  i, h[i], expected[i]);
+    }
+
+  vlib_cli_output (vm, "toeplitz: %u RSS verification vectors OK", n);
+  return 0;
+}
+
 void
 fill_buffers (vlib_main_t *vm, u32 *buffer_indices, u8 *data, u32 data_size,
 	      u32 n_buffers)
@@ -284,6 +400,7 @@ test_hash_command_fn (vlib_main_t *vm, unformat_input_t *input,
 {
   hash_test_main_t *tm = &hash_test_main;
   clib_error_t *err = 0;
+  int toeplitz = 0;
 
   while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
     {
@@ -293,6 +410,8 @@ test_hash_command_fn (vlib_main_t *vm, unformat_input_t *input,
 	tm->verbose = 2;
       else if (unformat (input, "perf %s", &tm->hash_name))
 	;
+      else if (unformat (input, "toeplitz"))
+	toeplitz = 1;
       else if (unformat (input, "buffers %u", &tm->n_buffers))
 	;
       else if (unformat (input, "rounds %u", &tm->rounds))
@@ -307,7 +426,10 @@ test_hash_command_fn (vlib_main_t *vm, unformat_input_t *input,
 	}
     }
 
-  err = test_hash_perf (vm, tm);
+  if (toeplitz)
+    err = test_hash_toeplitz (vm);
+  else
+    err = test_hash_perf (vm, tm);
 
 error:
   vec_free (tm->hash_name);
@@ -317,8 +439,8 @@ error:
 
 VLIB_CLI_COMMAND (test_hash_command, static) = {
   .path = "test hash",
-  .short_help = "test hash [perf <hash-name>] [buffers <n>] [rounds <n>] "
-		"[warmup-rounds <n>]",
+  .short_help = "test hash [toeplitz] [perf <hash-name>] [buffers <n>] "
+		"[rounds <n>] [warmup-rounds <n>]",
   .function = test_hash_command_fn,
 };
 
@@ -14,6 +14,7 @@
  */
 
 #include <vnet/vnet.h>
+#include <vnet/interface/rx_queue_funcs.h>
 
 static clib_error_t *
 test_interface_command_fn (vlib_main_t * vm,
@@ -64,6 +65,102 @@ VLIB_CLI_COMMAND (test_interface_command, static) =
   .function = test_interface_command_fn,
 };
 
+/*
+ * Runs balancing rounds over made up queues of local0 on workers 1 and 2,
+ * with each worker busy for the sum of its queue loads:
+ *   round 1: A and B, 30% each, on worker 1, worker 2 only has C pinned.
+ *            Only one of them may move.
+ *   then:    A 40%, B 20%, C 40%, so worker 2 is hot and A is its only
+ *            queue which can move. A is held for the next two rounds and
+ *            goes back to worker 1 on the third.
+ */
+static clib_error_t *
+test_rx_balance_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			    vlib_cli_command_t *cmd)
+{
+  vnet_hw_if_rx_balance_main_t tbm = {
+    .interval = 1.0,
+    .threshold = 20,
+    .interval_clocks = 100,
+  };
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_hw_if_rx_queue_t *queues = 0, *rxq, *a, *b, *c;
+  u32 qi, ti, round, n_moves = 0;
+  clib_error_t *err = 0;
+  f64 now = 0;
+
+  if (vlib_get_n_threads () < 3)
+    {
+      vlib_cli_output (vm, "needs 2 workers, rx placement balance not tested");
+      return 0;
+    }
+
+  pool_alloc (queues, 3);
+  pool_get_zero (queues, a);
+  a->thread_index = 1;
+  a->auto_placement = 1;
+  a->n_balance_clocks = 30;
+  pool_get_zero (queues, b);
+  b->thread_index = 1;
+  b->auto_placement = 1;
+  b->n_balance_clocks = 30;
+  pool_get_zero (queues, c);
+  c->thread_index = 2;
+  vec_validate (tbm.busy_clocks, 2);
+
+  for (round = 1; round <= 4; round++)
+    {
+      now += tbm.interval;
+      vec_zero (tbm.busy_clocks);
+      pool_foreach (rxq, queues)
+	tbm.busy_clocks[rxq->thread_index] += rxq->n_balance_clocks;
+
+      qi = vnet_hw_if_rx_balance_pick (vnm, &tbm, queues, 1, 2, now, &ti);
+      vlib_cli_output (vm, "round %u: imbalance %u%%, %s", round,
+		       tbm.imbalance, qi == ~0 ? "no move" : "queue moved");
+
+      if (qi != ~0)
+	{
+	  queues[qi].thread_index = ti;
+	  queues[qi].last_balance_move = now;
+	  n_moves++;
+	}
+
+      if (round == 1)
+	{
+	  if (n_moves != 1 || a->thread_index != 2 || b->thread_index != 1)
+	    {
+	      err = clib_error_return (0, "round 1: A alone should move");
+	      break;
+	    }
+	  a->n_balance_clocks = 40;
+	  b->n_balance_clocks = 20;
+	  c->n_balance_clocks = 40;
+	}
+      else if (round < 4 && qi != ~0)
+	{
+	  err = clib_error_return (0, "round %u: A moved again too soon",
+				   round);
+	  break;
+	}
+      else if (round == 4 && (qi != 0 || a->thread_index != 1))
+	{
+	  err = clib_error_return (0, "round 4: A should move back");
+	  break;
+	}
+    }
+
+  vec_free (tbm.busy_clocks);
+  pool_free (queues);
+  return err;
+}
+
+VLIB_CLI_COMMAND (test_rx_balance_command, static) = {
+  .path = "test interface rx-placement balance",
+  .short_help = "test interface rx-placement balance",
+  .function = test_rx_balance_command_fn,
+};
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
@@ -0,0 +1,177 @@
+/* SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <vlib/vlib.h>
+#include <vnet/ip/ip4_forward.h>
+#include <vnet/fib/fib_table.h>
+#include <vppinfra/random.h>
+
+/* Resolve the buffers the way ip4-lookup of this variant does. Returns 1
+   if that is the x8 walk */
+CLIB_MARCH_FN (ip4_lookup_test_resolve, int, vlib_buffer_t **b, index_t *lbi,
+	       u32 n_left)
+{
+  ip4_main_t *im = &ip4_main;
+  ip4_header_t *ip;
+
+#ifdef IP4_MTRIE_HAVE_LOOKUP_X8
+  if (ip4_mtrie_lookup_x8_ok ())
+    {
+      ip4_lookup_resolve_x8 (im, b, lbi, n_left);
+      return 1;
+    }
+#endif
+
+  while (n_left)
+    {
+      ip = vlib_buffer_get_current (b[0]);
+      lbi[0] = ip4_fib_forwarding_lookup (
+	ip4_lookup_buffer_fib_index (im, b[0]), &ip->dst_address);
+      b += 1;
+      lbi += 1;
+      n_left -= 1;
+    }
+  return 0;
+}
+
+#ifndef CLIB_MARCH_VARIANT
+
+#define IP4_LOOKUP_TEST_N_TABLES 3
+#define IP4_LOOKUP_TEST_N_ROUTES 300
+
+static const u8 ip4_lookup_test_plens[] = { 1,  7,  8,  12, 16,
+					      17, 20, 24, 28, 32 };
+
+static clib_error_t *
+test_ip4_lookup_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			    vlib_cli_command_t *cmd)
+{
+  static const u32 batch_sizes[] = { 1, 7, 13, 67, 255 };
+  u32 fib_index[IP4_LOOKUP_TEST_N_TABLES], bi[VLIB_FRAME_SIZE];
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE];
+  index_t lbi[VLIB_FRAME_SIZE];
+  fib_prefix_t *pfxs[IP4_LOOKUP_TEST_N_TABLES] = {}, pfx, *p;
+  clib_error_t *error = 0;
+  u32 seed = 0xdeadbeef, n_bufs, n_checked = 0;
+  int i, j, t, is_x8 = 0;
+
+  unformat (input, "seed %u", &seed);
+
+  /* the default table and two vrfs, with routes of mixed lengths so that
+     lookups end at every stride */
+  fib_index[0] = 0;
+  for (t = 1; t < IP4_LOOKUP_TEST_N_TABLES; t++)
+    fib_index[t] = fib_table_find_or_create_and_lock (
+      FIB_PROTOCOL_IP4, 0xf1b0 + t, FIB_SOURCE_SPECIAL);
+
+  for (t = 0; t < IP4_LOOKUP_TEST_N_TABLES; t++)
+    for (i = 0; i < IP4_LOOKUP_TEST_N_ROUTES; i++)
+      {
+	clib_memset (&pfx, 0, sizeof (pfx));
+	pfx.fp_proto = FIB_PROTOCOL_IP4;
+	pfx.fp_len = ip4_lookup_test_plens[random_u32 (&seed) %
+					   ARRAY_LEN (ip4_lookup_test_plens)];
+	pfx.fp_addr.ip4.as_u32 = random_u32 (&seed);
+	ip4_address_normalize (&pfx.fp_addr.ip4, pfx.fp_len);
+
+	vec_foreach (p, pfxs[t])
+	  if (!fib_prefix_cmp (p, &pfx))
+	    break;
+	if (p < vec_end (pfxs[t]) || ~0 != fib_table_lookup_exact_match (
+					    fib_index[t], &pfx))
+	  continue;
+
+	fib_table_entry_special_add (fib_index[t], &pfx, FIB_SOURCE_SPECIAL,
+				     FIB_ENTRY_FLAG_DROP);
+	vec_add1 (pfxs[t], pfx);
+      }
+
+  n_bufs = vlib_buffer_alloc (vm, bi, VLIB_FRAME_SIZE);
+  if (n_bufs != VLIB_FRAME_SIZE)
+    {
+      error = clib_error_return (0, "Failed: buffer allocation");
+      goto done;
+    }
+  vlib_get_buffers (vm, bi, bufs, n_bufs);
+
+  for (i = 0; i < ARRAY_LEN (batch_sizes) * 20; i++)
+    {
+      u32 n = batch_sizes[i % ARRAY_LEN (batch_sizes)];
+
+      for (j = 0; j < n; j++)
+	{
+	  vlib_buffer_t *b = bufs[j];
+	  ip4_address_t mask;
+	  ip4_header_t *ip;
+
+	  /* a destination inside one of the routes, or anywhere */
+	  t = random_u32 (&seed) % IP4_LOOKUP_TEST_N_TABLES;
+	  b->current_data = 0;
+	  ip = vlib_buffer_get_current (b);
+	  clib_memset (ip, 0, sizeof (*ip));
+	  ip->dst_address.as_u32 = random_u32 (&seed);
+	  if (vec_len (pfxs[t]) && (random_u32 (&seed) & 3))
+	    {
+	      p = vec_elt_at_index (pfxs[t],
+				    random_u32 (&seed) % vec_len (pfxs[t]));
+	      ip4_preflen_to_mask (p->fp_len, &mask);
+	      ip->dst_address.as_u32 = (ip->dst_address.as_u32 & ~mask.as_u32) |
+				       p->fp_addr.ip4.as_u32;
+	    }
+
+	  /* the default table is found from the rx interface */
+	  vnet_buffer (b)->sw_if_index[VLIB_RX] = 0;
+	  vnet_buffer (b)->sw_if_index[VLIB_TX] = t ? fib_index[t] : ~0;
+	  vnet_buffer (b)->ip.fib_index = ~0;
+	}
+
+      is_x8 = CLIB_MARCH_FN_SELECT (ip4_lookup_test_resolve) (bufs, lbi, n);
+
+      for (j = 0; j < n; j++)
+	{
+	  ip4_header_t *ip = vlib_buffer_get_current (bufs[j]);
+	  u32 fi = vnet_buffer (bufs[j])->sw_if_index[VLIB_TX];
+	  index_t expected;
+
+	  fi = fi == ~0 ? 0 : fi;
+	  expected = ip4_fib_forwarding_lookup (fi, &ip->dst_address);
+	  if (vnet_buffer (bufs[j])->ip.fib_index != fi ||
+	      lbi[j] != expected)
+	    {
+	      error = clib_error_return (
+		0,
+		"Failed: batch of %u, packet %u to %U in fib %u: "
+		"fib %u lb %u, expected lb %u",
+		n, j, format_ip4_address, &ip->dst_address, fi,
+		vnet_buffer (bufs[j])->ip.fib_index, lbi[j], expected);
+	      goto done;
+	    }
+	  n_checked++;
+	}
+    }
+
+  vlib_cli_output (vm, "%u lookups in %u tables match the scalar lookup (%s)",
+		   n_checked, IP4_LOOKUP_TEST_N_TABLES,
+		   is_x8 ? "x8 walk" : "no x8 walk in this variant");
+
+done:
+  if (n_bufs)
+    vlib_buffer_free (vm, bi, n_bufs);
+  for (t = 0; t < IP4_LOOKUP_TEST_N_TABLES; t++)
+    {
+      vec_foreach (p, pfxs[t])
+	fib_table_entry_special_remove (fib_index[t], p, FIB_SOURCE_SPECIAL);
+      vec_free (pfxs[t]);
+      if (t)
+	fib_table_unlock (fib_index[t], FIB_PROTOCOL_IP4, FIB_SOURCE_SPECIAL);
+    }
+  return error;
+}
+
+VLIB_CLI_COMMAND (test_ip4_lookup_command, static) = {
+  .path = "test ip4 lookup",
+  .short_help = "test ip4 lookup [seed <n>]",
+  .function = test_ip4_lookup_command_fn,
+};
+
+#endif /* CLIB_MARCH_VARIANT */
@@ -681,6 +681,118 @@ segment_manager_test_fifo_ops (vlib_main_t *vm, unformat_input_t *input)
   return 0;
 }
 
+static int
+segment_manager_test_fifo_ramp (vlib_main_t * vm, unformat_input_t * input)
+{
+  int rv, i;
+  segment_manager_t *sm;
+  fifo_segment_t *fs;
+  svm_fifo_t *rx_fifo, *tx_fifo, *rx_fifo2, *tx_fifo2;
+  svm_fifo_chunk_t *c;
+  uword app_seg_size = size_2MB;
+  u32 fifo_size = size_128KB, n_chunks, n_free, wnd;
+  u64 options[APP_OPTIONS_N_OPTIONS];
+  u8 data[size_128KB];
+
+  memset (&options, 0, sizeof (options));
+
+  vnet_app_attach_args_t attach_args = {
+    .api_client_index = ~0,
+    .options = options,
+    .namespace_id = 0,
+    .session_cb_vft = &placeholder_session_cbs,
+    .name = format (0, "segment_manager_test_fifo_ramp"),
+  };
+
+  attach_args.options[APP_OPTIONS_SEGMENT_SIZE] = app_seg_size;
+  attach_args.options[APP_OPTIONS_FLAGS] = APP_OPTIONS_FLAGS_IS_BUILTIN;
+  attach_args.options[APP_OPTIONS_RX_FIFO_SIZE] = fifo_size;
+  attach_args.options[APP_OPTIONS_TX_FIFO_SIZE] = fifo_size;
+  rv = vnet_application_attach (&attach_args);
+  SEG_MGR_TEST ((rv == 0), "vnet_application_attach %d", rv);
+
+  sm =
+    segment_manager_get (SEGMENT_MANAGER_GET_INDEX_FROM_HANDLE
+			 (attach_args.segment_handle));
+  SEG_MGR_TEST ((sm != 0), "segment_manager_get %p", sm);
+
+  rv = segment_manager_alloc_session_fifos (sm, vlib_get_thread_index (),
+					    &rx_fifo, &tx_fifo);
+  SEG_MGR_TEST ((rv == 0), "segment_manager_alloc_session_fifos %d", rv);
+  fs = segment_manager_get_segment (sm, rx_fifo->segment_index);
+  svm_fifo_set_size (rx_fifo, size_1MB);
+
+  /* fifos start with one small chunk regardless of their size */
+  n_chunks = svm_fifo_n_chunks (rx_fifo);
+  SEG_MGR_TEST ((n_chunks == 1), "n_chunks %u", n_chunks);
+  c = f_end_cptr (rx_fifo);
+  SEG_MGR_TEST ((c->length == size_4KB), "first chunk %u", c->length);
+
+  /* growth doubles the fifo up to min_alloc: 4KB -> 8KB -> 16KB */
+  for (i = 0; i < 3; i++)
+    {
+      rv = svm_fifo_enqueue (rx_fifo, (size_4KB << i) + 1, data);
+      SEG_MGR_TEST ((rv == (size_4KB << i) + 1), "svm_fifo_enqueue %d", rv);
+      c = f_end_cptr (rx_fifo);
+      SEG_MGR_TEST ((c->length == size_4KB << i), "grew by %u", c->length);
+    }
+
+  /* drained fifo returns all but its last chunk */
+  svm_fifo_dequeue_drop (rx_fifo, svm_fifo_max_dequeue (rx_fifo));
+  n_chunks = svm_fifo_n_chunks (rx_fifo);
+  SEG_MGR_TEST ((n_chunks == 1), "n_chunks %u", n_chunks);
+
+  /* push segment into high memory pressure with another session */
+  rv = segment_manager_alloc_session_fifos (sm, vlib_get_thread_index (),
+					    &rx_fifo2, &tx_fifo2);
+  SEG_MGR_TEST ((rv == 0), "segment_manager_alloc_session_fifos %d", rv);
+  svm_fifo_set_size (rx_fifo2, size_1MB);
+  svm_fifo_set_size (tx_fifo2, size_1MB);
+  for (i = 0; i < 16; i++)
+    {
+      if (fifo_segment_get_mem_status (fs) == MEMORY_PRESSURE_HIGH_PRESSURE)
+	break;
+      svm_fifo_enqueue (i & 1 ? tx_fifo2 : rx_fifo2, size_128KB, data);
+    }
+  rv = fifo_segment_get_mem_status (fs);
+  SEG_MGR_TEST ((rv == MEMORY_PRESSURE_HIGH_PRESSURE),
+		"fifo_segment_get_mem_status %s", states_str[rv]);
+  SEG_MGR_TEST ((fsh_has_mem_pressure (fs->h)), "segment has mem pressure");
+
+  /* window is limited to allocated space plus one growth step */
+  n_free = f_chunk_end (f_end_cptr (rx_fifo)) - rx_fifo->shr->tail;
+  wnd = svm_fifo_max_enqueue_window (rx_fifo);
+  SEG_MGR_TEST ((wnd == n_free + rx_fifo->shr->min_alloc), "window %u", wnd);
+  SEG_MGR_TEST ((wnd < svm_fifo_max_enqueue_prod (rx_fifo)),
+		"window %u should be less than free space %u", wnd,
+		svm_fifo_max_enqueue_prod (rx_fifo));
+
+  /* and fifos grow only by what is needed */
+  rv = svm_fifo_enqueue (rx_fifo, n_free + 1, data);
+  SEG_MGR_TEST ((rv == n_free + 1), "svm_fifo_enqueue %d", rv);
+  c = f_end_cptr (rx_fifo);
+  SEG_MGR_TEST ((c->length == size_4KB), "grew by %u", c->length);
+
+  /* releasing memory lifts the throttling */
+  svm_fifo_dequeue_drop (rx_fifo2, svm_fifo_max_dequeue (rx_fifo2));
+  svm_fifo_dequeue_drop (tx_fifo2, svm_fifo_max_dequeue (tx_fifo2));
+  rv = fifo_segment_get_mem_status (fs);
+  SEG_MGR_TEST ((rv == MEMORY_PRESSURE_NO_PRESSURE),
+		"fifo_segment_get_mem_status %s", states_str[rv]);
+  wnd = svm_fifo_max_enqueue_window (rx_fifo);
+  SEG_MGR_TEST ((wnd == svm_fifo_max_enqueue_prod (rx_fifo)), "window %u",
+		wnd);
+
+  vnet_app_detach_args_t detach_args = {
+    .app_index = attach_args.app_index,
+    .api_client_index = ~0,
+  };
+  rv = vnet_application_detach (&detach_args);
+  SEG_MGR_TEST ((rv == 0), "vnet_application_detach %d", rv);
+
+  return 0;
+}
+
 static int
 segment_manager_test_prealloc_hdrs (vlib_main_t * vm,
 				    unformat_input_t * input)
@@ -752,6 +864,8 @@ segment_manager_test (vlib_main_t * vm,
 	res = segment_manager_test_fifo_balanced_alloc (vm, input);
       else if (unformat (input, "prealloc_hdrs"))
 	res = segment_manager_test_prealloc_hdrs (vm, input);
+      else if (unformat (input, "fifo_ramp"))
+	res = segment_manager_test_fifo_ramp (vm, input);
 
       else if (unformat (input, "all"))
 	{
@@ -763,6 +877,8 @@ segment_manager_test (vlib_main_t * vm,
 	    goto done;
 	  if ((res = segment_manager_test_prealloc_hdrs (vm, input)))
 	    goto done;
+	  if ((res = segment_manager_test_fifo_ramp (vm, input)))
+	    goto done;
 	}
       else
 	break;
@@ -778,7 +894,8 @@ VLIB_CLI_COMMAND (tcp_test_command, static) =
 {
   .path = "test segment-manager",
   .short_help = "test segment manager [pressure_levels_1]"
-                "[pressure_level_2][alloc][fifo_ops][prealloc_hdrs][all]",
+                "[pressure_level_2][alloc][fifo_ops][prealloc_hdrs]"
+                "[fifo_ramp][all]",
   .function = segment_manager_test,
 };
 
@@ -1609,6 +1609,212 @@ session_test_rules (vlib_main_t * vm, unformat_input_t * input)
   return 0;
 }
 
+static u32
+session_test_port_filter_count (session_table_t *st, u16 lcl_port)
+{
+  u32 index = session_table_port_filter_index (TRANSPORT_PROTO_TCP, lcl_port);
+  return st->lcl_port_filter[index];
+}
+
+static int
+session_test_lookup (vlib_main_t *vm, unformat_input_t *input)
+{
+  session_endpoint_t sep = SESSION_ENDPOINT_NULL;
+  u64 options[APP_OPTIONS_N_OPTIONS];
+  u16 lcl_port = 5678, rmt_port = 8765;
+  transport_connection_t *tc;
+  tcp_connection_t *tcp;
+  u32 cnt, server_index;
+  session_t *s, *ls;
+  session_table_t *st;
+  app_listener_t *al;
+  int verbose = 0;
+  int error = 0;
+  u32 st_index;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "verbose"))
+	verbose = 1;
+      else
+	{
+	  vlib_cli_output (vm, "parse error: '%U'", format_unformat_error,
+			   input);
+	  return -1;
+	}
+    }
+
+  ip4_address_t lcl_ip = {
+    .as_u32 = clib_host_to_net_u32 (0x01020304),
+  };
+  ip4_address_t rmt_ip = {
+    .as_u32 = clib_host_to_net_u32 (0x05060708),
+  };
+
+  st_index = session_lookup_get_index_for_fib (FIB_PROTOCOL_IP4, 0);
+  st = session_table_get (st_index);
+  SESSION_TEST ((st != 0), "default ip4 session table should exist");
+  SESSION_TEST ((session_test_port_filter_count (st, 0) == 0),
+		"no proxy listener should use the port 0 slot");
+
+  /* Use a local port whose filter slot is not shared with other keys */
+  while (session_test_port_filter_count (st, lcl_port))
+    lcl_port += 1;
+
+  /*
+   * Closed port, the filter should miss and all lookups should fail
+   */
+  SESSION_TEST (
+    (!session_table_port_filter_test (st, TRANSPORT_PROTO_TCP, lcl_port)),
+    "filter should miss for closed port %u", lcl_port);
+  tc = session_lookup_connection4 (0, &lcl_ip, &rmt_ip, lcl_port, rmt_port,
+				   TRANSPORT_PROTO_TCP);
+  SESSION_TEST ((tc == 0), "lookup for closed port should fail");
+  s = session_lookup_safe4 (0, &lcl_ip, &rmt_ip, lcl_port, rmt_port,
+			    TRANSPORT_PROTO_TCP);
+  SESSION_TEST ((s == 0), "safe lookup for closed port should fail");
+
+  /*
+   * Established connection
+   */
+  tcp = tcp_connection_alloc (0);
+  tcp->c_lcl_ip4.as_u32 = lcl_ip.as_u32;
+  tcp->c_rmt_ip4.as_u32 = rmt_ip.as_u32;
+  tcp->c_lcl_port = lcl_port;
+  tcp->c_rmt_port = rmt_port;
+  tcp->c_proto = TRANSPORT_PROTO_TCP;
+  tcp->c_is_ip4 = 1;
+  tcp->c_fib_index = 0;
+  s = session_alloc_for_connection (&tcp->connection);
+
+  error = session_lookup_add_connection (&tcp->connection,
+					 session_handle (s));
+  SESSION_TEST ((error == 0), "connection add should work");
+  cnt = session_test_port_filter_count (st, lcl_port);
+  SESSION_TEST ((cnt == 1), "filter count should be 1 is %u", cnt);
+  SESSION_TEST (
+    (session_table_port_filter_test (st, TRANSPORT_PROTO_TCP, lcl_port)),
+    "filter should hit for connection port");
+
+  tc = session_lookup_connection4 (0, &lcl_ip, &rmt_ip, lcl_port, rmt_port,
+				   TRANSPORT_PROTO_TCP);
+  SESSION_TEST ((tc == &tcp->connection), "lookup should return connection");
+  session_lookup_prefetch4 (0, &lcl_ip, &rmt_ip, lcl_port, rmt_port,
+			    TRANSPORT_PROTO_TCP);
+  SESSION_TEST ((session_lookup_safe4 (0, &lcl_ip, &rmt_ip, lcl_port,
+				       rmt_port, TRANSPORT_PROTO_TCP) == s),
+		"safe lookup should return session");
+  tc = session_lookup_connection4 (0, &lcl_ip, &rmt_ip, lcl_port,
+				   rmt_port + 1, TRANSPORT_PROTO_TCP);
+  SESSION_TEST ((tc == 0), "lookup for other remote port should fail");
+
+  error = session_lookup_del_connection (&tcp->connection);
+  SESSION_TEST ((error == 0), "connection del should work");
+  error = session_lookup_del_connection (&tcp->connection);
+  SESSION_TEST ((error != 0), "second connection del should fail");
+  cnt = session_test_port_filter_count (st, lcl_port);
+  SESSION_TEST ((cnt == 0), "filter count should be 0 is %u", cnt);
+  tc = session_lookup_connection4 (0, &lcl_ip, &rmt_ip, lcl_port, rmt_port,
+				   TRANSPORT_PROTO_TCP);
+  SESSION_TEST ((tc == 0), "lookup after del should fail");
+
+  /*
+   * Half-open connection
+   */
+  error = session_lookup_add_half_open (&tcp->connection, tcp->c_c_index);
+  SESSION_TEST ((error == 0), "half-open add should work");
+  cnt = session_test_port_filter_count (st, lcl_port);
+  SESSION_TEST ((cnt == 1), "filter count should be 1 is %u", cnt);
+  SESSION_TEST (
+    (session_lookup_half_open_handle (&tcp->connection) == tcp->c_c_index),
+    "half-open lookup should return connection index");
+  error = session_lookup_del_half_open (&tcp->connection);
+  SESSION_TEST ((error == 0), "half-open del should work");
+  cnt = session_test_port_filter_count (st, lcl_port);
+  SESSION_TEST ((cnt == 0), "filter count should be 0 is %u", cnt);
+
+  session_free (s);
+  tcp_connection_free (tcp);
+
+  /*
+   * Listener
+   */
+  clib_memset (options, 0, sizeof (options));
+  options[APP_OPTIONS_FLAGS] = APP_OPTIONS_FLAGS_IS_BUILTIN;
+  options[APP_OPTIONS_FLAGS] |= APP_OPTIONS_FLAGS_USE_GLOBAL_SCOPE;
+  vnet_app_attach_args_t attach_args = {
+    .api_client_index = ~0,
+    .options = options,
+    .namespace_id = 0,
+    .session_cb_vft = &placeholder_session_cbs,
+    .name = format (0, "session_test"),
+  };
+  error = vnet_application_attach (&attach_args);
+  SESSION_TEST ((error == 0), "server attach should work");
+  server_index = attach_args.app_index;
+
+  sep.is_ip4 = 1;
+  sep.port = lcl_port;
+  vnet_listen_args_t bind_args = {
+    .sep = sep,
+    .app_index = server_index,
+  };
+  error = vnet_listen (&bind_args);
+  SESSION_TEST ((error == 0), "server listen on port %u should work",
+		lcl_port);
+  al = app_listener_get_w_handle (bind_args.handle);
+  ls = app_listener_get_session (al);
+  cnt = session_test_port_filter_count (st, lcl_port);
+  SESSION_TEST ((cnt == 1), "filter count should be 1 is %u", cnt);
+
+  tc = session_lookup_connection4 (0, &lcl_ip, &rmt_ip, lcl_port, rmt_port,
+				   TRANSPORT_PROTO_TCP);
+  SESSION_TEST ((tc && tc->c_index == ls->connection_index),
+		"lookup should return listener");
+  SESSION_TEST ((session_lookup_safe4 (0, &lcl_ip, &rmt_ip, lcl_port,
+				       rmt_port, TRANSPORT_PROTO_TCP) == ls),
+		"safe lookup should return listener");
+
+  vnet_unlisten_args_t unbind_args = {
+    .app_index = server_index,
+    .handle = bind_args.handle,
+  };
+  error = vnet_unlisten (&unbind_args);
+  SESSION_TEST ((error == 0), "unlisten should work");
+  cnt = session_test_port_filter_count (st, lcl_port);
+  SESSION_TEST ((cnt == 0), "filter count should be 0 is %u", cnt);
+  tc = session_lookup_connection4 (0, &lcl_ip, &rmt_ip, lcl_port, rmt_port,
+				   TRANSPORT_PROTO_TCP);
+  SESSION_TEST ((tc == 0), "lookup after unlisten should fail");
+
+  /*
+   * Proxy listener, keyed with port 0, matches all local ports
+   */
+  sep.port = 0;
+  sep.transport_proto = TRANSPORT_PROTO_TCP;
+  error = session_lookup_add_session_endpoint (st_index, &sep, 0);
+  SESSION_TEST ((error == 0), "proxy endpoint add should work");
+  SESSION_TEST (
+    (session_table_port_filter_test (st, TRANSPORT_PROTO_TCP, lcl_port)),
+    "filter should hit for any port with proxy listener");
+  error = session_lookup_del_session_endpoint (st_index, &sep);
+  SESSION_TEST ((error == 0), "proxy endpoint del should work");
+  SESSION_TEST (
+    (!session_table_port_filter_test (st, TRANSPORT_PROTO_TCP, lcl_port)),
+    "filter should miss after proxy endpoint del");
+
+  if (verbose)
+    vlib_cli_output (vm, "filter checked for local port %u", lcl_port);
+
+  vnet_app_detach_args_t detach_args = {
+    .app_index = server_index,
+    .api_client_index = ~0,
+  };
+  vnet_application_detach (&detach_args);
+  vec_free (attach_args.name);
+  return 0;
+}
+
 static int
 session_test_proxy (vlib_main_t * vm, unformat_input_t * input)
 {
@@ -2154,6 +2360,8 @@ session_test (vlib_main_t * vm,
 	res = session_test_rules (vm, input);
       else if (unformat (input, "proxy"))
 	res = session_test_proxy (vm, input);
+      else if (unformat (input, "lookup"))
+	res = session_test_lookup (vm, input);
       else if (unformat (input, "endpt-cfg"))
 	res = session_test_endpoint_cfg (vm, input);
       else if (unformat (input, "mq-speed"))
@@ -2166,6 +2374,9 @@ session_test (vlib_main_t * vm,
 	{
 	  if ((res = session_test_basic (vm, input)))
 	    goto done;
+	  /* Before tests that leave proxy listeners behind */
+	  if ((res = session_test_lookup (vm, input)))
+	    goto done;
 	  if ((res = session_test_namespace (vm, input)))
 	    goto done;
 	  if ((res = session_test_rule_table (vm, input)))
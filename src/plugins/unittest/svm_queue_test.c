@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2026 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <vlib/vlib.h>
+#include <svm/queue.h>
+
+#define SQUEUE_TEST_I(_cond, _comment, _args...)                              \
+  ({                                                                          \
+    int _evald = (_cond);                                                     \
+    if (!(_evald))                                                            \
+      {                                                                       \
+	fformat (stderr, "FAIL:%d: " _comment "\n", __LINE__, ##_args);       \
+      }                                                                       \
+    else                                                                      \
+      {                                                                       \
+	fformat (stderr, "PASS:%d: " _comment "\n", __LINE__, ##_args);       \
+      }                                                                       \
+    _evald;                                                                   \
+  })
+
+#define SQUEUE_TEST(_cond, _comment, _args...)                                \
+  {                                                                           \
+    if (!SQUEUE_TEST_I (_cond, _comment, ##_args))                            \
+      {                                                                       \
+	rv = 1;                                                               \
+	goto done;                                                            \
+      }                                                                       \
+  }
+
+#define SQUEUE_TEST_NELTS 8
+
+static int
+squeue_test_add (svm_queue_t *q, u32 first, u32 n)
+{
+  u32 i, val;
+
+  for (i = 0; i < n; i++)
+    {
+      val = first + i;
+      if (svm_queue_add (q, (u8 *) &val, 1 /* nowait */))
+	return -1;
+    }
+  return 0;
+}
+
+static int
+squeue_test_check (u32 *elts, u32 first, u32 n)
+{
+  u32 i;
+
+  for (i = 0; i < n; i++)
+    if (elts[i] != first + i)
+      return -1;
+  return 0;
+}
+
+static int
+squeue_test_batch (vlib_main_t *vm, unformat_input_t *input)
+{
+  u32 elts[2 * SQUEUE_TEST_NELTS];
+  svm_queue_t *q;
+  int n, rv = 0;
+
+  q = svm_queue_alloc_and_init (SQUEUE_TEST_NELTS, sizeof (u32), getpid ());
+
+  n = svm_queue_sub_batch (q, (u8 *) elts, ARRAY_LEN (elts));
+  SQUEUE_TEST (n == 0, "empty queue batch returned %d", n);
+
+  /* Move head to 5 so the next 7 elements wrap at the end of the ring */
+  SQUEUE_TEST (!squeue_test_add (q, 0, 5), "add 5 elements");
+  n = svm_queue_sub_batch (q, (u8 *) elts, ARRAY_LEN (elts));
+  SQUEUE_TEST (n == 5, "batch returned %d, expected 5", n);
+  SQUEUE_TEST (!squeue_test_check (elts, 0, 5), "first 5 elements in order");
+  SQUEUE_TEST (q->head == 5 && q->cursize == 0, "head %d cursize %d",
+	       q->head, q->cursize);
+
+  /* One batch that copies out both sides of the wrap */
+  SQUEUE_TEST (!squeue_test_add (q, 100, 7), "add 7 elements across wrap");
+  SQUEUE_TEST (q->tail == 4, "tail %d, expected 4", q->tail);
+  n = svm_queue_sub_batch (q, (u8 *) elts, ARRAY_LEN (elts));
+  SQUEUE_TEST (n == 7, "batch returned %d, expected 7", n);
+  SQUEUE_TEST (!squeue_test_check (elts, 100, 7),
+	       "wrapped elements in order");
+  SQUEUE_TEST (q->head == 4 && q->cursize == 0, "head %d cursize %d",
+	       q->head, q->cursize);
+
+  /* Partial batches, the second one starting just before the wrap */
+  SQUEUE_TEST (!squeue_test_add (q, 200, SQUEUE_TEST_NELTS),
+	       "fill the queue");
+  SQUEUE_TEST (svm_queue_is_full (q), "queue is full");
+  n = svm_queue_sub_batch (q, (u8 *) elts, 3);
+  SQUEUE_TEST (n == 3, "batch returned %d, expected 3", n);
+  SQUEUE_TEST (!squeue_test_check (elts, 200, 3), "partial batch in order");
+  SQUEUE_TEST (q->head == 7 && q->cursize == 5, "head %d cursize %d",
+	       q->head, q->cursize);
+  n = svm_queue_sub_batch (q, (u8 *) elts, 2);
+  SQUEUE_TEST (n == 2, "batch returned %d, expected 2", n);
+  SQUEUE_TEST (!squeue_test_check (elts, 203, 2),
+	       "batch across the wrap in order");
+  SQUEUE_TEST (q->head == 1 && q->cursize == 3, "head %d cursize %d",
+	       q->head, q->cursize);
+
+  /* Batch and single element dequeues interleave */
+  n = svm_queue_sub2 (q, (u8 *) elts);
+  SQUEUE_TEST (n == 0 && elts[0] == 205, "sub2 returned %u", elts[0]);
+  n = svm_queue_sub_batch (q, (u8 *) elts, ARRAY_LEN (elts));
+  SQUEUE_TEST (n == 2, "batch returned %d, expected 2", n);
+  SQUEUE_TEST (!squeue_test_check (elts, 206, 2), "rest in order");
+  SQUEUE_TEST (q->head == q->tail && q->cursize == 0, "head %d tail %d",
+	       q->head, q->tail);
+
+done:
+  svm_queue_free (q);
+  return rv;
+}
+
+static clib_error_t *
+svm_queue_test (vlib_main_t *vm, unformat_input_t *input,
+		vlib_cli_command_t *cmd_arg)
+{
+  int res = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "batch") || unformat (input, "all"))
+	res = squeue_test_batch (vm, input);
+      else
+	{
+	  vlib_cli_output (vm, "unknown input `%U'", format_unformat_error,
+			   input);
+	  res = -1;
+	}
+      if (res)
+	break;
+    }
+
+  if (res)
+    return clib_error_return (0, "svm queue unit test failed");
+  return 0;
+}
+
+VLIB_CLI_COMMAND (svm_queue_test_command, static) = {
+  .path = "test svm queue",
+  .short_help = "internal svm queue unit tests",
+  .function = svm_queue_test,
+};
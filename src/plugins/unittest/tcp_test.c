@@ -14,6 +14,9 @@
  */
 #include <vnet/tcp/tcp.h>
 #include <vnet/tcp/tcp_inlines.h>
+#include <vnet/ethernet/ethernet.h>
+#include <vnet/fib/fib_table.h>
+#include <vnet/gso/gso.h>
 
 #define TCP_TEST_I(_cond, _comment, _args...)			\
 ({								\
@@ -801,6 +804,219 @@ tcp_test_sack_tx (vlib_main_t * vm, unformat_input_t * input)
   return 0;
 }
 
+static void tcp_test_set_time (u32 thread_index, u32 val);
+
+static int
+tcp_test_sack_rbtree (vlib_main_t * vm, unformat_input_t * input)
+{
+  tcp_connection_t _tc, *tc = &_tc;
+  sack_scoreboard_t *sb = &tc->sack_sb;
+  sack_scoreboard_hole_t *hole;
+  rb_tree_t *rt = &sb->hole_lookup;
+  rb_node_t *rbn;
+  sack_block_t block;
+  u32 i, n_holes, hole_bytes, lost_bytes, n_blocks = 500;
+
+  clib_memset (tc, 0, sizeof (*tc));
+
+  tc->flags |= TCP_CONN_FAST_RECOVERY | TCP_CONN_RECOVERY;
+  tc->snd_una = 0;
+  tc->snd_nxt = n_blocks * 200;
+  tc->rcv_opts.flags |= TCP_OPTS_FLAG_SACK;
+  tc->snd_mss = 100;
+  scoreboard_init (sb);
+
+  /*
+   * Sack every other 100 byte block, in batches of 4 blocks per ack, last
+   * blocks first so holes are split and inserted out of order
+   */
+  for (i = 0; i < n_blocks; i++)
+    {
+      block.start = (n_blocks - i - 1) * 200 + 100;
+      block.end = block.start + 100;
+      vec_add1 (tc->rcv_opts.sacks, block);
+      if (vec_len (tc->rcv_opts.sacks) < 4 && i != n_blocks - 1)
+	continue;
+      tc->rcv_opts.n_sack_blocks = vec_len (tc->rcv_opts.sacks);
+      tcp_rcv_sacks (tc, 0);
+      vec_reset_length (tc->rcv_opts.sacks);
+    }
+
+  TCP_TEST ((pool_elts (sb->holes) == n_blocks), "scoreboard has %d holes",
+	    pool_elts (sb->holes));
+  TCP_TEST ((sb->sacked_bytes == n_blocks * 100), "sacked bytes %d",
+	    sb->sacked_bytes);
+
+  /*
+   * In order walk of the rbtree must match the hole list, and the byte
+   * counters must match the holes
+   */
+  hole = scoreboard_first_hole (sb);
+  rbn = rb_tree_min_subtree (rt, rb_node (rt, rt->root));
+  n_holes = hole_bytes = lost_bytes = 0;
+  while (hole)
+    {
+      if (rb_node_is_tnil (rt, rbn) || rbn->opaque != hole - sb->holes
+	  || rbn->key != hole->start || hole->lookup_node != rb_node_index (rt,
+									    rbn))
+	TCP_TEST (0, "rbtree node for hole %u [%u %u] is wrong", n_holes,
+		  hole->start, hole->end);
+      n_holes += 1;
+      hole_bytes += scoreboard_hole_bytes (hole);
+      lost_bytes += hole->is_lost ? scoreboard_hole_bytes (hole) : 0;
+      hole = scoreboard_next_hole (sb, hole);
+      rbn = rb_tree_successor (rt, rbn);
+    }
+  TCP_TEST (rb_node_is_tnil (rt, rbn), "rbtree has more nodes than holes");
+  TCP_TEST ((n_holes == rb_tree_n_nodes (rt) - 1), "rbtree has %u nodes",
+	    rb_tree_n_nodes (rt) - 1);
+  TCP_TEST ((sb->hole_bytes == hole_bytes), "hole bytes %u expected %u",
+	    sb->hole_bytes, hole_bytes);
+  TCP_TEST ((sb->lost_bytes == lost_bytes), "lost bytes %u expected %u",
+	    sb->lost_bytes, lost_bytes);
+
+  /*
+   * Cumulative ack into the middle of a hole trims it and updates its key
+   */
+  tcp_rcv_sacks (tc, 50050);
+  tc->snd_una = 50050;
+  hole = scoreboard_first_hole (sb);
+  TCP_TEST ((hole->start == 50050 && hole->end == 50100),
+	    "first hole start %u end %u", hole->start, hole->end);
+  rbn = rb_tree_min_subtree (rt, rb_node (rt, rt->root));
+  TCP_TEST ((rbn->key == 50050 && rbn->opaque == hole - sb->holes),
+	    "rbtree min key %u", rbn->key);
+  TCP_TEST ((pool_elts (sb->holes) == rb_tree_n_nodes (rt) - 1),
+	    "rbtree nodes %u holes %u", rb_tree_n_nodes (rt) - 1,
+	    pool_elts (sb->holes));
+
+  /*
+   * Sack filling the last hole in one block merges and removes it
+   */
+  hole = scoreboard_last_hole (sb);
+  block.start = hole->start;
+  block.end = hole->end;
+  vec_add1 (tc->rcv_opts.sacks, block);
+  tc->rcv_opts.n_sack_blocks = 1;
+  n_holes = pool_elts (sb->holes);
+  tcp_rcv_sacks (tc, tc->snd_una);
+  TCP_TEST ((pool_elts (sb->holes) == n_holes - 1), "holes %u expected %u",
+	    pool_elts (sb->holes), n_holes - 1);
+  TCP_TEST ((pool_elts (sb->holes) == rb_tree_n_nodes (rt) - 1),
+	    "rbtree nodes %u holes %u", rb_tree_n_nodes (rt) - 1,
+	    pool_elts (sb->holes));
+
+  scoreboard_clear (sb);
+  TCP_TEST ((rb_tree_n_nodes (rt) == 1), "rbtree should be empty");
+  scoreboard_free (sb);
+  vec_free (tc->rcv_opts.sacks);
+
+  return 0;
+}
+
+static int
+tcp_test_sack_rack (vlib_main_t * vm, unformat_input_t * input)
+{
+  u32 thread_index = 0, i, lost;
+  tcp_rate_sample_t _rs = { 0 }, *rs = &_rs;
+  tcp_connection_t _tc, *tc = &_tc;
+  sack_scoreboard_t *sb = &tc->sack_sb;
+  sack_scoreboard_hole_t *hole;
+  sack_block_t block;
+
+  clib_memset (tc, 0, sizeof (*tc));
+  tc->cfg_flags |= TCP_CFG_F_RACK | TCP_CFG_F_RATE_SAMPLE;
+  tc->rcv_opts.flags |= TCP_OPTS_FLAG_SACK;
+  /* Large mss so the dupack threshold of RFC6675 never marks holes lost,
+   * only rack does */
+  tc->snd_mss = 1000;
+  tc->srtt = 10 / TCP_TICK;
+  scoreboard_init (sb);
+  tcp_test_set_time (thread_index, 100);
+  transport_connection_tx_pacer_update (&tc->connection, 1000, 1e6);
+  tcp_bt_init (tc);
+
+  /* First segment at time 100, the other 9 right after */
+  tcp_bt_track_tx (tc, 100);
+  tc->snd_nxt += 100;
+  tcp_test_set_time (thread_index, 101);
+  for (i = 0; i < 9; i++)
+    {
+      tcp_bt_track_tx (tc, 100);
+      tc->snd_nxt += 100;
+    }
+
+  /*
+   * 1) At time 120 all but the first segment are sacked. The first was
+   * sent only 1 before the newest delivered segment, within the reordering
+   * window of min rtt / 4, so it is not lost yet
+   */
+  tcp_test_set_time (thread_index, 120);
+  block.start = 100;
+  block.end = 1000;
+  vec_add1 (tc->rcv_opts.sacks, block);
+  tc->rcv_opts.n_sack_blocks = 1;
+  tcp_rcv_sacks (tc, 0);
+  tc->bytes_acked = 0;
+  tcp_bt_sample_delivery_rate (tc, rs);
+  tcp_bt_rack_detect_loss (tc, rs);
+
+  TCP_TEST ((tc->rack_xmit_time == 101), "rack xmit time %.2f",
+	    tc->rack_xmit_time);
+  TCP_TEST ((tc->rack_rtt == 19), "rack rtt %.2f", tc->rack_rtt);
+  hole = scoreboard_first_hole (sb);
+  TCP_TEST ((hole->start == 0 && hole->end == 100 && !hole->is_lost),
+	    "reordered hole [%u %u] should not be lost", hole->start,
+	    hole->end);
+  TCP_TEST ((sb->last_lost_bytes == 0 && rs->last_lost == 0),
+	    "last lost %u rs last lost %u", sb->last_lost_bytes,
+	    rs->last_lost);
+
+  /*
+   * 2) Duplicate ack at time 125. The reordering window has passed so
+   * the hole is lost, and the loss is reported in the rate sample
+   */
+  tcp_test_set_time (thread_index, 125);
+  lost = tc->lost;
+  clib_memset (rs, 0, sizeof (*rs));
+  tc->rcv_opts.sacks[0] = block;
+  tc->rcv_opts.n_sack_blocks = 1;
+  tcp_rcv_sacks (tc, 0);
+  tcp_bt_sample_delivery_rate (tc, rs);
+  tcp_bt_rack_detect_loss (tc, rs);
+
+  hole = scoreboard_first_hole (sb);
+  TCP_TEST (hole->is_lost, "hole should be lost");
+  TCP_TEST ((sb->lost_bytes == 100), "lost bytes %u", sb->lost_bytes);
+  TCP_TEST ((sb->last_lost_bytes == 100), "last lost bytes %u",
+	    sb->last_lost_bytes);
+  TCP_TEST ((rs->last_lost == 100), "rs last lost %u", rs->last_lost);
+  TCP_TEST ((rs->lost == 100), "rs lost %u", rs->lost);
+  TCP_TEST ((tc->lost == lost + 100), "tc lost %u", tc->lost);
+
+  /*
+   * 3) Another duplicate ack must not report the same loss again
+   */
+  tcp_test_set_time (thread_index, 130);
+  clib_memset (rs, 0, sizeof (*rs));
+  vec_reset_length (tc->rcv_opts.sacks);
+  tc->rcv_opts.n_sack_blocks = 0;
+  tcp_rcv_sacks (tc, 0);
+  tcp_bt_sample_delivery_rate (tc, rs);
+  tcp_bt_rack_detect_loss (tc, rs);
+  TCP_TEST ((sb->last_lost_bytes == 0 && rs->last_lost == 0),
+	    "last lost %u rs last lost %u", sb->last_lost_bytes,
+	    rs->last_lost);
+  TCP_TEST ((tc->lost == lost + 100), "tc lost %u", tc->lost);
+
+  scoreboard_clear (sb);
+  scoreboard_free (sb);
+  tcp_bt_cleanup (tc);
+  vec_free (tc->rcv_opts.sacks);
+
+  return 0;
+}
+
 static int
 tcp_test_sack (vlib_main_t * vm, unformat_input_t * input)
 {
@@ -818,6 +1034,16 @@ tcp_test_sack (vlib_main_t * vm, unformat_input_t * input)
 	{
 	  return -1;
 	}
+
+      if (tcp_test_sack_rbtree (vm, input))
+	{
+	  return -1;
+	}
+
+      if (tcp_test_sack_rack (vm, input))
+	{
+	  return -1;
+	}
     }
   else
     {
@@ -829,6 +1055,14 @@ tcp_test_sack (vlib_main_t * vm, unformat_input_t * input)
 	{
 	  res = tcp_test_sack_rx (vm, input);
 	}
+      else if (unformat (input, "rbtree"))
+	{
+	  res = tcp_test_sack_rbtree (vm, input);
+	}
+      else if (unformat (input, "rack"))
+	{
+	  res = tcp_test_sack_rack (vm, input);
+	}
     }
 
   return res;
@@ -1545,6 +1779,285 @@ tcp_test_bt (vlib_main_t * vm, unformat_input_t * input)
   return 0;
 }
 
+static vlib_buffer_t *
+tcp_test_syncookie_buffer (vlib_main_t *vm, u32 *bi, u32 seq, u32 ack,
+			   u8 flags, u8 *opts, u8 opts_len)
+{
+  ip4_header_t *ih4;
+  tcp_header_t *th;
+  vlib_buffer_t *b;
+
+  if (vlib_buffer_alloc (vm, bi, 1) != 1)
+    return 0;
+
+  b = vlib_get_buffer (vm, *bi);
+  ih4 = vlib_buffer_get_current (b);
+  clib_memset (ih4, 0, sizeof (*ih4));
+  ih4->ip_version_and_header_length = 0x45;
+  ih4->ttl = 64;
+  ih4->protocol = IP_PROTOCOL_TCP;
+  ih4->src_address.as_u32 = clib_host_to_net_u32 (0x0a000002);
+  ih4->dst_address.as_u32 = clib_host_to_net_u32 (0x0a000001);
+
+  th = ip4_next_header (ih4);
+  clib_memset (th, 0, sizeof (*th));
+  th->src_port = clib_host_to_net_u16 (40000);
+  th->dst_port = clib_host_to_net_u16 (80);
+  th->seq_number = clib_host_to_net_u32 (seq);
+  th->ack_number = clib_host_to_net_u32 (ack);
+  th->data_offset_and_reserved = ((sizeof (*th) + opts_len) >> 2) << 4;
+  th->flags = flags;
+  th->window = clib_host_to_net_u16 (1000);
+  if (opts_len)
+    clib_memcpy_fast (th + 1, opts, opts_len);
+
+  b->current_length = sizeof (*ih4) + sizeof (*th) + opts_len;
+  ih4->length = clib_host_to_net_u16 (b->current_length);
+  vnet_buffer (b)->tcp.hdr_offset = sizeof (*ih4);
+  vnet_buffer (b)->tcp.seq_number = seq;
+  vnet_buffer (b)->tcp.ack_number = ack;
+  return b;
+}
+
+static int
+tcp_test_syncookie (vlib_main_t *vm, unformat_input_t *input)
+{
+  u8 syn_opts[] = { TCP_OPTION_MSS, TCP_OPTION_LEN_MSS, 0x05, 0xb4,
+		    TCP_OPTION_NOOP, TCP_OPTION_WINDOW_SCALE,
+		    TCP_OPTION_LEN_WINDOW_SCALE, 7, TCP_OPTION_SACK_PERMITTED,
+		    TCP_OPTION_LEN_SACK_PERMITTED, TCP_OPTION_NOOP,
+		    TCP_OPTION_NOOP };
+  tcp_worker_ctx_t *wrk = tcp_get_worker (vm->thread_index);
+  u32 thread_index = vm->thread_index, isn = 0xfffffff0, bi, iss;
+  tcp_options_t _opts, *opts = &_opts;
+  f64 time_us = wrk->time_us;
+  ip4_header_t *ih4;
+  tcp_header_t *th;
+  vlib_buffer_t *b;
+  int rv;
+
+  /* Start of a cookie count interval */
+  wrk->time_us = 640.0;
+
+  b = tcp_test_syncookie_buffer (vm, &bi, isn, 0, TCP_FLAG_SYN, syn_opts,
+				 sizeof (syn_opts));
+  TCP_TEST (b != 0, "buffer allocated");
+
+  clib_memset (opts, 0, sizeof (*opts));
+  TCP_TEST (!tcp_options_parse (tcp_buffer_hdr (b), opts, 1),
+	    "syn options parsed");
+  iss = tcp_syncookie_make (b, opts, thread_index, 1 /* is_ip4 */);
+  TCP_TEST (iss == tcp_syncookie_make (b, opts, thread_index, 1),
+	    "cookie is stable");
+
+  /* Convert syn to syn-ack and check headers */
+  tcp_buffer_make_syncookie_synack (vm, b, opts, iss, 1 /* is_ip4 */);
+  ih4 = vlib_buffer_get_current (b);
+  th = ip4_next_header (ih4);
+  TCP_TEST (ih4->src_address.as_u32 == clib_host_to_net_u32 (0x0a000001),
+	    "syn-ack src is syn dst");
+  TCP_TEST (th->src_port == clib_host_to_net_u16 (80),
+	    "syn-ack src port is syn dst port");
+  TCP_TEST (th->flags == (TCP_FLAG_SYN | TCP_FLAG_ACK), "flags are syn-ack");
+  TCP_TEST (clib_net_to_host_u32 (th->seq_number) == iss,
+	    "syn-ack seq is cookie");
+  TCP_TEST (clib_net_to_host_u32 (th->ack_number) == isn + 1,
+	    "syn-ack acks syn");
+  clib_memset (opts, 0, sizeof (*opts));
+  tcp_options_parse (th, opts, 1);
+  TCP_TEST (tcp_opts_mss (opts) && tcp_opts_wscale (opts) &&
+	      tcp_opts_sack_permitted (opts) && !tcp_opts_tstamp (opts),
+	    "syn-ack has mss, wscale and sack permitted options");
+  vlib_buffer_free (vm, &bi, 1);
+
+  /* Valid ack restores syn options */
+  b = tcp_test_syncookie_buffer (vm, &bi, isn + 1, iss + 1, TCP_FLAG_ACK, 0,
+				 0);
+  TCP_TEST (b != 0, "buffer allocated");
+  clib_memset (opts, 0, sizeof (*opts));
+  rv = tcp_syncookie_check (b, opts, thread_index, 1 /* is_ip4 */);
+  TCP_TEST (rv == 0, "cookie should be valid");
+  TCP_TEST (opts->mss == 1460, "mss %u should be 1460", opts->mss);
+  TCP_TEST (tcp_opts_wscale (opts) && opts->wscale == 7,
+	    "wscale %u should be 7", opts->wscale);
+  TCP_TEST (tcp_opts_sack_permitted (opts), "sack should be permitted");
+
+  /* Still valid in next count interval but not after */
+  wrk->time_us = 640.0 + 64;
+  rv = tcp_syncookie_check (b, opts, thread_index, 1 /* is_ip4 */);
+  TCP_TEST (rv == 0, "cookie should be valid after one interval");
+  wrk->time_us = 640.0 + 2 * 64;
+  rv = tcp_syncookie_check (b, opts, thread_index, 1 /* is_ip4 */);
+  TCP_TEST (rv != 0, "cookie should be too old after two intervals");
+  wrk->time_us = 640.0;
+
+  /* Tampered ack or different 4-tuple should be rejected */
+  vnet_buffer (b)->tcp.ack_number = iss + 2;
+  rv = tcp_syncookie_check (b, opts, thread_index, 1 /* is_ip4 */);
+  TCP_TEST (rv != 0, "modified cookie should be invalid");
+  vnet_buffer (b)->tcp.ack_number = iss + 1;
+  tcp_buffer_hdr (b)->src_port = clib_host_to_net_u16 (40001);
+  rv = tcp_syncookie_check (b, opts, thread_index, 1 /* is_ip4 */);
+  TCP_TEST (rv != 0, "cookie for other port should be invalid");
+  vlib_buffer_free (vm, &bi, 1);
+
+  /* Syn without options falls back to min mss */
+  b = tcp_test_syncookie_buffer (vm, &bi, isn, 0, TCP_FLAG_SYN, 0, 0);
+  TCP_TEST (b != 0, "buffer allocated");
+  clib_memset (opts, 0, sizeof (*opts));
+  tcp_options_parse (tcp_buffer_hdr (b), opts, 1);
+  iss = tcp_syncookie_make (b, opts, thread_index, 1 /* is_ip4 */);
+  vnet_buffer (b)->tcp.seq_number = isn + 1;
+  vnet_buffer (b)->tcp.ack_number = iss + 1;
+  rv = tcp_syncookie_check (b, opts, thread_index, 1 /* is_ip4 */);
+  TCP_TEST (rv == 0 && opts->mss == 536 && !tcp_opts_wscale (opts) &&
+	      !tcp_opts_sack_permitted (opts),
+	    "cookie without options should be valid with mss 536");
+  vlib_buffer_free (vm, &bi, 1);
+
+  wrk->time_us = time_us;
+  return 0;
+}
+
+static int
+tcp_test_tso (vlib_main_t *vm, unformat_input_t *input)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  tcp_connection_t _tc, *tc = &_tc;
+  u32 sw_if_index[2], i;
+  ip4_address_t intf_addr;
+  ip46_address_t nh[2];
+  u8 intf_mac[6];
+  fib_prefix_t pfx = {
+    .fp_proto = FIB_PROTOCOL_IP4,
+    .fp_len = 24,
+    .fp_addr.ip4.as_u32 = clib_host_to_net_u32 (0x0a0a0a00),
+  };
+
+  /*
+   * Two loopbacks, neither with hw tso, and a route that can be moved
+   * between them
+   */
+  clib_memset (intf_mac, 0, sizeof (intf_mac));
+  for (i = 0; i < 2; i++)
+    {
+      if (vnet_create_loopback_interface (&sw_if_index[i], intf_mac, 0, 0))
+	{
+	  vlib_cli_output (vm, "couldn't create loopback");
+	  return -1;
+	}
+      vnet_sw_interface_set_flags (vnm, sw_if_index[i],
+				   VNET_SW_INTERFACE_FLAG_ADMIN_UP);
+      intf_addr.as_u32 = clib_host_to_net_u32 (0x0a0a0101 + (i << 8));
+      ip4_add_del_interface_address (vm, sw_if_index[i], &intf_addr, 24, 0);
+      clib_memset (&nh[i], 0, sizeof (nh[i]));
+      nh[i].ip4.as_u32 = clib_host_to_net_u32 (0x0a0a0102 + (i << 8));
+      TCP_TEST (!(vnet_get_sup_hw_interface (vnm, sw_if_index[i])->caps &
+		  VNET_HW_IF_CAP_TCP_GSO),
+		"loopback should not have hw tso");
+    }
+
+  clib_memset (tc, 0, sizeof (*tc));
+  tc->c_is_ip4 = 1;
+  tc->c_fib_index = 0;
+  tc->c_rmt_ip4.as_u32 = clib_host_to_net_u32 (0x0a0a0a01);
+
+  fib_table_entry_update_one_path (0, &pfx, FIB_SOURCE_CLI,
+				   FIB_ENTRY_FLAG_NONE, DPO_PROTO_IP4, &nh[0],
+				   sw_if_index[0], ~0, 1, NULL,
+				   FIB_ROUTE_PATH_FLAG_NONE);
+
+  /* No hw tso and no gso feature, tcp must segment itself */
+  tc->cfg_flags |= TCP_CFG_F_TSO;
+  tcp_check_gso (tc);
+  TCP_TEST (!(tc->cfg_flags & TCP_CFG_F_TSO), "no tso without gso");
+
+  /* Software gso enabled on the egress */
+  vnet_sw_interface_gso_enable_disable (sw_if_index[0], 1);
+  tcp_check_gso (tc);
+  TCP_TEST ((tc->cfg_flags & TCP_CFG_F_TSO), "tso with gso on egress");
+
+  /* Route moves to an interface without gso, next burst must not send
+   * super-segments */
+  fib_table_entry_update_one_path (0, &pfx, FIB_SOURCE_CLI,
+				   FIB_ENTRY_FLAG_NONE, DPO_PROTO_IP4, &nh[1],
+				   sw_if_index[1], ~0, 1, NULL,
+				   FIB_ROUTE_PATH_FLAG_NONE);
+  tcp_check_gso (tc);
+  TCP_TEST (!(tc->cfg_flags & TCP_CFG_F_TSO), "no tso after route moved");
+
+  /* Gso enabled and then disabled on the new egress */
+  vnet_sw_interface_gso_enable_disable (sw_if_index[1], 1);
+  tcp_check_gso (tc);
+  TCP_TEST ((tc->cfg_flags & TCP_CFG_F_TSO), "tso with gso on new egress");
+  vnet_sw_interface_gso_enable_disable (sw_if_index[1], 0);
+  tcp_check_gso (tc);
+  TCP_TEST (!(tc->cfg_flags & TCP_CFG_F_TSO), "no tso after gso disabled");
+
+  /* Cleanup */
+  fib_table_entry_delete (0, &pfx, FIB_SOURCE_CLI);
+  vnet_sw_interface_gso_enable_disable (sw_if_index[0], 0);
+  for (i = 0; i < 2; i++)
+    {
+      intf_addr.as_u32 = clib_host_to_net_u32 (0x0a0a0101 + (i << 8));
+      ip4_add_del_interface_address (vm, sw_if_index[i], &intf_addr, 24, 1);
+      vnet_sw_interface_set_flags (vnm, sw_if_index[i], 0);
+    }
+
+  return 0;
+}
+
+static tcp_connection_t *
+tcp_test_embryonic_alloc (tcp_worker_ctx_t *wrk, u32 thread_index)
+{
+  tcp_connection_t *tc;
+
+  tc = tcp_connection_alloc (thread_index);
+  tc->state = TCP_STATE_SYN_RCVD;
+  tc->flags |= TCP_CONN_EMBRYONIC;
+  wrk->n_embryonic += 1;
+  return tc;
+}
+
+static int
+tcp_test_embryonic (vlib_main_t *vm, unformat_input_t *input)
+{
+  tcp_worker_ctx_t *wrk = tcp_get_worker (vm->thread_index);
+  tcp_state_t exits[] = { TCP_STATE_ESTABLISHED, TCP_STATE_CLOSED,
+			  TCP_STATE_FIN_WAIT_1, TCP_STATE_CLOSE_WAIT };
+  u32 thread_index = vm->thread_index, n_embryonic, i;
+  tcp_connection_t *tc;
+
+  n_embryonic = wrk->n_embryonic;
+
+  /* Accept, reset or establish timeout, close and fin received */
+  for (i = 0; i < ARRAY_LEN (exits); i++)
+    {
+      tc = tcp_test_embryonic_alloc (wrk, thread_index);
+      TCP_TEST (wrk->n_embryonic == n_embryonic + 1,
+		"syn-rcvd connection should be embryonic");
+      tcp_connection_set_state (tc, exits[i]);
+      TCP_TEST (wrk->n_embryonic == n_embryonic,
+		"%U should not be embryonic", format_tcp_state, exits[i]);
+      TCP_TEST (!(tc->flags & TCP_CONN_EMBRYONIC), "flag should be reset");
+
+      /* Later state changes and free should not account it again */
+      tcp_connection_set_state (tc, TCP_STATE_CLOSED);
+      tcp_connection_free (tc);
+      TCP_TEST (wrk->n_embryonic == n_embryonic,
+		"embryonic count should be %u is %u", n_embryonic,
+		wrk->n_embryonic);
+    }
+
+  /* Connection freed without leaving syn-rcvd */
+  tc = tcp_test_embryonic_alloc (wrk, thread_index);
+  tcp_connection_free (tc);
+  TCP_TEST (wrk->n_embryonic == n_embryonic,
+	    "freed syn-rcvd connection should not be embryonic");
+
+  return 0;
+}
+
 static clib_error_t *
 tcp_test (vlib_main_t * vm,
 	  unformat_input_t * input, vlib_cli_command_t * cmd_arg)
@@ -1575,6 +2088,18 @@ tcp_test (vlib_main_t * vm,
 	{
 	  res = tcp_test_bt (vm, input);
 	}
+      else if (unformat (input, "syncookie"))
+	{
+	  res = tcp_test_syncookie (vm, input);
+	}
+      else if (unformat (input, "embryonic"))
+	{
+	  res = tcp_test_embryonic (vm, input);
+	}
+      else if (unformat (input, "tso"))
+	{
+	  res = tcp_test_tso (vm, input);
+	}
       else if (unformat (input, "all"))
 	{
 	  if ((res = tcp_test_sack (vm, input)))
@@ -1583,6 +2108,12 @@ tcp_test (vlib_main_t * vm,
 	    goto done;
 	  if ((res = tcp_test_delivery (vm, input)))
 	    goto done;
+	  if ((res = tcp_test_syncookie (vm, input)))
+	    goto done;
+	  if ((res = tcp_test_embryonic (vm, input)))
+	    goto done;
+	  if ((res = tcp_test_tso (vm, input)))
+	    goto done;
 	}
       else
 	break;
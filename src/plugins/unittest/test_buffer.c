@@ -15,6 +15,7 @@
 
 #include <vlib/vlib.h>
 #include <vlib/buffer_funcs.h>
+#include <pthread.h>
 
 #define TEST_I(_cond, _comment, _args...)                                     \
   ({                                                                          \
@@ -316,6 +317,440 @@ VLIB_CLI_COMMAND (test_linearize_speed_command, static) = {
   .function = test_linearize_speed_fn,
 };
 
+typedef struct
+{
+  vlib_buffer_pool_t *bp;
+  u32 n_iterations;
+  u32 batch;
+  u8 asymmetric;
+  volatile u32 thread_barrier;
+  volatile u32 threads_running;
+  /* asymmetric mode, per producer ring of buffer batches */
+  u32 **rings;
+  volatile u32 *ring_heads;
+  volatile u32 *ring_tails;
+} buffer_pool_test_main_t;
+
+static buffer_pool_test_main_t buffer_pool_test_main;
+
+#define BUFFER_POOL_TEST_RING_SZ 8
+
+static void *
+test_depot_thread_fn (void *arg)
+{
+  buffer_pool_test_main_t *tm = &buffer_pool_test_main;
+  vlib_buffer_pool_thread_t bpt = {};
+  vlib_buffer_pool_t *bp = tm->bp;
+  vlib_buffer_magazine_t *m;
+  u32 tag = (uword) arg, i;
+
+  while (tm->thread_barrier)
+    ;
+
+  for (i = 0; i < tm->n_iterations; i++)
+    {
+      m = vlib_buffer_magazine_pop (bp, &bp->empty_magazines, &bpt);
+      if (m)
+	{
+	  m->buffers[0] = tag;
+	  vlib_buffer_magazine_push (bp, &bp->full_magazines, m, &bpt);
+	}
+      m = vlib_buffer_magazine_pop (bp, &bp->full_magazines, &bpt);
+      if (m)
+	vlib_buffer_magazine_push (bp, &bp->empty_magazines, m, &bpt);
+    }
+
+  clib_atomic_fetch_add (&bp->threads[0].n_depot_retries,
+			 bpt.n_depot_retries);
+  clib_atomic_fetch_sub (&tm->threads_running, 1);
+  return 0;
+}
+
+static int
+test_depot_count (vlib_buffer_pool_t *bp, u64 head, uword *seen)
+{
+  vlib_buffer_magazine_t *m;
+  u32 mi = (u32) head;
+  int n = 0;
+
+  while (mi)
+    {
+      if (clib_bitmap_get (seen, mi - 1))
+	return -1;
+      seen = clib_bitmap_set (seen, mi - 1, 1);
+      m = bp->magazines + mi - 1;
+      mi = m->next;
+      n++;
+    }
+  return n;
+}
+
+static int
+buffer_pool_depot_test (vlib_main_t *vm, u32 n_threads, u32 n_iterations)
+{
+  buffer_pool_test_main_t *tm = &buffer_pool_test_main;
+  vlib_buffer_pool_t _bp = {}, *bp = &_bp, *rbp;
+  u32 n_magazines = 16, i, n_alloc, *bis = 0, n_total;
+  vlib_buffer_pool_thread_t *bpt;
+  uword *seen = 0;
+  pthread_t *handles = 0;
+  int ret = 0, n_full, n_empty;
+  u64 pushed;
+
+  /* 1. concurrent push/pop on a standalone depot */
+  vec_validate_aligned (bp->magazines, n_magazines - 1,
+			CLIB_CACHE_LINE_BYTES);
+  vec_validate (bp->threads, 0);
+  for (i = 0; i < n_magazines; i++)
+    bp->magazines[i].next = i;
+  bp->empty_magazines = n_magazines;
+
+  tm->bp = bp;
+  tm->n_iterations = n_iterations;
+  tm->thread_barrier = 1;
+  tm->threads_running = 0;
+  vec_validate (handles, n_threads - 1);
+  for (i = 0; i < n_threads; i++)
+    {
+      if (pthread_create (&handles[i], NULL, test_depot_thread_fn,
+			  (void *) (uword) i))
+	break;
+      tm->threads_running++;
+    }
+  TEST (tm->threads_running == n_threads, "started %u threads", n_threads);
+  tm->thread_barrier = 0;
+  for (i = 0; i < n_threads; i++)
+    pthread_join (handles[i], 0);
+
+  n_full = test_depot_count (bp, bp->full_magazines, seen);
+  n_empty = test_depot_count (bp, bp->empty_magazines, seen);
+  TEST (n_full >= 0 && n_empty >= 0, "no magazine on both stacks");
+  TEST (n_full + n_empty == n_magazines, "all %u magazines accounted for, "
+	"full %d empty %d retries %lu", n_magazines, n_full, n_empty,
+	bp->threads[0].n_depot_retries);
+
+  /* 2. drain and refill default pool through depot */
+  rbp = vlib_get_buffer_pool (vm, vlib_buffer_pool_get_default_for_numa (
+				     vm, vm->numa_node));
+  bpt = vec_elt_at_index (rbp->threads, vm->thread_index);
+  pushed = bpt->n_full_pushed;
+
+  vec_validate (bis, rbp->n_buffers - 1);
+  n_total = 0;
+  while ((n_alloc = vlib_buffer_alloc (vm, bis + n_total, 256)))
+    n_total += n_alloc;
+  TEST (n_total > 2 * VLIB_BUFFER_MAGAZINE_SZ, "drained %u buffers",
+	n_total);
+  vlib_buffer_free (vm, bis, n_total);
+  TEST (bpt->n_full_pushed - pushed >=
+	  (n_total - VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ) /
+	    VLIB_BUFFER_MAGAZINE_SZ - 1,
+	"freed buffers moved to depot, %lu magazines",
+	bpt->n_full_pushed - pushed);
+
+  n_alloc = 0;
+  while ((i = vlib_buffer_alloc (vm, bis + n_alloc, 256)))
+    n_alloc += i;
+  TEST (n_alloc == n_total, "realloc %u buffers, expected %u", n_alloc,
+	n_total);
+  vlib_buffer_free (vm, bis, n_alloc);
+
+  ret = 1;
+err:
+  vec_free (bp->magazines);
+  vec_free (bp->threads);
+  vec_free (handles);
+  vec_free (seen);
+  vec_free (bis);
+  return ret;
+}
+
+static void *
+test_pool_speed_thread_fn (void *arg)
+{
+  buffer_pool_test_main_t *tm = &buffer_pool_test_main;
+  u32 thread_index = (uword) arg, i, n, batch = tm->batch, ring, slot;
+  vlib_main_t *vm = vlib_get_main_by_index (thread_index);
+  u32 bis[VLIB_FRAME_SIZE];
+
+  if (thread_index)
+    os_set_thread_index (thread_index);
+
+  while (tm->thread_barrier)
+    ;
+
+  /* symmetric, thread allocates and frees its own buffers */
+  if (!tm->asymmetric)
+    {
+      for (i = 0; i < tm->n_iterations; i++)
+	{
+	  n = vlib_buffer_alloc (vm, bis, batch);
+	  vlib_buffer_free (vm, bis, n);
+	}
+      goto done;
+    }
+
+  /* asymmetric, even threads allocate and odd threads free */
+  ring = thread_index >> 1;
+  for (i = 0; i < tm->n_iterations; i++)
+    {
+      if (!(thread_index & 1))
+	{
+	  while (tm->ring_tails[ring] - tm->ring_heads[ring] ==
+		 BUFFER_POOL_TEST_RING_SZ)
+	    CLIB_PAUSE ();
+	  slot = tm->ring_tails[ring] % BUFFER_POOL_TEST_RING_SZ;
+	  n = vlib_buffer_alloc (vm, tm->rings[ring] + slot * (batch + 1) + 1,
+				 batch);
+	  tm->rings[ring][slot * (batch + 1)] = n;
+	  clib_atomic_store_rel_n (&tm->ring_tails[ring],
+				   tm->ring_tails[ring] + 1);
+	}
+      else
+	{
+	  while (clib_atomic_load_acq_n (&tm->ring_tails[ring]) ==
+		 tm->ring_heads[ring])
+	    CLIB_PAUSE ();
+	  slot = tm->ring_heads[ring] % BUFFER_POOL_TEST_RING_SZ;
+	  vlib_buffer_free (vm, tm->rings[ring] + slot * (batch + 1) + 1,
+			    tm->rings[ring][slot * (batch + 1)]);
+	  clib_atomic_store_rel_n (&tm->ring_heads[ring],
+				   tm->ring_heads[ring] + 1);
+	}
+    }
+
+done:
+  clib_atomic_fetch_sub (&tm->threads_running, 1);
+  return 0;
+}
+
+static void
+buffer_pool_speed_test (vlib_main_t *vm, u32 n_threads, u32 n_iterations,
+			u32 batch, u8 asymmetric)
+{
+  buffer_pool_test_main_t *tm = &buffer_pool_test_main;
+  u64 retries = 0, locked = 0;
+  vlib_buffer_pool_thread_t *bpt;
+  vlib_buffer_pool_t *bp;
+  pthread_t *handles = 0;
+  f64 start, elapsed;
+  u32 i, n_rings;
+
+  bp = vlib_get_buffer_pool (
+    vm, vlib_buffer_pool_get_default_for_numa (vm, vm->numa_node));
+  vec_foreach (bpt, bp->threads)
+    {
+      retries -= bpt->n_depot_retries;
+      locked -= bpt->n_lock_acquired;
+    }
+
+  n_rings = (n_threads + 1) / 2;
+  if (asymmetric)
+    {
+      vec_validate (tm->rings, n_rings - 1);
+      for (i = 0; i < n_rings; i++)
+	vec_validate (tm->rings[i],
+		      BUFFER_POOL_TEST_RING_SZ * (batch + 1) - 1);
+      tm->ring_heads = clib_mem_alloc (n_rings * sizeof (u32));
+      tm->ring_tails = clib_mem_alloc (n_rings * sizeof (u32));
+      clib_memset ((void *) tm->ring_heads, 0, n_rings * sizeof (u32));
+      clib_memset ((void *) tm->ring_tails, 0, n_rings * sizeof (u32));
+    }
+
+  tm->n_iterations = n_iterations;
+  tm->batch = batch;
+  tm->asymmetric = asymmetric;
+  tm->thread_barrier = 1;
+  tm->threads_running = n_threads;
+
+  /* workers are parked at the barrier, borrow their buffer caches */
+  if (n_threads > 1)
+    vlib_worker_thread_barrier_sync (vm);
+
+  vec_validate (handles, n_threads - 1);
+  for (i = 1; i < n_threads; i++)
+    pthread_create (&handles[i], NULL, test_pool_speed_thread_fn,
+		    (void *) (uword) i);
+
+  start = vlib_time_now (vm);
+  tm->thread_barrier = 0;
+  test_pool_speed_thread_fn (0);
+  for (i = 1; i < n_threads; i++)
+    pthread_join (handles[i], 0);
+  elapsed = vlib_time_now (vm) - start;
+
+  if (n_threads > 1)
+    vlib_worker_thread_barrier_release (vm);
+
+  vec_foreach (bpt, bp->threads)
+    {
+      retries += bpt->n_depot_retries;
+      locked += bpt->n_lock_acquired;
+    }
+
+  /* each alloc and free counted as one op per buffer */
+  vlib_cli_output (vm,
+		   "%2u threads: %.2f Mops/s total, %.2f Mops/s per thread, "
+		   "depot retries %lu, lock acquired %lu",
+		   n_threads,
+		   (f64) n_threads * n_iterations * batch / elapsed / 1e6,
+		   (f64) n_iterations * batch / elapsed / 1e6, retries,
+		   locked);
+
+  if (asymmetric)
+    {
+      for (i = 0; i < n_rings; i++)
+	vec_free (tm->rings[i]);
+      vec_free (tm->rings);
+      clib_mem_free ((void *) tm->ring_heads);
+      clib_mem_free ((void *) tm->ring_tails);
+    }
+  vec_free (handles);
+}
+
+static int
+buffer_pool_size_class_test (vlib_main_t *vm)
+{
+  vlib_buffer_size_class_t _sc = {}, *sc = &_sc;
+  u8 data[1000], out[1000], small_index, default_index;
+  vlib_buffer_t *b, *last;
+  u32 bi = ~0, i, data_size;
+  int ret = 0;
+
+  /* 1. size class selection, fake pool indices */
+  sc->default_pool_index = sc->pool_index = 0;
+  sc->small_pool_index = 1;
+
+  for (i = 0; i < VLIB_BUFFER_SIZE_CLASS_WINDOW / 64 - 1; i++)
+    vlib_buffer_size_class_update (sc, 64, 64);
+  TEST (sc->pool_index == 0, "default pool before full window");
+  vlib_buffer_size_class_update (sc, 64, 64);
+  TEST (sc->pool_index == 1, "small pool after window of small packets");
+  TEST (vlib_buffer_size_class_update (sc, 8, 7) == 1,
+	"7/8 small batch keeps small pool");
+  TEST (vlib_buffer_size_class_update (sc, 8, 6) == 0,
+	"6/8 small batch switches back to default pool");
+  for (i = 0; i < VLIB_BUFFER_SIZE_CLASS_WINDOW / 64; i++)
+    vlib_buffer_size_class_update (sc, 64, 48);
+  TEST (sc->pool_index == 0, "default pool after window of 3/4 small");
+
+  sc->small_pool_index = 0;
+  for (i = 0; i < VLIB_BUFFER_SIZE_CLASS_WINDOW / 64; i++)
+    vlib_buffer_size_class_update (sc, 64, 64);
+  TEST (sc->pool_index == 0, "no switch without small pool");
+
+  /* 2. small buffers, if configured */
+  default_index = vlib_buffer_pool_get_default_for_numa (vm, vm->numa_node);
+  small_index = vlib_buffer_pool_get_small_for_numa (vm, vm->numa_node);
+  if (small_index == default_index)
+    {
+      vlib_cli_output (vm, "small buffer pools not configured, skipping");
+      return 1;
+    }
+
+  vlib_buffer_size_class_init (vm, sc, vm->numa_node);
+  data_size = vlib_buffer_get_pool_data_size (vm, small_index);
+  TEST (sc->small_pool_index == small_index &&
+	  sc->small_data_size == data_size,
+	"size class init picks small pool %u data size %u", small_index,
+	data_size);
+
+  TEST (vlib_buffer_alloc_small (vm, &bi, 1) == 1, "alloc small buffer");
+  b = vlib_get_buffer (vm, bi);
+  TEST (b->buffer_pool_index == small_index, "buffer from small pool");
+  TEST (vlib_buffer_space_left_at_end (vm, b) == data_size,
+	"space left at end %u", vlib_buffer_space_left_at_end (vm, b));
+
+  for (i = 0; i < sizeof (data); i++)
+    data[i] = i;
+  last = b;
+  TEST (vlib_buffer_chain_append_data_with_alloc (vm, b, &last, data,
+						  sizeof (data)) ==
+	  sizeof (data),
+	"append %u bytes", sizeof (data));
+  TEST (last->buffer_pool_index == small_index,
+	"chained buffers from small pool");
+  TEST (vlib_buffer_length_in_chain (vm, b) == sizeof (data),
+	"chain length %u", vlib_buffer_length_in_chain (vm, b));
+  TEST (b->current_length == data_size, "first buffer filled to %u",
+	b->current_length);
+
+  TEST (vlib_buffer_chain_linearize (vm, b) ==
+	  (sizeof (data) + data_size - 1) / data_size,
+	"linearize into small buffers");
+  TEST (vlib_buffer_contents (vm, bi, out) == sizeof (data) &&
+	  !memcmp (data, out, sizeof (data)),
+	"data intact");
+
+  ret = 1;
+err:
+  if (bi != ~0)
+    vlib_buffer_free_one (vm, bi);
+  return ret;
+}
+
+static clib_error_t *
+test_buffer_pool_fn (vlib_main_t *vm, unformat_input_t *input,
+		     vlib_cli_command_t *cmd)
+{
+  u32 n_threads = 32, n_iterations = 100000, batch = 64, max_threads;
+  u8 speed = 0, asymmetric = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "size-class"))
+	{
+	  if (!buffer_pool_size_class_test (vm))
+	    return clib_error_return (0, "buffer size class test failed");
+	  return 0;
+	}
+      else if (unformat (input, "speed"))
+	speed = 1;
+      else if (unformat (input, "depot"))
+	speed = 0;
+      else if (unformat (input, "threads %u", &n_threads))
+	;
+      else if (unformat (input, "iterations %u", &n_iterations))
+	;
+      else if (unformat (input, "batch %u", &batch))
+	;
+      else if (unformat (input, "asymmetric"))
+	asymmetric = 1;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  if (!n_threads || !n_iterations || !batch || batch > VLIB_FRAME_SIZE)
+    return clib_error_return (0, "invalid threads, iterations or batch");
+
+  if (!speed)
+    {
+      if (!buffer_pool_depot_test (vm, clib_min (n_threads, 8),
+				   n_iterations))
+	return clib_error_return (0, "buffer pool depot test failed");
+      return 0;
+    }
+
+  /* threads share vlib mains with workers, so can't exceed their count */
+  max_threads = clib_min (n_threads, vlib_get_n_threads ());
+  if (asymmetric && max_threads < 2)
+    return clib_error_return (0, "asymmetric test needs at least 2 threads");
+
+  for (n_threads = asymmetric ? 2 : 1; n_threads <= max_threads;
+       n_threads <<= 1)
+    buffer_pool_speed_test (vm, n_threads, n_iterations, batch, asymmetric);
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (test_buffer_pool_command, static) = {
+  .path = "test buffer-pool",
+  .short_help = "test buffer-pool [depot|speed|size-class] [threads <n>] "
+		"[iterations <n>] [batch <n>] [asymmetric]",
+  .function = test_buffer_pool_fn,
+};
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
@@ -218,6 +218,578 @@ VLIB_CLI_COMMAND (test_vlib2_command, static) =
   .function = test_vlib2_command_fn,
 };
 
+static clib_error_t *
+test_vlib_time_hist_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				vlib_cli_command_t *cmd)
+{
+  u64 ns, min, next, *hist = 0;
+  u32 b, last = 0;
+  clib_error_t *err = 0;
+
+  /* every duration falls in a bucket no wider than a quarter of its
+     lower bound, and buckets grow with the duration */
+  for (ns = 0; ns < 1ULL << 36; ns = ns < 4096 ? ns + 1 : ns + ns / 7)
+    {
+      b = vlib_time_ns_hist_bucket (ns);
+      min = vlib_time_ns_hist_bucket_min (b);
+      next = vlib_time_ns_hist_bucket_min (b + 1);
+
+      if (b < last || min > ns ||
+	  (b < VLIB_TIME_NS_HIST_N_BUCKETS - 1 &&
+	   (ns >= next || next - min > clib_max (1, min / 4))))
+	return clib_error_return (0, "%llu ns in bucket %u [%llu, %llu)", ns,
+				  b, min, next);
+      last = b;
+    }
+
+  if (vlib_time_ns_hist_bucket (~0ULL) != VLIB_TIME_NS_HIST_N_BUCKETS - 1)
+    return clib_error_return (0, "longest duration not in the last bucket");
+
+  /* 90 dispatches of 100ns, 9 of 1us and one of 100us */
+  vec_validate (hist, VLIB_TIME_NS_HIST_N_BUCKETS - 1);
+  hist[vlib_time_ns_hist_bucket (100)] = 90;
+  hist[vlib_time_ns_hist_bucket (1000)] = 9;
+  hist[vlib_time_ns_hist_bucket (100000)] = 1;
+
+  for (b = 0; b < 3; b++)
+    {
+      f64 percentile[] = { 50, 99, 99.9 };
+      u64 expected[] = { 100, 1000, 100000 };
+
+      ns = vlib_time_ns_hist_percentile (hist, percentile[b]);
+      vlib_cli_output (vm, "p%.1f < %lluns", percentile[b], ns);
+      if (ns <= expected[b] || ns > expected[b] + expected[b] / 4)
+	{
+	  err = clib_error_return (0, "p%.1f is %llu, expected %llu",
+				   percentile[b], ns, expected[b]);
+	  break;
+	}
+    }
+
+  vec_free (hist);
+  return err;
+}
+
+VLIB_CLI_COMMAND (test_vlib_time_hist_command, static) = {
+  .path = "test vlib time-hist",
+  .short_help = "vlib dispatch and sojourn time histogram unit test",
+  .function = test_vlib_time_hist_command_fn,
+};
+
+
+static int
+epoch_vec_is_waiting (vlib_thread_main_t *tm, void *v)
+{
+  void **w;
+
+  vec_foreach (w, tm->epoch_waiting_frees)
+    if (w[0] == v)
+      return 1;
+  return 0;
+}
+
+static clib_error_t *
+test_vlib_epoch_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			    vlib_cli_command_t *cmd)
+{
+  vlib_global_main_t *vgm = vlib_get_global_main ();
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  u64 *pool = 0, *old, *e, n_forced;
+  u32 *loop_counts = 0;
+  int i, all_moved;
+  f64 deadline;
+
+  /* fill the pool up to the point where the next get grows it */
+  do
+    {
+      pool_get (pool, e);
+      e[0] = e - pool;
+    }
+  while (!pool_get_will_expand (pool));
+
+  old = pool;
+  vlib_pool_get_aligned_mt_safe (pool, e, 0);
+  e[0] = e - pool;
+
+  for (i = 0; i < pool_len (pool); i++)
+    ALWAYS_ASSERT (pool[i] == i);
+
+  if (vlib_get_n_threads () < 2)
+    {
+      vlib_cli_output (vm, "no workers, pool grown in place");
+      pool_free (pool);
+      return 0;
+    }
+
+  /* the old copy stays around until the workers are done with it */
+  ALWAYS_ASSERT (pool != old);
+  for (i = 0; i < vec_len (old); i++)
+    ALWAYS_ASSERT (old[i] == i);
+
+  /* closing the batch snapshots the worker loop counts */
+  deadline = vlib_time_now (vm) + 1.0;
+  while (!epoch_vec_is_waiting (tm, old))
+    {
+      vlib_worker_thread_epoch_reclaim (vm);
+      ALWAYS_ASSERT (vlib_time_now (vm) < deadline);
+    }
+
+  vec_validate (loop_counts, vec_len (tm->epoch_loop_counts) - 1);
+  for (i = 1; i < vec_len (loop_counts); i++)
+    loop_counts[i] = tm->epoch_loop_counts[i];
+  n_forced = tm->epoch_n_forced_grace_periods;
+
+  while (epoch_vec_is_waiting (tm, old))
+    {
+      all_moved = 1;
+      for (i = 1; i < vec_len (loop_counts); i++)
+	all_moved &= vgm->vlib_mains[i]->main_loop_count != loop_counts[i];
+
+      vlib_worker_thread_epoch_reclaim (vm);
+
+      /* still waiting only while some worker has not moved on */
+      if (epoch_vec_is_waiting (tm, old))
+	ALWAYS_ASSERT (!all_moved);
+      ALWAYS_ASSERT (vlib_time_now (vm) < deadline);
+    }
+
+  /* unless the grace period was forced by a barrier, the old copy was
+     freed after every worker passed the end of its loop */
+  if (tm->epoch_n_forced_grace_periods == n_forced)
+    for (i = 1; i < vec_len (loop_counts); i++)
+      ALWAYS_ASSERT (vgm->vlib_mains[i]->main_loop_count != loop_counts[i]);
+
+  vlib_cli_output (vm, "old pool copy freed after a %s grace period",
+		   tm->epoch_n_forced_grace_periods == n_forced ? "regular" :
+								  "forced");
+  vec_free (loop_counts);
+  pool_free (pool);
+  return 0;
+}
+
+VLIB_CLI_COMMAND (test_vlib_epoch_command, static) = {
+  .path = "test vlib epoch",
+  .short_help = "vlib epoch based reclamation unit test",
+  .function = test_vlib_epoch_command_fn,
+  .is_mp_safe = 1,
+};
+
+typedef struct
+{
+  vlib_barrier_reader_t *reader;
+  u32 *volatile vec;
+  volatile u32 stop;
+  volatile u32 hold;
+  volatile u32 n_bad;
+} test_vlib_reader_t;
+
+/* Each element of the shared vector holds its length, a vector freed
+   under a reader or half written shows up as a bad element */
+static void *
+test_vlib_reader_fn (void *arg)
+{
+  test_vlib_reader_t *tr = arg;
+  u32 *v, i, j;
+
+  while (!tr->stop)
+    {
+      vlib_barrier_reader_enter (tr->reader);
+      v = tr->vec;
+      for (j = 0; j < tr->hold; j++)
+	for (i = 0; i < vec_len (v); i++)
+	  if (v[i] != vec_len (v))
+	    tr->n_bad++;
+      vlib_barrier_reader_leave (tr->reader);
+    }
+  return 0;
+}
+
+static u32 *
+test_vlib_reader_vec (u32 len)
+{
+  u32 *v = 0;
+
+  vec_validate_init_empty (v, len - 1, len);
+  return v;
+}
+
+static clib_error_t *
+test_vlib_barrier_reader_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				     vlib_cli_command_t *cmd)
+{
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  test_vlib_reader_t tr = { .hold = 64 };
+  u32 *old, n_iter = 200, i, n;
+  pthread_t thread;
+  f64 deadline;
+
+  tr.reader = vlib_barrier_reader_alloc ();
+  tr.vec = test_vlib_reader_vec (1);
+  if (pthread_create (&thread, 0, test_vlib_reader_fn, &tr))
+    return clib_error_return (0, "pthread_create failed");
+
+  /* A barrier sync waits for the reader to leave, the old vector can go
+     right away */
+  for (i = 0; i < n_iter; i++)
+    {
+      vlib_worker_thread_barrier_sync (vm);
+      ALWAYS_ASSERT (tr.reader->active == 0);
+      old = tr.vec;
+      tr.vec = test_vlib_reader_vec (vec_len (old) + 1);
+      clib_memset (old, 0xff, vec_len (old) * sizeof (old[0]));
+      vec_free (old);
+      vlib_worker_thread_barrier_release (vm);
+      n = tr.reader->n_sections;
+      while (tr.reader->n_sections == n)
+	CLIB_PAUSE ();
+    }
+  vlib_cli_output (vm, "barrier: %u replacements, %u bad reads", n_iter,
+		   tr.n_bad);
+
+  /* Without the barrier the old vector is freed after the reader left
+     the section it may have read it in */
+  for (i = 0; i < n_iter; i++)
+    {
+      old = tr.vec;
+      tr.vec = test_vlib_reader_vec (vec_len (old) + 1);
+      vlib_worker_thread_defer_vec_free (old);
+      deadline = vlib_time_now (vm) + 1.0;
+      while (vec_len (tm->epoch_waiting_frees) ||
+	     vec_len (tm->epoch_pending_frees))
+	{
+	  vlib_worker_thread_epoch_reclaim (vm);
+	  ALWAYS_ASSERT (vlib_time_now (vm) < deadline);
+	}
+    }
+  vlib_cli_output (vm, "deferred free: %u replacements, %u bad reads",
+		   n_iter, tr.n_bad);
+
+  /* Waiting one loop includes the reader's current section */
+  n = tr.reader->n_sections;
+  vlib_worker_wait_one_loop ();
+  ALWAYS_ASSERT (tr.reader->n_sections != n || !tr.reader->active);
+
+  tr.stop = 1;
+  pthread_join (thread, 0);
+  vlib_barrier_reader_free (tr.reader);
+  vec_free (tr.vec);
+
+  if (tr.n_bad)
+    return clib_error_return (0, "reader saw %u bad elements", tr.n_bad);
+  return 0;
+}
+
+VLIB_CLI_COMMAND (test_vlib_barrier_reader_command, static) = {
+  .path = "test vlib barrier-reader",
+  .short_help = "vlib barrier reader unit test",
+  .function = test_vlib_barrier_reader_command_fn,
+  .is_mp_safe = 1,
+};
+
+typedef struct
+{
+  u32 fq_index;
+  u32 n_received;
+  u32 n_bad_aux;
+  u32 n_bad_thread;
+  u64 rx_time;
+} test_vlib_handoff_main_t;
+
+static test_vlib_handoff_main_t test_vlib_handoff_main = {
+  .fq_index = ~0,
+};
+
+#define TEST_VLIB_HANDOFF_THREAD 1
+
+/* expected aux value is carried in the buffer data */
+static uword
+test_vlib_handoff_node_fn (vlib_main_t *vm, vlib_node_runtime_t *node,
+			   vlib_frame_t *frame)
+{
+  test_vlib_handoff_main_t *thm = &test_vlib_handoff_main;
+  u32 *from = vlib_frame_vector_args (frame);
+  u32 *aux = vlib_frame_aux_args (frame);
+  u32 i, n_bad_aux = 0;
+  vlib_buffer_t *b;
+
+  for (i = 0; i < frame->n_vectors; i++)
+    {
+      b = vlib_get_buffer (vm, from[i]);
+      n_bad_aux += *(u32 *) vlib_buffer_get_current (b) != aux[i];
+    }
+
+  thm->rx_time = clib_cpu_time_now ();
+  if (vm->thread_index != TEST_VLIB_HANDOFF_THREAD)
+    clib_atomic_fetch_add (&thm->n_bad_thread, frame->n_vectors);
+  clib_atomic_fetch_add (&thm->n_bad_aux, n_bad_aux);
+  clib_atomic_fetch_add (&thm->n_received, frame->n_vectors);
+
+  vlib_buffer_free (vm, from, frame->n_vectors);
+  return frame->n_vectors;
+}
+
+VLIB_REGISTER_NODE (test_vlib_handoff_node, static) = {
+  .function = test_vlib_handoff_node_fn,
+  .name = "test-vlib-handoff",
+  .vector_size = sizeof (u32),
+  .aux_size = sizeof (u32),
+  .type = VLIB_NODE_TYPE_INTERNAL,
+};
+
+static void
+test_vlib_handoff_init (vlib_main_t *vm)
+{
+  test_vlib_handoff_main_t *thm = &test_vlib_handoff_main;
+
+  if (thm->fq_index != ~0)
+    return;
+
+  vlib_worker_thread_barrier_sync (vm);
+  thm->fq_index = vlib_frame_queue_main_init (test_vlib_handoff_node.index, 0);
+  vlib_worker_thread_barrier_release (vm);
+}
+
+static clib_error_t *
+test_vlib_handoff_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			      vlib_cli_command_t *cmd)
+{
+  test_vlib_handoff_main_t *thm = &test_vlib_handoff_main;
+  u32 bi[VLIB_FRAME_SIZE], aux[VLIB_FRAME_SIZE];
+  u16 threads[VLIB_FRAME_SIZE];
+  u32 i, n, n_left = 10000, n_sent = 0;
+  vlib_node_runtime_t *node;
+  f64 deadline;
+
+  unformat (input, "%u", &n_left);
+
+  if (vlib_get_n_threads () <= TEST_VLIB_HANDOFF_THREAD)
+    {
+      vlib_cli_output (vm, "no workers, handoff not tested");
+      return 0;
+    }
+
+  test_vlib_handoff_init (vm);
+
+  thm->n_received = thm->n_bad_aux = thm->n_bad_thread = 0;
+  node = vlib_node_get_runtime (vm, vlib_get_current_process_node_index (vm));
+  clib_memset_u16 (threads, TEST_VLIB_HANDOFF_THREAD, VLIB_FRAME_SIZE);
+
+  while (n_left)
+    {
+      n = vlib_buffer_alloc (vm, bi, clib_min (n_left, VLIB_FRAME_SIZE));
+      if (!n)
+	return clib_error_return (0, "buffer allocation failed");
+
+      /* aux data as used by vhost-user tx handoff, instance and queue id */
+      for (i = 0; i < n; i++)
+	{
+	  vlib_buffer_t *b = vlib_get_buffer (vm, bi[i]);
+	  aux[i] = (n_sent + i) << 8 | ((n_sent + i) & 0xff);
+	  *(u32 *) vlib_buffer_get_current (b) = aux[i];
+	  b->current_length = sizeof (u32);
+	}
+
+      n_sent += vlib_buffer_enqueue_to_thread_with_aux (
+	vm, node, thm->fq_index, bi, aux, threads, n,
+	1 /* drop_on_congestion */);
+      n_left -= n;
+
+      /* let the worker drain the queue, bounding buffers in flight */
+      deadline = vlib_time_now (vm) + 2.0;
+      do
+	vlib_process_suspend (vm, 1e-4);
+      while (n_sent - thm->n_received > 4 * VLIB_FRAME_SIZE &&
+	     vlib_time_now (vm) < deadline);
+    }
+
+  deadline = vlib_time_now (vm) + 2.0;
+  while (thm->n_received < n_sent && vlib_time_now (vm) < deadline)
+    vlib_process_suspend (vm, 1e-3);
+
+  vlib_cli_output (vm,
+		   "%u packets handed off to thread %u, %u received, "
+		   "%u with bad aux, %u on wrong thread",
+		   n_sent, TEST_VLIB_HANDOFF_THREAD, thm->n_received,
+		   thm->n_bad_aux, thm->n_bad_thread);
+
+  if (!n_sent || thm->n_received != n_sent || thm->n_bad_aux ||
+      thm->n_bad_thread)
+    return clib_error_return (0, "handoff with aux data failed");
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (test_vlib_handoff_command, static) = {
+  .path = "test vlib handoff-aux",
+  .short_help = "test vlib handoff-aux [<n-packets>]",
+  .function = test_vlib_handoff_command_fn,
+  .is_mp_safe = 1,
+};
+
+/* marks when the worker ran, like the handoff node does */
+static uword
+test_vlib_wakeup_node_fn (vlib_main_t *vm, vlib_node_runtime_t *node,
+			  vlib_frame_t *frame)
+{
+  test_vlib_handoff_main.rx_time = clib_cpu_time_now ();
+  return 0;
+}
+
+VLIB_REGISTER_NODE (test_vlib_wakeup_node, static) = {
+  .function = test_vlib_wakeup_node_fn,
+  .name = "test-vlib-wakeup",
+  .type = VLIB_NODE_TYPE_INPUT,
+  .state = VLIB_NODE_STATE_DISABLED,
+};
+
+/* wait until the worker sleeps and its backoff reached the longest sleep */
+static int
+test_vlib_tickless_wait_asleep (vlib_main_t *vm, vlib_main_t *wvm)
+{
+  f64 deadline = vlib_time_now (vm) + 2.0;
+
+  while (!wvm->sleeping && vlib_time_now (vm) < deadline)
+    vlib_process_suspend (vm, 1e-3);
+
+  vlib_process_suspend (vm, 0.5);
+  return wvm->sleeping;
+}
+
+/* ticks from t0 until the worker ran, 0 if it never did */
+static u64
+test_vlib_tickless_wait_rx (vlib_main_t *vm, u64 t0)
+{
+  test_vlib_handoff_main_t *thm = &test_vlib_handoff_main;
+  f64 deadline = vlib_time_now (vm) + 1.0;
+  u64 rx_time;
+
+  while (!(rx_time = __atomic_load_n (&thm->rx_time, __ATOMIC_ACQUIRE)) &&
+	 vlib_time_now (vm) < deadline)
+    vlib_process_suspend (vm, 1e-5);
+
+  return rx_time ? rx_time - t0 : 0;
+}
+
+static clib_error_t *
+test_vlib_tickless_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			       vlib_cli_command_t *cmd)
+{
+  test_vlib_handoff_main_t *thm = &test_vlib_handoff_main;
+  char *names[] = { "interrupt", "handoff", "wait one loop" };
+  u64 min[3], max[3], sum[3], t0, dt;
+  f64 us = 1e6 / vm->clib_time.clocks_per_second;
+  u32 bi, aux = 0, i, k, n_trials = 5;
+  u16 thread = TEST_VLIB_HANDOFF_THREAD;
+  clib_error_t *err = 0;
+  vlib_node_runtime_t *node;
+  vlib_main_t *wvm;
+  vlib_buffer_t *b;
+
+  unformat (input, "%u", &n_trials);
+
+  if (!vlib_thread_main.tickless_sleep ||
+      vlib_get_n_threads () <= TEST_VLIB_HANDOFF_THREAD)
+    {
+      vlib_cli_output (vm, "no tickless workers, wakeup not tested");
+      return 0;
+    }
+
+  wvm = vlib_get_main_by_index (TEST_VLIB_HANDOFF_THREAD);
+  node = vlib_node_get_runtime (vm, vlib_get_current_process_node_index (vm));
+  test_vlib_handoff_init (vm);
+
+  vlib_worker_thread_barrier_sync (vm);
+  vlib_node_set_state (wvm, test_vlib_wakeup_node.index,
+		       VLIB_NODE_STATE_INTERRUPT);
+  vlib_worker_thread_barrier_release (vm);
+
+  for (k = 0; k < 3; k++)
+    {
+      min[k] = ~0ULL;
+      max[k] = sum[k] = 0;
+    }
+
+  for (i = 0; i < n_trials && !err; i++)
+    for (k = 0; k < 3 && !err; k++)
+      {
+	if (!test_vlib_tickless_wait_asleep (vm, wvm))
+	  {
+	    err = clib_error_return (0, "worker %u does not sleep",
+				     TEST_VLIB_HANDOFF_THREAD);
+	    break;
+	  }
+
+	thm->rx_time = 0;
+	t0 = clib_cpu_time_now ();
+
+	if (k == 0)
+	  {
+	    vlib_node_set_interrupt_pending (wvm, test_vlib_wakeup_node.index);
+	    dt = test_vlib_tickless_wait_rx (vm, t0);
+	  }
+	else if (k == 1)
+	  {
+	    if (vlib_buffer_alloc (vm, &bi, 1) != 1)
+	      {
+		err = clib_error_return (0, "buffer allocation failed");
+		break;
+	      }
+	    b = vlib_get_buffer (vm, bi);
+	    *(u32 *) vlib_buffer_get_current (b) = aux;
+	    b->current_length = sizeof (u32);
+	    vlib_buffer_enqueue_to_thread_with_aux (vm, node, thm->fq_index,
+						    &bi, &aux, &thread, 1, 1);
+	    dt = test_vlib_tickless_wait_rx (vm, t0);
+	  }
+	else
+	  {
+	    vlib_worker_wait_one_loop ();
+	    dt = clib_cpu_time_now () - t0;
+	  }
+
+	if (dt == 0)
+	  {
+	    err = clib_error_return (0, "%s: worker never ran", names[k]);
+	    break;
+	  }
+
+	min[k] = clib_min (min[k], dt);
+	max[k] = clib_max (max[k], dt);
+	sum[k] += dt;
+      }
+
+  vlib_worker_thread_barrier_sync (vm);
+  vlib_node_set_state (wvm, test_vlib_wakeup_node.index,
+		       VLIB_NODE_STATE_DISABLED);
+  vlib_worker_thread_barrier_release (vm);
+
+  if (err)
+    return err;
+
+  /* waiting for sleeps of up to 100ms to end would average around 50ms,
+     leave room for scheduling delays on a loaded host */
+  for (k = 0; k < 3; k++)
+    {
+      f64 avg = sum[k] * us / n_trials;
+
+      vlib_cli_output (vm, "%s: min %.1fus avg %.1fus max %.1fus", names[k],
+		       min[k] * us, avg, max[k] * us);
+      if (avg >= 20e3 && !err)
+	err = clib_error_return (0, "%s took %.1fus on average to wake "
+				 "worker %u", names[k], avg,
+				 TEST_VLIB_HANDOFF_THREAD);
+    }
+
+  return err;
+}
+
+VLIB_CLI_COMMAND (test_vlib_tickless_command, static) = {
+  .path = "test vlib tickless",
+  .short_help = "test vlib tickless [<n-trials>]",
+  .function = test_vlib_tickless_command_fn,
+  .is_mp_safe = 1,
+};
+
 
 
 
@@ -118,6 +118,7 @@ static_always_inline void
 vhost_user_tx_thread_placement (vhost_user_intf_t *vui, u32 qid)
 {
   vnet_main_t *vnm = vnet_get_main ();
+  vhost_user_main_t *vum = &vhost_user_main;
   vhost_user_vring_t *rxvq = &vui->vrings[qid];
   u32 q = qid >> 1, rxvq_count;
 
@@ -153,7 +154,33 @@ vhost_user_tx_thread_placement (vhost_user_intf_t *vui, u32 qid)
       vnet_hw_if_tx_queue_assign_thread (vnm, qi, i);
     }
 
+  /*
+   * Pick the thread which owns each vring in tx-handoff mode. Prefer a
+   * worker, the main thread only transmits when there are none. The owner
+   * changes under the barrier, so no two threads ever write a vring.
+   */
+  if (vum->tx_handoff)
+    vlib_worker_thread_barrier_sync (vlib_get_main ());
+
+  FOR_ALL_VHOST_RXQ (q, vui)
+  {
+    vhost_user_vring_t *rxvq = &vui->vrings[q];
+    vnet_hw_if_tx_queue_t *txq;
+    uword owner;
+
+    if (rxvq->queue_index == ~0)
+      break;
+    txq = vnet_hw_if_get_tx_queue (vnm, rxvq->queue_index);
+    owner = clib_bitmap_next_set (txq->threads, vlib_num_workers () ? 1 : 0);
+    if (owner == ~0)
+      owner = clib_bitmap_first_set (txq->threads);
+    rxvq->thread_index = owner;
+  }
+
   vnet_hw_if_update_runtime_data (vnm, vui->hw_if_index);
+
+  if (vum->tx_handoff)
+    vlib_worker_thread_barrier_release (vlib_get_main ());
 }
 
 /**
@@ -357,6 +384,55 @@ vhost_user_vring_close (vhost_user_intf_t * vui, u32 qid)
   vui->vrings[qid].thread_index = thread_index;
 }
 
+static void
+vhost_user_dma_config_add (vlib_main_t *vm, vhost_user_intf_t *vui)
+{
+  vlib_dma_config_t args;
+
+  /* the feature bits share a word, initializers leave the others unset */
+  clib_memset (&args, 0, sizeof (args));
+  args.max_batches = 256;
+  args.max_transfers = VHOST_USER_COPY_ARRAY_N;
+  args.max_transfer_size = vlib_buffer_get_default_data_size (vm);
+  args.barrier_before_last = 1;
+  args.sw_fallback = 1;
+  args.callback_fn = vhost_user_tx_dma_completion_cb;
+
+  vui->dma_tx_config = vlib_dma_config_add (vm, &args);
+  if (vui->dma_tx_config < 0)
+    vu_log_warn (vui, "no DMA backend available, copying with the cpu");
+}
+
+static void
+vhost_user_dma_config_del (vlib_main_t *vm, vhost_user_intf_t *vui)
+{
+  vhost_user_main_t *vum = &vhost_user_main;
+  u32 dev_instance = vui - vum->vhost_user_interfaces;
+  vhost_cpu_t *cpu;
+  vhost_user_dma_t *d;
+  int q;
+
+  if (vui->dma_tx_config < 0)
+    return;
+
+  /* drops the batches still in flight, release their buffers */
+  vlib_dma_config_del (vm, vui->dma_tx_config);
+  vui->dma_tx_config = -1;
+
+  vec_foreach (cpu, vum->cpus)
+    pool_foreach (d, cpu->dma)
+      {
+	if (d->dev_instance != dev_instance)
+	  continue;
+	vlib_buffer_free (vm, d->buffers, vec_len (d->buffers));
+	vec_free (d->buffers);
+	pool_put (cpu->dma, d);
+      }
+
+  FOR_ALL_VHOST_RXQ (q, vui)
+    vui->vrings[q].dma_pending = 0;
+}
+
 static_always_inline void
 vhost_user_if_disconnect (vhost_user_intf_t * vui)
 {
@@ -375,6 +451,14 @@ vhost_user_if_disconnect (vhost_user_intf_t * vui)
 
   FOR_ALL_VHOST_RX_TXQ (q, vui) { vhost_user_vring_close (vui, q); }
 
+  /* no DMA may land in guest memory once it is unmapped */
+  if (vui->use_dma)
+    {
+      vlib_main_t *vm = vlib_get_main ();
+      vhost_user_dma_config_del (vm, vui);
+      vhost_user_dma_config_add (vm, vui);
+    }
+
   unmap_all_mem_regions (vui);
   vu_log_debug (vui, "interface ifindex %d disconnected", vui->sw_if_index);
 }
@@ -521,6 +605,8 @@ vhost_user_socket_read (clib_file_t * uf)
 	msg.u64 |= FEATURE_VIRTIO_NET_F_HOST_GUEST_TSO_FEATURE_BITS;
       if (vui->enable_packed)
 	msg.u64 |= VIRTIO_FEATURE (VIRTIO_F_RING_PACKED);
+      if (vui->enable_in_order)
+	msg.u64 |= VIRTIO_FEATURE (VIRTIO_F_IN_ORDER);
 
       msg.size = sizeof (msg.u64);
       vu_log_debug (vui, "if %d msg VHOST_USER_GET_FEATURES - reply "
@@ -1173,6 +1259,7 @@ vhost_user_init (vlib_main_t * vm)
 
   vum->coalesce_frames = 32;
   vum->coalesce_time = 1e-3;
+  vum->dma_threshold = VHOST_USER_DMA_THRESHOLD_DEFAULT;
 
   vec_validate (vum->cpus, tm->n_vlib_mains - 1);
 
@@ -1405,6 +1492,8 @@ vhost_user_term_if (vhost_user_intf_t * vui)
   for (q = 0; q < vec_len (vui->vrings); q++)
     clib_spinlock_free (&vui->vrings[q].vring_lock);
 
+  vhost_user_dma_config_del (vlib_get_main (), vui);
+
   if (vui->unix_server_index != ~0)
     {
       //Close server socket
@@ -1614,6 +1703,11 @@ vhost_user_vui_init (vnet_main_t * vnm, vhost_user_intf_t * vui,
   vui->enable_gso = args->enable_gso;
   vui->enable_event_idx = args->enable_event_idx;
   vui->enable_packed = args->enable_packed;
+  vui->enable_in_order = args->enable_in_order;
+  vui->use_dma = args->use_dma;
+  vui->dma_tx_config = -1;
+  if (vui->use_dma)
+    vhost_user_dma_config_add (vlib_get_main (), vui);
   /*
    * enable_gso takes precedence over configurable feature mask if there
    * is a clash.
@@ -1787,6 +1881,10 @@ vhost_user_connect_command_fn (vlib_main_t * vm,
 	args.enable_packed = 1;
       else if (unformat (line_input, "event-idx"))
 	args.enable_event_idx = 1;
+      else if (unformat (line_input, "in-order"))
+	args.enable_in_order = 1;
+      else if (unformat (line_input, "use-dma"))
+	args.use_dma = 1;
       else if (unformat (line_input, "feature-mask 0x%llx",
 			 &args.feature_mask))
 	;
@@ -2201,6 +2299,11 @@ show_vhost_user_command_fn (vlib_main_t * vm,
 	vlib_cli_output (vm, "  Packed ring enable");
       if (vui->enable_event_idx)
 	vlib_cli_output (vm, "  Event index enable");
+      if (vui->enable_in_order)
+	vlib_cli_output (vm, "  In-order enable");
+      if (vui->dma_tx_config >= 0)
+	vlib_cli_output (vm, "  DMA config %d threshold %u", vui->dma_tx_config,
+			 vum->dma_threshold);
 
       vlib_cli_output (vm, "virtio_net_hdr_sz %d\n"
 		       " features mask (0x%llx): \n"
@@ -2258,7 +2361,11 @@ show_vhost_user_command_fn (vlib_main_t * vm,
 	if (rxvq->queue_index == ~0)
 	  continue;
 	txq = vnet_hw_if_get_tx_queue (vnm, rxvq->queue_index);
-	if (txq->threads)
+	if (txq->threads && txq->shared_queue && vum->tx_handoff)
+	  vlib_cli_output (vm, "   threads %U on vring %u: handoff to %u\n",
+			   format_bitmap_list, txq->threads, qid,
+			   rxvq->thread_index);
+	else if (txq->threads)
 	  vlib_cli_output (vm, "   threads %U on vring %u: %s\n",
 			   format_bitmap_list, txq->threads, qid,
 			   txq->shared_queue ? "spin-lock" : "lock-free");
@@ -2383,7 +2490,7 @@ VLIB_CLI_COMMAND (vhost_user_connect_command, static) = {
     .path = "create vhost-user",
     .short_help = "create vhost-user socket <socket-filename> [server] "
     "[feature-mask <hex>] [hwaddr <mac-addr>] [renumber <dev_instance>] [gso] "
-    "[packed] [event-idx]",
+    "[packed] [event-idx] [in-order] [use-dma]",
     .function = vhost_user_connect_command_fn,
     .is_mp_safe = 1,
 };
@@ -2561,11 +2668,19 @@ vhost_user_config (vlib_main_t * vm, unformat_input_t * input)
 	;
       else if (unformat (input, "dont-dump-memory"))
 	vum->dont_dump_vhost_user_memory = 1;
+      else if (unformat (input, "tx-handoff"))
+	vum->tx_handoff = 1;
+      else if (unformat (input, "dma-threshold %u", &vum->dma_threshold))
+	;
       else
 	return clib_error_return (0, "unknown input `%U'",
 				  format_unformat_error, input);
     }
 
+  if (vum->tx_handoff)
+    vum->tx_handoff_fq_index =
+      vlib_frame_queue_main_init (vhost_user_tx_handoff_node.index, 0);
+
   return 0;
 }
 
@@ -15,6 +15,7 @@
 #ifndef __VIRTIO_VHOST_USER_H__
 #define __VIRTIO_VHOST_USER_H__
 
+#include <vlib/dma/dma.h>
 #include <vhost/virtio_std.h>
 #include <vhost/vhost_std.h>
 
@@ -109,6 +110,8 @@ typedef struct
   u8 enable_gso;
   u8 enable_packed;
   u8 enable_event_idx;
+  u8 enable_in_order;
+  u8 use_dma;
   u8 use_custom_mac;
 
   /* return */
@@ -228,7 +231,13 @@ typedef struct
   u16 avail_wrap_counter;
   u16 last_kick;
   u8 first_kick;
+  /* DMA batches submitted and not completed yet */
+  u16 dma_pending;
   u32 queue_index;
+  /*
+   * Thread polling a guest tx vring. For a guest rx vring, the thread which
+   * transmits on it on behalf of all others when tx-handoff is enabled.
+   */
   u32 thread_index;
 } vhost_user_vring_t;
 
@@ -283,6 +292,14 @@ typedef struct
   u8 enable_packed;
 
   u8 enable_event_idx;
+
+  /* In-order descriptor completion configured */
+  u8 enable_in_order;
+
+  /* Copies to the guest go through DMA */
+  u8 use_dma;
+  /* DMA config, -1 when not used */
+  int dma_tx_config;
 } vhost_user_intf_t;
 
 #define FOR_ALL_VHOST_TXQ(qid, vui) for (qid = 1; qid < vui->num_qid; qid += 2)
@@ -298,6 +315,17 @@ typedef struct
   u32 len;
 } vhost_copy_t;
 
+/* A DMA batch of guest rx copies in flight */
+typedef struct
+{
+  /* Buffers freed once the copies are done */
+  u32 *buffers;
+  u32 dev_instance;
+  u16 vring_idx;
+  /* Used ring index the batch covers */
+  u16 used_idx;
+} vhost_user_dma_t;
+
 typedef struct
 {
   u16 qid; /** The interface queue index (Not the virtio vring idx) */
@@ -309,6 +337,7 @@ typedef struct
 
 #define VHOST_USER_RX_BUFFERS_N (2 * VLIB_FRAME_SIZE + 2)
 #define VHOST_USER_COPY_ARRAY_N (4 * VLIB_FRAME_SIZE)
+#define VHOST_USER_DMA_THRESHOLD_DEFAULT 256
 
 typedef struct
 {
@@ -325,6 +354,9 @@ typedef struct
   u32 *to_next_list;
   vlib_buffer_t **rx_buffers_pdesc;
   u32 polling_q_count;
+
+  /* Pool of DMA batches in flight */
+  vhost_user_dma_t *dma;
 } vhost_cpu_t;
 
 typedef struct
@@ -351,6 +383,13 @@ typedef struct
 
   /* gso interface count */
   u32 gso_count;
+
+  /* Shared tx queues are handed off to the owning thread instead of locked */
+  u8 tx_handoff;
+  u32 tx_handoff_fq_index;
+
+  /* Copies shorter than this are done by the cpu even with DMA */
+  u32 dma_threshold;
 } vhost_user_main_t;
 
 typedef struct
@@ -369,10 +408,12 @@ int vhost_user_dump_ifs (vnet_main_t * vnm, vlib_main_t * vm,
 			 vhost_user_intf_details_t ** out_vuids);
 void vhost_user_set_operation_mode (vhost_user_intf_t *vui,
 				    vhost_user_vring_t *txvq);
+void vhost_user_tx_dma_completion_cb (vlib_main_t *vm, vlib_dma_batch_t *b);
 
 extern vlib_node_registration_t vhost_user_send_interrupt_node;
 extern vnet_device_class_t vhost_user_device_class;
 extern vlib_node_registration_t vhost_user_input_node;
+extern vlib_node_registration_t vhost_user_tx_handoff_node;
 extern vhost_user_main_t vhost_user_main;
 
 #endif
@@ -255,6 +255,31 @@ vhost_user_is_packed_ring_supported (vhost_user_intf_t * vui)
   return (vui->features & VIRTIO_FEATURE (VIRTIO_F_RING_PACKED));
 }
 
+static_always_inline u64
+vhost_user_is_in_order_supported (vhost_user_intf_t *vui)
+{
+  return (vui->features & VIRTIO_FEATURE (VIRTIO_F_IN_ORDER));
+}
+
+/*
+ * With VIRTIO_F_IN_ORDER the driver only needs one used ring entry per
+ * batch, placed at the start of the batch and carrying the head of the
+ * last descriptor chain.
+ */
+static_always_inline void
+vhost_user_used_in_order (vhost_user_intf_t *vui, vhost_user_vring_t *vq,
+			  u16 used_idx, u16 last_used_idx, u16 last_head)
+{
+  u16 slot = used_idx & vq->qsz_mask;
+
+  if (used_idx == last_used_idx)
+    return;
+
+  vq->used->ring[slot].id = last_head;
+  vq->used->ring[slot].len = 0;
+  vhost_user_log_dirty_ring (vui, vq, ring[slot]);
+}
+
 static_always_inline u64
 vhost_user_is_event_idx_supported (vhost_user_intf_t * vui)
 {
@@ -510,6 +510,8 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
 
   u16 last_avail_idx = txvq->last_avail_idx;
   u16 last_used_idx = txvq->last_used_idx;
+  u16 used_idx = last_used_idx, last_head = 0;
+  u8 in_order = vhost_user_is_in_order_supported (vui) != 0;
 
   while (n_left > 0)
     {
@@ -541,9 +543,14 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
 	(vm, cpu->rx_buffers[cpu->rx_buffers_len - 1], LOAD);
 
       /* Just preset the used descriptor id and length for later */
-      txvq->used->ring[last_used_idx & mask].id = desc_current;
-      txvq->used->ring[last_used_idx & mask].len = 0;
-      vhost_user_log_dirty_ring (vui, txvq, ring[last_used_idx & mask]);
+      if (in_order)
+	last_head = desc_current;
+      else
+	{
+	  txvq->used->ring[last_used_idx & mask].id = desc_current;
+	  txvq->used->ring[last_used_idx & mask].len = 0;
+	  vhost_user_log_dirty_ring (vui, txvq, ring[last_used_idx & mask]);
+	}
 
       /* The buffer should already be initialized */
       b_head->total_length_not_including_first_buffer = 0;
@@ -718,8 +725,11 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
 	  copy_len = 0;
 
 	  /* give buffers back to driver */
+	  if (in_order)
+	    vhost_user_used_in_order (vui, txvq, used_idx, last_used_idx,
+				      last_head);
 	  CLIB_MEMORY_STORE_BARRIER ();
-	  txvq->used->idx = last_used_idx;
+	  txvq->used->idx = used_idx = last_used_idx;
 	  vhost_user_log_dirty_ring (vui, txvq, idx);
 	}
     }
@@ -738,6 +748,9 @@ stop:
     }
 
   /* give buffers back to driver */
+  if (in_order)
+    vhost_user_used_in_order (vui, txvq, used_idx, txvq->last_used_idx,
+			      last_head);
   CLIB_MEMORY_STORE_BARRIER ();
   txvq->used->idx = txvq->last_used_idx;
   vhost_user_log_dirty_ring (vui, txvq, idx);
@@ -66,7 +66,8 @@ extern vnet_device_class_t vhost_user_device_class;
   _(PKT_DROP_NOBUF, "tx packet drops (no available descriptors)")  \
   _(PKT_DROP_NOMRG, "tx packet drops (cannot merge descriptors)")  \
   _(MMAP_FAIL, "mmap failure") \
-  _(INDIRECT_OVERFLOW, "indirect descriptor table overflow")
+  _(INDIRECT_OVERFLOW, "indirect descriptor table overflow") \
+  _(HANDOFF_DROP, "tx packet drops (handoff queue congestion)")
 
 typedef enum
 {
@@ -201,6 +202,105 @@ vhost_user_tx_copy (vhost_user_intf_t * vui, vhost_copy_t * cpy,
   return 0;
 }
 
+/*
+ * Same as vhost_user_tx_copy, but copies of at least dma_threshold bytes go
+ * through DMA. The used ring index is then published by the completion
+ * callback, once the copies landed in guest memory.
+ *
+ * Only the split ring is offloaded: a single used->idx store hands all
+ * descriptors back, so it alone needs deferring. The packed ring marks
+ * every descriptor used through its flags, and the guest tx path would have
+ * to hold its frames until completion, as memif input does.
+ */
+static_always_inline u32
+vhost_user_tx_copy_dma (vlib_main_t *vm, vhost_user_intf_t *vui,
+			vhost_user_vring_t *rxvq, vhost_copy_t *cpy,
+			u16 copy_len, u32 *map_hint, u32 *dma_index)
+{
+  vhost_user_main_t *vum = &vhost_user_main;
+  vhost_cpu_t *cpu = &vum->cpus[vm->thread_index];
+  vlib_dma_batch_t *b;
+  vhost_user_dma_t *d;
+  void *dst;
+  u32 rv = 0;
+
+  b = vlib_dma_batch_new (vm, vui->dma_tx_config);
+  if (PREDICT_FALSE (!b))
+    return vhost_user_tx_copy (vui, cpy, copy_len, map_hint);
+
+  for (; copy_len; copy_len--, cpy++)
+    {
+      if (PREDICT_FALSE (!(dst = map_guest_mem (vui, cpy->dst, map_hint))))
+	{
+	  rv = 1;
+	  break;
+	}
+      /* virtio headers live in cpu->tx_headers, which the next frame
+       * rewrites before this batch may have completed */
+      if (cpy->len < vum->dma_threshold ||
+	  cpy->src - pointer_to_uword (cpu->tx_headers) <
+	    sizeof (cpu->tx_headers))
+	clib_memcpy_fast (dst, (void *) cpy->src, cpy->len);
+      else
+	vlib_dma_batch_add (vm, b, dst, (void *) cpy->src, cpy->len);
+      vhost_user_log_dirty_pages_2 (vui, cpy->dst, cpy->len, 1);
+    }
+
+  if (b->n_enq)
+    {
+      pool_get_zero (cpu->dma, d);
+      d->dev_instance = vui - vum->vhost_user_interfaces;
+      d->vring_idx = rxvq - vui->vrings;
+      d->used_idx = rxvq->last_used_idx;
+      *dma_index = d - cpu->dma;
+      vlib_dma_batch_set_cookie (vm, b, *dma_index);
+      rxvq->dma_pending++;
+    }
+
+  /* an empty batch just goes back to the backend */
+  vlib_dma_batch_submit (vm, b);
+  return rv;
+}
+
+CLIB_MARCH_FN (vhost_user_tx_dma_completion_cb, void, vlib_main_t *vm,
+	       vlib_dma_batch_t *b)
+{
+  vhost_user_main_t *vum = &vhost_user_main;
+  vhost_cpu_t *cpu = &vum->cpus[vm->thread_index];
+  vhost_user_dma_t *d =
+    pool_elt_at_index (cpu->dma, vlib_dma_batch_get_cookie (vm, b));
+  vhost_user_intf_t *vui =
+    pool_elt_at_index (vum->vhost_user_interfaces, d->dev_instance);
+  vhost_user_vring_t *rxvq = &vui->vrings[d->vring_idx];
+
+  /*
+   * Batches complete in order. Descriptors filled by the cpu after the
+   * last batch was submitted are given back together with it.
+   */
+  ASSERT (rxvq->dma_pending);
+  rxvq->dma_pending--;
+  CLIB_MEMORY_BARRIER ();
+  rxvq->used->idx = rxvq->dma_pending ? d->used_idx : rxvq->last_used_idx;
+  vhost_user_log_dirty_ring (vui, rxvq, idx);
+
+  if ((rxvq->callfd_idx != ~0) &&
+      !(rxvq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT) &&
+      (rxvq->n_since_last_int > vum->coalesce_frames))
+    vhost_user_send_call (vm, vui, rxvq);
+
+  vlib_buffer_free (vm, d->buffers, vec_len (d->buffers));
+  vec_free (d->buffers);
+  pool_put (cpu->dma, d);
+}
+
+#ifndef CLIB_MARCH_VARIANT
+void
+vhost_user_tx_dma_completion_cb (vlib_main_t *vm, vlib_dma_batch_t *b)
+{
+  return CLIB_MARCH_FN_SELECT (vhost_user_tx_dma_completion_cb) (vm, b);
+}
+#endif
+
 static_always_inline void
 vhost_user_handle_tx_offload (vhost_user_intf_t *vui, vlib_buffer_t *b,
 			      vnet_virtio_net_hdr_t *hdr)
@@ -279,7 +379,7 @@ static_always_inline void
 vhost_user_mark_desc_available (vlib_main_t * vm, vhost_user_intf_t * vui,
 				vhost_user_vring_t * rxvq,
 				u16 * n_descs_processed, u8 chained,
-				vlib_frame_t * frame, u32 n_left)
+				u32 n_vectors, u32 n_left)
 {
   u16 desc_idx, flags;
   vnet_virtio_vring_packed_desc_t *desc_table = rxvq->packed_desc;
@@ -330,7 +430,7 @@ vhost_user_mark_desc_available (vlib_main_t * vm, vhost_user_intf_t * vui,
     {
       vhost_user_main_t *vum = &vhost_user_main;
 
-      rxvq->n_since_last_int += frame->n_vectors - n_left;
+      rxvq->n_since_last_int += n_vectors - n_left;
       if (rxvq->n_since_last_int > vum->coalesce_frames)
 	vhost_user_send_call (vm, vui, rxvq);
     }
@@ -374,11 +474,11 @@ vhost_user_tx_trace_packed (vhost_trace_t * t, vhost_user_intf_t * vui,
 
 static_always_inline uword
 vhost_user_device_class_packed (vlib_main_t *vm, vlib_node_runtime_t *node,
-				vlib_frame_t *frame, vhost_user_intf_t *vui,
+				u32 *from, u32 n_vectors, vhost_user_intf_t *vui,
 				vhost_user_vring_t *rxvq)
 {
-  u32 *buffers = vlib_frame_vector_args (frame);
-  u32 n_left = frame->n_vectors;
+  u32 *buffers = from;
+  u32 n_left = n_vectors;
   vhost_user_main_t *vum = &vhost_user_main;
   u32 qid = rxvq->qid;
   u8 error;
@@ -635,7 +735,7 @@ retry:
 
 	  /* give buffers back to driver */
 	  vhost_user_mark_desc_available (vm, vui, rxvq, &n_descs_processed,
-					  chained, frame, n_left);
+					  chained, n_vectors, n_left);
 	}
 
       buffers++;
@@ -650,7 +750,7 @@ done:
 			  VHOST_USER_TX_FUNC_ERROR_MMAP_FAIL, 1);
 
       vhost_user_mark_desc_available (vm, vui, rxvq, &n_descs_processed,
-				      chained, frame, n_left);
+				      chained, n_vectors, n_left);
     }
 
   /*
@@ -681,20 +781,18 @@ done:
 	 VNET_INTERFACE_COUNTER_DROP, thread_index, vui->sw_if_index, n_left);
     }
 
-  vlib_buffer_free (vm, vlib_frame_vector_args (frame), frame->n_vectors);
-  return frame->n_vectors;
+  vlib_buffer_free (vm, from, n_vectors);
+  return n_vectors;
 }
 
-VNET_DEVICE_CLASS_TX_FN (vhost_user_device_class) (vlib_main_t * vm,
-						   vlib_node_runtime_t *
-						   node, vlib_frame_t * frame)
+static_always_inline uword
+vhost_user_device_class_tx_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
+				   vhost_user_intf_t *vui, u32 *from,
+				   u32 n_vectors, u16 queue_id, u8 lock)
 {
-  u32 *buffers = vlib_frame_vector_args (frame);
-  u32 n_left = frame->n_vectors;
+  u32 *buffers = from;
+  u32 n_left = n_vectors;
   vhost_user_main_t *vum = &vhost_user_main;
-  vnet_interface_output_runtime_t *rd = (void *) node->runtime_data;
-  vhost_user_intf_t *vui =
-    pool_elt_at_index (vum->vhost_user_interfaces, rd->dev_instance);
   u32 qid;
   vhost_user_vring_t *rxvq;
   u8 error;
@@ -705,7 +803,8 @@ VNET_DEVICE_CLASS_TX_FN (vhost_user_device_class) (vlib_main_t * vm,
   u16 copy_len;
   u16 tx_headers_len;
   u32 or_flags;
-  vnet_hw_if_tx_frame_t *tf = vlib_frame_scalar_args (frame);
+  u32 dma_index = ~0;
+  u8 use_dma;
 
   if (PREDICT_FALSE (!vui->admin_up))
     {
@@ -719,20 +818,24 @@ VNET_DEVICE_CLASS_TX_FN (vhost_user_device_class) (vlib_main_t * vm,
       goto done3;
     }
 
-  qid = VHOST_VRING_IDX_RX (tf->queue_id);
+  qid = VHOST_VRING_IDX_RX (queue_id);
   rxvq = &vui->vrings[qid];
-  ASSERT (tf->queue_id == rxvq->qid);
+  ASSERT (queue_id == rxvq->qid);
 
   if (PREDICT_FALSE (rxvq->avail == 0))
     {
       error = VHOST_USER_TX_FUNC_ERROR_MMAP_FAIL;
       goto done3;
     }
-  if (tf->shared_queue)
+  if (lock)
     clib_spinlock_lock (&rxvq->vring_lock);
 
   if (vhost_user_is_packed_ring_supported (vui))
-    return (vhost_user_device_class_packed (vm, node, frame, vui, rxvq));
+    return (vhost_user_device_class_packed (vm, node, from, n_vectors, vui,
+					    rxvq));
+
+  /* DMA completions are ordered per thread, so the vring must not be shared */
+  use_dma = vui->dma_tx_config >= 0 && !lock;
 
 retry:
   error = VHOST_USER_TX_FUNC_ERROR_NONE;
@@ -954,34 +1057,47 @@ retry:
        */
       if (PREDICT_FALSE (copy_len >= VHOST_USER_TX_COPY_THRESHOLD))
 	{
-	  if (PREDICT_FALSE (vhost_user_tx_copy (vui, cpu->copy, copy_len,
-						 &map_hint)))
+	  if (PREDICT_FALSE (
+		use_dma ? vhost_user_tx_copy_dma (vm, vui, rxvq, cpu->copy,
+						  copy_len, &map_hint,
+						  &dma_index) :
+			  vhost_user_tx_copy (vui, cpu->copy, copy_len,
+					      &map_hint)))
 	    {
 	      vlib_error_count (vm, node->node_index,
 				VHOST_USER_TX_FUNC_ERROR_MMAP_FAIL, 1);
 	    }
 	  copy_len = 0;
 
-	  /* give buffers back to driver */
-	  CLIB_MEMORY_BARRIER ();
-	  rxvq->used->idx = rxvq->last_used_idx;
-	  vhost_user_log_dirty_ring (vui, rxvq, idx);
+	  /* give buffers back to driver, unless DMA will do it */
+	  if (!rxvq->dma_pending)
+	    {
+	      CLIB_MEMORY_BARRIER ();
+	      rxvq->used->idx = rxvq->last_used_idx;
+	      vhost_user_log_dirty_ring (vui, rxvq, idx);
+	    }
 	}
       buffers++;
     }
 
 done:
   //Do the memory copies
-  if (PREDICT_FALSE (vhost_user_tx_copy (vui, cpu->copy, copy_len,
-					 &map_hint)))
+  if (PREDICT_FALSE (use_dma ? vhost_user_tx_copy_dma (vm, vui, rxvq,
+						       cpu->copy, copy_len,
+						       &map_hint, &dma_index) :
+			       vhost_user_tx_copy (vui, cpu->copy, copy_len,
+						   &map_hint)))
     {
       vlib_error_count (vm, node->node_index,
 			VHOST_USER_TX_FUNC_ERROR_MMAP_FAIL, 1);
     }
 
-  CLIB_MEMORY_BARRIER ();
-  rxvq->used->idx = rxvq->last_used_idx;
-  vhost_user_log_dirty_ring (vui, rxvq, idx);
+  if (!rxvq->dma_pending)
+    {
+      CLIB_MEMORY_BARRIER ();
+      rxvq->used->idx = rxvq->last_used_idx;
+      vhost_user_log_dirty_ring (vui, rxvq, idx);
+    }
 
   /*
    * When n_left is set, error is always set to something too.
@@ -1005,9 +1121,10 @@ done:
   if ((rxvq->callfd_idx != ~0) &&
       !(rxvq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT))
     {
-      rxvq->n_since_last_int += frame->n_vectors - n_left;
+      rxvq->n_since_last_int += n_vectors - n_left;
 
-      if (rxvq->n_since_last_int > vum->coalesce_frames)
+      if (rxvq->n_since_last_int > vum->coalesce_frames &&
+	  !rxvq->dma_pending)
 	vhost_user_send_call (vm, vui, rxvq);
     }
 
@@ -1023,10 +1140,153 @@ done3:
 	 thread_index, vui->sw_if_index, n_left);
     }
 
-  vlib_buffer_free (vm, vlib_frame_vector_args (frame), frame->n_vectors);
+  /* buffers are the source of DMA copies, keep them until completion */
+  if (dma_index != ~0)
+    {
+      vhost_user_dma_t *d = pool_elt_at_index (cpu->dma, dma_index);
+      vec_add (d->buffers, from, n_vectors);
+      return n_vectors;
+    }
+
+  vlib_buffer_free (vm, from, n_vectors);
+  return n_vectors;
+}
+
+/* handoff aux data: device instance and interface queue id */
+#define vhost_user_tx_handoff_aux(dev_instance, queue_id)                     \
+  ((dev_instance) << 8 | (queue_id))
+#define vhost_user_tx_handoff_aux_dev_instance(aux) ((aux) >> 8)
+#define vhost_user_tx_handoff_aux_queue_id(aux)	    ((aux) & 0xff)
+
+static_always_inline void
+vhost_user_tx_handoff (vlib_main_t *vm, vlib_node_runtime_t *node, u32 *from,
+		       u32 n_vectors, vhost_user_intf_t *vui, u16 queue_id,
+		       u32 thread_index)
+{
+  vhost_user_main_t *vum = &vhost_user_main;
+  u16 thread_indices[VLIB_FRAME_SIZE];
+  u32 aux[VLIB_FRAME_SIZE];
+  u32 dev_instance = vui - vum->vhost_user_interfaces;
+  u32 n_enq;
+
+  clib_memset_u16 (thread_indices, thread_index, n_vectors);
+  clib_memset_u32 (aux, vhost_user_tx_handoff_aux (dev_instance, queue_id),
+		   n_vectors);
+
+  n_enq = vlib_buffer_enqueue_to_thread_with_aux (
+    vm, node, vum->tx_handoff_fq_index, from, aux, thread_indices, n_vectors,
+    1 /* drop_on_congestion */);
+
+  if (PREDICT_FALSE (n_enq < n_vectors))
+    {
+      vlib_error_count (vm, node->node_index,
+			VHOST_USER_TX_FUNC_ERROR_HANDOFF_DROP,
+			n_vectors - n_enq);
+      vlib_increment_simple_counter (
+	vnet_main.interface_main.sw_if_counters + VNET_INTERFACE_COUNTER_DROP,
+	vm->thread_index, vui->sw_if_index, n_vectors - n_enq);
+    }
+}
+
+VNET_DEVICE_CLASS_TX_FN (vhost_user_device_class) (vlib_main_t * vm,
+						   vlib_node_runtime_t *
+						   node, vlib_frame_t * frame)
+{
+  vhost_user_main_t *vum = &vhost_user_main;
+  vnet_interface_output_runtime_t *rd = (void *) node->runtime_data;
+  vhost_user_intf_t *vui =
+    pool_elt_at_index (vum->vhost_user_interfaces, rd->dev_instance);
+  vnet_hw_if_tx_frame_t *tf = vlib_frame_scalar_args (frame);
+  u32 *from = vlib_frame_vector_args (frame);
+  u8 lock = tf->shared_queue;
+
+  /*
+   * In tx-handoff mode a shared vring is only ever written by its owner
+   * thread, everybody else hands the packets over instead of spinning on
+   * the vring lock.
+   */
+  if (tf->shared_queue && vum->tx_handoff)
+    {
+      vhost_user_vring_t *rxvq =
+	&vui->vrings[VHOST_VRING_IDX_RX (tf->queue_id)];
+
+      if (rxvq->thread_index != ~0)
+	{
+	  if (rxvq->thread_index != vm->thread_index)
+	    {
+	      vhost_user_tx_handoff (vm, node, from, frame->n_vectors, vui,
+				     tf->queue_id, rxvq->thread_index);
+	      return frame->n_vectors;
+	    }
+	  lock = 0;
+	}
+    }
+
+  return vhost_user_device_class_tx_inline (vm, node, vui, from,
+					    frame->n_vectors, tf->queue_id,
+					    lock);
+}
+
+VLIB_NODE_FN (vhost_user_tx_handoff_node)
+(vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
+{
+  vhost_user_main_t *vum = &vhost_user_main;
+  u32 *from = vlib_frame_vector_args (frame);
+  u32 *aux = vlib_frame_aux_args (frame);
+  u32 n_left = frame->n_vectors;
+
+  while (n_left)
+    {
+      u32 dev_instance = vhost_user_tx_handoff_aux_dev_instance (aux[0]);
+      u16 queue_id = vhost_user_tx_handoff_aux_queue_id (aux[0]);
+      vhost_user_intf_t *vui;
+      vhost_user_vring_t *rxvq;
+      u32 n = 1;
+
+      /* packets for the same vring arrive back to back */
+      while (n < n_left && aux[n] == aux[0])
+	n++;
+
+      if (PREDICT_FALSE (
+	    pool_is_free_index (vum->vhost_user_interfaces, dev_instance)))
+	{
+	  vlib_error_count (vm, node->node_index,
+			    VHOST_USER_TX_FUNC_ERROR_NOT_READY, n);
+	  vlib_buffer_free (vm, from, n);
+	  goto next;
+	}
+
+      vui = pool_elt_at_index (vum->vhost_user_interfaces, dev_instance);
+      rxvq = &vui->vrings[VHOST_VRING_IDX_RX (queue_id)];
+
+      /* the owner moved while the packets were in flight, follow it */
+      if (PREDICT_FALSE (rxvq->thread_index != vm->thread_index &&
+			 rxvq->thread_index != ~0))
+	vhost_user_tx_handoff (vm, node, from, n, vui, queue_id,
+			       rxvq->thread_index);
+      else
+	vhost_user_device_class_tx_inline (vm, node, vui, from, n, queue_id,
+					   rxvq->thread_index == ~0);
+
+    next:
+      from += n;
+      aux += n;
+      n_left -= n;
+    }
+
   return frame->n_vectors;
 }
 
+VLIB_REGISTER_NODE (vhost_user_tx_handoff_node) = {
+  .name = "vhost-user-tx-handoff",
+  .vector_size = sizeof (u32),
+  .aux_size = sizeof (u32),
+  .format_trace = format_vhost_trace,
+  .type = VLIB_NODE_TYPE_INTERNAL,
+  .n_errors = VHOST_USER_TX_FUNC_N_ERROR,
+  .error_strings = vhost_user_tx_func_error_strings,
+};
+
 static __clib_unused clib_error_t *
 vhost_user_interface_rx_mode_change (vnet_main_t * vnm, u32 hw_if_index,
 				     u32 qid, vnet_hw_if_rx_mode mode)
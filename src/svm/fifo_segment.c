@@ -1502,6 +1502,18 @@ fifo_segment_get_mem_status (fifo_segment_t * fs)
   return fifo_segment_determine_status (fs, usage);
 }
 
+void
+fifo_segment_set_watermarks (fifo_segment_t *fs, u8 high_watermark,
+			     u8 low_watermark)
+{
+  fs->high_watermark = high_watermark;
+  fs->low_watermark = low_watermark;
+  fs->h->low_mem_bytes =
+    high_watermark ?
+      ((u64) fifo_segment_size (fs) * (100 - high_watermark)) / 100 :
+      0;
+}
+
 u8 *
 format_fifo_segment_type (u8 * s, va_list * args)
 {
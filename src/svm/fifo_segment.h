@@ -343,6 +343,21 @@ u32 fifo_segment_num_free_chunks (fifo_segment_t * fs, u32 size);
 u8 fifo_segment_get_mem_usage (fifo_segment_t * fs);
 fifo_segment_mem_status_t fifo_segment_get_mem_status (fifo_segment_t * fs);
 
+/**
+ * Set segment memory pressure watermarks
+ *
+ * Besides the watermarks used to compute @ref fifo_segment_get_mem_status,
+ * this sets the shared threshold at which fifos stop growing eagerly and
+ * producers throttle the space they advertise, i.e., once usage crosses
+ * the high watermark.
+ *
+ * @param fs		fifo segment
+ * @param high_watermark	high watermark as percent of segment size
+ * @param low_watermark	low watermark as percent of segment size
+ */
+void fifo_segment_set_watermarks (fifo_segment_t *fs, u8 high_watermark,
+				  u8 low_watermark);
+
 void fifo_segment_main_init (fifo_segment_main_t * sm, u64 baseva,
 			     u32 timeout_in_seconds);
 
@@ -138,6 +138,8 @@ typedef struct fifo_slice_private_
 struct fifo_segment_header_
 {
   uword n_cached_bytes;			/**< Cached bytes */
+  uword low_mem_bytes;			/**< Free bytes below which fifos
+					     stop growing eagerly */
   u32 n_active_fifos;			/**< Number of active fifos */
   u32 n_reserved_bytes;			/**< Bytes not to be allocated */
   u32 max_log2_fifo_size;		/**< Max log2(chunk size) for fs */
@@ -179,6 +181,25 @@ fs_chunk_sptr (fifo_segment_header_t *fsh, svm_fifo_chunk_t *c)
   return c ? (fs_sptr_t) ((u8 *) c - (u8 *) fsh) : 0;
 }
 
+/**
+ * Check if segment is under memory pressure
+ *
+ * True if the bytes still available for chunk allocation, including those
+ * cached on freelists, dropped below the segment's low memory threshold.
+ */
+always_inline u8
+fsh_has_mem_pressure (fifo_segment_header_t *fsh)
+{
+  uword n_avail;
+
+  if (!fsh->low_mem_bytes)
+    return 0;
+
+  n_avail = fsh->max_byte_index - clib_atomic_load_relax_n (&fsh->byte_index);
+  n_avail += clib_atomic_load_relax_n (&fsh->n_cached_bytes);
+  return n_avail < fsh->low_mem_bytes;
+}
+
 #endif /* SRC_SVM_FIFO_TYPES_H_ */
 
 /*
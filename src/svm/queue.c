@@ -460,6 +460,47 @@ svm_queue_sub2 (svm_queue_t * q, u8 * elem)
   return 0;
 }
 
+/**
+ * Dequeue up to n_elts elements with a single mutex acquisition
+ *
+ * Producers are signalled at most once, if the dequeue drained the queue
+ * below the half-full mark they may be waiting on.
+ */
+int
+svm_queue_sub_batch (svm_queue_t *q, u8 *elems, u32 n_elts)
+{
+  u32 n_first, n_deq, need_broadcast;
+  i8 *headp;
+
+  svm_queue_lock (q);
+  if (q->cursize == 0)
+    {
+      svm_queue_unlock (q);
+      return 0;
+    }
+
+  n_deq = clib_min (n_elts, (u32) q->cursize);
+
+  /* Copy out in at most two chunks to account for wrap-around */
+  n_first = clib_min (n_deq, (u32) (q->maxsize - q->head));
+  headp = (i8 *) (&q->data[0] + q->elsize * q->head);
+  clib_memcpy_fast (elems, headp, n_first * q->elsize);
+  if (n_deq > n_first)
+    clib_memcpy_fast (elems + n_first * q->elsize, &q->data[0],
+		      (n_deq - n_first) * q->elsize);
+
+  q->head = (q->head + n_deq) % q->maxsize;
+  need_broadcast = (q->cursize >= q->maxsize / 2 &&
+		    q->cursize - n_deq < q->maxsize / 2);
+  q->cursize -= n_deq;
+  svm_queue_unlock (q);
+
+  if (need_broadcast)
+    svm_queue_send_signal_inline (q, 0);
+
+  return n_deq;
+}
+
 int
 svm_queue_sub_raw (svm_queue_t * q, u8 * elem)
 {
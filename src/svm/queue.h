@@ -76,6 +76,7 @@ int svm_queue_add2 (svm_queue_t * q, u8 * elem, u8 * elem2, int nowait);
 int svm_queue_sub (svm_queue_t * q, u8 * elem, svm_q_conditional_wait_t cond,
 		   u32 time);
 int svm_queue_sub2 (svm_queue_t * q, u8 * elem);
+int svm_queue_sub_batch (svm_queue_t *q, u8 *elems, u32 n_elts);
 void svm_queue_lock (svm_queue_t * q);
 void svm_queue_send_signal (svm_queue_t * q, u8 is_prod);
 void svm_queue_unlock (svm_queue_t * q);
@@ -814,7 +814,18 @@ f_try_chunk_alloc (svm_fifo_t * f, u32 head, u32 tail, u32 len)
   prev = f_end_cptr (f);
   free_alloced = f_chunk_end (prev) - tail;
 
-  alloc_size = clib_min (f->shr->min_alloc, f->shr->size - (tail - head));
+  /* Ramp up growth with what is already allocated, i.e., double the fifo
+   * until min_alloc steps are reached. Sessions that only buffer a little
+   * stay close to their first chunk. Under memory pressure only allocate
+   * what is needed for this enqueue. */
+  if (PREDICT_FALSE (fsh_has_mem_pressure (f->fs_hdr)))
+    alloc_size = 0;
+  else
+    {
+      alloc_size = f_chunk_end (prev) - f_start_cptr (f)->start_byte;
+      alloc_size = clib_min (alloc_size, f->shr->min_alloc);
+      alloc_size = clib_min (alloc_size, f->shr->size - (tail - head));
+    }
   alloc_size = clib_max (alloc_size, len - free_alloced);
 
   c = fsh_alloc_chunk (f->fs_hdr, f->shr->slice_index, alloc_size);
@@ -611,6 +611,31 @@ svm_fifo_max_enqueue_prod (svm_fifo_t * f)
   return f_free_count (f, head, tail);
 }
 
+/**
+ * Maximum number of bytes producer should let its peer send
+ *
+ * Same as @ref svm_fifo_max_enqueue_prod unless the fifo segment is under
+ * memory pressure, in which case the space not yet backed by chunks is
+ * limited to one min_alloc step. Meant for transports that advertise a
+ * window, so peers are throttled instead of forcing fifo growth.
+ *
+ * @param f	fifo
+ * @return	max number of bytes to advertise
+ */
+static inline u32
+svm_fifo_max_enqueue_window (svm_fifo_t *f)
+{
+  u32 head, tail, free_count, n_alloced;
+
+  f_load_head_tail_prod (f, &head, &tail);
+  free_count = f_free_count (f, head, tail);
+  if (PREDICT_TRUE (!fsh_has_mem_pressure (f->fs_hdr)))
+    return free_count;
+
+  n_alloced = f_chunk_end (f_end_cptr (f)) - tail;
+  return clib_min (free_count, n_alloced + f->shr->min_alloc);
+}
+
 /* Maximum number of bytes that can be enqueued into fifo
  *
  * Note: use producer or consumer specific functions for performance.
@@ -76,6 +76,15 @@ typedef struct ldp_worker_ctx_
   u8 *io_buffer;
   clib_time_t clib_time;
 
+  /*
+   * Batched datagram state
+   */
+  vppcom_mmsg_t *mmsgs;
+  vppcom_endpt_t *mmsg_eps;
+  vppcom_endpt_t *mmsg_lcl_eps;
+  u8 *mmsg_ips;
+  u8 *mmsg_buf;
+
   /*
    * Select state
    */
@@ -1568,6 +1577,29 @@ __recv_chk (int fd, void *buf, size_t n, size_t buflen, int flags)
   return recv (fd, buf, n, flags);
 }
 
+static int
+ldp_sockaddr_to_ep (const struct sockaddr *addr, vppcom_endpt_t *ep)
+{
+  switch (addr->sa_family)
+    {
+    case AF_INET:
+      ep->is_ip4 = VPPCOM_IS_IP4;
+      ep->ip = (uint8_t *) &((const struct sockaddr_in *) addr)->sin_addr;
+      ep->port = (uint16_t) ((const struct sockaddr_in *) addr)->sin_port;
+      break;
+
+    case AF_INET6:
+      ep->is_ip4 = VPPCOM_IS_IP6;
+      ep->ip = (uint8_t *) &((const struct sockaddr_in6 *) addr)->sin6_addr;
+      ep->port = (uint16_t) ((const struct sockaddr_in6 *) addr)->sin6_port;
+      break;
+
+    default:
+      return -EAFNOSUPPORT;
+    }
+  return 0;
+}
+
 static inline int
 ldp_vls_sendo (vls_handle_t vlsh, const void *buf, size_t n,
 	       vppcom_endpt_tlv_t *app_tlvs, int flags,
@@ -1577,31 +1609,19 @@ ldp_vls_sendo (vls_handle_t vlsh, const void *buf, size_t n,
   vppcom_endpt_t *ep = 0;
   vppcom_endpt_t _ep;
 
+  _ep.ip = 0;
   _ep.app_tlvs = app_tlvs;
 
   if (addr)
     {
       ep = &_ep;
-      switch (addr->sa_family)
-	{
-	case AF_INET:
-	  ep->is_ip4 = VPPCOM_IS_IP4;
-	  ep->ip =
-	    (uint8_t *) & ((const struct sockaddr_in *) addr)->sin_addr;
-	  ep->port = (uint16_t) ((const struct sockaddr_in *) addr)->sin_port;
-	  break;
-
-	case AF_INET6:
-	  ep->is_ip4 = VPPCOM_IS_IP6;
-	  ep->ip =
-	    (uint8_t *) & ((const struct sockaddr_in6 *) addr)->sin6_addr;
-	  ep->port =
-	    (uint16_t) ((const struct sockaddr_in6 *) addr)->sin6_port;
-	  break;
-
-	default:
-	  return EAFNOSUPPORT;
-	}
+      if (ldp_sockaddr_to_ep (addr, ep))
+	return EAFNOSUPPORT;
+    }
+  else if (app_tlvs)
+    {
+      /* Ancillary data for the connected peer */
+      ep = &_ep;
     }
 
   return vls_sendto (vlsh, (void *) buf, n, flags, ep);
@@ -1748,37 +1768,52 @@ ldp_parse_cmsg (vls_handle_t vlsh, const struct msghdr *msg,
 }
 
 static int
-ldp_make_cmsg (vls_handle_t vlsh, struct msghdr *msg)
+ldp_pktinfo_enabled (vls_handle_t vlsh)
 {
-  u32 optval, optlen = sizeof (optval);
+  u32 optval = 0, optlen = sizeof (optval);
+
+  if (vls_attr (vlsh, VPPCOM_ATTR_GET_IP_PKTINFO, (void *) &optval, &optlen))
+    return 0;
+  return optval != 0;
+}
+
+/* IP_PKTINFO with the address a datagram was sent to, lcl_ep */
+static void
+ldp_make_pktinfo_cmsg (struct msghdr *msg, vppcom_endpt_t *lcl_ep)
+{
+  struct in_pktinfo pi = {};
   struct cmsghdr *cmsg;
 
   cmsg = CMSG_FIRSTHDR (msg);
+  if (!cmsg)
+    return;
   memset (cmsg, 0, sizeof (*cmsg));
 
-  if (!vls_attr (vlsh, VPPCOM_ATTR_GET_IP_PKTINFO, (void *) &optval, &optlen))
-    return 0;
+  if (!lcl_ep)
+    return;
 
-  if (optval)
-    {
-      vppcom_endpt_t ep;
-      u8 addr_buf[sizeof (struct in_addr)];
-      u32 size = sizeof (ep);
+  clib_memcpy (&pi.ipi_addr, lcl_ep->ip, sizeof (struct in_addr));
+  cmsg->cmsg_level = SOL_IP;
+  cmsg->cmsg_type = IP_PKTINFO;
+  cmsg->cmsg_len = CMSG_LEN (sizeof (pi));
+  clib_memcpy (CMSG_DATA (cmsg), &pi, sizeof (pi));
+}
 
-      ep.ip = addr_buf;
+static int
+ldp_make_cmsg (vls_handle_t vlsh, struct msghdr *msg)
+{
+  u8 addr_buf[sizeof (struct in_addr)];
+  vppcom_endpt_t ep, *lcl_ep = 0;
+  u32 size = sizeof (ep);
 
+  if (ldp_pktinfo_enabled (vlsh))
+    {
+      ep.ip = addr_buf;
       if (!vls_attr (vlsh, VPPCOM_ATTR_GET_LCL_ADDR, &ep, &size))
-	{
-	  struct in_pktinfo pi = {};
-
-	  clib_memcpy (&pi.ipi_addr, ep.ip, sizeof (struct in_addr));
-	  cmsg->cmsg_level = SOL_IP;
-	  cmsg->cmsg_type = IP_PKTINFO;
-	  cmsg->cmsg_len = CMSG_LEN (sizeof (pi));
-	  clib_memcpy (CMSG_DATA (cmsg), &pi, sizeof (pi));
-	}
+	lcl_ep = &ep;
     }
 
+  ldp_make_pktinfo_cmsg (msg, lcl_ep);
   return 0;
 }
 
@@ -1833,48 +1868,140 @@ sendmsg (int fd, const struct msghdr * msg, int flags)
 }
 
 #ifdef _GNU_SOURCE
-int
-sendmmsg (int fd, struct mmsghdr *vmessages, unsigned int vlen, int flags)
+/**
+ * Build vcl datagram descriptors for an mmsghdr vector. Messages with a
+ * single iovec are used in place, all others are gathered into, or
+ * received into and later scattered from, the worker's scratch buffer.
+ */
+static void
+ldp_mmsg_prepare (ldp_worker_ctx_t *ldpw, struct mmsghdr *vmessages,
+		  unsigned int vlen, u8 is_tx)
 {
-  ssize_t size;
-  const char *func_str;
-  u32 sh = ldp_fd_to_vlsh (fd);
+  u32 i, j, buf_len = 0, offset = 0;
+  struct msghdr *mh;
+  vppcom_mmsg_t *m;
 
-  ldp_init_check ();
+  vec_validate (ldpw->mmsgs, vlen - 1);
+  vec_validate (ldpw->mmsg_eps, vlen - 1);
 
-  if (sh != VLS_INVALID_HANDLE)
+  for (i = 0; i < vlen; i++)
     {
-      clib_warning ("LDP<%d>: LDP-TBD", getpid ());
-      errno = ENOSYS;
-      size = -1;
+      mh = &vmessages[i].msg_hdr;
+      if (mh->msg_iovlen > 1)
+	for (j = 0; j < mh->msg_iovlen; j++)
+	  buf_len += mh->msg_iov[j].iov_len;
     }
-  else
+  if (buf_len)
+    vec_validate (ldpw->mmsg_buf, buf_len - 1);
+
+  for (i = 0; i < vlen; i++)
     {
-      func_str = "libc_sendmmsg";
+      mh = &vmessages[i].msg_hdr;
+      m = &ldpw->mmsgs[i];
+      m->ep = 0;
+      m->lcl_ep = 0;
+      m->n_bytes = 0;
+      m->flags = 0;
+      if (mh->msg_iovlen == 1)
+	{
+	  m->buf = mh->msg_iov[0].iov_base;
+	  m->len = mh->msg_iov[0].iov_len;
+	  continue;
+	}
+      m->buf = ldpw->mmsg_buf + offset;
+      m->len = 0;
+      for (j = 0; j < mh->msg_iovlen; j++)
+	{
+	  if (is_tx)
+	    clib_memcpy_fast (m->buf + m->len, mh->msg_iov[j].iov_base,
+			      mh->msg_iov[j].iov_len);
+	  m->len += mh->msg_iov[j].iov_len;
+	}
+      offset += m->len;
+    }
+}
 
-      if (LDP_DEBUG > 2)
-	clib_warning ("LDP<%d>: fd %d (0x%x): calling %s(): "
-		      "vmessages %p, vlen %u, flags 0x%x",
-		      getpid (), fd, fd, func_str, vmessages, vlen, flags);
+static void
+ldp_mmsg_scatter (vppcom_mmsg_t *m, struct msghdr *mh)
+{
+  u32 j, len, offset = 0;
 
-      size = libc_sendmmsg (fd, vmessages, vlen, flags);
+  for (j = 0; j < mh->msg_iovlen && offset < m->n_bytes; j++)
+    {
+      len = clib_min (mh->msg_iov[j].iov_len, m->n_bytes - offset);
+      clib_memcpy_fast (mh->msg_iov[j].iov_base, m->buf + offset, len);
+      offset += len;
     }
+}
+
+int
+sendmmsg (int fd, struct mmsghdr *vmessages, unsigned int vlen, int flags)
+{
+  vls_handle_t vlsh;
+  int rv;
+
+  ldp_init_check ();
 
-  if (LDP_DEBUG > 2)
+  vlsh = ldp_fd_to_vlsh (fd);
+  if (vlsh != VLS_INVALID_HANDLE)
     {
-      if (size < 0)
+      ldp_worker_ctx_t *ldpw = ldp_worker_get_current ();
+      vppcom_endpt_tlv_t **tlvs = 0, *app_tlvs;
+      struct msghdr *mh;
+      vppcom_endpt_t *ep;
+      u32 i;
+
+      if (!vlen)
+	return 0;
+
+      ldp_mmsg_prepare (ldpw, vmessages, vlen, 1 /* is_tx */);
+
+      for (i = 0; i < vlen; i++)
 	{
-	  int errno_val = errno;
-	  clib_warning ("LDP<%d>: ERROR: fd %d (0x%x): %s() failed! "
-			"rv %d, errno = %d", getpid (), fd, fd,
-			func_str, size, errno_val);
-	  errno = errno_val;
+	  mh = &vmessages[i].msg_hdr;
+	  app_tlvs = 0;
+	  if (mh->msg_controllen)
+	    {
+	      ldp_parse_cmsg (vlsh, mh, &app_tlvs);
+	      if (app_tlvs)
+		vec_add1 (tlvs, app_tlvs);
+	    }
+	  if (!mh->msg_name && !app_tlvs)
+	    continue;
+
+	  /* Without a name, an endpoint with only the ancillary data */
+	  ep = &ldpw->mmsg_eps[i];
+	  ep->ip = 0;
+	  if (mh->msg_name && ldp_sockaddr_to_ep (mh->msg_name, ep))
+	    {
+	      rv = -EAFNOSUPPORT;
+	      goto done;
+	    }
+	  ep->app_tlvs = app_tlvs;
+	  ldpw->mmsgs[i].ep = ep;
+	}
+
+      rv = vls_sendmmsg (vlsh, ldpw->mmsgs, vlen, flags);
+      for (i = 0; rv > 0 && i < rv; i++)
+	vmessages[i].msg_len = ldpw->mmsgs[i].n_bytes;
+
+    done:
+      for (i = 0; i < vec_len (tlvs); i++)
+	vec_free (tlvs[i]);
+      vec_free (tlvs);
+
+      if (rv < 0)
+	{
+	  errno = -rv;
+	  rv = -1;
 	}
-      else
-	clib_warning ("LDP<%d>: fd %d (0x%x): returning %d (0x%x)",
-		      getpid (), fd, fd, size, size);
     }
-  return size;
+  else
+    {
+      rv = libc_sendmmsg (fd, vmessages, vlen, flags);
+    }
+
+  return rv;
 }
 #endif
 
@@ -1948,11 +2075,15 @@ recvmmsg (int fd, struct mmsghdr *vmessages,
 
   if (sh != VLS_INVALID_HANDLE)
     {
-      struct mmsghdr *mh;
+      struct msghdr *mh;
       ssize_t rv = 0;
-      u32 nvecs = 0;
+      u32 i, nvecs = 0;
+      int dontwait, pktinfo;
       f64 time_out;
 
+      if (!vlen)
+	return 0;
+
       if (PREDICT_FALSE (ldpw->clib_time.init_cpu_time == 0))
 	clib_time_init (&ldpw->clib_time);
       if (tmo)
@@ -1965,24 +2096,76 @@ recvmmsg (int fd, struct mmsghdr *vmessages,
 	  time_out = (f64) ~0;
 	}
 
+      ldp_mmsg_prepare (ldpw, vmessages, vlen, 0 /* is_tx */);
+      pktinfo = ldp_pktinfo_enabled (sh);
+      vec_validate (ldpw->mmsg_lcl_eps, vlen - 1);
+      /* Peer and local address storage, per datagram */
+      vec_validate (ldpw->mmsg_ips, 2 * vlen * sizeof (struct in6_addr) - 1);
+      for (i = 0; i < vlen; i++)
+	{
+	  mh = &vmessages[i].msg_hdr;
+	  if (mh->msg_name)
+	    {
+	      ldpw->mmsg_eps[i].ip =
+		ldpw->mmsg_ips + 2 * i * sizeof (struct in6_addr);
+	      ldpw->mmsgs[i].ep = &ldpw->mmsg_eps[i];
+	    }
+	  if (pktinfo && mh->msg_controllen)
+	    {
+	      ldpw->mmsg_lcl_eps[i].ip =
+		ldpw->mmsg_ips + (2 * i + 1) * sizeof (struct in6_addr);
+	      ldpw->mmsgs[i].lcl_ep = &ldpw->mmsg_lcl_eps[i];
+	    }
+	}
+
       while (nvecs < vlen)
 	{
-	  mh = &vmessages[nvecs];
-	  rv = recvmsg (fd, &mh->msg_hdr, flags);
+	  /* Only block in vcl if neither a timeout nor the flags bound the
+	   * wait, otherwise poll */
+	  dontwait = (flags & MSG_DONTWAIT) || tmo ||
+		     (nvecs && (flags & MSG_WAITFORONE));
+	  rv = vls_recvmmsg (sh, ldpw->mmsgs + nvecs, vlen - nvecs,
+			     dontwait ? MSG_DONTWAIT : 0);
 	  if (rv > 0)
 	    {
-	      mh->msg_len = rv;
-	      nvecs += 1;
+	      nvecs += rv;
 	      continue;
 	    }
 
+	  if (rv < 0 && rv != VPPCOM_EWOULDBLOCK && rv != VPPCOM_EAGAIN)
+	    break;
+	  if (flags & MSG_DONTWAIT)
+	    break;
+	  if (nvecs && (flags & MSG_WAITFORONE))
+	    break;
 	  if (!time_out || clib_time_now (&ldpw->clib_time) >= time_out)
 	    break;
 
 	  usleep (1);
 	}
 
-      return nvecs > 0 ? nvecs : rv;
+      for (i = 0; i < nvecs; i++)
+	{
+	  mh = &vmessages[i].msg_hdr;
+	  vmessages[i].msg_len = ldpw->mmsgs[i].n_bytes;
+	  if (mh->msg_iovlen > 1)
+	    ldp_mmsg_scatter (&ldpw->mmsgs[i], mh);
+	  if (mh->msg_name)
+	    ldp_copy_ep_to_sockaddr (mh->msg_name, &mh->msg_namelen,
+				     &ldpw->mmsg_eps[i]);
+	  if (mh->msg_controllen)
+	    ldp_make_pktinfo_cmsg (mh, ldpw->mmsgs[i].lcl_ep);
+	  mh->msg_flags = ldpw->mmsgs[i].flags;
+	}
+
+      if (nvecs > 0)
+	return nvecs;
+      if (rv < 0)
+	{
+	  errno = -rv;
+	  return -1;
+	}
+      return 0;
     }
   else
     {
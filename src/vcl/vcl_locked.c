@@ -1225,6 +1225,40 @@ vls_recvfrom (vls_handle_t vlsh, void *buffer, uint32_t buflen, int flags,
   return rv;
 }
 
+int
+vls_sendmmsg (vls_handle_t vlsh, vppcom_mmsg_t *msgs, uint32_t n_msgs,
+	      int flags)
+{
+  vcl_locked_session_t *vls;
+  int rv;
+
+  vls_mt_detect ();
+  if (!(vls = vls_get_w_dlock (vlsh)))
+    return VPPCOM_EBADFD;
+  vls_mt_guard (vls, VLS_MT_OP_WRITE);
+  rv = vppcom_session_sendmmsg (vls_to_sh_tu (vls), msgs, n_msgs, flags);
+  vls_mt_unguard ();
+  vls_get_and_unlock (vlsh);
+  return rv;
+}
+
+int
+vls_recvmmsg (vls_handle_t vlsh, vppcom_mmsg_t *msgs, uint32_t n_msgs,
+	      int flags)
+{
+  vcl_locked_session_t *vls;
+  int rv;
+
+  vls_mt_detect ();
+  if (!(vls = vls_get_w_dlock (vlsh)))
+    return VPPCOM_EBADFD;
+  vls_mt_guard (vls, VLS_MT_OP_READ);
+  rv = vppcom_session_recvmmsg (vls_to_sh_tu (vls), msgs, n_msgs, flags);
+  vls_mt_unguard ();
+  vls_get_and_unlock (vlsh);
+  return rv;
+}
+
 int
 vls_attr (vls_handle_t vlsh, uint32_t op, void *buffer, uint32_t * buflen)
 {
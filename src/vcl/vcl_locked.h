@@ -39,6 +39,10 @@ int vls_write (vls_handle_t vlsh, void *buf, size_t nbytes);
 int vls_write_msg (vls_handle_t vlsh, void *buf, size_t nbytes);
 int vls_sendto (vls_handle_t vlsh, void *buf, int buflen, int flags,
 		vppcom_endpt_t * ep);
+int vls_sendmmsg (vls_handle_t vlsh, vppcom_mmsg_t *msgs, uint32_t n_msgs,
+		  int flags);
+int vls_recvmmsg (vls_handle_t vlsh, vppcom_mmsg_t *msgs, uint32_t n_msgs,
+		  int flags);
 int vls_attr (vls_handle_t vlsh, uint32_t op, void *buffer,
 	      uint32_t * buflen);
 vls_handle_t vls_epoll_create (void);
@@ -163,6 +163,7 @@ vcl_worker_cleanup (vcl_worker_t * wrk, u8 notify_vpp)
   vec_free (wrk->mq_msg_vector);
   vec_free (wrk->unhandled_evts_vector);
   vec_free (wrk->pending_session_wrk_updates);
+  vcl_worker_rings_free (wrk);
   clib_bitmap_free (wrk->rd_bitmap);
   clib_bitmap_free (wrk->wr_bitmap);
   clib_bitmap_free (wrk->ex_bitmap);
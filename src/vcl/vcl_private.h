@@ -143,6 +143,7 @@ typedef enum vcl_session_flags_
   VCL_SESSION_F_PENDING_DISCONNECT = 1 << 6,
   VCL_SESSION_F_PENDING_FREE = 1 << 7,
   VCL_SESSION_F_PENDING_LISTEN = 1 << 8,
+  VCL_SESSION_F_RING_TX_BLOCKED = 1 << 9,
 } __clib_packed vcl_session_flags_t;
 
 typedef struct vcl_session_
@@ -231,6 +232,31 @@ typedef struct vcl_mq_evt_conn_
   int mq_fd;
 } vcl_mq_evt_conn_t;
 
+typedef struct vcl_ring_pending_
+{
+  vppcom_ring_sqe_t sqe;
+  u32 n_done;	  /**< bytes of a write already enqueued */
+  u8 in_progress; /**< connect sent, waiting for vpp reply */
+} vcl_ring_pending_t;
+
+/**
+ * Submission/completion ring. Counters are free running and are masked
+ * with n_entries - 1 to index the sqes and cqes arrays
+ */
+typedef struct vcl_ring_
+{
+  u32 ring_index;
+  u32 n_entries;
+  u32 sq_head;	/**< next sqe to be submitted */
+  u32 sq_tail;	/**< next sqe to be handed to app */
+  u32 cq_head;	/**< next cqe to be reaped by app */
+  u32 cq_tail;	/**< next cqe to be filled */
+  vppcom_ring_sqe_t *sqes;
+  vppcom_ring_cqe_t *cqes;
+  vcl_ring_pending_t *pending; /**< submitted ops not yet completed */
+  uword *pending_sessions;     /**< scratch, sessions with pending ops */
+} vcl_ring_t;
+
 typedef struct vcl_worker_
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
@@ -290,6 +316,9 @@ typedef struct vcl_worker_
 
   u32 *pending_session_wrk_updates;
 
+  /** Pool of submission/completion rings */
+  vcl_ring_t *rings;
+
   /** Used also as a thread stop key buffer */
   pthread_t thread_id;
 
@@ -701,6 +730,7 @@ int vcl_mq_epoll_del_evfd (vcl_worker_t * wrk, u32 mqc_index);
 
 vcl_worker_t *vcl_worker_alloc_and_init (void);
 void vcl_worker_cleanup (vcl_worker_t * wrk, u8 notify_vpp);
+void vcl_worker_rings_free (vcl_worker_t *wrk);
 int vcl_worker_register_with_vpp (void);
 svm_msg_q_t *vcl_worker_ctrl_mq (vcl_worker_t * wrk);
 
@@ -1863,17 +1863,13 @@ handle:
   return vcl_session_handle (client_session);
 }
 
-int
-vppcom_session_connect (uint32_t session_handle, vppcom_endpt_t * server_ep)
+static int
+vcl_session_connect (vcl_worker_t *wrk, vcl_session_t *session,
+		     vppcom_endpt_t *server_ep, u8 is_nonblocking)
 {
-  vcl_worker_t *wrk = vcl_worker_get_current ();
-  vcl_session_t *session = 0;
   u32 session_index;
   int rv;
 
-  session = vcl_session_get_w_handle (wrk, session_handle);
-  if (!session)
-    return VPPCOM_EBADFD;
   session_index = session->session_index;
 
   if (PREDICT_FALSE (session->flags & VCL_SESSION_F_IS_VEP))
@@ -1920,7 +1916,7 @@ vppcom_session_connect (uint32_t session_handle, vppcom_endpt_t * server_ep)
 
   vcl_send_session_connect (wrk, session);
 
-  if (vcl_session_has_attr (session, VCL_SESS_ATTR_NONBLOCK))
+  if (is_nonblocking)
     {
       /* State set to STATE_UPDATED to ensure the session is not assumed
        * to be ready and to also allow the app to close it prior to vpp's
@@ -1942,6 +1938,21 @@ vppcom_session_connect (uint32_t session_handle, vppcom_endpt_t * server_ep)
   return rv;
 }
 
+int
+vppcom_session_connect (uint32_t session_handle, vppcom_endpt_t * server_ep)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  vcl_session_t *session = 0;
+
+  session = vcl_session_get_w_handle (wrk, session_handle);
+  if (!session)
+    return VPPCOM_EBADFD;
+
+  return vcl_session_connect (
+    wrk, session, server_ep,
+    vcl_session_has_attr (session, VCL_SESS_ATTR_NONBLOCK));
+}
+
 int
 vppcom_session_stream_connect (uint32_t session_handle,
 			       uint32_t parent_session_handle)
@@ -2007,6 +2018,52 @@ vppcom_session_stream_connect (uint32_t session_handle,
   return rv;
 }
 
+/**
+ * Wait for data in session's rx fifo, unless session is non-blocking or
+ * the caller asked not to wait.
+ *
+ * @return 0 if data is available, VPPCOM error otherwise
+ */
+static int
+vcl_session_wait_rx_data (vcl_worker_t *wrk, vcl_session_t *s,
+			  svm_fifo_t *rx_fifo, u8 dontwait)
+{
+  svm_msg_q_t *mq = wrk->app_event_queue;
+  int is_nonblocking;
+  u8 is_ct;
+
+  is_nonblocking =
+    dontwait || vcl_session_has_attr (s, VCL_SESS_ATTR_NONBLOCK);
+  is_ct = vcl_session_is_ct (s);
+
+  if (svm_fifo_is_empty_cons (rx_fifo))
+    {
+      if (is_ct)
+	svm_fifo_unset_event (s->rx_fifo);
+      svm_fifo_unset_event (rx_fifo);
+      if (is_nonblocking)
+	{
+	  if (vcl_session_is_closing (s))
+	    return vcl_session_closing_error (s);
+	  return VPPCOM_EWOULDBLOCK;
+	}
+      while (svm_fifo_is_empty_cons (rx_fifo))
+	{
+	  if (vcl_session_is_closing (s))
+	    return vcl_session_closing_error (s);
+
+	  if (is_ct)
+	    svm_fifo_unset_event (s->rx_fifo);
+	  svm_fifo_unset_event (rx_fifo);
+
+	  svm_msg_q_wait (mq, SVM_MQ_WAIT_EMPTY);
+	  vcl_worker_flush_mq_events (wrk);
+	}
+    }
+
+  return 0;
+}
+
 static inline int
 vppcom_session_read_internal (uint32_t session_handle, void *buf, int n,
 			      u8 peek)
@@ -2016,7 +2073,6 @@ vppcom_session_read_internal (uint32_t session_handle, void *buf, int n,
   vcl_session_t *s = 0;
   svm_fifo_t *rx_fifo;
   session_event_t *e;
-  svm_msg_q_t *mq;
   u8 is_ct;
 
   if (PREDICT_FALSE (!buf))
@@ -2048,34 +2104,11 @@ vppcom_session_read_internal (uint32_t session_handle, void *buf, int n,
 
   is_nonblocking = vcl_session_has_attr (s, VCL_SESS_ATTR_NONBLOCK);
   is_ct = vcl_session_is_ct (s);
-  mq = wrk->app_event_queue;
   rx_fifo = is_ct ? s->ct_rx_fifo : s->rx_fifo;
   s->flags &= ~VCL_SESSION_F_HAS_RX_EVT;
 
-  if (svm_fifo_is_empty_cons (rx_fifo))
-    {
-      if (is_ct)
-	svm_fifo_unset_event (s->rx_fifo);
-      svm_fifo_unset_event (rx_fifo);
-      if (is_nonblocking)
-	{
-	  if (vcl_session_is_closing (s))
-	    return vcl_session_closing_error (s);
-	  return VPPCOM_EWOULDBLOCK;
-	}
-      while (svm_fifo_is_empty_cons (rx_fifo))
-	{
-	  if (vcl_session_is_closing (s))
-	    return vcl_session_closing_error (s);
-
-	  if (is_ct)
-	    svm_fifo_unset_event (s->rx_fifo);
-	  svm_fifo_unset_event (rx_fifo);
-
-	  svm_msg_q_wait (mq, SVM_MQ_WAIT_EMPTY);
-	  vcl_worker_flush_mq_events (wrk);
-	}
-    }
+  if ((rv = vcl_session_wait_rx_data (wrk, s, rx_fifo, 0)))
+    return rv;
 
 read_again:
 
@@ -2154,10 +2187,9 @@ vppcom_session_read_segments (uint32_t session_handle,
 			      uint32_t max_bytes)
 {
   vcl_worker_t *wrk = vcl_worker_get_current ();
-  int n_read = 0, is_nonblocking;
+  int rv, n_read = 0;
   vcl_session_t *s = 0;
   svm_fifo_t *rx_fifo;
-  svm_msg_q_t *mq;
   u8 is_ct;
 
   s = vcl_session_get_w_handle (wrk, session_handle);
@@ -2167,36 +2199,12 @@ vppcom_session_read_segments (uint32_t session_handle,
   if (PREDICT_FALSE (!vcl_session_is_open (s)))
     return vcl_session_closed_error (s);
 
-  is_nonblocking = vcl_session_has_attr (s, VCL_SESS_ATTR_NONBLOCK);
   is_ct = vcl_session_is_ct (s);
-  mq = wrk->app_event_queue;
   rx_fifo = is_ct ? s->ct_rx_fifo : s->rx_fifo;
   s->flags &= ~VCL_SESSION_F_HAS_RX_EVT;
 
-  if (svm_fifo_is_empty_cons (rx_fifo))
-    {
-      if (is_ct)
-	svm_fifo_unset_event (s->rx_fifo);
-      svm_fifo_unset_event (rx_fifo);
-      if (is_nonblocking)
-	{
-	  if (vcl_session_is_closing (s))
-	    return vcl_session_closing_error (s);
-	  return VPPCOM_EWOULDBLOCK;
-	}
-      while (svm_fifo_is_empty_cons (rx_fifo))
-	{
-	  if (vcl_session_is_closing (s))
-	    return vcl_session_closing_error (s);
-
-	  if (is_ct)
-	    svm_fifo_unset_event (s->rx_fifo);
-	  svm_fifo_unset_event (rx_fifo);
-
-	  svm_msg_q_wait (mq, SVM_MQ_WAIT_EMPTY);
-	  vcl_worker_flush_mq_events (wrk);
-	}
-    }
+  if ((rv = vcl_session_wait_rx_data (wrk, s, rx_fifo, 0)))
+    return rv;
 
   n_read = svm_fifo_segments (rx_fifo, s->rx_bytes_pending,
 			      (svm_fifo_seg_t *) ds, &n_segments, max_bytes);
@@ -2227,18 +2235,27 @@ void
 vppcom_session_free_segments (uint32_t session_handle, uint32_t n_bytes)
 {
   vcl_worker_t *wrk = vcl_worker_get_current ();
+  svm_fifo_t *rx_fifo;
   vcl_session_t *s;
-  u8 is_ct;
 
   s = vcl_session_get_w_handle (wrk, session_handle);
   if (PREDICT_FALSE (!s || (s->flags & VCL_SESSION_F_IS_VEP)))
     return;
 
-  is_ct = vcl_session_is_ct (s);
-  svm_fifo_dequeue_drop (is_ct ? s->ct_rx_fifo : s->rx_fifo, n_bytes);
+  rx_fifo = vcl_session_is_ct (s) ? s->ct_rx_fifo : s->rx_fifo;
+  svm_fifo_dequeue_drop (rx_fifo, n_bytes);
 
   ASSERT (s->rx_bytes_pending >= n_bytes);
   s->rx_bytes_pending -= n_bytes;
+
+  /* Peer may be waiting for space, e.g., blocked in write */
+  if (PREDICT_FALSE (svm_fifo_needs_deq_ntf (rx_fifo, n_bytes)))
+    {
+      svm_fifo_clear_deq_ntf (rx_fifo);
+      app_send_io_evt_to_vpp (s->vpp_evt_q,
+			      s->rx_fifo->shr->master_session_index,
+			      SESSION_IO_EVT_RX, SVM_Q_WAIT);
+    }
 }
 
 always_inline u8
@@ -2253,7 +2270,7 @@ vcl_fifo_is_writeable (svm_fifo_t * f, u32 len, u8 is_dgram)
 
 always_inline int
 vppcom_session_write_inline (vcl_worker_t *wrk, vcl_session_t *s, void *buf,
-			     size_t n, u8 is_flush, u8 is_dgram)
+			     size_t n, u8 is_flush, u8 is_dgram, u8 do_evt)
 {
   int n_write, is_nonblocking;
   session_evt_type_t et;
@@ -2330,7 +2347,7 @@ vppcom_session_write_inline (vcl_worker_t *wrk, vcl_session_t *s, void *buf,
 				     0 /* do_evt */, SVM_Q_WAIT);
     }
 
-  if (svm_fifo_set_event (s->tx_fifo))
+  if (do_evt && svm_fifo_set_event (s->tx_fifo))
     app_send_io_evt_to_vpp (
       s->vpp_evt_q, s->tx_fifo->shr->master_session_index, et, SVM_Q_WAIT);
 
@@ -2355,7 +2372,7 @@ vppcom_session_write (uint32_t session_handle, void *buf, size_t n)
     return VPPCOM_EBADFD;
 
   return vppcom_session_write_inline (wrk, s, buf, n, 0 /* is_flush */,
-				      s->is_dgram ? 1 : 0);
+				      s->is_dgram ? 1 : 0, 1 /* do_evt */);
 }
 
 int
@@ -2369,7 +2386,7 @@ vppcom_session_write_msg (uint32_t session_handle, void *buf, size_t n)
     return VPPCOM_EBADFD;
 
   return vppcom_session_write_inline (wrk, s, buf, n, 1 /* is_flush */,
-				      s->is_dgram ? 1 : 0);
+				      s->is_dgram ? 1 : 0, 1 /* do_evt */);
 }
 
 #define vcl_fifo_rx_evt_valid_or_break(_s)				\
@@ -4354,7 +4371,8 @@ vcl_handle_ep_app_tlvs (vcl_session_t *s, vppcom_endpt_t *ep)
 	  s->gso_size = *(u16 *) tlv->data;
 	  break;
 	case VCL_IP_PKTINFO:
-	  clib_memcpy_fast (&s->transport.lcl_ip, (ip4_address_t *) tlv->data,
+	  ip46_address_reset (&s->transport.lcl_ip);
+	  clib_memcpy_fast (&s->transport.lcl_ip.ip4, tlv->data,
 			    sizeof (ip4_address_t));
 	  break;
 	default:
@@ -4366,12 +4384,59 @@ vcl_handle_ep_app_tlvs (vcl_session_t *s, vppcom_endpt_t *ep)
   while (tlv);
 }
 
+/**
+ * Set connectionless session peer for next datagram. If the session is not
+ * yet bound in vpp, it is 'connected' and the session pointer refreshed.
+ */
+static int
+vcl_session_set_dgram_peer (vcl_worker_t *wrk, vcl_session_t **sp,
+			    vppcom_endpt_t *ep)
+{
+  vcl_session_t *s = *sp;
+
+  /* No address, only ancillary data for the connected peer */
+  if (!ep->ip)
+    {
+      if (ep->app_tlvs && s->is_dgram)
+	vcl_handle_ep_app_tlvs (s, ep);
+      return VPPCOM_OK;
+    }
+
+  if (!vcl_session_is_cl (s))
+    return VPPCOM_EINVAL;
+
+  s->transport.is_ip4 = ep->is_ip4;
+  s->transport.rmt_port = ep->port;
+  vcl_ip_copy_from_ep (&s->transport.rmt_ip, ep);
+
+  if (ep->app_tlvs)
+    vcl_handle_ep_app_tlvs (s, ep);
+
+  /* Session not connected/bound in vpp. Create it by 'connecting' it */
+  if (PREDICT_FALSE (s->session_state == VCL_STATE_CLOSED))
+    {
+      u32 session_index = s->session_index;
+      f64 timeout = vcm->cfg.session_timeout;
+      int rv;
+
+      vcl_send_session_connect (wrk, s);
+      rv = vppcom_wait_for_session_state_change (session_index,
+						 VCL_STATE_READY, timeout);
+      if (rv < 0)
+	return rv;
+      *sp = vcl_session_get (wrk, session_index);
+    }
+
+  return VPPCOM_OK;
+}
+
 int
 vppcom_session_sendto (uint32_t session_handle, void *buffer,
 		       uint32_t buflen, int flags, vppcom_endpt_t * ep)
 {
   vcl_worker_t *wrk = vcl_worker_get_current ();
   vcl_session_t *s;
+  int rv;
 
   s = vcl_session_get_w_handle (wrk, session_handle);
   if (PREDICT_FALSE (!s))
@@ -4379,41 +4444,199 @@ vppcom_session_sendto (uint32_t session_handle, void *buffer,
 
   if (ep)
     {
-      if (!vcl_session_is_cl (s))
-	return VPPCOM_EINVAL;
+      if ((rv = vcl_session_set_dgram_peer (wrk, &s, ep)))
+	return rv;
+    }
 
-      s->transport.is_ip4 = ep->is_ip4;
-      s->transport.rmt_port = ep->port;
-      vcl_ip_copy_from_ep (&s->transport.rmt_ip, ep);
+  if (flags)
+    {
+      // TBD check the flags and do the right thing
+      VDBG (2, "handling flags 0x%u (%d) not implemented yet.", flags, flags);
+    }
 
-      if (ep->app_tlvs)
-	vcl_handle_ep_app_tlvs (s, ep);
+  return (vppcom_session_write_inline (wrk, s, buffer, buflen, 1,
+				       s->is_dgram ? 1 : 0, 1 /* do_evt */));
+}
 
-      /* Session not connected/bound in vpp. Create it by 'connecting' it */
-      if (PREDICT_FALSE (s->session_state == VCL_STATE_CLOSED))
+int
+vppcom_session_sendmmsg (uint32_t session_handle, vppcom_mmsg_t *msgs,
+			 uint32_t n_msgs, int flags)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  session_evt_type_t et;
+  svm_fifo_t *tx_fifo;
+  vcl_session_t *s;
+  int rv = 0;
+  u32 i;
+
+  if (PREDICT_FALSE (!msgs))
+    return VPPCOM_EFAULT;
+
+  s = vcl_session_get_w_handle (wrk, session_handle);
+  if (PREDICT_FALSE (!s))
+    return VPPCOM_EBADFD;
+
+  if (flags)
+    VDBG (2, "handling flags 0x%u (%d) not implemented yet.", flags, flags);
+
+  for (i = 0; i < n_msgs; i++)
+    {
+      msgs[i].n_bytes = 0;
+      if (msgs[i].ep)
 	{
-	  u32 session_index = s->session_index;
-	  f64 timeout = vcm->cfg.session_timeout;
-	  int rv;
+	  if ((rv = vcl_session_set_dgram_peer (wrk, &s, msgs[i].ep)))
+	    break;
+	}
 
-	  vcl_send_session_connect (wrk, s);
-	  rv = vppcom_wait_for_session_state_change (session_index,
-						     VCL_STATE_READY,
-						     timeout);
-	  if (rv < 0)
-	    return rv;
-	  s = vcl_session_get (wrk, session_index);
+      /* Vpp is notified only once the whole batch is enqueued, so never
+       * block on a full fifo while datagrams are pending */
+      if (i)
+	{
+	  tx_fifo = vcl_session_is_ct (s) ? s->ct_tx_fifo : s->tx_fifo;
+	  if (!vcl_fifo_is_writeable (tx_fifo, msgs[i].len, s->is_dgram))
+	    break;
+	}
+
+      rv = vppcom_session_write_inline (wrk, s, msgs[i].buf, msgs[i].len,
+					1 /* is_flush */, s->is_dgram ? 1 : 0,
+					0 /* do_evt */);
+      if (rv < 0 || (rv == 0 && msgs[i].len))
+	break;
+
+      msgs[i].n_bytes = rv;
+      if (rv < msgs[i].len)
+	{
+	  i += 1;
+	  break;
 	}
     }
 
-  if (flags)
+  if (!i)
+    return rv;
+
+  et = vcl_session_is_ct (s) ? SESSION_IO_EVT_TX : SESSION_IO_EVT_TX_FLUSH;
+  if (s->is_dgram)
+    et = vcl_session_dgram_tx_evt (s, et);
+  if (svm_fifo_set_event (s->tx_fifo))
+    app_send_io_evt_to_vpp (
+      s->vpp_evt_q, s->tx_fifo->shr->master_session_index, et, SVM_Q_WAIT);
+
+  VDBG (2, "session %u [0x%llx]: sent %u of %u msgs", s->session_index,
+	s->vpp_handle, i, n_msgs);
+
+  return i;
+}
+
+int
+vppcom_session_recvmmsg (uint32_t session_handle, vppcom_mmsg_t *msgs,
+			 uint32_t n_msgs, int flags)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  session_dgram_pre_hdr_t ph;
+  int rv = 0, n_read = 0;
+  svm_fifo_t *rx_fifo;
+  session_event_t *e;
+  vcl_session_t *s;
+  u32 i;
+  u8 is_ct;
+
+  if (PREDICT_FALSE (!msgs))
+    return VPPCOM_EFAULT;
+
+  if (flags & ~MSG_DONTWAIT)
     {
-      // TBD check the flags and do the right thing
-      VDBG (2, "handling flags 0x%u (%d) not implemented yet.", flags, flags);
+      VDBG (0, "Unsupport flags for recvmmsg %d", flags);
+      return VPPCOM_EAFNOSUPPORT;
     }
 
-  return (vppcom_session_write_inline (wrk, s, buffer, buflen, 1,
-				       s->is_dgram ? 1 : 0));
+  s = vcl_session_get_w_handle (wrk, session_handle);
+  if (PREDICT_FALSE (!s || (s->flags & VCL_SESSION_F_IS_VEP)))
+    return VPPCOM_EBADFD;
+
+  if (PREDICT_FALSE (!vcl_session_is_open (s)))
+    return vcl_session_closed_error (s);
+
+  if (PREDICT_FALSE (s->flags & VCL_SESSION_F_RD_SHUTDOWN)
+      && !vcl_session_read_ready (s))
+    return 0;
+
+  is_ct = vcl_session_is_ct (s);
+  rx_fifo = is_ct ? s->ct_rx_fifo : s->rx_fifo;
+  s->flags &= ~VCL_SESSION_F_HAS_RX_EVT;
+
+  if ((rv = vcl_session_wait_rx_data (wrk, s, rx_fifo,
+				      (flags & MSG_DONTWAIT) != 0)))
+    return rv;
+
+  /* Drain as many messages as available, but handle fifo events and
+   * dequeue notifications only once for the whole batch */
+  for (i = 0; i < n_msgs; i++)
+    {
+      msgs[i].flags = 0;
+      if (s->is_dgram)
+	{
+	  /* Datagrams longer than the buffer are truncated, flag them */
+	  if (svm_fifo_max_dequeue_cons (rx_fifo) >
+	      sizeof (session_dgram_hdr_t))
+	    {
+	      svm_fifo_peek (rx_fifo, 0, sizeof (ph), (u8 *) &ph);
+	      if (ph.data_length - ph.data_offset > msgs[i].len)
+		msgs[i].flags |= MSG_TRUNC;
+	    }
+	  rv = app_recv_dgram_raw (rx_fifo, msgs[i].buf, msgs[i].len,
+				   &s->transport, 0, 0);
+	}
+      else
+	rv = app_recv_stream_raw (rx_fifo, msgs[i].buf, msgs[i].len, 0, 0);
+      if (rv <= 0)
+	break;
+
+      msgs[i].n_bytes = rv;
+      n_read += rv;
+      if (msgs[i].ep)
+	{
+	  vcl_ip_copy_to_ep (&s->transport.rmt_ip, msgs[i].ep,
+			     s->transport.is_ip4);
+	  msgs[i].ep->is_ip4 = s->transport.is_ip4;
+	  msgs[i].ep->port = s->transport.rmt_port;
+	}
+      /* The header of this datagram, read into s->transport, has the
+       * address it was sent to */
+      if (msgs[i].lcl_ep)
+	{
+	  vcl_ip_copy_to_ep (&s->transport.lcl_ip, msgs[i].lcl_ep,
+			     s->transport.is_ip4);
+	  msgs[i].lcl_ep->is_ip4 = s->transport.is_ip4;
+	  msgs[i].lcl_ep->port = s->transport.lcl_port;
+	}
+    }
+
+  if (svm_fifo_is_empty_cons (rx_fifo))
+    {
+      if (is_ct)
+	svm_fifo_unset_event (s->rx_fifo);
+      svm_fifo_unset_event (rx_fifo);
+      if (!svm_fifo_is_empty_cons (rx_fifo) && svm_fifo_set_event (rx_fifo)
+	  && vcl_session_has_attr (s, VCL_SESS_ATTR_NONBLOCK))
+	{
+	  vec_add2 (wrk->unhandled_evts_vector, e, 1);
+	  e->event_type = SESSION_IO_EVT_RX;
+	  e->session_index = s->session_index;
+	}
+    }
+
+  if (PREDICT_FALSE (n_read && svm_fifo_needs_deq_ntf (rx_fifo, n_read)))
+    {
+      svm_fifo_clear_deq_ntf (rx_fifo);
+      app_send_io_evt_to_vpp (s->vpp_evt_q,
+			      s->rx_fifo->shr->master_session_index,
+			      SESSION_IO_EVT_RX, SVM_Q_WAIT);
+    }
+
+  VDBG (2, "session %u[0x%llx]: read %u msgs, %d bytes from (%p)",
+	s->session_index, s->vpp_handle, i, n_read, rx_fifo);
+
+  return i;
 }
 
 int
@@ -4518,6 +4741,476 @@ vppcom_poll (vcl_poll_t * vp, uint32_t n_sids, double wait_for_time)
   return num_ev;
 }
 
+static inline vcl_ring_t *
+vcl_ring_get (vcl_worker_t *wrk, u32 ring_handle)
+{
+  if (pool_is_free_index (wrk->rings, ring_handle))
+    return 0;
+  return pool_elt_at_index (wrk->rings, ring_handle);
+}
+
+int
+vppcom_ring_create (uint32_t n_entries)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  vcl_ring_t *r;
+
+  if (!n_entries || !is_pow2 (n_entries))
+    return VPPCOM_EINVAL;
+
+  pool_get_zero (wrk->rings, r);
+  r->ring_index = r - wrk->rings;
+  r->n_entries = n_entries;
+  vec_validate (r->sqes, n_entries - 1);
+  vec_validate (r->cqes, n_entries - 1);
+
+  VDBG (0, "created ring %u with %u entries", r->ring_index, n_entries);
+
+  return r->ring_index;
+}
+
+static void
+vcl_ring_free (vcl_worker_t *wrk, vcl_ring_t *r)
+{
+  vec_free (r->sqes);
+  vec_free (r->cqes);
+  vec_free (r->pending);
+  clib_bitmap_free (r->pending_sessions);
+  pool_put (wrk->rings, r);
+}
+
+int
+vppcom_ring_destroy (uint32_t ring_handle)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  vcl_ring_t *r;
+
+  if (!(r = vcl_ring_get (wrk, ring_handle)))
+    return VPPCOM_EBADFD;
+
+  vcl_ring_free (wrk, r);
+  return VPPCOM_OK;
+}
+
+void
+vcl_worker_rings_free (vcl_worker_t *wrk)
+{
+  vcl_ring_t *r;
+
+  pool_foreach (r, wrk->rings)
+    {
+      vec_free (r->sqes);
+      vec_free (r->cqes);
+      vec_free (r->pending);
+      clib_bitmap_free (r->pending_sessions);
+    }
+  pool_free (wrk->rings);
+}
+
+vppcom_ring_sqe_t *
+vppcom_ring_get_sqe (uint32_t ring_handle)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  vppcom_ring_sqe_t *sqe;
+  vcl_ring_t *r;
+
+  if (!(r = vcl_ring_get (wrk, ring_handle)))
+    return 0;
+
+  if (r->sq_tail - r->sq_head == r->n_entries)
+    return 0;
+
+  sqe = &r->sqes[r->sq_tail & (r->n_entries - 1)];
+  clib_memset (sqe, 0, sizeof (*sqe));
+  r->sq_tail += 1;
+
+  return sqe;
+}
+
+static int
+vcl_ring_op_read (vcl_worker_t *wrk, vppcom_ring_sqe_t *sqe,
+		  vppcom_ring_cqe_t *cqe)
+{
+  u32 n_segments = 2;
+  svm_fifo_t *rx_fifo;
+  vcl_session_t *s;
+  int n_read;
+
+  s = vcl_session_get_w_handle (wrk, sqe->session_handle);
+  if (PREDICT_FALSE (!s || (s->flags & VCL_SESSION_F_IS_VEP)))
+    return VPPCOM_EBADFD;
+
+  if (PREDICT_FALSE (!vcl_session_is_open (s)))
+    return vcl_session_closed_error (s);
+
+  rx_fifo = vcl_session_is_ct (s) ? s->ct_rx_fifo : s->rx_fifo;
+  s->flags &= ~VCL_SESSION_F_HAS_RX_EVT;
+
+  /* Rx events are only requested, see @ref vcl_ring_arm, when the ring is
+   * about to block. While polling, leaving the event flag set keeps the
+   * peer from generating an event per write */
+  if (svm_fifo_max_dequeue_cons (rx_fifo) <= s->rx_bytes_pending)
+    {
+      if (vcl_session_is_closing (s))
+	return vcl_session_closing_error (s);
+      return VPPCOM_EWOULDBLOCK;
+    }
+
+  n_read = svm_fifo_segments (rx_fifo, s->rx_bytes_pending,
+			      (svm_fifo_seg_t *) cqe->ds, &n_segments,
+			      sqe->len);
+  if (n_read < 0)
+    return VPPCOM_EAGAIN;
+
+  s->rx_bytes_pending += n_read;
+  return n_read;
+}
+
+/**
+ * Write as much of the submission as fits. A stream write that is only
+ * partially enqueued stays pending, at its position, until the rest is
+ * written, and writes submitted after it on the same session are held
+ * back. Otherwise, data submitted later would end up in the fifo ahead of
+ * the unsent tail.
+ */
+static int
+vcl_ring_op_write (vcl_worker_t *wrk, vcl_ring_pending_t *p)
+{
+  vppcom_ring_sqe_t *sqe = &p->sqe;
+  svm_fifo_t *tx_fifo;
+  vcl_session_t *s;
+  int rv;
+
+  s = vcl_session_get_w_handle (wrk, sqe->session_handle);
+  if (PREDICT_FALSE (!s || (s->flags & VCL_SESSION_F_IS_VEP)))
+    return VPPCOM_EBADFD;
+
+  if (PREDICT_FALSE (!vcl_session_is_open (s)))
+    return p->n_done ? p->n_done : vcl_session_closed_error (s);
+
+  if (s->flags & VCL_SESSION_F_RING_TX_BLOCKED)
+    return VPPCOM_EWOULDBLOCK;
+
+  tx_fifo = vcl_session_is_ct (s) ? s->ct_tx_fifo : s->tx_fifo;
+  if (!vcl_fifo_is_writeable (tx_fifo, sqe->len - p->n_done, s->is_dgram))
+    {
+      if (vcl_session_is_closing (s))
+	return p->n_done ? p->n_done : vcl_session_closing_error (s);
+
+      svm_fifo_add_want_deq_ntf (tx_fifo, SVM_FIFO_WANT_DEQ_NOTIF);
+      if (!vcl_fifo_is_writeable (tx_fifo, sqe->len - p->n_done,
+				  s->is_dgram))
+	{
+	  s->flags |= VCL_SESSION_F_RING_TX_BLOCKED;
+	  return VPPCOM_EWOULDBLOCK;
+	}
+    }
+
+  rv = vppcom_session_write_inline (
+    wrk, s, (u8 *) sqe->buf + p->n_done, sqe->len - p->n_done,
+    0 /* is_flush */, s->is_dgram ? 1 : 0, 1 /* do_evt */);
+  if (rv == VPPCOM_EWOULDBLOCK)
+    {
+      s->flags |= VCL_SESSION_F_RING_TX_BLOCKED;
+      return rv;
+    }
+  if (rv < 0)
+    return p->n_done ? p->n_done : rv;
+
+  p->n_done += rv;
+  if (p->n_done < sqe->len)
+    {
+      s->flags |= VCL_SESSION_F_RING_TX_BLOCKED;
+      return VPPCOM_EWOULDBLOCK;
+    }
+
+  return p->n_done;
+}
+
+static int
+vcl_ring_op_accept (vcl_worker_t *wrk, vppcom_ring_sqe_t *sqe)
+{
+  vcl_session_t *ls;
+
+  ls = vcl_session_get_w_handle (wrk, sqe->session_handle);
+  if (PREDICT_FALSE (!ls))
+    return VPPCOM_EBADFD;
+
+  /* Accept does not block if events are pending */
+  if (!clib_fifo_elts (ls->accept_evts_fifo))
+    {
+      if (ls->session_state != VCL_STATE_LISTEN &&
+	  ls->session_state != VCL_STATE_LISTEN_NO_MQ &&
+	  !vcl_session_is_connectable_listener (wrk, ls))
+	return VPPCOM_EBADFD;
+      return VPPCOM_EWOULDBLOCK;
+    }
+
+  return vppcom_session_accept (sqe->session_handle, sqe->ep, sqe->flags);
+}
+
+static int
+vcl_ring_op_connect (vcl_worker_t *wrk, vcl_ring_pending_t *p)
+{
+  vppcom_ring_sqe_t *sqe = &p->sqe;
+  vcl_session_t *s;
+  int rv;
+
+  s = vcl_session_get_w_handle (wrk, sqe->session_handle);
+  if (PREDICT_FALSE (!s))
+    return VPPCOM_EBADFD;
+
+  if (!p->in_progress)
+    {
+      if (!sqe->ep)
+	return VPPCOM_EINVAL;
+      rv = vcl_session_connect (wrk, s, sqe->ep, 1 /* is_nonblocking */);
+      if (rv != VPPCOM_EINPROGRESS)
+	return rv;
+      p->in_progress = 1;
+      return VPPCOM_EWOULDBLOCK;
+    }
+
+  if (vcl_session_is_ready (s))
+    return VPPCOM_OK;
+
+  if (s->session_state == VCL_STATE_DETACHED)
+    return VPPCOM_ECONNREFUSED;
+
+  if (vcl_session_is_closing (s) || vcl_session_is_closed (s))
+    return vcl_session_closed_error (s);
+
+  return VPPCOM_EWOULDBLOCK;
+}
+
+/**
+ * Try to complete submitted ops, in order, until the completion queue is
+ * full. Ops that would block are kept for the next attempt.
+ */
+static void
+vcl_ring_process (vcl_worker_t *wrk, vcl_ring_t *r)
+{
+  vppcom_ring_cqe_t *cqe;
+  vcl_ring_pending_t *p;
+  u32 i, n_left = 0;
+  vcl_session_t *s;
+  int rv;
+
+  for (i = 0; i < vec_len (r->pending); i++)
+    {
+      p = vec_elt_at_index (r->pending, i);
+      if (r->cq_tail - r->cq_head == r->n_entries)
+	goto keep;
+
+      cqe = &r->cqes[r->cq_tail & (r->n_entries - 1)];
+      switch (p->sqe.op)
+	{
+	case VPPCOM_RING_OP_READ:
+	  rv = vcl_ring_op_read (wrk, &p->sqe, cqe);
+	  break;
+	case VPPCOM_RING_OP_WRITE:
+	  rv = vcl_ring_op_write (wrk, p);
+	  break;
+	case VPPCOM_RING_OP_ACCEPT:
+	  rv = vcl_ring_op_accept (wrk, &p->sqe);
+	  break;
+	case VPPCOM_RING_OP_CONNECT:
+	  rv = vcl_ring_op_connect (wrk, p);
+	  break;
+	default:
+	  rv = VPPCOM_EINVAL;
+	  break;
+	}
+
+      if (rv == VPPCOM_EWOULDBLOCK)
+	goto keep;
+
+      cqe->user_data = p->sqe.user_data;
+      cqe->session_handle = p->sqe.session_handle;
+      cqe->result = rv;
+      r->cq_tail += 1;
+      continue;
+
+    keep:
+      if (n_left != i)
+	r->pending[n_left] = *p;
+      n_left += 1;
+    }
+
+  vec_set_len (r->pending, n_left);
+
+  /* Blocked writes are retried, in order, on the next pass */
+  vec_foreach (p, r->pending)
+    {
+      if (p->sqe.op != VPPCOM_RING_OP_WRITE)
+	continue;
+      if ((s = vcl_session_get_w_handle (wrk, p->sqe.session_handle)))
+	s->flags &= ~VCL_SESSION_F_RING_TX_BLOCKED;
+    }
+}
+
+/**
+ * Reset rx event flags of sessions with pending reads, so that new data
+ * generates events that wake up the worker.
+ */
+static void
+vcl_ring_arm (vcl_worker_t *wrk, vcl_ring_t *r)
+{
+  vcl_ring_pending_t *p;
+  vcl_session_t *s;
+
+  vec_foreach (p, r->pending)
+    {
+      if (p->sqe.op != VPPCOM_RING_OP_READ)
+	continue;
+      s = vcl_session_get_w_handle (wrk, p->sqe.session_handle);
+      if (!s || !s->rx_fifo)
+	continue;
+      if (vcl_session_is_ct (s))
+	svm_fifo_unset_event (s->ct_rx_fifo);
+      svm_fifo_unset_event (s->rx_fifo);
+    }
+}
+
+/**
+ * Drop io events of sessions with pending ops, the ring polls their fifos.
+ * Events of other sessions are kept for select or epoll.
+ */
+static void
+vcl_ring_consume_events (vcl_worker_t *wrk, vcl_ring_t *r)
+{
+  session_event_t *e;
+  vcl_ring_pending_t *p;
+  vcl_session_t *s;
+  u32 i, n_left = 0;
+
+  if (!vec_len (wrk->unhandled_evts_vector))
+    return;
+
+  clib_bitmap_zero (r->pending_sessions);
+  vec_foreach (p, r->pending)
+    {
+      if ((s = vcl_session_get_w_handle (wrk, p->sqe.session_handle)))
+	r->pending_sessions =
+	  clib_bitmap_set (r->pending_sessions, s->session_index, 1);
+    }
+
+  for (i = 0; i < vec_len (wrk->unhandled_evts_vector); i++)
+    {
+      e = &wrk->unhandled_evts_vector[i];
+      if ((e->event_type == SESSION_IO_EVT_RX ||
+	   e->event_type == SESSION_IO_EVT_TX) &&
+	  clib_bitmap_get (r->pending_sessions, e->session_index))
+	continue;
+      if (n_left != i)
+	wrk->unhandled_evts_vector[n_left] = *e;
+      n_left += 1;
+    }
+  vec_set_len (wrk->unhandled_evts_vector, n_left);
+}
+
+int
+vppcom_ring_submit (uint32_t ring_handle)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  vcl_ring_pending_t *p;
+  vcl_ring_t *r;
+  u32 n_submit;
+
+  if (!(r = vcl_ring_get (wrk, ring_handle)))
+    return VPPCOM_EBADFD;
+
+  n_submit = r->sq_tail - r->sq_head;
+  while (r->sq_head != r->sq_tail)
+    {
+      vec_add2 (r->pending, p, 1);
+      p->sqe = r->sqes[r->sq_head & (r->n_entries - 1)];
+      p->n_done = 0;
+      p->in_progress = 0;
+      r->sq_head += 1;
+    }
+
+  vcl_ring_process (wrk, r);
+
+  return n_submit;
+}
+
+/**
+ * Wait for completions. Io events of sessions with pending ops are
+ * consumed, all other events are left for select or epoll.
+ *
+ * @param wait_for_time	seconds to wait, 0 to not wait, -1 to wait forever
+ * @return number of completions returned in cqes
+ */
+int
+vppcom_ring_wait_cqes (uint32_t ring_handle, vppcom_ring_cqe_t **cqes,
+		       uint32_t n_cqes, double wait_for_time)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  svm_msg_q_t *mq = wrk->app_event_queue;
+  f64 timeout = 0, now;
+  u32 i, n_ready;
+  vcl_ring_t *r;
+
+  if (!(r = vcl_ring_get (wrk, ring_handle)))
+    return VPPCOM_EBADFD;
+
+  if (wait_for_time > 0)
+    timeout = clib_time_now (&wrk->clib_time) + wait_for_time;
+
+  while (1)
+    {
+      if (vec_len (r->pending))
+	{
+	  vcl_worker_flush_mq_events (wrk);
+	  vcl_ring_consume_events (wrk, r);
+	  vcl_ring_process (wrk, r);
+	}
+
+      n_ready = r->cq_tail - r->cq_head;
+      if (n_ready || !wait_for_time || !vec_len (r->pending))
+	break;
+
+      /* About to block. Request rx events and check for data that raced
+       * with the event reset */
+      vcl_ring_arm (wrk, r);
+      vcl_ring_process (wrk, r);
+      if (r->cq_tail != r->cq_head)
+	continue;
+
+      if (wait_for_time > 0)
+	{
+	  now = clib_time_now (&wrk->clib_time);
+	  if (now >= timeout)
+	    break;
+	  svm_msg_q_timedwait (mq, timeout - now);
+	}
+      else
+	{
+	  svm_msg_q_wait (mq, SVM_MQ_WAIT_EMPTY);
+	}
+    }
+
+  n_ready = clib_min (n_ready, n_cqes);
+  for (i = 0; i < n_ready; i++)
+    cqes[i] = &r->cqes[(r->cq_head + i) & (r->n_entries - 1)];
+
+  return n_ready;
+}
+
+void
+vppcom_ring_cqes_seen (uint32_t ring_handle, uint32_t n_cqes)
+{
+  vcl_worker_t *wrk = vcl_worker_get_current ();
+  vcl_ring_t *r;
+
+  if (!(r = vcl_ring_get (wrk, ring_handle)))
+    return;
+
+  ASSERT (r->cq_tail - r->cq_head >= n_cqes);
+  r->cq_head += n_cqes;
+}
+
 int
 vppcom_mq_epoll_fd (void)
 {
@@ -203,6 +203,62 @@ typedef struct vppcom_data_segment_
 
 typedef vppcom_data_segment_t vppcom_data_segments_t[2];
 
+/**
+ * Datagram descriptor for batched send/receive. On return, n_bytes is the
+ * number of payload bytes sent or received for the datagram. On send, an
+ * ep without ip only carries app tlvs for the connected peer. On receive,
+ * ep and lcl_ep, if set, must point to caller provided ip storage and
+ * flags has MSG_TRUNC set if the datagram did not fit in buf.
+ */
+typedef struct vppcom_mmsg_
+{
+  void *buf;		  /**< payload */
+  uint32_t len;		  /**< payload or buffer length */
+  uint32_t n_bytes;	  /**< bytes sent or received */
+  vppcom_endpt_t *ep;	  /**< optional peer endpoint */
+  vppcom_endpt_t *lcl_ep; /**< optional local endpoint, receive only */
+  uint32_t flags;	  /**< MSG_* flags of received datagram */
+} vppcom_mmsg_t;
+
+typedef enum vppcom_ring_op_
+{
+  VPPCOM_RING_OP_READ,	  /**< zero-copy read of fifo segments */
+  VPPCOM_RING_OP_WRITE,	  /**< write buffer */
+  VPPCOM_RING_OP_ACCEPT,  /**< accept session on listener */
+  VPPCOM_RING_OP_CONNECT, /**< connect session */
+} vppcom_ring_op_t;
+
+/**
+ * Ring submission. Buffer and endpoint must be valid until the operation
+ * completes.
+ */
+typedef struct vppcom_ring_sqe_
+{
+  uint8_t op;		   /**< vppcom_ring_op_t */
+  int flags;		   /**< accept flags */
+  uint32_t session_handle; /**< session or listener */
+  void *buf;		   /**< write payload */
+  uint32_t len;		   /**< bytes to write or max bytes to read */
+  vppcom_endpt_t *ep;	   /**< connect peer or accepted peer */
+  uint64_t user_data;	   /**< opaque, returned in completion */
+} vppcom_ring_sqe_t;
+
+/**
+ * Ring completion. Result is the number of bytes read or written, the
+ * accepted session handle or 0 for connects, or a negative error. Writes
+ * of a session complete in order and only once the whole buffer is
+ * enqueued, unless the session fails after part of it was. Read data is
+ * referenced in fifo segments that are valid until freed with
+ * vppcom_session_free_segments.
+ */
+typedef struct vppcom_ring_cqe_
+{
+  uint64_t user_data;
+  int result;
+  uint32_t session_handle;
+  vppcom_data_segments_t ds;
+} vppcom_ring_cqe_t;
+
 typedef unsigned long vcl_si_set;
 
 /*
@@ -249,6 +305,12 @@ extern int vppcom_session_recvfrom (uint32_t session_handle, void *buffer,
 extern int vppcom_session_sendto (uint32_t session_handle, void *buffer,
 				  uint32_t buflen, int flags,
 				  vppcom_endpt_t * ep);
+extern int vppcom_session_sendmmsg (uint32_t session_handle,
+				    vppcom_mmsg_t *msgs, uint32_t n_msgs,
+				    int flags);
+extern int vppcom_session_recvmmsg (uint32_t session_handle,
+				    vppcom_mmsg_t *msgs, uint32_t n_msgs,
+				    int flags);
 extern int vppcom_poll (vcl_poll_t * vp, uint32_t n_sids,
 			double wait_for_time);
 extern int vppcom_mq_epoll_fd (void);
@@ -261,6 +323,14 @@ extern int vppcom_session_read_segments (uint32_t session_handle,
 					 uint32_t max_bytes);
 extern void vppcom_session_free_segments (uint32_t session_handle,
 					  uint32_t n_bytes);
+extern int vppcom_ring_create (uint32_t n_entries);
+extern int vppcom_ring_destroy (uint32_t ring_handle);
+extern vppcom_ring_sqe_t *vppcom_ring_get_sqe (uint32_t ring_handle);
+extern int vppcom_ring_submit (uint32_t ring_handle);
+extern int vppcom_ring_wait_cqes (uint32_t ring_handle,
+				  vppcom_ring_cqe_t **cqes, uint32_t n_cqes,
+				  double wait_for_time);
+extern void vppcom_ring_cqes_seen (uint32_t ring_handle, uint32_t n_cqes);
 extern int vppcom_add_cert_key_pair (vppcom_cert_key_pair_t *ckpair);
 extern int vppcom_del_cert_key_pair (uint32_t ckpair_index);
 extern int vppcom_unformat_proto (uint8_t * proto, char *proto_str);
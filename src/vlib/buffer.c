@@ -203,9 +203,10 @@ vlib_validate_buffer_helper (vlib_main_t * vm,
     return format (0, "current data %d before pre-data", b->current_data);
 
   if (b->current_data + b->current_length >
-      vlib_buffer_get_default_data_size (vm))
+      vlib_buffer_get_pool_data_size (vm, b->buffer_pool_index))
     return format (0, "%d-%d beyond end of buffer %d", b->current_data,
-		   b->current_length, vlib_buffer_get_default_data_size (vm));
+		   b->current_length,
+		   vlib_buffer_get_pool_data_size (vm, b->buffer_pool_index));
 
   if (follow_buffer_next && (b->flags & VLIB_BUFFER_NEXT_PRESENT))
     {
@@ -395,7 +396,6 @@ vlib_buffer_add_data (vlib_main_t * vm, u32 * buffer_index, void *data,
 
   d = data;
   n_left = n_data_bytes;
-  n_buffer_bytes = vlib_buffer_get_default_data_size (vm);
 
   b = vlib_get_buffer (vm, bi);
   b->flags &= ~VLIB_BUFFER_TOTAL_LENGTH_VALID;
@@ -408,6 +408,8 @@ vlib_buffer_add_data (vlib_main_t * vm, u32 * buffer_index, void *data,
     {
       u32 n;
 
+      n_buffer_bytes =
+	vlib_buffer_get_pool_data_size (vm, b->buffer_pool_index);
       ASSERT (n_buffer_bytes >= b->current_length);
       n_left_this_buffer =
 	n_buffer_bytes - (b->current_data + b->current_length);
@@ -443,7 +445,8 @@ vlib_buffer_chain_append_data_with_alloc (vlib_main_t * vm,
 					  u16 data_len)
 {
   vlib_buffer_t *l = *last;
-  u32 n_buffer_bytes = vlib_buffer_get_default_data_size (vm);
+  u32 n_buffer_bytes =
+    vlib_buffer_get_pool_data_size (vm, l->buffer_pool_index);
   u16 copied = 0;
   ASSERT (n_buffer_bytes >= l->current_length + l->current_data);
   while (data_len)
@@ -455,6 +458,8 @@ vlib_buffer_chain_append_data_with_alloc (vlib_main_t * vm,
 						first->buffer_pool_index))
 	    return copied;
 	  *last = l = vlib_buffer_chain_buffer (vm, l, l->next_buffer);
+	  n_buffer_bytes =
+	    vlib_buffer_get_pool_data_size (vm, l->buffer_pool_index);
 	  max = n_buffer_bytes - l->current_length - l->current_data;
 	}
 
@@ -492,7 +497,7 @@ vlib_buffer_pool_create (vlib_main_t *vm, u32 data_size, u32 physmem_map_index,
   uword size = (uword) m->n_pages << m->log2_page_size;
   uword page_mask = ~pow2_mask (m->log2_page_size);
   u8 *p;
-  u32 alloc_size;
+  u32 alloc_size, n_magazines, i;
   va_list va;
 
   if (vec_len (bm->buffer_pools) >= 255)
@@ -583,6 +588,13 @@ vlib_buffer_pool_create (vlib_main_t *vm, u32 data_size, u32 physmem_map_index,
 
   bp->n_buffers = bp->n_avail;
 
+  /* enough magazines to hold all buffers, all start empty */
+  n_magazines = bp->n_buffers / VLIB_BUFFER_MAGAZINE_SZ + 1;
+  vec_validate_aligned (bp->magazines, n_magazines - 1, CLIB_CACHE_LINE_BYTES);
+  for (i = 0; i < n_magazines; i++)
+    bp->magazines[i].next = i;
+  bp->empty_magazines = n_magazines;
+
   return bp->index;
 }
 
@@ -592,7 +604,7 @@ format_vlib_buffer_pool (u8 * s, va_list * va)
   vlib_main_t *vm = va_arg (*va, vlib_main_t *);
   vlib_buffer_pool_t *bp = va_arg (*va, vlib_buffer_pool_t *);
   vlib_buffer_pool_thread_t *bpt;
-  u32 cached = 0;
+  u32 cached = 0, avail;
 
   if (!bp)
     return format (s, "%-20s%=6s%=6s%=6s%=11s%=6s%=8s%=8s%=8s",
@@ -601,13 +613,40 @@ format_vlib_buffer_pool (u8 * s, va_list * va)
 
   vec_foreach (bpt, bp->threads)
     cached += bpt->n_cached;
+  avail = bp->n_avail + vlib_buffer_pool_n_depot (bp);
 
   s = format (s, "%-20v%=6d%=6d%=6u%=11u%=6u%=8u%=8u%=8u", bp->name, bp->index,
 	      bp->numa_node,
 	      bp->data_size + sizeof (vlib_buffer_t) +
 		vm->buffer_main->ext_hdr_size,
-	      bp->data_size, bp->n_buffers, bp->n_avail, cached,
-	      bp->n_buffers - bp->n_avail - cached);
+	      bp->data_size, bp->n_buffers, avail, cached,
+	      bp->n_buffers - avail - cached);
+
+  return s;
+}
+
+static u8 *
+format_vlib_buffer_pool_depot (u8 *s, va_list *va)
+{
+  vlib_buffer_pool_t *bp = va_arg (*va, vlib_buffer_pool_t *);
+  vlib_buffer_pool_thread_t *bpt;
+  u64 pushed = 0, popped = 0, retries = 0, locked = 0;
+
+  if (!bp)
+    return format (s, "%-20s%=8s%=8s%=12s%=12s%=12s%=12s", "Pool Name",
+		   "Full", "Empty", "Pushed", "Popped", "Retries", "Locked");
+
+  vec_foreach (bpt, bp->threads)
+    {
+      pushed += bpt->n_full_pushed;
+      popped += bpt->n_full_popped;
+      retries += bpt->n_depot_retries;
+      locked += bpt->n_lock_acquired;
+    }
+
+  s = format (s, "%-20v%=8lu%=8lu%=12lu%=12lu%=12lu%=12lu", bp->name,
+	      pushed - popped, vec_len (bp->magazines) - (pushed - popped),
+	      pushed, popped, retries, locked);
 
   return s;
 }
@@ -631,13 +670,24 @@ static clib_error_t *
 show_buffers (vlib_main_t *vm, unformat_input_t *input,
 	      vlib_cli_command_t *cmd)
 {
+  vlib_buffer_main_t *bm = vm->buffer_main;
+  vlib_buffer_pool_t *bp;
+
+  if (unformat (input, "depot"))
+    {
+      vlib_cli_output (vm, "%U", format_vlib_buffer_pool_depot, 0);
+      vec_foreach (bp, bm->buffer_pools)
+	vlib_cli_output (vm, "%U", format_vlib_buffer_pool_depot, bp);
+      return 0;
+    }
+
   vlib_cli_output (vm, "%U", format_vlib_buffer_pool_all, vm);
   return 0;
 }
 
 VLIB_CLI_COMMAND (show_buffers_command, static) = {
   .path = "show buffers",
-  .short_help = "Show packet buffer allocation",
+  .short_help = "show buffers [depot]",
   .function = show_buffers,
 };
 
@@ -658,27 +708,30 @@ VLIB_NUM_WORKERS_CHANGE_FN (vlib_buffer_num_workers_change);
 
 static clib_error_t *
 vlib_buffer_main_init_numa_alloc (struct vlib_main_t *vm, u32 numa_node,
-				  u32 * physmem_map_index,
+				  u8 is_small, u32 *physmem_map_index,
 				  clib_mem_page_sz_t log2_page_size,
 				  u8 unpriv)
 {
   vlib_buffer_main_t *bm = vm->buffer_main;
   u32 buffers_per_numa = bm->buffers_per_numa[numa_node];
   clib_error_t *error;
-  u32 buffer_size;
+  u32 buffer_size, data_size;
   uword n_pages, pagesize;
   u8 *name = 0;
 
   ASSERT (log2_page_size != CLIB_MEM_PAGE_SZ_UNKNOWN);
 
   pagesize = clib_mem_page_bytes (log2_page_size);
-  buffer_size = vlib_buffer_alloc_size (bm->ext_hdr_size,
-					vlib_buffer_get_default_data_size
-					(vm));
+  data_size = is_small ? bm->small_data_size :
+			 vlib_buffer_get_default_data_size (vm);
+  buffer_size = vlib_buffer_alloc_size (bm->ext_hdr_size, data_size);
   if (buffer_size > pagesize)
     return clib_error_return (0, "buffer size (%llu) is greater than page "
 			      "size (%llu)", buffer_size, pagesize);
 
+  if (is_small)
+    buffers_per_numa = bm->small_buffers_per_numa;
+
   if (buffers_per_numa == 0)
     buffers_per_numa = bm->default_buffers_per_numa;
 
@@ -686,7 +739,8 @@ vlib_buffer_main_init_numa_alloc (struct vlib_main_t *vm, u32 numa_node,
     buffers_per_numa = unpriv ? VLIB_BUFFER_DEFAULT_BUFFERS_PER_NUMA_UNPRIV :
       VLIB_BUFFER_DEFAULT_BUFFERS_PER_NUMA;
 
-  name = format (0, "buffers-numa-%d%c", numa_node, 0);
+  name = format (0, "buffers-%snuma-%d%c", is_small ? "small-" : "",
+		 numa_node, 0);
   n_pages = (buffers_per_numa - 1) / (pagesize / buffer_size) + 1;
   error = vlib_physmem_shared_map_create (vm, (char *) name,
 					  n_pages * pagesize,
@@ -698,7 +752,7 @@ vlib_buffer_main_init_numa_alloc (struct vlib_main_t *vm, u32 numa_node,
 
 static clib_error_t *
 vlib_buffer_main_init_numa_node (struct vlib_main_t *vm, u32 numa_node,
-				 u8 * index)
+				 u8 is_small, u8 *index)
 {
   vlib_buffer_main_t *bm = vm->buffer_main;
   u32 physmem_map_index;
@@ -706,7 +760,7 @@ vlib_buffer_main_init_numa_node (struct vlib_main_t *vm, u32 numa_node,
 
   if (bm->log2_page_size == CLIB_MEM_PAGE_SZ_UNKNOWN)
     {
-      error = vlib_buffer_main_init_numa_alloc (vm, numa_node,
+      error = vlib_buffer_main_init_numa_alloc (vm, numa_node, is_small,
 						&physmem_map_index,
 						CLIB_MEM_PAGE_SZ_DEFAULT_HUGE,
 						0 /* unpriv */ );
@@ -719,13 +773,13 @@ vlib_buffer_main_init_numa_node (struct vlib_main_t *vm, u32 numa_node,
 		     "buffer pool (%U)", numa_node, format_clib_error, error);
       clib_error_free (error);
 
-      error = vlib_buffer_main_init_numa_alloc (vm, numa_node,
+      error = vlib_buffer_main_init_numa_alloc (vm, numa_node, is_small,
 						&physmem_map_index,
 						CLIB_MEM_PAGE_SZ_DEFAULT,
 						1 /* unpriv */ );
     }
   else
-    error = vlib_buffer_main_init_numa_alloc (vm, numa_node,
+    error = vlib_buffer_main_init_numa_alloc (vm, numa_node, is_small,
 					      &physmem_map_index,
 					      bm->log2_page_size,
 					      0 /* unpriv */ );
@@ -733,9 +787,14 @@ vlib_buffer_main_init_numa_node (struct vlib_main_t *vm, u32 numa_node,
     return error;
 
 buffer_pool_create:
-  *index =
-    vlib_buffer_pool_create (vm, vlib_buffer_get_default_data_size (vm),
-			     physmem_map_index, "default-numa-%d", numa_node);
+  if (is_small)
+    *index = vlib_buffer_pool_create (vm, bm->small_data_size,
+				      physmem_map_index, "small-numa-%d",
+				      numa_node);
+  else
+    *index =
+      vlib_buffer_pool_create (vm, vlib_buffer_get_default_data_size (vm),
+			       physmem_map_index, "default-numa-%d", numa_node);
 
   if (*index == (u8) ~ 0)
     error = clib_error_return (0, "maximum number of buffer pools reached");
@@ -755,6 +814,7 @@ vlib_buffer_main_alloc (vlib_main_t * vm)
   vm->buffer_main = bm = clib_mem_alloc (sizeof (bm[0]));
   clib_memset (vm->buffer_main, 0, sizeof (bm[0]));
   bm->default_data_size = VLIB_BUFFER_DEFAULT_DATA_SIZE;
+  bm->small_data_size = VLIB_BUFFER_SMALL_DEFAULT_DATA_SIZE;
 }
 
 static u32
@@ -793,7 +853,8 @@ buffer_gauges_collect_used_fn (vlib_stats_collector_data_t *d)
   if (!bp)
     return;
 
-  d->entry->value = bp->n_buffers - bp->n_avail - buffer_get_cached (bp);
+  d->entry->value = bp->n_buffers - bp->n_avail -
+		    vlib_buffer_pool_n_depot (bp) - buffer_get_cached (bp);
 }
 
 static void
@@ -805,7 +866,7 @@ buffer_gauges_collect_available_fn (vlib_stats_collector_data_t *d)
   if (!bp)
     return;
 
-  d->entry->value = bp->n_avail;
+  d->entry->value = bp->n_avail + vlib_buffer_pool_n_depot (bp);
 }
 
 static void
@@ -852,11 +913,14 @@ vlib_buffer_main_init (struct vlib_main_t * vm)
     clib_panic ("system have more than %u NUMA nodes",
 		VLIB_BUFFER_MAX_NUMA_NODES);
 
+  clib_memset (bm->small_buffer_pool_index_for_numa, 0xff,
+	       sizeof (bm->small_buffer_pool_index_for_numa));
+
   clib_bitmap_foreach (numa_node, bmp)
     {
       u8 *index = bm->default_buffer_pool_index_for_numa + numa_node;
       index[0] = ~0;
-      if ((err = vlib_buffer_main_init_numa_node (vm, numa_node, index)))
+      if ((err = vlib_buffer_main_init_numa_node (vm, numa_node, 0, index)))
         {
 	  clib_error_report (err);
 	  clib_error_free (err);
@@ -880,6 +944,20 @@ vlib_buffer_main_init (struct vlib_main_t * vm)
 	  first_valid_buffer_pool_index;
     }
 
+  /* small buffer pools are optional, on failure users fall back to
+   * default pools */
+  if (bm->small_buffers_per_numa)
+    clib_bitmap_foreach (numa_node, bmp)
+      {
+	u8 *index = bm->small_buffer_pool_index_for_numa + numa_node;
+	if ((err = vlib_buffer_main_init_numa_node (vm, numa_node, 1, index)))
+	  {
+	    clib_error_report (err);
+	    clib_error_free (err);
+	    index[0] = ~0;
+	  }
+      }
+
   vec_foreach (bp, bm->buffer_pools)
   {
     vlib_stats_collector_reg_t reg = { .private_data = bp - bm->buffer_pools };
@@ -958,6 +1036,11 @@ vlib_buffers_configure (vlib_main_t * vm, unformat_input_t * input)
       else if (unformat (input, "default data-size %u",
 			 &bm->default_data_size))
 	;
+      else if (unformat (input, "small-buffers-per-numa %u",
+			 &bm->small_buffers_per_numa))
+	;
+      else if (unformat (input, "small data-size %u", &bm->small_data_size))
+	;
       else if (unformat (input, "numa %u %U", &numa_node,
 			 unformat_vlib_cli_sub_input, &sub_input))
 	{
@@ -971,12 +1054,32 @@ vlib_buffers_configure (vlib_main_t * vm, unformat_input_t * input)
 	return unformat_parse_error (input);
     }
 
+  if (bm->small_buffers_per_numa &&
+      (bm->small_data_size < VLIB_BUFFER_MIN_CHAIN_SEG_SIZE ||
+       bm->small_data_size >= bm->default_data_size))
+    return clib_error_return (0,
+			      "small data-size must be at least %u and "
+			      "smaller than default data-size",
+			      VLIB_BUFFER_MIN_CHAIN_SEG_SIZE);
+
   unformat_free (input);
   return 0;
 }
 
 VLIB_EARLY_CONFIG_FUNCTION (vlib_buffers_configure, "buffers");
 
+void
+vlib_buffer_size_class_init (vlib_main_t *vm, vlib_buffer_size_class_t *sc,
+			     u32 numa_node)
+{
+  clib_memset (sc, 0, sizeof (*sc));
+  sc->default_pool_index = vlib_buffer_pool_get_default_for_numa (vm, numa_node);
+  sc->small_pool_index = vlib_buffer_pool_get_small_for_numa (vm, numa_node);
+  sc->small_data_size =
+    vlib_buffer_get_pool_data_size (vm, sc->small_pool_index);
+  sc->pool_index = sc->default_pool_index;
+}
+
 #if VLIB_BUFFER_ALLOC_FAULT_INJECTOR > 0
 u32
 vlib_buffer_alloc_may_fail (vlib_main_t * vm, u32 n_buffers)
@@ -51,6 +51,11 @@
 
 #define VLIB_BUFFER_DEFAULT_DATA_SIZE (2048)
 
+/* Data size of buffers in small buffer pools, used for control packets and
+   headers. Packet headers are prepended into pre-data, so small buffers can
+   hold complete minimum sized frames with room to spare */
+#define VLIB_BUFFER_SMALL_DEFAULT_DATA_SIZE (256)
+
 /* Minimum buffer chain segment size. Does not apply to last buffer in chain.
    Dataplane code can safely asume that specified amount of data is not split
    into 2 chained buffers */
@@ -455,14 +460,31 @@ vlib_buffer_pull (vlib_buffer_t * b, u8 size)
 struct vlib_main_t;
 
 #define VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ 512
+#define VLIB_BUFFER_MAGAZINE_SZ		     (VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ / 2)
 
 typedef struct
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
   u32 cached_buffers[VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ];
   u32 n_cached;
+
+  /* magazine depot and global list counters */
+  u64 n_full_pushed;
+  u64 n_full_popped;
+  u64 n_depot_retries;
+  u64 n_lock_acquired;
 } vlib_buffer_pool_thread_t;
 
+/* Fixed size batch of free buffer indices exchanged between per-thread
+ * caches through the pool's depot */
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  u32 buffers[VLIB_BUFFER_MAGAZINE_SZ];
+  /* index + 1 of next magazine in depot stack */
+  u32 next;
+} vlib_buffer_magazine_t;
+
 typedef struct
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
@@ -485,10 +507,34 @@ typedef struct
 
   /* buffer metadata template */
   vlib_buffer_template_t buffer_template;
+
+  /* magazine depot. Full and empty magazines are kept on lock-free stacks
+   * whose heads hold a generation tag in the upper 32 bits and index + 1
+   * of the top magazine in the lower 32 bits */
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
+  u64 full_magazines;
+  u64 empty_magazines;
+  vlib_buffer_magazine_t *magazines;
 } vlib_buffer_pool_t;
 
 #define VLIB_BUFFER_MAX_NUMA_NODES 32
 
+/* Per receive queue buffer size class selection. Drivers report observed
+   packet sizes and refill from the small pool while nearly all packets fit
+   into small buffers */
+typedef struct
+{
+  u32 n_packets;
+  u32 n_small;
+  u16 small_data_size;
+  u8 default_pool_index;
+  u8 small_pool_index;
+  u8 pool_index;
+} vlib_buffer_size_class_t;
+
+/* number of packets observed before switching to small pool */
+#define VLIB_BUFFER_SIZE_CLASS_WINDOW 1024
+
 typedef u32 (vlib_buffer_alloc_free_callback_t) (struct vlib_main_t *vm,
 						 u8 buffer_pool_index,
 						 u32 *buffers, u32 n_buffers);
@@ -506,12 +552,15 @@ typedef struct
   vlib_buffer_alloc_free_callback_t *free_callback_fn;
 
   u8 default_buffer_pool_index_for_numa[VLIB_BUFFER_MAX_NUMA_NODES];
+  u8 small_buffer_pool_index_for_numa[VLIB_BUFFER_MAX_NUMA_NODES];
 
   /* config */
   u32 default_buffers_per_numa;
   u32 buffers_per_numa[VLIB_BUFFER_MAX_NUMA_NODES];
   u16 ext_hdr_size;
   u32 default_data_size;
+  u32 small_buffers_per_numa;
+  u32 small_data_size;
   clib_mem_page_sz_t log2_page_size;
 
   /* Hash table mapping buffer index into number
@@ -308,9 +308,9 @@ more:
 
   n_comp = clib_compress_u32 (hf ? hf->buffer_index : drop_list + n_drop,
 			      buffer_indices, mask, n_packets);
-  if (with_aux)
-    clib_compress_u32 (hf ? hf->aux_data : drop_list + n_drop, aux_data, mask,
-		       n_packets);
+  /* aux data of dropped buffers is not needed, don't clobber drop_list */
+  if (with_aux && hf)
+    clib_compress_u32 (hf->aux_data, aux_data, mask, n_packets);
 
   if (hf)
     {
@@ -318,7 +318,9 @@ more:
 	hf->maybe_trace = 1;
       hf->n_vectors = n_comp;
       __atomic_store_n (&hf->valid, 1, __ATOMIC_RELEASE);
-      vlib_get_main_by_index (thread_index)->check_frame_queues = 1;
+      vlib_main_t *tvm = vlib_get_main_by_index (thread_index);
+      tvm->check_frame_queues = 1;
+      vlib_thread_wakeup (tvm);
     }
   else
     n_drop += n_comp;
@@ -390,6 +392,9 @@ CLIB_MULTIARCH_FN (vlib_buffer_enqueue_to_thread_with_aux_fn)
 
   fqm = vec_elt_at_index (tm->frame_queue_mains, frame_queue_index);
 
+  /* aux data would be dropped by the dequeue side */
+  ASSERT (fqm->with_aux);
+
   while (n_packets >= VLIB_FRAME_SIZE)
     {
       n_enq += vlib_buffer_enqueue_to_thread_inline (
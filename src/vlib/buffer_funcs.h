@@ -206,6 +206,25 @@ vlib_buffer_pool_get_default_for_numa (vlib_main_t * vm, u32 numa_node)
   return vm->buffer_main->default_buffer_pool_index_for_numa[numa_node];
 }
 
+/** \brief Get small buffer pool index for numa node
+
+    @param vm - (vlib_main_t *) vlib main data structure pointer
+    @param numa_node - (u32) numa node
+    @return - (u8) small buffer pool index, or default buffer pool index
+    if small buffer pools are not configured
+*/
+always_inline u8
+vlib_buffer_pool_get_small_for_numa (vlib_main_t *vm, u32 numa_node)
+{
+  u8 index;
+
+  ASSERT (numa_node < VLIB_BUFFER_MAX_NUMA_NODES);
+  index = vm->buffer_main->small_buffer_pool_index_for_numa[numa_node];
+  if (index == (u8) ~0)
+    return vlib_buffer_pool_get_default_for_numa (vm, numa_node);
+  return index;
+}
+
 /** \brief Translate array of buffer indices into buffer pointers with offset
 
     @param vm - (vlib_main_t *) vlib main data structure pointer
@@ -505,34 +524,182 @@ vlib_get_buffer_pool (vlib_main_t * vm, u8 buffer_pool_index)
   return vec_elt_at_index (bm->buffer_pools, buffer_pool_index);
 }
 
+static_always_inline u32
+vlib_buffer_get_pool_data_size (vlib_main_t *vm, u8 buffer_pool_index)
+{
+  return vlib_get_buffer_pool (vm, buffer_pool_index)->data_size;
+}
+
+#define VLIB_BUFFER_MAGAZINE_TAG_INC  (1ULL << 32)
+#define VLIB_BUFFER_MAGAZINE_TAG_MASK (~0ULL << 32)
+
+/* Lock-free stacks are affected by ABA if a thread pops a magazine and
+ * pushes it back while another is between reading the head and swapping
+ * it. The generation tag in the upper bits of the head is incremented on
+ * every push and pop so such a stale swap fails */
+static_always_inline void
+vlib_buffer_magazine_push (vlib_buffer_pool_t *bp, u64 *head,
+			   vlib_buffer_magazine_t *m,
+			   vlib_buffer_pool_thread_t *bpt)
+{
+  u64 old_head, new_head;
+  u32 mi = m - bp->magazines + 1;
+
+  old_head = clib_atomic_load_acq_n (head);
+  while (1)
+    {
+      m->next = (u32) old_head;
+      new_head = ((old_head + VLIB_BUFFER_MAGAZINE_TAG_INC) &
+		  VLIB_BUFFER_MAGAZINE_TAG_MASK) |
+		 mi;
+      if (__atomic_compare_exchange (head, &old_head, &new_head, 0 /* weak */,
+				     __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+	return;
+      bpt->n_depot_retries += 1;
+    }
+}
+
+static_always_inline vlib_buffer_magazine_t *
+vlib_buffer_magazine_pop (vlib_buffer_pool_t *bp, u64 *head,
+			  vlib_buffer_pool_thread_t *bpt)
+{
+  vlib_buffer_magazine_t *m;
+  u64 old_head, new_head;
+
+  old_head = clib_atomic_load_acq_n (head);
+  while (1)
+    {
+      if (!(u32) old_head)
+	return 0;
+      m = bp->magazines + (u32) old_head - 1;
+      new_head = ((old_head + VLIB_BUFFER_MAGAZINE_TAG_INC) &
+		  VLIB_BUFFER_MAGAZINE_TAG_MASK) |
+		 clib_atomic_load_relax_n (&m->next);
+      if (__atomic_compare_exchange (head, &old_head, &new_head, 0 /* weak */,
+				     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+	return m;
+      bpt->n_depot_retries += 1;
+    }
+}
+
+/** \brief Take a full magazine from the pool's depot and copy its buffers
+
+    @param bp - (vlib_buffer_pool_t *) buffer pool
+    @param bpt - (vlib_buffer_pool_thread_t *) caller's per-thread data
+    @param buffers - (u32 *) buffer index array with room for a magazine
+    @return - (u32) number of buffers copied, either 0 or a full magazine
+*/
+static_always_inline u32
+vlib_buffer_depot_get (vlib_buffer_pool_t *bp, vlib_buffer_pool_thread_t *bpt,
+		       u32 *buffers)
+{
+  vlib_buffer_magazine_t *m;
+
+  m = vlib_buffer_magazine_pop (bp, &bp->full_magazines, bpt);
+  if (!m)
+    return 0;
+
+  vlib_buffer_copy_indices (buffers, m->buffers, VLIB_BUFFER_MAGAZINE_SZ);
+  vlib_buffer_magazine_push (bp, &bp->empty_magazines, m, bpt);
+  bpt->n_full_popped += 1;
+  return VLIB_BUFFER_MAGAZINE_SZ;
+}
+
+/** \brief Move a magazine worth of buffers to the pool's depot
+
+    @param bp - (vlib_buffer_pool_t *) buffer pool
+    @param bpt - (vlib_buffer_pool_thread_t *) caller's per-thread data
+    @param buffers - (u32 *) buffer index array with a magazine of buffers
+    @return - (int) 0 on success, -1 if no empty magazine is available
+*/
+static_always_inline int
+vlib_buffer_depot_put (vlib_buffer_pool_t *bp, vlib_buffer_pool_thread_t *bpt,
+		       u32 *buffers)
+{
+  vlib_buffer_magazine_t *m;
+
+  m = vlib_buffer_magazine_pop (bp, &bp->empty_magazines, bpt);
+  if (!m)
+    return -1;
+
+  vlib_buffer_copy_indices (m->buffers, buffers, VLIB_BUFFER_MAGAZINE_SZ);
+  vlib_buffer_magazine_push (bp, &bp->full_magazines, m, bpt);
+  bpt->n_full_pushed += 1;
+  return 0;
+}
+
+/** \brief Number of buffers held in the pool's depot
+
+    @param bp - (vlib_buffer_pool_t *) buffer pool
+    @return - (u32) buffers in full magazines, not counted in bp->n_avail
+*/
+static_always_inline u32
+vlib_buffer_pool_n_depot (vlib_buffer_pool_t *bp)
+{
+  vlib_buffer_pool_thread_t *bpt;
+  u64 n_full = 0;
+
+  vec_foreach (bpt, bp->threads)
+    n_full += bpt->n_full_pushed - bpt->n_full_popped;
+
+  return n_full * VLIB_BUFFER_MAGAZINE_SZ;
+}
+
 static_always_inline __clib_warn_unused_result uword
 vlib_buffer_pool_get (vlib_main_t * vm, u8 buffer_pool_index, u32 * buffers,
 		      u32 n_buffers)
 {
   vlib_buffer_pool_t *bp = vlib_get_buffer_pool (vm, buffer_pool_index);
-  u32 len;
+  vlib_buffer_pool_thread_t *bpt = vec_elt_at_index (bp->threads,
+						     vm->thread_index);
+  u32 mag[VLIB_BUFFER_MAGAZINE_SZ];
+  u32 len, n_left = n_buffers;
 
   ASSERT (bp->buffers);
 
+  /* whole magazines from the depot first, no lock needed */
+  while (n_left >= VLIB_BUFFER_MAGAZINE_SZ)
+    {
+      if (!vlib_buffer_depot_get (bp, bpt, buffers))
+	break;
+      buffers += VLIB_BUFFER_MAGAZINE_SZ;
+      n_left -= VLIB_BUFFER_MAGAZINE_SZ;
+    }
+
+  if (!n_left)
+    return n_buffers;
+
   clib_spinlock_lock (&bp->lock);
+  bpt->n_lock_acquired += 1;
   len = bp->n_avail;
-  if (PREDICT_TRUE (n_buffers < len))
+  if (PREDICT_TRUE (n_left < len))
     {
-      len -= n_buffers;
-      vlib_buffer_copy_indices (buffers, bp->buffers + len, n_buffers);
+      len -= n_left;
+      vlib_buffer_copy_indices (buffers, bp->buffers + len, n_left);
       bp->n_avail = len;
       clib_spinlock_unlock (&bp->lock);
       return n_buffers;
     }
-  else
+
+  vlib_buffer_copy_indices (buffers, bp->buffers, len);
+  bp->n_avail = 0;
+  buffers += len;
+  n_left -= len;
+
+  /* global list exhausted, split a magazine if depot has one */
+  if (n_left && vlib_buffer_depot_get (bp, bpt, mag))
     {
-      vlib_buffer_copy_indices (buffers, bp->buffers, len);
-      bp->n_avail = 0;
-      clib_spinlock_unlock (&bp->lock);
-      return len;
+      len = clib_min (n_left, VLIB_BUFFER_MAGAZINE_SZ);
+      vlib_buffer_copy_indices (buffers, mag, len);
+      vlib_buffer_copy_indices (bp->buffers, mag + len,
+				VLIB_BUFFER_MAGAZINE_SZ - len);
+      bp->n_avail = VLIB_BUFFER_MAGAZINE_SZ - len;
+      n_left -= len;
     }
-}
+  clib_spinlock_unlock (&bp->lock);
 
+  return n_buffers - n_left;
+}
 
 /** \brief Allocate buffers from specific pool into supplied array
 
@@ -596,9 +763,19 @@ vlib_buffer_alloc_from_pool (vlib_main_t * vm, u32 * buffers, u32 n_buffers,
       n_left -= len;
     }
 
-  len = round_pow2 (n_left, 32);
-  len = vlib_buffer_pool_get (vm, buffer_pool_index, bpt->cached_buffers,
-			      len);
+  /* refill cache with full magazines from depot, if that doesn't
+   * suffice, fall back to pool's global list */
+  len = 0;
+  while (len < n_left)
+    {
+      if (!vlib_buffer_depot_get (bp, bpt, bpt->cached_buffers + len))
+	break;
+      len += VLIB_BUFFER_MAGAZINE_SZ;
+    }
+  if (len < n_left)
+    len += vlib_buffer_pool_get (vm, buffer_pool_index,
+				 bpt->cached_buffers + len,
+				 round_pow2 (n_left - len, 32));
   bpt->n_cached = len;
 
   if (len)
@@ -654,6 +831,69 @@ vlib_buffer_alloc (vlib_main_t * vm, u32 * buffers, u32 n_buffers)
   return vlib_buffer_alloc_on_numa (vm, buffers, n_buffers, vm->numa_node);
 }
 
+/** \brief Allocate small buffers into supplied array
+
+    Small buffers are meant for packets which carry only headers, like
+    control packets or head buffers prepended to a chain by encap nodes.
+    Falls back to default buffer pool if small pools are not configured.
+
+    @param vm - (vlib_main_t *) vlib main data structure pointer
+    @param buffers - (u32 * ) buffer index array
+    @param n_buffers - (u32) number of buffers requested
+    @return - (u32) number of buffers actually allocated, may be
+    less than the number requested or zero
+*/
+always_inline __clib_warn_unused_result u32
+vlib_buffer_alloc_small (vlib_main_t *vm, u32 *buffers, u32 n_buffers)
+{
+  u8 index = vlib_buffer_pool_get_small_for_numa (vm, vm->numa_node);
+  return vlib_buffer_alloc_from_pool (vm, buffers, n_buffers, index);
+}
+
+void vlib_buffer_size_class_init (vlib_main_t *vm,
+				  vlib_buffer_size_class_t *sc, u32 numa_node);
+
+/** \brief Update receive queue buffer size class
+
+    Switches to small buffer pool once 7/8 of packets seen over
+    VLIB_BUFFER_SIZE_CLASS_WINDOW packets fit into small buffers, and back
+    to default pool as soon as a batch doesn't, as large packets received
+    into small buffers end up chained.
+
+    @param sc - (vlib_buffer_size_class_t *) size class state
+    @param n_packets - (u32) number of packets received in batch
+    @param n_small - (u32) number of those which fit into small buffer
+    @return - (u8) buffer pool index to refill queue from
+*/
+static_always_inline u8
+vlib_buffer_size_class_update (vlib_buffer_size_class_t *sc, u32 n_packets,
+			       u32 n_small)
+{
+  if (sc->small_pool_index == sc->default_pool_index)
+    return sc->pool_index;
+
+  sc->n_packets += n_packets;
+  sc->n_small += n_small;
+
+  if (sc->pool_index == sc->small_pool_index && n_small * 8 < n_packets * 7)
+    goto set_default;
+
+  if (sc->n_packets < VLIB_BUFFER_SIZE_CLASS_WINDOW)
+    return sc->pool_index;
+
+  if ((u64) sc->n_small * 8 >= (u64) sc->n_packets * 7)
+    {
+      sc->pool_index = sc->small_pool_index;
+      sc->n_packets = sc->n_small = 0;
+      return sc->pool_index;
+    }
+
+set_default:
+  sc->pool_index = sc->default_pool_index;
+  sc->n_packets = sc->n_small = 0;
+  return sc->pool_index;
+}
+
 /** \brief Allocate buffers into ring
 
     @param vm - (vlib_main_t *) vlib main data structure pointer
@@ -744,12 +984,41 @@ vlib_buffer_pool_put (vlib_main_t * vm, u8 buffer_pool_index,
 
   vlib_buffer_copy_indices (bpt->cached_buffers + n_cached,
 			    buffers + n_buffers - n_empty, n_empty);
-  bpt->n_cached = VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ;
+  n_cached = VLIB_BUFFER_POOL_PER_THREAD_CACHE_SZ;
+  n_buffers -= n_empty;
+
+  /* cache is full, move whole magazines to depot. Remainder smaller than
+   * a magazine goes into the cache after its top half is moved out */
+  while (n_buffers >= VLIB_BUFFER_MAGAZINE_SZ)
+    {
+      if (vlib_buffer_depot_put (bp, bpt,
+				 buffers + n_buffers - VLIB_BUFFER_MAGAZINE_SZ))
+	goto global_put;
+      n_buffers -= VLIB_BUFFER_MAGAZINE_SZ;
+    }
+
+  if (n_buffers)
+    {
+      n_cached -= VLIB_BUFFER_MAGAZINE_SZ;
+      if (vlib_buffer_depot_put (bp, bpt, bpt->cached_buffers + n_cached))
+	{
+	  n_cached += VLIB_BUFFER_MAGAZINE_SZ;
+	  goto global_put;
+	}
+      vlib_buffer_copy_indices (bpt->cached_buffers + n_cached, buffers,
+				n_buffers);
+      n_cached += n_buffers;
+    }
+
+  bpt->n_cached = n_cached;
+  return;
 
+global_put:
+  bpt->n_cached = n_cached;
   clib_spinlock_lock (&bp->lock);
-  vlib_buffer_copy_indices (bp->buffers + bp->n_avail, buffers,
-			    n_buffers - n_empty);
-  bp->n_avail += n_buffers - n_empty;
+  bpt->n_lock_acquired += 1;
+  vlib_buffer_copy_indices (bp->buffers + bp->n_avail, buffers, n_buffers);
+  bp->n_avail += n_buffers;
   clib_spinlock_unlock (&bp->lock);
 }
 
@@ -1125,7 +1394,9 @@ vlib_buffer_copy (vlib_main_t * vm, vlib_buffer_t * b)
     }
   u32 new_buffers[n_buffers];
 
-  n_alloc = vlib_buffer_alloc (vm, new_buffers, n_buffers);
+  /* same pool, so segments fit in the copies */
+  n_alloc = vlib_buffer_alloc_from_pool (vm, new_buffers, n_buffers,
+					 b->buffer_pool_index);
 
   /* No guarantee that we'll get all the buffers we asked for */
   if (PREDICT_FALSE (n_alloc < n_buffers))
@@ -1173,7 +1444,7 @@ vlib_buffer_copy_no_chain (vlib_main_t * vm, vlib_buffer_t * b, u32 * di)
 {
   vlib_buffer_t *d;
 
-  if ((vlib_buffer_alloc (vm, di, 1)) != 1)
+  if ((vlib_buffer_alloc_from_pool (vm, di, 1, b->buffer_pool_index)) != 1)
     return 0;
 
   d = vlib_get_buffer (vm, *di);
@@ -1200,7 +1471,7 @@ vlib_buffer_move (vlib_main_t * vm, vlib_buffer_t * b, i16 offset)
   ASSERT ((b->flags & VLIB_BUFFER_NEXT_PRESENT) == 0);
   ASSERT (offset + VLIB_BUFFER_PRE_DATA_SIZE >= 0);
   ASSERT (offset + b->current_length <
-	  vlib_buffer_get_default_data_size (vm));
+	  vlib_buffer_get_pool_data_size (vm, b->buffer_pool_index));
 
   u8 *source = vlib_buffer_get_current (b);
   b->current_data = offset;
@@ -1239,7 +1510,7 @@ vlib_buffer_clone_256 (vlib_main_t * vm, u32 src_buffer, u32 * buffers,
   ASSERT (n_buffers <= 256);
   ASSERT (offset + VLIB_BUFFER_PRE_DATA_SIZE >= 0);
   ASSERT ((offset + head_end_offset) <
-	  vlib_buffer_get_default_data_size (vm));
+	  vlib_buffer_get_pool_data_size (vm, s->buffer_pool_index));
 
   if (s->current_length <= head_end_offset + CLIB_CACHE_LINE_BYTES * 2)
     {
@@ -1439,7 +1710,8 @@ vlib_buffer_chain_append_data (vlib_main_t * vm,
 			       vlib_buffer_t * first,
 			       vlib_buffer_t * last, void *data, u16 data_len)
 {
-  u32 n_buffer_bytes = vlib_buffer_get_default_data_size (vm);
+  u32 n_buffer_bytes =
+    vlib_buffer_get_pool_data_size (vm, last->buffer_pool_index);
   ASSERT (n_buffer_bytes >= last->current_length + last->current_data);
   u16 len = clib_min (data_len,
 		      n_buffer_bytes - last->current_length -
@@ -1496,8 +1768,8 @@ vlib_packet_template_free (vlib_main_t * vm, vlib_packet_template_t * t)
 always_inline u32
 vlib_buffer_space_left_at_end (vlib_main_t * vm, vlib_buffer_t * b)
 {
-  return b->data + vlib_buffer_get_default_data_size (vm) -
-    ((u8 *) vlib_buffer_get_current (b) + b->current_length);
+  return b->data + vlib_buffer_get_pool_data_size (vm, b->buffer_pool_index) -
+	 ((u8 *) vlib_buffer_get_current (b) + b->current_length);
 }
 
 #define VLIB_BUFFER_LINEARIZE_MAX 64
@@ -1508,7 +1780,7 @@ vlib_buffer_chain_linearize (vlib_main_t * vm, vlib_buffer_t * b)
   vlib_buffer_t *dst_b;
   u32 n_buffers = 1, to_free = 0;
   u16 rem_len, dst_len, data_size, src_len = 0;
-  u8 *dst, *src = 0;
+  u8 *dst, *src = 0, buffer_pool_index = b->buffer_pool_index;
 
   if (PREDICT_TRUE ((b->flags & VLIB_BUFFER_NEXT_PRESENT) == 0))
     return 1;
@@ -1517,7 +1789,8 @@ vlib_buffer_chain_linearize (vlib_main_t * vm, vlib_buffer_t * b)
   if (PREDICT_FALSE (1 != b->ref_count))
     return 0;
 
-  data_size = vlib_buffer_get_default_data_size (vm);
+  /* new buffers come from the pool of the first one */
+  data_size = vlib_buffer_get_pool_data_size (vm, buffer_pool_index);
   rem_len = vlib_buffer_length_in_chain (vm, b) - b->current_length;
 
   dst_b = b;
@@ -1567,7 +1840,8 @@ vlib_buffer_chain_linearize (vlib_main_t * vm, vlib_buffer_t * b)
 	      if (PREDICT_FALSE (n > VLIB_BUFFER_LINEARIZE_MAX))
 		return 0;
 
-	      n_alloc = vlib_buffer_alloc (vm, bis, n);
+	      n_alloc =
+		vlib_buffer_alloc_from_pool (vm, bis, n, buffer_pool_index);
 	      if (PREDICT_FALSE (n_alloc != n))
 		{
 		  vlib_buffer_free (vm, bis, n_alloc);
@@ -1593,7 +1867,9 @@ vlib_buffer_chain_linearize (vlib_main_t * vm, vlib_buffer_t * b)
 	  dst_b->current_length = 0;
 
 	  dst = dst_b->data + dst_b->current_data;
-	  dst_len = data_size - dst_b->current_data;
+	  dst_len =
+	    vlib_buffer_get_pool_data_size (vm, dst_b->buffer_pool_index) -
+	    dst_b->current_data;
 	}
 
       copy_len = clib_min (src_len, dst_len);
@@ -33,17 +33,21 @@ vlib_dma_config_add (vlib_main_t *vm, vlib_dma_config_t *c)
 
   clib_memcpy (&cd->cfg, c, sizeof (vlib_dma_config_t));
 
-  vec_foreach (b, dm->backends)
-    {
-      dma_log_info ("calling '%s' config_add_fn", b->name);
-      if (b->config_add_fn (vm, cd))
-	{
-	  dma_log_info ("config %u added into backend %s", cd - dm->configs,
-			b->name);
-	  cd->backend_index = b - dm->backends;
-	  return cd - dm->configs;
-	}
-    }
+  /* hardware backends first, then software ones */
+  for (int is_software = 0; is_software < 2; is_software++)
+    vec_foreach (b, dm->backends)
+      {
+	if (b->is_software != is_software)
+	  continue;
+	dma_log_info ("calling '%s' config_add_fn", b->name);
+	if (b->config_add_fn (vm, cd))
+	  {
+	    dma_log_info ("config %u added into backend %s", cd - dm->configs,
+			  b->name);
+	    cd->backend_index = b - dm->backends;
+	    return cd - dm->configs;
+	  }
+      }
 
   pool_put (dm->configs, cd);
   return -1;
@@ -62,6 +62,8 @@ typedef struct
   vlib_dma_config_add_fn *config_add_fn;
   vlib_dma_config_del_fn *config_del_fn;
   format_function_t *info_fn;
+  /* only used when no hardware backend accepts the config */
+  u8 is_software;
 } vlib_dma_backend_t;
 
 typedef struct vlib_dma_config_data
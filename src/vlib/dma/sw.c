@@ -0,0 +1,265 @@
+/* SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Software DMA backend. Transfers are done with the cpu, but batches still
+ * complete asynchronously from an interrupt node, so DMA users behave the
+ * same way as with a hardware backend. It is only picked when no hardware
+ * backend accepts the config.
+ */
+
+#include <vlib/vlib.h>
+#include <vlib/log.h>
+#include <vlib/dma/dma.h>
+
+VLIB_REGISTER_LOG_CLASS (dma_log, static) = {
+  .class_name = "dma",
+  .subclass_name = "sw",
+};
+
+typedef struct
+{
+  void *src;
+  void *dst;
+  u32 size;
+} vlib_dma_sw_transfer_t;
+
+typedef struct
+{
+  vlib_dma_batch_t batch;
+  u32 config_index;
+  u16 max_transfers;
+  vlib_dma_sw_transfer_t transfers[0];
+} vlib_dma_sw_batch_t;
+
+typedef struct
+{
+  u32 config_index;
+  u32 alloc_size;
+  vlib_dma_sw_batch_t batch_template;
+  /* per thread freelists */
+  vlib_dma_sw_batch_t ***freelist;
+} vlib_dma_sw_config_t;
+
+typedef struct
+{
+  vlib_dma_sw_batch_t **pending_batches;
+  u64 n_batches;
+  u64 n_transfers;
+  u64 n_bytes;
+} vlib_dma_sw_thread_t;
+
+typedef struct
+{
+  vlib_dma_sw_config_t *configs;
+  vlib_dma_sw_thread_t *threads;
+} vlib_dma_sw_main_t;
+
+static vlib_dma_sw_main_t vlib_dma_sw_main;
+
+extern vlib_node_registration_t vlib_dma_sw_node;
+
+static vlib_dma_batch_t *
+vlib_dma_sw_batch_new (vlib_main_t *vm, struct vlib_dma_config_data *cd)
+{
+  vlib_dma_sw_main_t *sm = &vlib_dma_sw_main;
+  vlib_dma_sw_config_t *sc = pool_elt_at_index (sm->configs, cd->private_data);
+  vlib_dma_sw_batch_t **fl = sc->freelist[vm->thread_index];
+  vlib_dma_sw_batch_t *b;
+
+  if (vec_len (fl))
+    return &vec_pop (sc->freelist[vm->thread_index])->batch;
+
+  b = clib_mem_alloc_aligned (sc->alloc_size, CLIB_CACHE_LINE_BYTES);
+  *b = sc->batch_template;
+  return &b->batch;
+}
+
+static int
+vlib_dma_sw_batch_submit (vlib_main_t *vm, struct vlib_dma_batch *vb)
+{
+  vlib_dma_sw_main_t *sm = &vlib_dma_sw_main;
+  vlib_dma_sw_batch_t *b = (vlib_dma_sw_batch_t *) vb;
+  vlib_dma_sw_thread_t *t = vec_elt_at_index (sm->threads, vm->thread_index);
+
+  if (PREDICT_FALSE (vb->n_enq == 0))
+    {
+      vlib_dma_sw_config_t *sc = pool_elt_at_index (
+	sm->configs,
+	vlib_dma_main.configs[b->config_index].private_data);
+      vec_add1 (sc->freelist[vm->thread_index], b);
+      return 0;
+    }
+
+  ASSERT (vb->n_enq <= b->max_transfers);
+  vec_add1 (t->pending_batches, b);
+  vlib_node_set_interrupt_pending (vm, vlib_dma_sw_node.index);
+  return 1;
+}
+
+static int
+vlib_dma_sw_config_add_fn (vlib_main_t *vm, vlib_dma_config_data_t *cd)
+{
+  vlib_dma_sw_main_t *sm = &vlib_dma_sw_main;
+  vlib_dma_sw_config_t *sc;
+  vlib_dma_sw_batch_t *bt;
+  vlib_dma_config_t supported_cfg = {
+    .barrier_before_last = 1,
+    .sw_fallback = 1,
+  };
+
+  if (cd->cfg.features & ~supported_cfg.features)
+    return 0;
+
+  if (cd->cfg.max_transfers == 0)
+    return 0;
+
+  vec_validate (sm->threads, vlib_get_n_threads () - 1);
+
+  pool_get_zero (sm->configs, sc);
+  sc->config_index = cd->config_index;
+  sc->alloc_size = sizeof (vlib_dma_sw_batch_t) +
+		   cd->cfg.max_transfers * sizeof (vlib_dma_sw_transfer_t);
+  vec_validate (sc->freelist, vlib_get_n_threads () - 1);
+
+  /* completion is always ordered, barrier_before_last comes for free */
+  bt = &sc->batch_template;
+  bt->config_index = cd->config_index;
+  bt->max_transfers = cd->cfg.max_transfers;
+  bt->batch.submit_fn = vlib_dma_sw_batch_submit;
+  bt->batch.callback_fn = cd->cfg.callback_fn;
+  bt->batch.stride = sizeof (vlib_dma_sw_transfer_t);
+  bt->batch.src_ptr_off = STRUCT_OFFSET_OF (vlib_dma_sw_batch_t, transfers) +
+			  STRUCT_OFFSET_OF (vlib_dma_sw_transfer_t, src);
+  bt->batch.dst_ptr_off = STRUCT_OFFSET_OF (vlib_dma_sw_batch_t, transfers) +
+			  STRUCT_OFFSET_OF (vlib_dma_sw_transfer_t, dst);
+  bt->batch.size_off = STRUCT_OFFSET_OF (vlib_dma_sw_batch_t, transfers) +
+		       STRUCT_OFFSET_OF (vlib_dma_sw_transfer_t, size);
+
+  cd->batch_new_fn = vlib_dma_sw_batch_new;
+  cd->private_data = sc - sm->configs;
+
+  dma_log_info ("config %u added", cd->config_index);
+  return 1;
+}
+
+static void
+vlib_dma_sw_config_del_fn (vlib_main_t *vm, vlib_dma_config_data_t *cd)
+{
+  vlib_dma_sw_main_t *sm = &vlib_dma_sw_main;
+  vlib_dma_sw_config_t *sc = pool_elt_at_index (sm->configs, cd->private_data);
+  vlib_dma_sw_thread_t *t;
+  vlib_dma_sw_batch_t ***fl;
+
+  /* drop batches of this config which did not complete yet */
+  vec_foreach (t, sm->threads)
+    {
+      u32 i, n = 0;
+
+      if (vec_len (t->pending_batches) == 0)
+	continue;
+
+      for (i = 0; i < vec_len (t->pending_batches); i++)
+	{
+	  vlib_dma_sw_batch_t *b = t->pending_batches[i];
+	  if (b->config_index == cd->config_index)
+	    clib_mem_free (b);
+	  else
+	    t->pending_batches[n++] = b;
+	}
+      vec_set_len (t->pending_batches, n);
+    }
+
+  vec_foreach (fl, sc->freelist)
+    {
+      vlib_dma_sw_batch_t **b;
+      vec_foreach (b, fl[0])
+	clib_mem_free (b[0]);
+      vec_free (fl[0]);
+    }
+  vec_free (sc->freelist);
+  pool_put (sm->configs, sc);
+
+  dma_log_info ("config %u removed", cd->config_index);
+}
+
+static u8 *
+format_vlib_dma_sw_info (u8 *s, va_list *args)
+{
+  vlib_dma_sw_main_t *sm = &vlib_dma_sw_main;
+  vlib_main_t *vm = va_arg (*args, vlib_main_t *);
+  vlib_dma_sw_thread_t *t;
+
+  if (vm->thread_index >= vec_len (sm->threads))
+    return format (s, "thread %u software idle", vm->thread_index);
+
+  t = vec_elt_at_index (sm->threads, vm->thread_index);
+  return format (s, "thread %u software batches %lu transfers %lu bytes %lu",
+		 vm->thread_index, t->n_batches, t->n_transfers, t->n_bytes);
+}
+
+static uword
+vlib_dma_sw_node_fn (vlib_main_t *vm, vlib_node_runtime_t *node,
+		     vlib_frame_t *frame)
+{
+  vlib_dma_sw_main_t *sm = &vlib_dma_sw_main;
+  vlib_dma_sw_thread_t *t;
+  u32 i, n_pending;
+
+  if (vm->thread_index >= vec_len (sm->threads))
+    return 0;
+
+  t = vec_elt_at_index (sm->threads, vm->thread_index);
+  n_pending = vec_len (t->pending_batches);
+
+  /* callbacks may submit new batches, they complete on the next dispatch */
+  for (i = 0; i < n_pending; i++)
+    {
+      vlib_dma_sw_batch_t *b = t->pending_batches[i];
+      vlib_dma_sw_transfer_t *tr = b->transfers;
+      vlib_dma_sw_config_t *sc;
+
+      for (u16 j = 0; j < b->batch.n_enq; j++, tr++)
+	{
+	  clib_memcpy_fast (tr->dst, tr->src, tr->size);
+	  t->n_bytes += tr->size;
+	}
+      t->n_transfers += b->batch.n_enq;
+      t->n_batches++;
+
+      if (b->batch.callback_fn)
+	b->batch.callback_fn (vm, &b->batch);
+
+      b->batch.n_enq = 0;
+      sc = pool_elt_at_index (
+	sm->configs, vlib_dma_main.configs[b->config_index].private_data);
+      vec_add1 (sc->freelist[vm->thread_index], b);
+    }
+
+  vec_delete (t->pending_batches, n_pending, 0);
+  return n_pending;
+}
+
+VLIB_REGISTER_NODE (vlib_dma_sw_node) = {
+  .function = vlib_dma_sw_node_fn,
+  .name = "dma-sw",
+  .type = VLIB_NODE_TYPE_INPUT,
+  .state = VLIB_NODE_STATE_INTERRUPT,
+  .vector_size = 4,
+};
+
+static clib_error_t *
+vlib_dma_sw_init (vlib_main_t *vm)
+{
+  vlib_dma_backend_t b = {
+    .name = "software",
+    .config_add_fn = vlib_dma_sw_config_add_fn,
+    .config_del_fn = vlib_dma_sw_config_del_fn,
+    .info_fn = format_vlib_dma_sw_info,
+    .is_software = 1,
+  };
+
+  return vlib_dma_register_backend (vm, &b);
+}
+
+VLIB_INIT_FUNCTION (vlib_dma_sw_init);
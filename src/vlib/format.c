@@ -232,6 +232,47 @@ format_vlib_thread_name_and_index (u8 * s, va_list * args)
 		 thread_index);
 }
 
+static u8 *
+format_vlib_time_ns (u8 *s, va_list *args)
+{
+  u64 ns = va_arg (*args, u64);
+
+  if (ns < 1000)
+    return format (s, "%lluns", ns);
+  if (ns < 1000000)
+    return format (s, "%.1fus", ns * 1e-3);
+  if (ns < 1000000000)
+    return format (s, "%.1fms", ns * 1e-6);
+  return format (s, "%.2fs", ns * 1e-9);
+}
+
+u8 *
+format_vlib_time_ns_hist (u8 *s, va_list *args)
+{
+  vlib_simple_counter_main_t *cm =
+    va_arg (*args, vlib_simple_counter_main_t *);
+  static const f64 percentiles[] = { 50, 90, 99, 99.9 };
+  static const char *names[] = { "50", "90", "99", "99.9" };
+  u64 *hist = 0, total = 0;
+  u32 b, i;
+
+  vec_validate (hist, VLIB_TIME_NS_HIST_N_BUCKETS - 1);
+  for (b = 0; b < VLIB_TIME_NS_HIST_N_BUCKETS; b++)
+    total += hist[b] = vlib_get_simple_counter (cm, b);
+
+  s = format (s, "samples %llu", total);
+  if (total == 0)
+    goto done;
+
+  for (i = 0; i < ARRAY_LEN (percentiles); i++)
+    s = format (s, " p%s <%U", names[i], format_vlib_time_ns,
+		vlib_time_ns_hist_percentile (hist, percentiles[i]));
+
+done:
+  vec_free (hist);
+  return s;
+}
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
@@ -53,6 +53,10 @@ u8 *format_vlib_thread_name (u8 * s, va_list * args);
 /* Formats thread name and thread index */
 u8 *format_vlib_thread_name_and_index (u8 * s, va_list * args);
 
+/* Formats sample count and percentiles of a vlib_time_ns_hist_bucket
+   histogram kept in a simple counter */
+u8 *format_vlib_time_ns_hist (u8 *s, va_list *args);
+
 /* Enable/on => 1; disable/off => 0. */
 uword unformat_vlib_enable_disable (unformat_input_t * input, va_list * args);
 
@@ -29,6 +29,7 @@ always_inline vlib_main_t *
 vlib_get_main_by_index (u32 thread_index)
 {
   vlib_main_t *vm;
+  ASSERT (thread_index < vec_len (vlib_global_main.vlib_mains));
   vm = vlib_global_main.vlib_mains[thread_index];
   ASSERT (vm);
   return vm;
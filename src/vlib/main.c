@@ -867,6 +867,53 @@ add_trajectory_trace (vlib_buffer_t * b, u32 node_index)
 #endif
 }
 
+u64
+vlib_time_ns_hist_percentile (u64 *hist, f64 percentile)
+{
+  u64 total = 0, sum = 0, rank;
+  f64 r;
+  u32 b;
+
+  for (b = 0; b < vec_len (hist); b++)
+    total += hist[b];
+
+  if (total == 0)
+    return 0;
+
+  /* nearest rank, p99.9 of 100 samples is the largest one */
+  r = total * percentile / 100;
+  rank = clib_max (1, (u64) r + ((u64) r < r));
+
+  for (b = 0; b < vec_len (hist) - 1; b++)
+    if ((sum += hist[b]) >= rank)
+      break;
+
+  /* upper bound of the bucket holding the requested rank */
+  return vlib_time_ns_hist_bucket_min (b + 1);
+}
+
+static never_inline void
+dispatch_time_sample (vlib_main_t *vm, vlib_node_runtime_t *node, u64 clocks)
+{
+  vlib_global_main_t *vgm = vlib_get_global_main ();
+  u32 *countdown = vec_elt_at_index (vm->node_main.dispatch_time_countdown,
+				     node->node_index);
+  vlib_node_dispatch_time_t *dt;
+
+  if (countdown[0])
+    {
+      countdown[0]--;
+      return;
+    }
+
+  dt = vec_elt_at_index (vgm->node_dispatch_times, node->node_index);
+  countdown[0] = dt->sample_interval - 1;
+  vlib_increment_simple_counter (
+    &dt->hist, vm->thread_index,
+    vlib_time_ns_hist_bucket (clocks * vm->clib_time.seconds_per_clock * 1e9),
+    1);
+}
+
 static_always_inline u64
 dispatch_node (vlib_main_t * vm,
 	       vlib_node_runtime_t * node,
@@ -957,6 +1004,11 @@ dispatch_node (vlib_main_t * vm,
 
   vm->main_loop_vectors_processed += n;
   vm->main_loop_nodes_processed += n > 0;
+  if (n)
+    vm->cpu_time_busy += t - last_time_stamp;
+
+  if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_DISPATCH_TIME) && n)
+    dispatch_time_sample (vm, node, t - last_time_stamp);
 
   v = vlib_node_runtime_update_stats (vm, node,
 				      /* n_calls */ 1,
@@ -1423,6 +1475,32 @@ dispatch_suspended_process (vlib_main_t * vm,
   return t;
 }
 
+static never_inline void
+expire_scheduled_interrupts (vlib_main_t *vm, f64 now)
+{
+  vlib_node_main_t *nm = &vm->node_main;
+  f64 next = CLIB_F64_MAX;
+  u32 i = 0;
+
+  while (i < vec_len (nm->scheduled_interrupts))
+    {
+      vlib_node_scheduled_interrupt_t *si = nm->scheduled_interrupts + i;
+
+      if (si->deadline <= now)
+	{
+	  vlib_node_set_interrupt_pending (vm, si->node_index);
+	  vec_del1 (nm->scheduled_interrupts, i);
+	}
+      else
+	{
+	  next = clib_min (next, si->deadline);
+	  i++;
+	}
+    }
+
+  nm->next_scheduled_interrupt = next;
+}
+
 static_always_inline void
 vlib_main_or_worker_loop (vlib_main_t * vm, int is_main)
 {
@@ -1519,6 +1597,13 @@ vlib_main_or_worker_loop (vlib_main_t * vm, int is_main)
 	clib_call_callbacks (vm->worker_thread_main_loop_callbacks, vm,
 			     cpu_time_now);
 
+      if (PREDICT_FALSE (vec_len (nm->scheduled_interrupts)))
+	{
+	  f64 now = vlib_time_now (vm);
+	  if (now >= nm->next_scheduled_interrupt)
+	    expire_scheduled_interrupts (vm, now);
+	}
+
       /* Process pre-input nodes. */
       cpu_time_now = clib_cpu_time_now ();
       vec_foreach (n, nm->nodes_by_type[VLIB_NODE_TYPE_PRE_INPUT])
@@ -1662,6 +1747,11 @@ vlib_main_or_worker_loop (vlib_main_t * vm, int is_main)
 		}
 	      vec_set_len (nm->data_from_advancing_timing_wheel, 0);
 	    }
+
+	  /* Free memory unpublished before the workers' last loop */
+	  if (PREDICT_FALSE (vec_len (tm->epoch_waiting_frees) ||
+			     vec_len (tm->epoch_pending_frees)))
+	    vlib_worker_thread_epoch_reclaim (vm);
 	}
       vlib_increment_main_loop_counter (vm);
       /* Record time stamp in case there are no enabled nodes and above
@@ -1860,6 +1950,7 @@ vlib_main (vlib_main_t * volatile vm, unformat_input_t * input)
   vlib_node_main_t *nm = &vm->node_main;
 
   vm->queue_signal_callback = placeholder_queue_signal_callback;
+  vm->wakeup_fd = -1;
 
   /* Reconfigure event log which is enabled very early */
   if (vgm->configured_elog_ring_size &&
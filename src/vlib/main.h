@@ -122,6 +122,9 @@ typedef struct vlib_main_t
   u32 main_loop_vectors_processed;
   u32 main_loop_nodes_processed;
 
+  /* Clocks spent in node dispatches which processed vectors */
+  u64 cpu_time_busy;
+
   /* Internal node vectors, calls */
   u64 internal_node_vectors;
   u64 internal_node_calls;
@@ -249,6 +252,11 @@ typedef struct vlib_main_t
   /* Need to check the frame queues */
   volatile uword check_frame_queues;
 
+  /* Set while the thread sleeps in tickless mode, other threads write to
+     wakeup_fd to end the sleep early */
+  volatile u32 sleeping;
+  int wakeup_fd;
+
   /* RPC requests, main thread only */
   uword *pending_rpc_requests;
   uword *processing_rpc_requests;
@@ -264,6 +272,15 @@ typedef struct vlib_main_t
 #endif
 } vlib_main_t;
 
+typedef struct
+{
+  /* Per thread histogram, see vlib_time_ns_hist_bucket */
+  vlib_simple_counter_main_t hist;
+
+  /* One dispatch out of sample_interval is recorded */
+  u32 sample_interval;
+} vlib_node_dispatch_time_t;
+
 typedef struct vlib_global_main_t
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
@@ -314,6 +331,10 @@ typedef struct vlib_global_main_t
   /* Hash table to record which init functions have been called. */
   uword *init_functions_called;
 
+  /* Dispatch time histograms of nodes with VLIB_NODE_FLAG_DISPATCH_TIME,
+     indexed by node index */
+  vlib_node_dispatch_time_t *node_dispatch_times;
+
 } vlib_global_main_t;
 
 /* Global main structure. */
@@ -340,6 +361,50 @@ vlib_time_now_ticks (vlib_main_t * vm, u64 n)
   return clib_time_now_internal (&vm->clib_time, n);
 }
 
+/*
+ * Histogram bucket for a duration in seconds, using log2 microsecond
+ * buckets: bucket 0 counts durations below 1us, bucket i counts
+ * [2^(i-1), 2^i) us and the last bucket also absorbs anything longer.
+ */
+always_inline u32
+vlib_time_log2_usec_bucket (f64 dt, u32 n_buckets)
+{
+  u64 usec = dt > 0 ? (u64) (dt * 1e6) : 0;
+  return usec ? clib_min (n_buckets - 1, 1 + min_log2_u64 (usec)) : 0;
+}
+
+/*
+ * Log-linear (HDR style) histogram of durations in nanoseconds. Every
+ * power of two above 4ns is split into 4 linear sub-buckets, so a bucket
+ * is never wider than a quarter of its lower bound. Durations below 4ns
+ * get a bucket each, the last bucket absorbs anything above ~7.5s.
+ */
+#define VLIB_TIME_NS_HIST_N_BUCKETS 128
+
+always_inline u32
+vlib_time_ns_hist_bucket (u64 ns)
+{
+  u32 l;
+
+  if (ns < 4)
+    return ns;
+
+  l = min_log2_u64 (ns);
+  return clib_min (VLIB_TIME_NS_HIST_N_BUCKETS - 1,
+		   (l - 1) * 4 + ((ns >> (l - 2)) & 3));
+}
+
+/* Lowest duration in nanoseconds counted in a bucket */
+always_inline u64
+vlib_time_ns_hist_bucket_min (u32 bucket)
+{
+  if (bucket < 4)
+    return bucket;
+  return (u64) (4 + (bucket & 3)) << ((bucket >> 2) - 1);
+}
+
+u64 vlib_time_ns_hist_percentile (u64 *hist, f64 percentile);
+
 /* Busy wait for specified time. */
 always_inline void
 vlib_time_wait (vlib_main_t * vm, f64 wait)
@@ -39,6 +39,7 @@
 
 #include <vlib/vlib.h>
 #include <vlib/threads.h>
+#include <vlib/stats/stats.h>
 
 /* Query node given name. */
 vlib_node_t *
@@ -927,6 +928,39 @@ vlib_node_set_march_variant (vlib_main_t *vm, u32 node_index,
     }
   return -1;
 }
+void
+vlib_node_set_dispatch_time (vlib_main_t *vm, u32 node_index,
+			     u32 sample_interval, u8 enable)
+{
+  vlib_global_main_t *vgm = vlib_get_global_main ();
+  vlib_node_t *n = vlib_get_node (vm, node_index);
+  vlib_node_dispatch_time_t *dt;
+
+  vec_validate (vgm->node_dispatch_times, node_index);
+  dt = vec_elt_at_index (vgm->node_dispatch_times, node_index);
+
+  if (enable && dt->hist.stat_segment_name == 0)
+    {
+      dt->hist.stat_segment_name =
+	(char *) format (0, "/nodes/%U/dispatch_time%c",
+			 format_vlib_stats_symlink, n->name, 0);
+      vlib_validate_simple_counter (&dt->hist,
+				    VLIB_TIME_NS_HIST_N_BUCKETS - 1);
+    }
+
+  if (enable)
+    dt->sample_interval = clib_max (1, sample_interval);
+
+  foreach_vlib_main ()
+    {
+      vlib_node_main_t *nm = &this_vlib_main->node_main;
+      vec_validate (nm->dispatch_time_countdown, node_index);
+      nm->dispatch_time_countdown[node_index] = 0;
+      vlib_node_set_flag (this_vlib_main, node_index,
+			  VLIB_NODE_FLAG_DISPATCH_TIME, enable);
+    }
+}
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
@@ -297,6 +297,8 @@ typedef struct vlib_node_t
 #define VLIB_NODE_FLAG_SWITCH_FROM_POLLING_TO_INTERRUPT_MODE (1 << 7)
 #define VLIB_NODE_FLAG_TRACE_SUPPORTED (1 << 8)
 #define VLIB_NODE_FLAG_ADAPTIVE_MODE			     (1 << 9)
+  /* Node dispatch times are sampled into a histogram. */
+#define VLIB_NODE_FLAG_DISPATCH_TIME (1 << 10)
 
   /* State for input nodes. */
   u8 state;
@@ -666,6 +668,13 @@ vlib_timing_wheel_data_get_index (u32 d)
   return d / 2;
 }
 
+/* Input node interrupt deferred by vlib_node_schedule_interrupt */
+typedef struct
+{
+  f64 deadline;
+  u32 node_index;
+} vlib_node_scheduled_interrupt_t;
+
 typedef struct
 {
   clib_march_variant_type_t index;
@@ -693,6 +702,10 @@ typedef struct
   void *input_node_interrupts;
   void *pre_input_node_interrupts;
 
+  /* Interrupts to set once their deadline passes, and the earliest one */
+  vlib_node_scheduled_interrupt_t *scheduled_interrupts;
+  f64 next_scheduled_interrupt;
+
   /* Input nodes are switched from/to interrupt to/from polling mode
      when average vector length goes above/below polling/interrupt
      thresholds. */
@@ -749,6 +762,9 @@ typedef struct
 
   /* Node Function march Variant by Suffix Hash */
   uword *node_fn_march_variant_by_suffix;
+
+  /* Dispatches left until the next dispatch time sample, per node */
+  u32 *dispatch_time_countdown;
 } vlib_node_main_t;
 
 typedef u16 vlib_error_t;
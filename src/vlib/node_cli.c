@@ -642,6 +642,7 @@ clear_node_runtime (vlib_main_t * vm,
   int i, j;
   vlib_main_t **stat_vms = 0, *stat_vm;
   vlib_node_runtime_t *r;
+  vlib_node_dispatch_time_t *dt;
 
   for (i = 0; i < vlib_get_n_threads (); i++)
     {
@@ -670,6 +671,10 @@ clear_node_runtime (vlib_main_t * vm,
       nm->time_last_runtime_stats_clear = vlib_time_now (vm);
     }
 
+  vec_foreach (dt, vlib_get_global_main ()->node_dispatch_times)
+    if (dt->hist.stat_segment_name)
+      vlib_clear_simple_counters (&dt->hist);
+
   vlib_stats_set_timestamp (STAT_COUNTER_LAST_STATS_CLEAR,
 			    vm->node_main.time_last_runtime_stats_clear);
   vlib_worker_thread_barrier_release (vm);
@@ -903,6 +908,106 @@ VLIB_CLI_COMMAND (set_node_fn_command, static) = {
   .function = set_node_fn,
 };
 
+static clib_error_t *
+set_node_dispatch_time (vlib_main_t *vm, unformat_input_t *input,
+			vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  u32 node_index = ~0, sample_interval = 1;
+  u8 enable = 1;
+  clib_error_t *err = 0;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return clib_error_return (0, "please specify valid node name");
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "sample %u", &sample_interval))
+	;
+      else if (unformat (line_input, "disable"))
+	enable = 0;
+      else if (unformat (line_input, "%U", unformat_vlib_node, vm,
+			 &node_index))
+	;
+      else
+	{
+	  err = clib_error_return (0, "unknown input '%U'",
+				   format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (node_index == ~0)
+    {
+      err = clib_error_return (0, "please specify valid node name");
+      goto done;
+    }
+
+  if (sample_interval == 0)
+    {
+      err = clib_error_return (0, "sample interval must be at least 1");
+      goto done;
+    }
+
+  vlib_node_set_dispatch_time (vm, node_index, sample_interval, enable);
+
+done:
+  unformat_free (line_input);
+  return err;
+}
+
+/*?
+ * Record how long each dispatch of a node takes in a log-linear
+ * histogram, exported to the stats segment as
+ * /nodes/<node-name>/dispatch_time with one counter per bucket (see
+ * vlib_time_ns_hist_bucket). Only dispatches which processed at least one
+ * vector are recorded, and only one of every <n> with 'sample <n>'.
+ *
+ * @cliexpar
+ * @cliexcmd{set node dispatch-time ip4-lookup sample 16}
+ ?*/
+VLIB_CLI_COMMAND (set_node_dispatch_time_command, static) = {
+  .path = "set node dispatch-time",
+  .short_help = "set node dispatch-time <node-name> [sample <n>] [disable]",
+  .function = set_node_dispatch_time,
+};
+
+static clib_error_t *
+show_node_dispatch_time (vlib_main_t *vm, unformat_input_t *input,
+			 vlib_cli_command_t *cmd)
+{
+  vlib_global_main_t *vgm = vlib_get_global_main ();
+  vlib_node_dispatch_time_t *dt;
+  u32 node_index = ~0;
+
+  if (unformat (input, "%U", unformat_vlib_node, vm, &node_index) &&
+      node_index >= vec_len (vgm->node_dispatch_times))
+    return clib_error_return (0, "no dispatch times recorded");
+
+  vec_foreach (dt, vgm->node_dispatch_times)
+    {
+      u32 i = dt - vgm->node_dispatch_times;
+      vlib_node_t *n;
+
+      if (dt->hist.stat_segment_name == 0 ||
+	  (node_index != ~0 && i != node_index))
+	continue;
+
+      n = vlib_get_node (vm, i);
+      vlib_cli_output (vm, "%-30v %s sample 1/%u %U", n->name,
+		       n->flags & VLIB_NODE_FLAG_DISPATCH_TIME ? "on " : "off",
+		       dt->sample_interval, format_vlib_time_ns_hist, &dt->hist);
+    }
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_node_dispatch_time_command, static) = {
+  .path = "show node dispatch-time",
+  .short_help = "show node dispatch-time [<node-name>]",
+  .function = show_node_dispatch_time,
+};
+
 /* Dummy function to get us linked in. */
 void
 vlib_node_cli_reference (void)
@@ -265,11 +265,39 @@ vlib_node_set_interrupt_pending (vlib_main_t *vm, u32 node_index)
     }
 
   if (vm != vlib_get_main ())
-    clib_interrupt_set_atomic (interrupts, n->runtime_index);
+    {
+      clib_interrupt_set_atomic (interrupts, n->runtime_index);
+      vlib_thread_wakeup (vm);
+    }
   else
     clib_interrupt_set (interrupts, n->runtime_index);
 }
 
+/** \brief Set an input node interrupt pending once dt seconds have passed.
+    Must be called on the thread owning the node runtime. Interrupts which
+    arrive in the meantime are handled by a single dispatch.
+    @param vm - vlib_main_t pointer of the calling thread
+    @param node_index - index of an input or pre-input node
+    @param dt - delay in seconds
+*/
+always_inline void
+vlib_node_schedule_interrupt (vlib_main_t *vm, u32 node_index, f64 dt)
+{
+  vlib_node_main_t *nm = &vm->node_main;
+  vlib_node_scheduled_interrupt_t *si;
+  f64 deadline = vlib_time_now (vm) + dt;
+
+  ASSERT (vm == vlib_get_main ());
+
+  if (vec_len (nm->scheduled_interrupts) == 0 ||
+      deadline < nm->next_scheduled_interrupt)
+    nm->next_scheduled_interrupt = deadline;
+
+  vec_add2 (nm->scheduled_interrupts, si, 1);
+  si->deadline = deadline;
+  si->node_index = node_index;
+}
+
 always_inline vlib_process_t *
 vlib_get_process_from_node (vlib_main_t * vm, vlib_node_t * node)
 {
@@ -1379,6 +1407,9 @@ vlib_node_set_dispatch_wrapper (vlib_main_t *vm, vlib_node_function_t *fn)
 int vlib_node_set_march_variant (vlib_main_t *vm, u32 node_index,
 				 clib_march_variant_type_t march_variant);
 
+void vlib_node_set_dispatch_time (vlib_main_t *vm, u32 node_index,
+				  u32 sample_interval, u8 enable);
+
 vlib_node_function_t *
 vlib_node_get_preferred_node_fn_variant (vlib_main_t *vm,
 					 vlib_node_fn_registration_t *regs);
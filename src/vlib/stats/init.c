@@ -9,6 +9,9 @@
 #define STAT_SEGMENT_SOCKET_FILENAME "stats.sock"
 
 static u32 vlib_loops_stats_counter_index;
+static u32 vlib_epoch_deferred_frees_gauge_index;
+static u32 vlib_epoch_grace_periods_gauge_index;
+static u32 vlib_epoch_forced_grace_periods_gauge_index;
 
 static void
 vector_rate_collector_fn (vlib_stats_collector_data_t *d)
@@ -46,6 +49,30 @@ vector_rate_collector_fn (vlib_stats_collector_data_t *d)
   vlib_stats_set_gauge (d->private_data, vector_rate);
 }
 
+static void
+barrier_collector_fn (vlib_stats_collector_data_t *d)
+{
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  vlib_worker_thread_t *w = vlib_worker_threads;
+  counter_t **counters = d->entry->data;
+  counter_t *cb = counters[0];
+  u32 i;
+
+  if (w == 0)
+    return;
+
+  for (i = 0; i < VLIB_BARRIER_HOLD_HIST_N_BUCKETS; i++)
+    cb[i] = w->barrier_hold_time_histogram[i];
+
+  vlib_stats_set_gauge (d->private_data, w->barrier_sync_count);
+  vlib_stats_set_gauge (vlib_epoch_deferred_frees_gauge_index,
+			tm->epoch_n_deferred_frees);
+  vlib_stats_set_gauge (vlib_epoch_grace_periods_gauge_index,
+			tm->epoch_n_grace_periods);
+  vlib_stats_set_gauge (vlib_epoch_forced_grace_periods_gauge_index,
+			tm->epoch_n_forced_grace_periods);
+}
+
 clib_error_t *
 vlib_stats_init (vlib_main_t *vm)
 {
@@ -130,6 +157,20 @@ vlib_stats_init (vlib_main_t *vm)
   vlib_stats_validate (vlib_loops_stats_counter_index, 0,
 		       vlib_get_n_threads ());
 
+  /* Barrier sync count and hold time histogram (log2 us buckets) */
+  reg.collect_fn = barrier_collector_fn;
+  reg.private_data = vlib_stats_add_gauge ("/sys/barrier/sync_count");
+  reg.entry_index = vlib_stats_add_counter_vector ("/sys/barrier/hold_time");
+  vlib_stats_validate (reg.entry_index, 0,
+		       VLIB_BARRIER_HOLD_HIST_N_BUCKETS - 1);
+  vlib_epoch_deferred_frees_gauge_index =
+    vlib_stats_add_gauge ("/sys/barrier/epoch/deferred_frees");
+  vlib_epoch_grace_periods_gauge_index =
+    vlib_stats_add_gauge ("/sys/barrier/epoch/grace_periods");
+  vlib_epoch_forced_grace_periods_gauge_index =
+    vlib_stats_add_gauge ("/sys/barrier/epoch/forced_grace_periods");
+  vlib_stats_register_collector_fn (&reg);
+
   return 0;
 }
 
@@ -139,6 +139,9 @@ barrier_trace_release (f64 t_entry, f64 t_closed_total, f64 t_update_main)
   vlib_worker_threads[0].barrier_context = NULL;
 }
 
+static void vlib_worker_thread_epoch_free (void ***vp);
+static void vlib_barrier_readers_wait_one_section (void);
+
 uword
 os_get_nthreads (void)
 {
@@ -683,6 +686,8 @@ start_workers (vlib_main_t * vm)
 	      vec_validate (nm_clone->pending_frames, 10);
 	      vec_set_len (nm_clone->pending_frames, 0);
 
+	      nm_clone->scheduled_interrupts = 0;
+
 	      /* fork nodes */
 	      nm_clone->nodes = 0;
 
@@ -1275,6 +1280,22 @@ VLIB_EARLY_CONFIG_FUNCTION (cpu_config, "cpu");
 #define BARRIER_MINIMUM_OPEN_FACTOR 3
 #endif
 
+void
+vlib_thread_wakeup_slow (vlib_main_t *vm)
+{
+  u64 one = 1;
+
+  if (write (vm->wakeup_fd, &one, sizeof (one)) < 0 && errno != EAGAIN)
+    clib_unix_warning ("write wakeup fd of thread %u", vm->thread_index);
+}
+
+static void
+worker_thread_wakeup_all (void)
+{
+  for (u32 i = 1; i < vlib_get_n_threads (); i++)
+    vlib_thread_wakeup (vlib_get_main_by_index (i));
+}
+
 void
 vlib_worker_thread_initial_barrier_sync_and_release (vlib_main_t * vm)
 {
@@ -1288,6 +1309,7 @@ vlib_worker_thread_initial_barrier_sync_and_release (vlib_main_t * vm)
 
   deadline = now + BARRIER_SYNC_TIMEOUT;
   *vlib_worker_threads->wait_at_barrier = 1;
+  worker_thread_wakeup_all ();
   while (*vlib_worker_threads->workers_at_barrier != count)
     {
       if ((now = vlib_time_now (vm)) > deadline)
@@ -1300,6 +1322,119 @@ vlib_worker_thread_initial_barrier_sync_and_release (vlib_main_t * vm)
   *vlib_worker_threads->wait_at_barrier = 0;
 }
 
+vlib_barrier_reader_t *
+vlib_barrier_reader_alloc (void)
+{
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  vlib_barrier_reader_t *r;
+
+  ASSERT (vlib_get_thread_index () == 0);
+
+  r = clib_mem_alloc_aligned (sizeof (*r), CLIB_CACHE_LINE_BYTES);
+  clib_memset (r, 0, sizeof (*r));
+  vec_add1 (tm->barrier_readers, r);
+  return r;
+}
+
+void
+vlib_barrier_reader_free (vlib_barrier_reader_t *r)
+{
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  u32 i;
+
+  ASSERT (vlib_get_thread_index () == 0);
+  ASSERT (r->active == 0);
+
+  i = vec_search (tm->barrier_readers, r);
+  if (i == ~0)
+    return;
+
+  /* The waiting epoch batch snapshot is indexed by reader, once the
+   * others have left their current sections it has no use */
+  vlib_barrier_readers_wait_one_section ();
+  vec_reset_length (tm->epoch_reader_sections);
+
+  vec_delete (tm->barrier_readers, 1, i);
+  clib_mem_free (r);
+}
+
+void
+vlib_barrier_reader_wait (void)
+{
+  u32 n_spins = 0;
+
+  /* The barrier may be held for a while, don't spin against the main
+   * thread if we share a core with it */
+  while (vlib_barrier_reader_should_leave ())
+    if (n_spins++ < 1024)
+      CLIB_PAUSE ();
+    else
+      usleep (10);
+}
+
+/* Keep barrier readers out of their read sections, and wait for the
+ * ones inside to leave */
+static void
+vlib_barrier_readers_close (vlib_main_t *vm)
+{
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  vlib_barrier_reader_t **r;
+  f64 deadline;
+
+  if (__atomic_fetch_add (&tm->barrier_readers_closed, 1, __ATOMIC_SEQ_CST))
+    return;
+
+  if (vec_len (tm->barrier_readers) == 0)
+    return;
+
+  deadline = vlib_time_now (vm) + BARRIER_SYNC_TIMEOUT;
+  vec_foreach (r, tm->barrier_readers)
+    while (__atomic_load_n (&r[0]->active, __ATOMIC_SEQ_CST))
+      {
+	if (vlib_time_now (vm) > deadline)
+	  {
+	    fformat (stderr, "%s: barrier reader deadlock\n", __FUNCTION__);
+	    os_panic ();
+	  }
+	CLIB_PAUSE ();
+      }
+}
+
+static void
+vlib_barrier_readers_open (void)
+{
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+
+  ASSERT (tm->barrier_readers_closed > 0);
+  __atomic_fetch_sub (&tm->barrier_readers_closed, 1, __ATOMIC_RELEASE);
+}
+
+/* Wait until each reader inside a read section has left it */
+static void
+vlib_barrier_readers_wait_one_section (void)
+{
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  u32 *sections = 0;
+  u32 i;
+
+  if (vec_len (tm->barrier_readers) == 0 || tm->barrier_readers_closed)
+    return;
+
+  vec_validate (sections, vec_len (tm->barrier_readers) - 1);
+  vec_foreach_index (i, tm->barrier_readers)
+    sections[i] = tm->barrier_readers[i]->n_sections;
+
+  vec_foreach_index (i, tm->barrier_readers)
+    {
+      vlib_barrier_reader_t *r = tm->barrier_readers[i];
+      while (__atomic_load_n (&r->active, __ATOMIC_ACQUIRE) &&
+	     r->n_sections == sections[i])
+	CLIB_PAUSE ();
+    }
+
+  vec_free (sections);
+}
+
 /**
  * Return true if the wroker thread barrier is held
  */
@@ -1324,6 +1459,8 @@ vlib_worker_thread_barrier_sync_int (vlib_main_t * vm, const char *func_name)
   u32 count;
   int i;
 
+  vlib_barrier_readers_close (vm);
+
   if (vlib_get_n_threads () < 2)
     return;
 
@@ -1393,6 +1530,7 @@ vlib_worker_thread_barrier_sync_int (vlib_main_t * vm, const char *func_name)
   deadline = now + BARRIER_SYNC_TIMEOUT;
 
   *vlib_worker_threads->wait_at_barrier = 1;
+  worker_thread_wakeup_all ();
   while (*vlib_worker_threads->workers_at_barrier != count)
     {
       if ((now = vlib_time_now (vm)) > deadline)
@@ -1421,7 +1559,10 @@ vlib_worker_thread_barrier_release (vlib_main_t * vm)
   int refork_needed = 0;
 
   if (vlib_get_n_threads () < 2)
-    return;
+    {
+      vlib_barrier_readers_open ();
+      return;
+    }
 
   ASSERT (vlib_get_thread_index () == 0);
 
@@ -1432,6 +1573,7 @@ vlib_worker_thread_barrier_release (vlib_main_t * vm)
   if (--vlib_worker_threads[0].recursion_level > 0)
     {
       barrier_trace_release_rec (t_entry);
+      vlib_barrier_readers_open ();
       return;
     }
 
@@ -1498,6 +1640,9 @@ vlib_worker_thread_barrier_release (vlib_main_t * vm)
     }
 
   t_closed_total = now - vm->barrier_epoch;
+  vlib_worker_threads[0].barrier_hold_time_histogram
+    [vlib_time_log2_usec_bucket (t_closed_total,
+				 VLIB_BARRIER_HOLD_HIST_N_BUCKETS)]++;
 
   minimum_open = t_closed_total * BARRIER_MINIMUM_OPEN_FACTOR;
 
@@ -1513,6 +1658,11 @@ vlib_worker_thread_barrier_release (vlib_main_t * vm)
 
   barrier_trace_release (t_entry, t_closed_total, t_update_main);
 
+  /* Workers and readers went through a quiescent point while parked */
+  vlib_worker_thread_epoch_free (&vlib_thread_main.epoch_waiting_frees);
+  vlib_worker_thread_epoch_free (&vlib_thread_main.epoch_pending_frees);
+  vlib_barrier_readers_open ();
+
   if (PREDICT_FALSE (vec_len (vm->barrier_perf_callbacks) != 0))
     clib_call_callbacks (vm->barrier_perf_callbacks, vm,
 			 vm->clib_time.last_cpu_time, 1 /* leave */ );
@@ -1578,6 +1728,8 @@ vlib_worker_wait_one_loop (void)
   vlib_global_main_t *vgm = vlib_get_global_main ();
   ASSERT (vlib_get_thread_index () == 0);
 
+  vlib_barrier_readers_wait_one_section ();
+
   if (vlib_get_n_threads () < 2)
     return;
 
@@ -1593,18 +1745,208 @@ vlib_worker_wait_one_loop (void)
   vec_foreach_index (ii, vgm->vlib_mains)
     counts[ii] = vgm->vlib_mains[ii]->main_loop_count;
 
+  /* idle tickless workers would only go around once their sleep ends */
+  worker_thread_wakeup_all ();
+
   /* spin until each changes, apart from the main thread, or we'd be
-   * a while */
+   * a while. A worker may have gone to sleep again before it saw the
+   * wakeup, so keep waking it. */
   for (ii = 1; ii < vec_len (counts); ii++)
     {
       while (counts[ii] == vgm->vlib_mains[ii]->main_loop_count)
-	CLIB_PAUSE ();
+	{
+	  vlib_thread_wakeup (vgm->vlib_mains[ii]);
+	  CLIB_PAUSE ();
+	}
     }
 
   vec_free (counts);
   return;
 }
 
+/* No workers or barrier readers, or all of them parked at the barrier:
+ * nobody but the main thread can hold a reference */
+static int
+vlib_worker_thread_epoch_unshared (void)
+{
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+
+  if (vec_len (tm->barrier_readers) && tm->barrier_readers_closed == 0)
+    return 0;
+
+  return vlib_worker_thread_barrier_held ();
+}
+
+void
+vlib_worker_thread_defer_vec_free (void *v)
+{
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+
+  ASSERT (vlib_get_thread_index () == 0);
+
+  if (v == 0)
+    return;
+
+  if (vlib_worker_thread_epoch_unshared ())
+    {
+      vec_free (v);
+      return;
+    }
+
+  vec_add1 (tm->epoch_pending_frees, v);
+  tm->epoch_n_deferred_frees++;
+}
+
+static void
+vlib_worker_thread_epoch_check_frozen (void *v)
+{
+#if CLIB_DEBUG > 0
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  vlib_epoch_frozen_vec_t *f;
+
+  vec_foreach (f, tm->epoch_frozen_vecs)
+    if (f->v == v)
+      {
+	if (hash_memory (v, f->n_bytes, 0) != f->hash)
+	  clib_panic ("pool copy %p written after it was replaced", v);
+	vec_del1 (tm->epoch_frozen_vecs, f - tm->epoch_frozen_vecs);
+	return;
+      }
+#endif
+}
+
+static void
+vlib_worker_thread_epoch_free (void ***vp)
+{
+  void **v;
+
+  vec_foreach (v, vp[0])
+    {
+      vlib_worker_thread_epoch_check_frozen (v[0]);
+      vec_free (v[0]);
+    }
+  vec_reset_length (vp[0]);
+}
+
+void
+vlib_worker_thread_epoch_reclaim (vlib_main_t *vm)
+{
+  vlib_global_main_t *vgm = vlib_get_global_main ();
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  void **tmp;
+  int busy = 0;
+  u32 ii;
+
+  ASSERT (vlib_get_thread_index () == 0);
+
+  if (vec_len (tm->epoch_waiting_frees))
+    {
+      /* Grace period ends once each worker has moved on from the loop
+       * iteration it was in when the waiting batch was closed, and each
+       * barrier reader from the read section it was in */
+      for (ii = 1; ii < vec_len (tm->epoch_loop_counts); ii++)
+	if (tm->epoch_loop_counts[ii] == vgm->vlib_mains[ii]->main_loop_count)
+	  busy = 1;
+
+      vec_foreach_index (ii, tm->epoch_reader_sections)
+	{
+	  vlib_barrier_reader_t *r = tm->barrier_readers[ii];
+	  if (__atomic_load_n (&r->active, __ATOMIC_ACQUIRE) &&
+	      r->n_sections == tm->epoch_reader_sections[ii])
+	    busy = 1;
+	}
+
+      if (busy)
+	{
+	  /* A worker asleep in interrupt mode does not advance its loop
+	   * count; don't let frees pile up behind it forever */
+	  if (vlib_time_now (vm) < tm->epoch_wait_start +
+				     VLIB_EPOCH_GRACE_PERIOD_TIMEOUT)
+	    return;
+
+	  tm->epoch_n_forced_grace_periods++;
+	  vlib_worker_thread_barrier_sync (vm);
+	  vlib_worker_thread_barrier_release (vm);
+	}
+
+      vlib_worker_thread_epoch_free (&tm->epoch_waiting_frees);
+      tm->epoch_n_grace_periods++;
+    }
+
+  if (vec_len (tm->epoch_pending_frees) == 0)
+    return;
+
+  /* Close the pending batch and snapshot the worker loop counts */
+  tmp = tm->epoch_waiting_frees;
+  tm->epoch_waiting_frees = tm->epoch_pending_frees;
+  tm->epoch_pending_frees = tmp;
+
+  vec_validate (tm->epoch_loop_counts, vlib_get_n_threads () - 1);
+  vec_foreach_index (ii, vgm->vlib_mains)
+    tm->epoch_loop_counts[ii] = vgm->vlib_mains[ii]->main_loop_count;
+  vec_reset_length (tm->epoch_reader_sections);
+  vec_foreach_index (ii, tm->barrier_readers)
+    vec_add1 (tm->epoch_reader_sections, tm->barrier_readers[ii]->n_sections);
+  tm->epoch_wait_start = vlib_time_now (vm);
+}
+
+void
+vlib_pool_grow_deferred (void **pp, uword n_elts, uword align, uword elt_sz)
+{
+  void *old = pp[0], *new;
+  pool_header_t *oph, *nph;
+  uword len;
+
+  ASSERT (vlib_get_thread_index () == 0);
+
+  /* Nothing published yet, or nobody to race with: grow in place */
+  if (old == 0 || vlib_worker_thread_epoch_unshared ())
+    {
+      _pool_alloc (pp, n_elts, align, 0, elt_sz);
+      return;
+    }
+
+  const vec_attr_t va = { .hdr_sz = sizeof (pool_header_t),
+			  .elt_sz = elt_sz,
+			  .align = align,
+			  .heap = vec_get_heap (old) };
+
+  len = vec_len (old);
+  oph = pool_header (old);
+
+  new = _vec_alloc_internal (len + n_elts, &va);
+  clib_memcpy_fast (new, old, len * elt_sz);
+  _vec_set_len (new, len, elt_sz);
+  clib_mem_poison (new + len * elt_sz, n_elts * elt_sz);
+
+  /* Workers may still test the old free bitmap, so the new pool gets its
+   * own copy; the free index vector is only ever used by this thread */
+  nph = pool_header (new);
+  nph->free_indices = oph->free_indices;
+  nph->free_bitmap = clib_bitmap_dup (oph->free_bitmap);
+  nph->max_elts = 0;
+  vec_resize (nph->free_indices, n_elts);
+  vec_dec_len (nph->free_indices, n_elts);
+  clib_bitmap_validate (nph->free_bitmap, len + n_elts);
+
+  clib_atomic_store_rel_n (pp, new);
+
+#if CLIB_DEBUG > 0
+  {
+    vlib_thread_main_t *tm = vlib_get_thread_main ();
+    vlib_epoch_frozen_vec_t *f;
+
+    vec_add2 (tm->epoch_frozen_vecs, f, 1);
+    f->v = old;
+    f->n_bytes = len * elt_sz;
+    f->hash = hash_memory (old, f->n_bytes, 0);
+  }
+#endif
+
+  vlib_worker_thread_defer_vec_free (oph->free_bitmap);
+  vlib_worker_thread_defer_vec_free (old);
+}
+
 void
 vlib_worker_flush_pending_rpc_requests (vlib_main_t *vm)
 {
@@ -1672,10 +2014,14 @@ vlib_frame_queue_main_init (u32 node_index, u32 frame_queue_nelts)
 
   vec_add2 (tm->frame_queue_mains, fqm, 1);
 
-  node = vlib_get_node (vm, fqm->node_index);
+  fqm->node_index = node_index;
+  fqm->frame_queue_nelts = frame_queue_nelts;
+
+  node = vlib_get_node (vm, node_index);
   ASSERT (node);
   if (node->aux_offset)
     {
+      fqm->with_aux = 1;
       fqm->frame_queue_dequeue_fn =
 	CLIB_MARCH_FN_VOID_POINTER (vlib_frame_queue_dequeue_with_aux_fn);
     }
@@ -1685,9 +2031,6 @@ vlib_frame_queue_main_init (u32 node_index, u32 frame_queue_nelts)
 	CLIB_MARCH_FN_VOID_POINTER (vlib_frame_queue_dequeue_fn);
     }
 
-  fqm->node_index = node_index;
-  fqm->frame_queue_nelts = frame_queue_nelts;
-
   vec_validate (fqm->vlib_frame_queues, tm->n_vlib_mains - 1);
   vec_set_len (fqm->vlib_frame_queues, 0);
   for (i = 0; i < tm->n_vlib_mains; i++)
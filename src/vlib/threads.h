@@ -67,6 +67,9 @@ typedef struct
 }
 vlib_frame_queue_elt_t;
 
+/* Barrier hold time histogram size, see vlib_time_log2_usec_bucket */
+#define VLIB_BARRIER_HOLD_HIST_N_BUCKETS 16
+
 typedef struct
 {
   /* First cache line */
@@ -86,6 +89,7 @@ typedef struct
   vlib_thread_registration_t *registration;
   u8 *name;
   u64 barrier_sync_count;
+  u64 barrier_hold_time_histogram[VLIB_BARRIER_HOLD_HIST_N_BUCKETS];
   u8 barrier_elog_enabled;
   const char *barrier_caller;
   const char *barrier_context;
@@ -129,6 +133,7 @@ typedef struct vlib_frame_queue_main_t_
 {
   u32 node_index;
   u32 frame_queue_nelts;
+  u8 with_aux; /**< node has aux data, dequeued with it */
 
   vlib_frame_queue_t **vlib_frame_queues;
 
@@ -175,7 +180,8 @@ u8 vlib_worker_thread_barrier_held (void);
 void vlib_worker_thread_initial_barrier_sync_and_release (vlib_main_t * vm);
 void vlib_worker_thread_node_refork (void);
 /**
- * Wait until each of the workers has been once around the track
+ * Wait until each of the workers has been once around the track, and
+ * each barrier reader has left the read section it was in
  */
 void vlib_worker_wait_one_loop (void);
 /**
@@ -183,6 +189,54 @@ void vlib_worker_wait_one_loop (void);
  */
 void vlib_worker_flush_pending_rpc_requests (vlib_main_t *vm);
 
+/* Force a barrier if workers have not passed a grace period by then */
+#define VLIB_EPOCH_GRACE_PERIOD_TIMEOUT (10e-3)
+
+/**
+ * Free vector V once each worker has been once around its main loop and
+ * each barrier reader has left its read section, so that threads still
+ * holding a pointer into it are done with it. Main thread only.
+ */
+void vlib_worker_thread_defer_vec_free (void *v);
+
+/**
+ * Free deferred vectors whose grace period has elapsed. Called from the
+ * main thread's dispatch loop.
+ */
+void vlib_worker_thread_epoch_reclaim (vlib_main_t *vm);
+
+/**
+ * Grow pool *PP by N_ELTS free slots without stopping the workers: the
+ * pool is copied, the new copy is published and the old one freed after
+ * a grace period. Only safe for pools whose elements the workers do not
+ * write.
+ *
+ * Until then workers may still read elements from the old copy, as they
+ * were at the swap, and see later updates from their next loop on.
+ * Callers that free what an updated element used to reference already
+ * wait for that with vlib_worker_wait_one_loop. Element pointers taken
+ * before the call point into the old copy and must be fetched again, a
+ * write through them would be lost with it. Debug images check that the
+ * old copy is unchanged when it is freed.
+ */
+void vlib_pool_grow_deferred (void **pp, uword n_elts, uword align,
+			      uword elt_sz);
+
+/**
+ * Allocate an element E from pool P with alignment A on the main thread
+ * without a worker barrier, growing the pool via vlib_pool_grow_deferred
+ */
+#define vlib_pool_get_aligned_mt_safe(P, E, A)                                \
+  do                                                                          \
+    {                                                                         \
+      if (pool_get_will_expand (P))                                           \
+	vlib_pool_grow_deferred ((void **) &(P),                              \
+				 clib_max (pool_len (P) / 2, 32),             \
+				 _vec_align (P, A), _vec_elt_sz (P));         \
+      pool_get_aligned (P, E, A);                                             \
+    }                                                                         \
+  while (0)
+
 static_always_inline uword
 vlib_get_thread_index (void)
 {
@@ -243,6 +297,26 @@ typedef enum
     SCHED_POLICY_N,
 } sched_policy_t;
 
+typedef struct
+{
+  void *v;
+  uword n_bytes;
+  uword hash;
+} vlib_epoch_frozen_vec_t;
+
+/* A thread outside the graph, e.g. an api handler thread, which reads
+ * main thread state without taking the worker barrier */
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+
+  /* Set while the thread is inside a read section */
+  volatile u32 active;
+
+  /* Number of read sections the thread has left */
+  volatile u32 n_sections;
+} vlib_barrier_reader_t;
+
 typedef struct
 {
   /* Link list of registrations, built by constructors */
@@ -299,12 +373,81 @@ typedef struct
   /* NUMA-bound heap size */
   uword numa_heap_size;
 
+  /* Epoch based reclamation: vectors unpublished by the main thread,
+   * freed once every worker has been once around its main loop */
+  void **epoch_pending_frees;
+  void **epoch_waiting_frees;
+  u32 *epoch_loop_counts;
+  f64 epoch_wait_start;
+
+  /* Replaced pool copies, checked for stray writes when freed */
+  vlib_epoch_frozen_vec_t *epoch_frozen_vecs;
+
+  /* Barrier readers, held off by barrier syncs and waited for by the
+   * epoch reclamation, see vlib_barrier_reader_enter */
+  vlib_barrier_reader_t **barrier_readers;
+  volatile u32 barrier_readers_closed;
+  u32 *epoch_reader_sections;
+
+  /* Epoch reclamation statistics */
+  u64 epoch_n_deferred_frees;
+  u64 epoch_n_grace_periods;
+  u64 epoch_n_forced_grace_periods;
+
+  /* Workers sleep until woken up by other threads, see unix/input.c */
+  u8 tickless_sleep;
+
 } vlib_thread_main_t;
 
 extern vlib_thread_main_t vlib_thread_main;
 
 #include <vlib/global_funcs.h>
 
+/**
+ * Register a barrier reader, main thread only. A barrier reader is a
+ * thread outside the graph which reads main thread state between
+ * vlib_barrier_reader_enter and vlib_barrier_reader_leave. Barrier syncs
+ * wait until no reader is inside such a read section and keep readers
+ * out until the barrier is released, also when there are no workers.
+ * Vectors handed to vlib_worker_thread_defer_vec_free are not freed
+ * before each reader has left the read section it was in.
+ */
+vlib_barrier_reader_t *vlib_barrier_reader_alloc (void);
+void vlib_barrier_reader_free (vlib_barrier_reader_t *r);
+void vlib_barrier_reader_wait (void);
+
+static_always_inline void
+vlib_barrier_reader_enter (vlib_barrier_reader_t *r)
+{
+  vlib_thread_main_t *tm = &vlib_thread_main;
+
+  while (1)
+    {
+      /* Either the main thread sees us active or we see the barrier */
+      __atomic_store_n (&r->active, 1, __ATOMIC_SEQ_CST);
+      if (__atomic_load_n (&tm->barrier_readers_closed, __ATOMIC_SEQ_CST) ==
+	  0)
+	return;
+      __atomic_store_n (&r->active, 0, __ATOMIC_RELEASE);
+      vlib_barrier_reader_wait ();
+    }
+}
+
+static_always_inline void
+vlib_barrier_reader_leave (vlib_barrier_reader_t *r)
+{
+  __atomic_store_n (&r->active, 0, __ATOMIC_RELEASE);
+  __atomic_store_n (&r->n_sections, r->n_sections + 1, __ATOMIC_RELEASE);
+}
+
+/* The main thread is waiting for readers to leave their read sections */
+static_always_inline int
+vlib_barrier_reader_should_leave (void)
+{
+  return __atomic_load_n (&vlib_thread_main.barrier_readers_closed,
+			  __ATOMIC_RELAXED) != 0;
+}
+
 #define VLIB_REGISTER_THREAD(x,...)                     \
   __VA_ARGS__ vlib_thread_registration_t x;             \
 static void __vlib_add_thread_registration_##x (void)   \
@@ -348,6 +491,22 @@ vlib_get_current_worker_index ()
   return vlib_get_thread_index () - 1;
 }
 
+void vlib_thread_wakeup_slow (vlib_main_t *vm);
+
+/* Wake up a thread sleeping in tickless mode, after posting work for it.
+   The sleeping thread sets vm->sleeping before it checks for work, so either
+   it sees the work or we see the flag. */
+always_inline void
+vlib_thread_wakeup (vlib_main_t *vm)
+{
+  if (PREDICT_TRUE (vlib_thread_main.tickless_sleep == 0))
+    return;
+
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+  if (vm->sleeping)
+    vlib_thread_wakeup_slow (vm);
+}
+
 static inline void
 vlib_worker_thread_barrier_check (void)
 {
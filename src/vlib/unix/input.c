@@ -37,6 +37,7 @@
  *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#define _GNU_SOURCE
 #include <vlib/vlib.h>
 #include <vlib/unix/unix.h>
 #include <signal.h>
@@ -49,6 +50,14 @@
 #ifdef HAVE_LINUX_EPOLL
 
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+
+/* First tickless sleep of an idle worker. Sleeps double up to max-sleep-usec
+   while the worker stays idle, so the cpu idle governor picks shallow
+   c-states right after a burst and deep ones once the worker is really
+   idle. */
+#define LINUX_EPOLL_MIN_SLEEP 100e-6
 
 typedef struct
 {
@@ -60,6 +69,9 @@ typedef struct
   /* Statistics. */
   u64 epoll_files_ready;
   u64 epoll_waits;
+
+  /* Next tickless sleep */
+  f64 sleep_backoff;
 } linux_epoll_main_t;
 
 static linux_epoll_main_t *linux_epoll_mains = 0;
@@ -130,11 +142,40 @@ linux_epoll_file_update (clib_file_t * f, clib_file_update_type_t update_type)
     }
 }
 
+/* Tickless sleep of a worker, returns 0 if the timeout expired */
+static int
+linux_epoll_tickless_sleep (vlib_main_t *vm, linux_epoll_main_t *em,
+			    f64 timeout)
+{
+  vlib_node_main_t *nm = &vm->node_main;
+  struct pollfd pfd = { .fd = em->epoll_fd, .events = POLLIN };
+  static sigset_t unblock_all_signals;
+  struct timespec ts;
+  int n = 1;
+
+  __atomic_store_n (&vm->sleeping, 1, __ATOMIC_SEQ_CST);
+
+  /* work posted before the flag was visible does not wake us up */
+  if (*vlib_worker_threads->wait_at_barrier == 0 &&
+      vm->check_frame_queues == 0 &&
+      !clib_interrupt_is_any_pending (nm->input_node_interrupts) &&
+      !clib_interrupt_is_any_pending (nm->pre_input_node_interrupts))
+    {
+      ts.tv_sec = timeout;
+      ts.tv_nsec = (timeout - ts.tv_sec) * 1e9;
+      n = ppoll (&pfd, 1, &ts, &unblock_all_signals);
+    }
+
+  __atomic_store_n (&vm->sleeping, 0, __ATOMIC_RELAXED);
+  return n;
+}
+
 static_always_inline uword
 linux_epoll_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 			  vlib_frame_t * frame, u32 thread_index)
 {
   unix_main_t *um = &unix_main;
+  vlib_thread_main_t *tm = &vlib_thread_main;
   clib_file_main_t *fm = &file_main;
   linux_epoll_main_t *em = vec_elt_at_index (linux_epoll_mains, thread_index);
   struct epoll_event *e;
@@ -144,10 +185,11 @@ linux_epoll_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
   {
     vlib_node_main_t *nm = &vm->node_main;
     u32 ticks_until_expiration;
-    f64 timeout;
+    f64 timeout = 0;
     f64 now;
     int timeout_ms = 0, max_timeout_ms = 10;
     f64 vector_rate = vlib_last_vectors_per_main_loop (vm);
+    int tickless = 0;
 
     if (is_main == 0)
       now = vlib_time_now (vm);
@@ -196,20 +238,55 @@ linux_epoll_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 		timeout_ms = clib_min (max_timeout_ms, timeout_ms);
 	      }
 	  }
+
+	/* wake up in time for the next scheduled interrupt */
+	if (PREDICT_FALSE (vec_len (nm->scheduled_interrupts)))
+	  {
+	    f64 dt = nm->next_scheduled_interrupt - vlib_time_now (vm);
+	    if (dt < timeout)
+	      {
+		timeout = dt;
+		timeout_ms = dt < 1e-3 ? 0 : dt * 1e3;
+	      }
+	  }
 	node->input_main_loops_per_call = 0;
       }
     else if (is_main == 0 && vector_rate < 2 &&
 	     (vlib_get_first_main ()->time_last_barrier_release + 0.5 < now) &&
 	     nm->input_node_counts_by_state[VLIB_NODE_STATE_POLLING] == 0)
       {
-	timeout = 10e-3;
-	timeout_ms = max_timeout_ms;
+	tickless = tm->tickless_sleep && vm->wakeup_fd != -1;
+	if (tickless)
+	  timeout = clib_max (em->sleep_backoff, LINUX_EPOLL_MIN_SLEEP);
+	else
+	  timeout = 10e-3;
+
+	/* wake up in time for the next scheduled interrupt */
+	if (PREDICT_FALSE (vec_len (nm->scheduled_interrupts)))
+	  timeout =
+	    clib_max (0, clib_min (timeout, nm->next_scheduled_interrupt - now));
+
+	timeout_ms = timeout > 0 ? clib_max (1, timeout * 1e3) : 0;
 	node->input_main_loops_per_call = 0;
       }
     else			/* busy */
       {
 	/* Don't come back for a respectable number of dispatch cycles */
 	node->input_main_loops_per_call = 1024;
+	em->sleep_backoff = 0;
+      }
+
+    if (tickless && timeout > 0)
+      {
+	f64 max_sleep = um->max_sleep_usec * 1e-6;
+
+	if (linux_epoll_tickless_sleep (vm, em, timeout))
+	  em->sleep_backoff = 0;
+	else if (timeout >= em->sleep_backoff)
+	  em->sleep_backoff = clib_min (2 * timeout, max_sleep);
+
+	/* only pick up the events which ended the sleep */
+	timeout_ms = 0;
       }
 
     /* Allow any signal to wakeup our sleep. */
@@ -236,10 +313,10 @@ linux_epoll_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 	 * Worker thread, no epoll fd's, sleep for 100us at a time
 	 * and check for a barrier sync request
 	 */
-	if (timeout_ms)
+	if (timeout > 0)
 	  {
 	    struct timespec ts, tsrem;
-	    f64 limit = now + (f64) timeout_ms * 1e-3;
+	    f64 limit = now + timeout;
 
 	    while (vlib_time_now (vm) < limit)
 	      {
@@ -409,6 +486,49 @@ linux_epoll_input_init (vlib_main_t * vm)
 
 VLIB_INIT_FUNCTION (linux_epoll_input_init);
 
+static clib_error_t *
+linux_epoll_wakeup_read (clib_file_t *f)
+{
+  u64 n;
+
+  if (read (f->file_descriptor, &n, sizeof (n)) < 0 && errno != EAGAIN)
+    return clib_error_return_unix (0, "read");
+
+  return 0;
+}
+
+/* Create the eventfd other threads use to wake up a sleeping worker */
+static clib_error_t *
+linux_epoll_tickless_init (vlib_main_t *vm)
+{
+  clib_file_t template = { 0 };
+
+  if (vlib_thread_main.tickless_sleep == 0)
+    return 0;
+
+  for (u32 i = 1; i < vlib_get_n_threads (); i++)
+    {
+      vlib_main_t *wvm = vlib_get_main_by_index (i);
+      int fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+      if (fd < 0)
+	return clib_error_return_unix (0, "eventfd");
+
+      template.read_function = linux_epoll_wakeup_read;
+      template.file_descriptor = fd;
+      template.polling_thread_index = i;
+      template.description = format (0, "thread %u wakeup", i);
+      clib_file_add (&file_main, &template);
+      wvm->wakeup_fd = fd;
+    }
+
+  return 0;
+}
+
+VLIB_MAIN_LOOP_ENTER_FUNCTION (linux_epoll_tickless_init) = {
+  .runs_after = VLIB_INITS ("start_workers"),
+};
+
 #endif /* HAVE_LINUX_EPOLL */
 
 static clib_error_t *
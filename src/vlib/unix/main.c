@@ -377,6 +377,7 @@ unix_config (vlib_main_t * vm, unformat_input_t * input)
 
   /* Defaults */
   um->cli_pager_buffer_limit = UNIX_CLI_DEFAULT_PAGER_LIMIT;
+  um->max_sleep_usec = 100000;
   um->cli_history_limit = UNIX_CLI_DEFAULT_HISTORY;
 
   while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
@@ -407,6 +408,10 @@ unix_config (vlib_main_t * vm, unformat_input_t * input)
 	um->cli_no_pager = 1;
       else if (unformat (input, "poll-sleep-usec %d", &um->poll_sleep_usec))
 	;
+      else if (unformat (input, "tickless-sleep"))
+	vlib_thread_main.tickless_sleep = 1;
+      else if (unformat (input, "max-sleep-usec %u", &um->max_sleep_usec))
+	;
       else if (unformat (input, "cli-pager-buffer-limit %d",
 			 &um->cli_pager_buffer_limit))
 	;
@@ -630,6 +635,13 @@ unix_config (vlib_main_t * vm, unformat_input_t * input)
  *
  * @cfgcmd{poll-sleep-usec, &lt;nn&gt;}
  * Set a fixed poll sleep interval between main loop polls.
+ *
+ * @cfgcmd{tickless-sleep}
+ * Idle workers sleep until another thread posts work for them or until
+ * the next scheduled interrupt, instead of waking up every 10ms.
+ *
+ * @cfgcmd{max-sleep-usec, &lt;nn&gt;}
+ * Longest tickless sleep of an idle worker. Default value: @c 100000
 ?*/
 VLIB_EARLY_CONFIG_FUNCTION (unix_config, "unix");
 
@@ -109,6 +109,9 @@ typedef struct
 
   u32 poll_sleep_usec;
 
+  /* Longest tickless sleep of an idle worker */
+  u32 max_sleep_usec;
+
 } unix_main_t;
 
 /** CLI session events. */
@@ -134,6 +134,22 @@ vl_api_set_msg_thread_safe (api_main_t *am, u32 msg_id, int v)
   am->msg_data[msg_id].is_mp_safe = v != 0;
 }
 
+/**
+ * Mark a message handler read-only. When api threads are configured,
+ * read-only handlers run on them instead of the main thread, concurrently
+ * with it and without the worker barrier. Such a handler may only read
+ * state which the main thread changes under the worker barrier, or
+ * publishes and frees with vlib_worker_thread_defer_vec_free. It
+ * replies with vl_api_send_msg to the registration of its own client,
+ * and must not use vlib_get_main or per-thread data. Messages of the
+ * same client are handled in order.
+ */
+always_inline void
+vl_api_set_msg_read_only (api_main_t *am, u32 msg_id, int v)
+{
+  am->msg_data[msg_id].is_read_only = v != 0;
+}
+
 always_inline void
 vl_api_set_msg_autoendian (api_main_t *am, u32 msg_id, int v)
 {
@@ -250,6 +250,7 @@ typedef struct
   u8 is_autoendian : 1;	 /**< Message requires us to do endian conversion */
   u8 trace_enable : 1;	 /**< trace this message  */
   u8 replay_allowed : 1; /**< This message can be replayed  */
+  u8 is_read_only : 1;	 /**< Handler may run on an api thread */
 
 } vl_api_msg_data_t;
 
@@ -205,9 +205,10 @@ vl_msg_api_alloc (int nbytes)
   vl_shmem_hdr_t *shmem_hdr = am->shmem_hdr;
 
   /*
-   * Clients use pool-0, vlib proc uses pool 1
+   * Clients use pool-0, vlib proc uses pool 1. Pool 1 is not locked,
+   * other vlib threads, e.g. api handler threads, use pool 0.
    */
-  pool = (am->our_pid == shmem_hdr->vl_pid);
+  pool = (am->our_pid == shmem_hdr->vl_pid) && os_get_thread_index () == 0;
   return vl_msg_api_alloc_internal (am->vlib_rp, nbytes, pool,
 				    0 /* may_return_null */ );
 }
@@ -229,7 +230,7 @@ vl_msg_api_alloc_or_null (int nbytes)
   api_main_t *am = vlibapi_get_main ();
   vl_shmem_hdr_t *shmem_hdr = am->shmem_hdr;
 
-  pool = (am->our_pid == shmem_hdr->vl_pid);
+  pool = (am->our_pid == shmem_hdr->vl_pid) && os_get_thread_index () == 0;
   return vl_msg_api_alloc_internal (am->vlib_rp, nbytes, pool,
 				    1 /* may_return_null */ );
 }
@@ -24,6 +24,7 @@
 #include <vlibmemory/memory_client.h>
 #include <vlibmemory/socket_api.h>
 #include <vlibmemory/socket_client.h>
+#include <vlibmemory/api_thread.h>
 
 void vl_api_rpc_call_main_thread (void *fp, u8 * data, u32 data_length);
 void vl_api_force_rpc_call_main_thread (void *fp, u8 * data, u32 data_length);
@@ -33,6 +34,12 @@ u8 *vl_api_serialize_message_table (api_main_t * am, u8 * vector);
 always_inline void
 vl_api_send_msg (vl_api_registration_t * rp, u8 * elem)
 {
+  /* Replies from api threads are sent by the main thread */
+  if (PREDICT_FALSE (vl_api_thread_job != 0))
+    {
+      vl_api_thread_send (elem);
+      return;
+    }
   if (PREDICT_FALSE (rp->registration_type > REGISTRATION_TYPE_SHMEM))
     {
       vl_socket_api_send (rp, elem);
@@ -46,6 +53,8 @@ vl_api_send_msg (vl_api_registration_t * rp, u8 * elem)
 always_inline int
 vl_api_can_send_msg (vl_api_registration_t * rp)
 {
+  if (PREDICT_FALSE (vl_api_thread_job != 0))
+    return 1;
   if (PREDICT_FALSE (rp->registration_type > REGISTRATION_TYPE_SHMEM))
     return 1;
   else
@@ -77,6 +86,11 @@ vl_api_process_may_suspend (vlib_main_t * vm, vl_api_registration_t * rp,
 always_inline vl_api_registration_t *
 vl_api_client_index_to_registration (u32 index)
 {
+  /* An api thread only serves the client of its job, rp is not to be
+   * dereferenced there */
+  if (PREDICT_FALSE (vl_api_thread_job != 0))
+    return vl_api_thread_job->client_index == index ? vl_api_thread_job->rp :
+						      0;
   if (vl_socket_api_registration_handle_is_valid (ntohl (index)))
     return vl_socket_api_client_handle_to_registration (ntohl (index));
   return vl_mem_api_client_index_to_registration (index);
@@ -130,7 +144,8 @@ extern volatile int **vl_api_queue_cursizes;
 typedef enum vl_api_clnt_process_events
 {
   QUEUE_SIGNAL_EVENT = 1,
-  SOCKET_READ_EVENT
+  SOCKET_READ_EVENT,
+  API_THREAD_EVENT,
 } vl_api_clnt_process_events_t;
 
 #define foreach_histogram_bucket                \
@@ -149,6 +164,18 @@ typedef enum
 
 extern u64 vector_rate_histogram[];
 
+/* API handler latency histogram size, see vlib_time_log2_usec_bucket */
+#define VL_API_LATENCY_HIST_N_BUCKETS 16
+
+extern u64 vl_api_handler_latency_histogram[];
+
+static_always_inline void
+vl_api_record_handler_latency (f64 dt)
+{
+  vl_api_handler_latency_histogram[vlib_time_log2_usec_bucket (
+    dt, VL_API_LATENCY_HIST_N_BUCKETS)]++;
+}
+
 /*
  * sockclnt APIs XXX are these actually used anywhere?
  */
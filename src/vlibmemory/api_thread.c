@@ -0,0 +1,573 @@
+/*
+ * Copyright (c) 2026 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/eventfd.h>
+#include <vlib/vlib.h>
+#include <vlib/unix/unix.h>
+#include <vlibapi/api.h>
+#include <vlibmemory/api.h>
+
+vl_api_thread_main_t vl_api_thread_main;
+__thread vl_api_thread_job_t *vl_api_thread_job;
+static __thread vl_api_thread_t *vl_api_thread_self;
+
+/* Replies an api thread posts before it wakes up the main thread */
+#define VL_API_THREAD_REPLY_BATCH 32
+
+/* Replies of a job not yet sent by the main thread before the handler
+ * waits for it in vl_api_thread_yield */
+#define VL_API_THREAD_MAX_OUTSTANDING 256
+
+static void
+vl_api_thread_wake_main (vl_api_thread_main_t *tm)
+{
+  u64 one = 1;
+
+  if (__atomic_exchange_n (&tm->event_pending, 1, __ATOMIC_ACQ_REL))
+    return;
+  if (write (tm->event_fd, &one, sizeof (one)) != sizeof (one))
+    clib_unix_warning ("api thread wakeup");
+}
+
+static void
+vl_api_thread_post (vl_api_thread_main_t *tm, vl_api_thread_job_t *job,
+		    void *msg)
+{
+  vl_api_thread_out_t *o;
+
+  clib_spinlock_lock (&tm->out_lock);
+  vec_add2 (tm->out, o, 1);
+  o->job = job;
+  o->msg = msg;
+  clib_spinlock_unlock (&tm->out_lock);
+}
+
+void
+vl_api_thread_send (void *msg)
+{
+  vl_api_thread_main_t *tm = &vl_api_thread_main;
+  vl_api_thread_t *t = vl_api_thread_self;
+
+  __atomic_fetch_add (&vl_api_thread_job->n_outstanding, 1,
+		      __ATOMIC_RELAXED);
+  vl_api_thread_post (tm, vl_api_thread_job, msg);
+  if (++t->n_unflushed >= VL_API_THREAD_REPLY_BATCH)
+    {
+      t->n_unflushed = 0;
+      vl_api_thread_wake_main (tm);
+    }
+}
+
+int
+vl_api_thread_yield (void)
+{
+  vl_api_thread_main_t *tm = &vl_api_thread_main;
+  vl_api_thread_t *t = vl_api_thread_self;
+  vl_api_thread_job_t *job = vl_api_thread_job;
+
+  t->n_yields++;
+  if (t->n_unflushed)
+    {
+      t->n_unflushed = 0;
+      vl_api_thread_wake_main (tm);
+    }
+
+  if (vlib_barrier_reader_should_leave () ||
+      job->n_outstanding > VL_API_THREAD_MAX_OUTSTANDING)
+    {
+      vlib_barrier_reader_leave (t->reader);
+      /* Don't run ahead of a slow client */
+      while (job->n_outstanding > VL_API_THREAD_MAX_OUTSTANDING / 2 &&
+	     !job->client_gone)
+	{
+	  vl_api_thread_wake_main (tm);
+	  vlib_barrier_reader_wait ();
+	}
+      vlib_barrier_reader_enter (t->reader);
+    }
+
+  return job->client_gone;
+}
+
+static void *
+vl_api_thread_fn (void *arg)
+{
+  vl_api_thread_main_t *tm = &vl_api_thread_main;
+  vl_api_thread_t *t = arg;
+  vl_api_thread_job_t *job;
+  u8 *name;
+
+  os_set_thread_index (t->thread_index);
+  vlibapi_set_main (&t->am);
+  vl_api_thread_self = t;
+
+  name = format (0, "vpp_api_%u%c", t->thread_index - vlib_get_n_threads (),
+		 0);
+  vlib_set_thread_name ((char *) name);
+  vec_free (name);
+
+  while (1)
+    {
+      pthread_mutex_lock (&tm->lock);
+      while (vec_len (tm->pending) == 0)
+	pthread_cond_wait (&tm->cond, &tm->lock);
+      job = tm->pending[0];
+      vec_delete (tm->pending, 1, 0);
+      pthread_mutex_unlock (&tm->lock);
+
+      vl_api_thread_job = job;
+      vlib_barrier_reader_enter (t->reader);
+      if (!job->client_gone)
+	job->handler (job->msg);
+      vlib_barrier_reader_leave (t->reader);
+      vl_api_thread_job = 0;
+
+      t->n_jobs++;
+      t->n_unflushed = 0;
+      vl_api_thread_post (tm, job, 0 /* done */);
+      vl_api_thread_wake_main (tm);
+    }
+
+  return 0;
+}
+
+static u8 *
+vl_api_thread_copy_socket_msg (void *msg, uword msg_len)
+{
+  u8 *copy = 0;
+
+  vec_add (copy, (u8 *) msg - sizeof (msgbuf_t), sizeof (msgbuf_t) + msg_len);
+  return copy;
+}
+
+static void
+vl_api_thread_dispatch (vl_api_thread_main_t *tm, api_main_t *am,
+			vl_api_thread_client_t *c, void *msg, u8 *socket_msg,
+			vl_api_registration_t *rp)
+{
+  u16 id = clib_net_to_host_u16 (*((u16 *) msg));
+  vl_api_msg_data_t *m = vl_api_get_msg_data (am, id);
+  vl_api_thread_job_t *job;
+
+  if (PREDICT_FALSE (am->rx_trace && am->rx_trace->enabled))
+    vl_msg_api_trace (am, am->rx_trace, msg);
+
+  if (PREDICT_FALSE (am->msg_print_flag))
+    {
+      fformat (stdout, "[%d]: %s\n", id, m->name);
+      fformat (stdout, "%U", format_vl_api_msg_text, am, id, msg);
+    }
+
+  if (m->is_autoendian)
+    m->endian_handler (msg, 0);
+
+  job = clib_mem_alloc (sizeof (*job));
+  clib_memset (job, 0, sizeof (*job));
+  job->msg = msg;
+  job->socket_msg = socket_msg;
+  job->handler = m->handler;
+  job->rp = rp;
+  job->client_index = c->client_index;
+  job->msg_id = id;
+  job->dispatch_time = vlib_time_now (vlib_get_main ());
+
+  c->job = job;
+  tm->n_busy_clients++;
+  tm->n_dispatched++;
+
+  pthread_mutex_lock (&tm->lock);
+  vec_add1 (tm->pending, job);
+  pthread_cond_signal (&tm->cond);
+  pthread_mutex_unlock (&tm->lock);
+}
+
+int
+vl_api_thread_take_msg (api_main_t *am, void *msg, uword msg_len,
+			vl_api_registration_t *rp)
+{
+  vl_api_thread_main_t *tm = &vl_api_thread_main;
+  vl_api_thread_client_t *c = 0;
+  vl_api_msg_data_t *m;
+  u8 *socket_msg = 0;
+  u32 client_index;
+  uword *p;
+  u16 id;
+
+  id = clib_net_to_host_u16 (*((u16 *) msg));
+  m = vl_api_get_msg_data (am, id);
+  if (!m || !m->handler)
+    return 0;
+
+  /* Messages are only held back while their client has a job running */
+  if (!m->is_read_only && tm->n_busy_clients == 0)
+    return 0;
+
+  /* Same as the reaper function handle */
+  if (rp)
+    client_index =
+      clib_host_to_net_u32 (vl_socket_api_registration_handle (rp));
+  else
+    client_index = clib_mem_unaligned ((u8 *) msg + sizeof (u16), u32);
+
+  p = hash_get (tm->client_by_index, client_index);
+  if (p)
+    c = pool_elt_at_index (tm->clients, p[0]);
+
+  if (c && c->job)
+    {
+      if (rp)
+	msg = vl_api_thread_copy_socket_msg (msg, msg_len);
+      vec_add1 (c->held_msgs, msg);
+      vec_add1 (c->held_is_socket, rp != 0);
+      tm->n_held++;
+      return 1;
+    }
+
+  if (!m->is_read_only)
+    return 0;
+
+  if (rp)
+    {
+      /* Truncated messages are dropped by the main thread */
+      if (m->calc_size_func && m->calc_size_func (msg) > msg_len)
+	return 0;
+      socket_msg = vl_api_thread_copy_socket_msg (msg, msg_len);
+      msg = socket_msg + sizeof (msgbuf_t);
+    }
+  else if (!(rp = vl_mem_api_client_index_to_registration (client_index)))
+    return 0;
+
+  if (!c)
+    {
+      pool_get_zero (tm->clients, c);
+      c->client_index = client_index;
+      hash_set (tm->client_by_index, client_index, c - tm->clients);
+    }
+
+  vl_api_thread_dispatch (tm, am, c, msg, socket_msg, rp);
+  return 1;
+}
+
+static void
+vl_api_thread_free_held_msg (void *msg, u8 is_socket)
+{
+  u8 *copy = msg;
+
+  if (is_socket)
+    vec_free (copy);
+  else
+    vl_msg_api_free (msg);
+}
+
+static void
+vl_api_thread_client_free (vl_api_thread_main_t *tm,
+			   vl_api_thread_client_t *c)
+{
+  hash_unset (tm->client_by_index, c->client_index);
+  vec_free (c->held_msgs);
+  vec_free (c->held_is_socket);
+  pool_put (tm->clients, c);
+}
+
+/* Handle the messages held back behind a finished job, in order, until
+ * one of them is handed to an api thread again */
+static void
+vl_api_thread_replay (vlib_main_t *vm, vlib_node_runtime_t *node,
+		      u32 client_index)
+{
+  vl_api_thread_main_t *tm = &vl_api_thread_main;
+  api_main_t *am = vlibapi_get_main ();
+  vl_api_thread_client_t *c;
+  vl_api_registration_t *rp;
+  u8 is_socket;
+  void *msg;
+  uword *p;
+
+  while (1)
+    {
+      /* Handlers may delete the client, see the reaper function */
+      p = hash_get (tm->client_by_index, client_index);
+      if (!p)
+	return;
+      c = pool_elt_at_index (tm->clients, p[0]);
+      if (c->job)
+	return;
+      if (vec_len (c->held_msgs) == 0)
+	{
+	  vl_api_thread_client_free (tm, c);
+	  return;
+	}
+
+      msg = c->held_msgs[0];
+      is_socket = c->held_is_socket[0];
+      vec_delete (c->held_msgs, 1, 0);
+      vec_delete (c->held_is_socket, 1, 0);
+
+      if (is_socket)
+	{
+	  rp = vl_api_client_index_to_registration (client_index);
+	  if (rp)
+	    vl_socket_process_api_msg (rp, (i8 *) msg);
+	  vl_api_thread_free_held_msg (msg, is_socket);
+	}
+      else if (!vl_api_thread_take_msg (am, msg, 0, 0))
+	vl_mem_api_handler_with_vm_node (am, am->vlib_rp, msg, vm, node,
+					 0 /* is_private */);
+    }
+}
+
+static void
+vl_api_thread_job_done (vlib_main_t *vm, vlib_node_runtime_t *node,
+			vl_api_thread_job_t *job)
+{
+  vl_api_thread_main_t *tm = &vl_api_thread_main;
+  api_main_t *am = vlibapi_get_main ();
+  vl_api_msg_data_t *m = vl_api_get_msg_data (am, job->msg_id);
+  u32 client_index = job->client_index;
+  int replay = 0;
+  uword *p;
+
+  if (job->socket_msg)
+    vec_free (job->socket_msg);
+  else if (!m->bounce)
+    vl_msg_api_free (job->msg);
+  vl_api_record_handler_latency (vlib_time_now (vm) - job->dispatch_time);
+
+  /* A client which went away may have come back with the same index */
+  p = hash_get (tm->client_by_index, client_index);
+  if (p)
+    {
+      vl_api_thread_client_t *c = pool_elt_at_index (tm->clients, p[0]);
+      if (c->job == job)
+	{
+	  c->job = 0;
+	  tm->n_busy_clients--;
+	  replay = 1;
+	}
+    }
+
+  clib_mem_free (job);
+
+  if (replay)
+    vl_api_thread_replay (vm, node, client_index);
+}
+
+void
+vl_api_thread_process (vlib_main_t *vm, vlib_node_runtime_t *node)
+{
+  vl_api_thread_main_t *tm = &vl_api_thread_main;
+  vl_api_registration_t *rp;
+  vl_api_thread_out_t *o, *tmp;
+  vl_api_thread_job_t *job;
+
+  if (tm->n_threads == 0)
+    return;
+
+  __atomic_store_n (&tm->event_pending, 0, __ATOMIC_RELEASE);
+
+  clib_spinlock_lock (&tm->out_lock);
+  tmp = tm->out;
+  tm->out = tm->out_main;
+  tm->out_main = tmp;
+  clib_spinlock_unlock (&tm->out_lock);
+
+  vec_foreach (o, tm->out_main)
+    {
+      job = o->job;
+      if (o->msg == 0)
+	{
+	  vl_api_thread_job_done (vm, node, job);
+	  continue;
+	}
+
+      rp = 0;
+      if (!job->client_gone)
+	rp = vl_api_client_index_to_registration (job->client_index);
+      if (rp)
+	{
+	  vl_api_send_msg (rp, o->msg);
+	  tm->n_replies++;
+	}
+      else
+	{
+	  vl_msg_api_free (o->msg);
+	  tm->n_replies_dropped++;
+	}
+      __atomic_fetch_sub (&job->n_outstanding, 1, __ATOMIC_RELEASE);
+    }
+  vec_reset_length (tm->out_main);
+}
+
+static clib_error_t *
+vl_api_thread_client_reaper (u32 client_index)
+{
+  vl_api_thread_main_t *tm = &vl_api_thread_main;
+  vl_api_thread_client_t *c;
+  uword *p;
+  int i;
+
+  p = hash_get (tm->client_by_index, client_index);
+  if (!p)
+    return 0;
+
+  c = pool_elt_at_index (tm->clients, p[0]);
+  if (c->job)
+    {
+      /* The job finishes on its own, its replies are dropped */
+      c->job->client_gone = 1;
+      tm->n_busy_clients--;
+    }
+  for (i = 0; i < vec_len (c->held_msgs); i++)
+    vl_api_thread_free_held_msg (c->held_msgs[i], c->held_is_socket[i]);
+  vl_api_thread_client_free (tm, c);
+
+  return 0;
+}
+
+VL_MSG_API_REAPER_FUNCTION (vl_api_thread_client_reaper);
+
+static clib_error_t *
+vl_api_thread_event_read (clib_file_t *uf)
+{
+  u64 n;
+
+  if (read (uf->file_descriptor, &n, sizeof (n)) < 0 && errno != EAGAIN)
+    return clib_error_return_unix (0, "read");
+
+  vlib_process_signal_event (vlib_get_main (), vl_api_clnt_node.index,
+			     API_THREAD_EVENT, 0);
+  return 0;
+}
+
+clib_error_t *
+vl_api_thread_start (vlib_main_t *vm)
+{
+  vl_api_thread_main_t *tm = &vl_api_thread_main;
+  api_main_t *am = vlibapi_get_main ();
+  clib_file_t template = { 0 };
+  vl_api_thread_t *t;
+  u32 i, thread_index;
+  int rv;
+
+  if (tm->n_threads == 0)
+    return 0;
+
+  /* Thread indices after the vlib threads, each with the main heap */
+  thread_index = vlib_get_n_threads ();
+  if (thread_index + tm->n_threads > CLIB_MAX_MHEAPS)
+    {
+      tm->n_threads = 0;
+      return clib_error_return (0, "too many api threads");
+    }
+
+  tm->event_fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (tm->event_fd < 0)
+    {
+      tm->n_threads = 0;
+      return clib_error_return_unix (0, "eventfd");
+    }
+
+  template.read_function = vl_api_thread_event_read;
+  template.file_descriptor = tm->event_fd;
+  template.description = format (0, "api-threads");
+  tm->clib_file_index = clib_file_add (&file_main, &template);
+
+  clib_spinlock_init (&tm->out_lock);
+  pthread_mutex_init (&tm->lock, 0);
+  pthread_cond_init (&tm->cond, 0);
+
+  for (i = 0; i < tm->n_threads; i++)
+    {
+      t = clib_mem_alloc_aligned (sizeof (*t), CLIB_CACHE_LINE_BYTES);
+      clib_memset (t, 0, sizeof (*t));
+      t->thread_index = thread_index + i;
+      t->reader = vlib_barrier_reader_alloc ();
+
+      /* Replies are allocated in the main segment */
+      t->am = *am;
+      if (am->vlib_primary_rp)
+	{
+	  t->am.vlib_rp = am->vlib_primary_rp;
+	  t->am.shmem_hdr = (void *) am->vlib_primary_rp->user_ctx;
+	}
+
+      clib_mem_main.per_cpu_mheaps[t->thread_index] =
+	clib_mem_main.per_cpu_mheaps[0];
+      vec_add1 (tm->threads, t);
+
+      if ((rv = pthread_create (&t->thread, 0, vl_api_thread_fn, t)))
+	{
+	  /* Threads already running keep serving the queue */
+	  tm->n_threads = i;
+	  return clib_error_return (0, "api thread create failed: %d", rv);
+	}
+    }
+
+  return 0;
+}
+
+static clib_error_t *
+show_api_threads_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			     vlib_cli_command_t *cmd)
+{
+  vl_api_thread_main_t *tm = &vl_api_thread_main;
+  vl_api_thread_t *t;
+  u32 i;
+
+  if (tm->n_threads == 0)
+    {
+      vlib_cli_output (vm, "api threads disabled");
+      return 0;
+    }
+
+  vlib_cli_output (vm,
+		   "%u api threads: %llu dispatched, %llu held, "
+		   "%llu replies, %llu dropped, %u busy clients",
+		   tm->n_threads, tm->n_dispatched, tm->n_held, tm->n_replies,
+		   tm->n_replies_dropped, tm->n_busy_clients);
+  vec_foreach_index (i, tm->threads)
+    {
+      t = tm->threads[i];
+      vlib_cli_output (vm, "  api thread %u: %llu jobs, %llu yields", i,
+		       t->n_jobs, t->n_yields);
+    }
+  return 0;
+}
+
+/*?
+ * Display the number of messages handled by the api threads, see
+ * the api-queue threads startup option.
+ *
+ * @cliexpar
+ * @cliexstart{show api threads}
+ * 2 api threads: 12 dispatched, 3 held, 2048 replies, 0 dropped, 0 busy
+ * clients
+ *   api thread 0: 7 jobs, 64 yields
+ *   api thread 1: 5 jobs, 0 yields
+ * @cliexend
+?*/
+VLIB_CLI_COMMAND (show_api_threads_command, static) = {
+  .path = "show api threads",
+  .short_help = "show api threads",
+  .function = show_api_threads_command_fn,
+};
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
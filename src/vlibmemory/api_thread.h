@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2026 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef included_vlibmemory_api_thread_h
+#define included_vlibmemory_api_thread_h
+
+#include <pthread.h>
+#include <vlib/vlib.h>
+#include <vppinfra/lock.h>
+#include <vlibapi/api_common.h>
+
+/*
+ * API threads run the handlers of read-only messages, see
+ * vl_api_set_msg_read_only, next to the main thread. The main thread
+ * still receives every message, hands read-only ones to an api thread
+ * and holds back later messages of the same client until that one is
+ * done. Replies are passed back to the main thread, which sends them.
+ */
+
+/* A read-only message being handled on an api thread */
+typedef struct
+{
+  /* Message as passed to the handler */
+  void *msg;
+
+  /* Socket messages are copies, freed with vec_free, see
+   * vl_api_thread_take_msg */
+  u8 *socket_msg;
+
+  void (*handler) (void *);
+  vl_api_registration_t *rp;
+
+  /* Client index as found in the message, also the reaper handle */
+  u32 client_index;
+  u16 msg_id;
+
+  /* Set by the main thread when the client goes away */
+  volatile u8 client_gone;
+
+  /* Replies posted and not yet sent by the main thread */
+  volatile u32 n_outstanding;
+
+  f64 dispatch_time;
+} vl_api_thread_job_t;
+
+/* Reply of a job, or the end of it when msg is 0 */
+typedef struct
+{
+  vl_api_thread_job_t *job;
+  void *msg;
+} vl_api_thread_out_t;
+
+/* Per client state, main thread only */
+typedef struct
+{
+  u32 client_index;
+
+  /* Job on an api thread, if any */
+  vl_api_thread_job_t *job;
+
+  /* Messages held back until the job is done, shared memory messages
+   * or socket message copies */
+  void **held_msgs;
+  u8 *held_is_socket;
+} vl_api_thread_client_t;
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  pthread_t thread;
+  u32 thread_index;
+  vlib_barrier_reader_t *reader;
+
+  /* This thread's view of the api main, see vlibapi_set_main */
+  api_main_t am;
+
+  /* Replies posted since the main thread was last woken up */
+  u32 n_unflushed;
+
+  u64 n_jobs;
+  u64 n_yields;
+} vl_api_thread_t;
+
+typedef struct
+{
+  /* Configured number of api threads, 0 when disabled */
+  u32 n_threads;
+
+  vl_api_thread_t **threads;
+
+  /* Jobs waiting for an api thread */
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  vl_api_thread_job_t **pending;
+
+  /* Replies and finished jobs waiting for the main thread */
+  clib_spinlock_t out_lock;
+  vl_api_thread_out_t *out;
+  vl_api_thread_out_t *out_main;
+  int event_fd;
+  u32 clib_file_index;
+  volatile u32 event_pending;
+
+  /* Main thread only */
+  vl_api_thread_client_t *clients;
+  uword *client_by_index;
+  u32 n_busy_clients;
+
+  /* Statistics */
+  u64 n_dispatched;
+  u64 n_held;
+  u64 n_replies;
+  u64 n_replies_dropped;
+} vl_api_thread_main_t;
+
+extern vl_api_thread_main_t vl_api_thread_main;
+
+/* Job of the calling api thread, 0 on all other threads */
+extern __thread vl_api_thread_job_t *vl_api_thread_job;
+
+clib_error_t *vl_api_thread_start (vlib_main_t *vm);
+int vl_api_thread_take_msg (api_main_t *am, void *msg, uword msg_len,
+			    vl_api_registration_t *rp);
+void vl_api_thread_process (vlib_main_t *vm, vlib_node_runtime_t *node);
+void vl_api_thread_send (void *msg);
+int vl_api_thread_yield (void);
+
+/**
+ * Called by the main thread for each message received from the main
+ * shared memory segment, with rp set to 0, or from a socket client.
+ * Returns 1 if the message was taken: handed to an api thread or held
+ * back behind an earlier message of the same client.
+ */
+static_always_inline int
+vl_api_thread_maybe_take_msg (api_main_t *am, void *msg, uword msg_len,
+			      vl_api_registration_t *rp)
+{
+  if (PREDICT_TRUE (vl_api_thread_main.n_threads == 0))
+    return 0;
+  return vl_api_thread_take_msg (am, msg, msg_len, rp);
+}
+
+/**
+ * Lets a long running read-only handler, e.g. a dump, give way. Hands
+ * the replies sent so far to the main thread and leaves the read section
+ * for a moment when the main thread waits for the worker barrier, so
+ * pointers into main thread state must be looked up again afterwards.
+ * Returns 1 if the client went away and the handler should stop. Does
+ * nothing off api threads.
+ */
+static_always_inline int
+vl_api_thread_may_yield (void)
+{
+  if (PREDICT_TRUE (vl_api_thread_job == 0))
+    return 0;
+  return vl_api_thread_yield ();
+}
+
+#endif /* included_vlibmemory_api_thread_h */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
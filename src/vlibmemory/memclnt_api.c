@@ -27,6 +27,7 @@
 #include <vppinfra/elog.h>
 #include <vlib/vlib.h>
 #include <vlib/unix/unix.h>
+#include <vlib/stats/stats.h>
 #include <vlibapi/api.h>
 #include <vlibmemory/api.h>
 #include <vlibapi/api_helper_macros.h>
@@ -235,6 +236,34 @@ vlib_api_init (void)
 }
 
 u64 vector_rate_histogram[SLEEP_N_BUCKETS];
+u64 vl_api_handler_latency_histogram[VL_API_LATENCY_HIST_N_BUCKETS];
+
+static void
+vl_api_latency_collector_fn (vlib_stats_collector_data_t *d)
+{
+  counter_t **counters = d->entry->data;
+  counter_t *cb = counters[0];
+  int i;
+
+  for (i = 0; i < VL_API_LATENCY_HIST_N_BUCKETS; i++)
+    cb[i] = vl_api_handler_latency_histogram[i];
+}
+
+static clib_error_t *
+vl_api_latency_stats_init (vlib_main_t *vm)
+{
+  vlib_stats_collector_reg_t reg = {};
+
+  /* API handler latency histogram (log2 us buckets) */
+  reg.collect_fn = vl_api_latency_collector_fn;
+  reg.entry_index = vlib_stats_add_counter_vector ("/sys/api/latency");
+  vlib_stats_validate (reg.entry_index, 0, VL_API_LATENCY_HIST_N_BUCKETS - 1);
+  vlib_stats_register_collector_fn (&reg);
+
+  return 0;
+}
+
+VLIB_INIT_FUNCTION (vl_api_latency_stats_init);
 
 /*
  * Callback to send ourselves a plugin numbering-space trace msg
@@ -348,6 +377,9 @@ vl_api_clnt_process (vlib_main_t *vm, vlib_node_runtime_t *node,
   shm = am->shmem_hdr;
   q = shm->vl_input_queue;
 
+  if ((error = vl_api_thread_start (vm)))
+    clib_error_report (error);
+
   e = vlib_call_init_exit_functions (vm, &vgm->api_init_function_registrations,
 				     1 /* call_once */, 1 /* is_global */);
   if (e)
@@ -391,6 +423,7 @@ vl_api_clnt_process (vlib_main_t *vm, vlib_node_runtime_t *node,
        */
       vector_rate = (f64) vlib_last_vectors_per_main_loop (vm);
       start_time = vlib_time_now (vm);
+      vl_api_thread_process (vm, node);
       while (1)
 	{
 	  if (vl_mem_api_handle_rpc (vm, node) ||
@@ -470,6 +503,10 @@ vl_api_clnt_process (vlib_main_t *vm, vlib_node_runtime_t *node,
 	    }
 	  break;
 
+	case API_THREAD_EVENT:
+	  vl_api_thread_process (vm, node);
+	  break;
+
 	  /* Timeout... */
 	case -1:
 	  break;
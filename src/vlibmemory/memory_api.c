@@ -762,7 +762,7 @@ vl_mem_api_dead_client_scan (api_main_t * am, vl_shmem_hdr_t * shm, f64 now)
 void (*vl_mem_api_fuzz_hook) (u16, void *);
 
 /* This is only to be called from a vlib/vnet app */
-static void
+void
 vl_mem_api_handler_with_vm_node (api_main_t *am, svm_region_t *vlib_rp,
 				 void *the_msg, vlib_main_t *vm,
 				 vlib_node_runtime_t *node, u8 is_private)
@@ -773,6 +773,7 @@ vl_mem_api_handler_with_vm_node (api_main_t *am, svm_region_t *vlib_rp,
   svm_region_t *old_vlib_rp;
   void *save_shmem_hdr;
   int is_mp_safe = 1;
+  f64 t0 = 0;
 
   if (PREDICT_FALSE (am->elog_trace_api_messages))
     {
@@ -804,6 +805,7 @@ vl_mem_api_handler_with_vm_node (api_main_t *am, svm_region_t *vlib_rp,
 	  fformat (stdout, "%U", format_vl_api_msg_text, am, id, the_msg);
 	}
       is_mp_safe = am->msg_data[id].is_mp_safe;
+      t0 = vlib_time_now (vm);
 
       if (!is_mp_safe)
 	{
@@ -841,6 +843,7 @@ vl_mem_api_handler_with_vm_node (api_main_t *am, svm_region_t *vlib_rp,
 	}
       if (!is_mp_safe)
 	vl_msg_api_barrier_release ();
+      vl_api_record_handler_latency (vlib_time_now (vm) - t0);
     }
   else
     {
@@ -897,19 +900,72 @@ void_mem_api_handle_msg_i (api_main_t * am, svm_region_t * vlib_rp,
 			   vlib_main_t * vm, vlib_node_runtime_t * node,
 			   u8 is_private)
 {
+  uword mps[VL_MEM_API_RX_BATCH_SIZE];
+  u8 needs_barrier[VL_MEM_API_RX_BATCH_SIZE];
+  vl_api_msg_data_t *m;
+  int i, n_msgs, barrier_held = 0;
   svm_queue_t *q;
-  uword mp;
+  u16 id;
 
   q = ((vl_shmem_hdr_t *) (void *) vlib_rp->user_ctx)->vl_input_queue;
 
-  if (!svm_queue_sub2 (q, (u8 *) & mp))
+  /* Drain a batch under a single queue lock */
+  n_msgs = svm_queue_sub_batch (q, (u8 *) mps, VL_MEM_API_RX_BATCH_SIZE);
+  if (!n_msgs)
+    return -1;
+
+  for (i = 0; i < n_msgs; i++)
+    {
+      VL_MSG_API_UNPOISON ((void *) mps[i]);
+      id = clib_net_to_host_u16 (*((u16 *) mps[i]));
+      m = vl_api_get_msg_data (am, id);
+      needs_barrier[i] = m && m->handler && !m->is_mp_safe;
+    }
+
+  for (i = 0; i < n_msgs; i++)
     {
-      VL_MSG_API_UNPOISON ((void *) mp);
-      vl_mem_api_handler_with_vm_node (am, vlib_rp, (void *) mp, vm, node,
+      /*
+       * Hold the worker barrier across a run of consecutive messages which
+       * need it instead of syncing once per message, the barrier is
+       * recursive so their own syncs collapse into this one. mp-safe
+       * handlers always run without it.
+       */
+      if (needs_barrier[i] && !barrier_held && i + 1 < n_msgs &&
+	  needs_barrier[i + 1])
+	{
+	  vl_msg_api_barrier_trace_context ("api-rx-batch");
+	  vl_msg_api_barrier_sync ();
+	  barrier_held = 1;
+	}
+      else if (!needs_barrier[i] && barrier_held)
+	{
+	  vl_msg_api_barrier_release ();
+	  barrier_held = 0;
+	}
+
+      id = clib_net_to_host_u16 (*((u16 *) mps[i]));
+      if (!is_private &&
+	  vl_api_thread_maybe_take_msg (am, (void *) mps[i], 0, 0))
+	continue;
+      vl_mem_api_handler_with_vm_node (am, vlib_rp, (void *) mps[i], vm, node,
 				       is_private);
-      return 0;
+
+      if (PREDICT_FALSE (id == VL_API_MEMCLNT_DELETE))
+	{
+	  if (barrier_held)
+	    vl_msg_api_barrier_release ();
+	  barrier_held = 0;
+	  /* a private segment is unmapped with its client, the rest of the
+	     batch went with it */
+	  if (is_private)
+	    return 0;
+	}
     }
-  return -1;
+
+  if (barrier_held)
+    vl_msg_api_barrier_release ();
+
+  return 0;
 }
 
 int
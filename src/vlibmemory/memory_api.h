@@ -25,6 +25,9 @@
 #include <vlibapi/api.h>
 #include <vlibapi/memory_shared.h>
 
+/** Max messages dequeued from an input queue per handler invocation */
+#define VL_MEM_API_RX_BATCH_SIZE 32
+
 svm_queue_t *vl_api_client_index_to_input_queue (u32 index);
 int vl_mem_api_init (const char *region_name);
 void vl_mem_api_dead_client_scan (api_main_t * am, vl_shmem_hdr_t * shm,
@@ -33,6 +36,9 @@ int vl_mem_api_handle_msg_main (vlib_main_t * vm, vlib_node_runtime_t * node);
 int vl_mem_api_handle_msg_private (vlib_main_t * vm,
 				   vlib_node_runtime_t * node, u32 reg_index);
 int vl_mem_api_handle_rpc (vlib_main_t * vm, vlib_node_runtime_t * node);
+void vl_mem_api_handler_with_vm_node (api_main_t *am, svm_region_t *vlib_rp,
+				      void *the_msg, vlib_main_t *vm,
+				      vlib_node_runtime_t *node, u8 is_private);
 
 vl_api_registration_t *vl_mem_api_client_index_to_registration (u32 handle);
 void vl_mem_api_enable_disable (vlib_main_t * vm, int yesno);
@@ -65,6 +65,12 @@ socket_api_registration_handle_to_index (u32 reg_index)
   return (reg_index & ~SOCK_API_REG_HANDLE_BIT);
 }
 
+u32
+vl_socket_api_registration_handle (vl_api_registration_t *regp)
+{
+  return sock_api_registration_handle (regp);
+}
+
 u8
 vl_socket_api_registration_handle_is_valid (u32 reg_handle)
 {
@@ -200,10 +206,19 @@ vl_socket_process_api_msg (vl_api_registration_t * rp, i8 * input_v)
 {
   msgbuf_t *mbp = (msgbuf_t *) input_v;
 
+  vlib_main_t *vm = vlib_get_main ();
   u8 *the_msg = (u8 *) (mbp->data);
+  f64 t0;
+
+  if (vl_api_thread_maybe_take_msg (vlibapi_get_main (), the_msg,
+				    ntohl (mbp->data_len), rp))
+    return;
+
+  t0 = vlib_time_now (vm);
   socket_main.current_rp = rp;
   vl_msg_api_socket_handler (the_msg, ntohl (mbp->data_len));
   socket_main.current_rp = 0;
+  vl_api_record_handler_latency (vlib_time_now (vm) - t0);
 }
 
 int
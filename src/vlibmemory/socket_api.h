@@ -85,6 +85,7 @@ clib_error_t *vl_sock_api_recv_fd_msg (int socket_fd, int fds[], int n_fds,
 
 vl_api_registration_t *vl_socket_api_client_handle_to_registration (u32 idx);
 u8 vl_socket_api_registration_handle_is_valid (u32 reg_index);
+u32 vl_socket_api_registration_handle (vl_api_registration_t *regp);
 
 #endif /* SRC_VLIBMEMORY_SOCKET_API_H_ */
 
@@ -37,11 +37,9 @@ vl_api_show_histogram_command (vlib_main_t * vm,
     }
 
   if (total_counts == 0)
+    vlib_cli_output (vm, "No control-plane activity.");
+  else
     {
-      vlib_cli_output (vm, "No control-plane activity.");
-      return 0;
-    }
-
 #define _(n)                                                    \
     do {                                                        \
         f64 percent;                                            \
@@ -52,14 +50,39 @@ vl_api_show_histogram_command (vlib_main_t * vm,
                          vector_rate_histogram[SLEEP_##n##_US], \
                          percent);                              \
     } while (0);
-  foreach_histogram_bucket;
+      foreach_histogram_bucket;
 #undef _
+    }
+
+  total_counts = 0;
+  for (i = 0; i < VL_API_LATENCY_HIST_N_BUCKETS; i++)
+    total_counts += vl_api_handler_latency_histogram[i];
+
+  if (total_counts == 0)
+    {
+      vlib_cli_output (vm, "No api handler activity.");
+      return 0;
+    }
+
+  vlib_cli_output (vm, "Handler latency:");
+  for (i = 0; i < VL_API_LATENCY_HIST_N_BUCKETS; i++)
+    {
+      u64 count = vl_api_handler_latency_histogram[i];
+      if (count == 0)
+	continue;
+      if (i == 0)
+	vlib_cli_output (vm, "  %10s: %llu, %.2f%%", "< 1 us", count,
+			 100.0 * count / total_counts);
+      else
+	vlib_cli_output (vm, "  >= %6llu us: %llu, %.2f%%", 1ULL << (i - 1),
+			 count, 100.0 * count / total_counts);
+    }
 
   return 0;
 }
 
 /*?
- * Display the binary api sleep-time histogram
+ * Display the binary api sleep-time and handler latency histograms
 ?*/
 VLIB_CLI_COMMAND (cli_show_api_histogram_command, static) =
 {
@@ -77,11 +100,13 @@ vl_api_clear_histogram_command (vlib_main_t * vm,
 
   for (i = 0; i < SLEEP_N_BUCKETS; i++)
     vector_rate_histogram[i] = 0;
+  for (i = 0; i < VL_API_LATENCY_HIST_N_BUCKETS; i++)
+    vl_api_handler_latency_histogram[i] = 0;
   return 0;
 }
 
 /*?
- * Clear the binary api sleep-time histogram
+ * Clear the binary api sleep-time and handler latency histograms
 ?*/
 VLIB_CLI_COMMAND (cli_clear_api_histogram_command, static) =
 {
@@ -1195,6 +1220,8 @@ api_queue_config_fn (vlib_main_t * vm, unformat_input_t * input)
 	    clib_warning ("vlib input queue length %d too small, ignored",
 			  nitems);
 	}
+      else if (unformat (input, "threads %u", &vl_api_thread_main.n_threads))
+	;
       else
 	return clib_error_return (0, "unknown input `%U'",
 				  format_unformat_error, input);
@@ -60,7 +60,21 @@ vnet_dev_rx_queue_alloc (vlib_main_t *vm, vnet_dev_port_t *port,
 
   if (n_threads > 1)
     {
-      rxq->rx_thread_index = dm->next_rx_queue_thread++;
+      u32 ti = rxq->rx_thread_index = dm->next_rx_queue_thread;
+
+      /* prefer the next worker on the numa node of the device */
+      for (u32 i = 1; i < n_threads; i++)
+	{
+	  if (vlib_worker_threads[ti].numa_id == dev->numa_node)
+	    {
+	      rxq->rx_thread_index = ti;
+	      break;
+	    }
+	  if (++ti >= n_threads)
+	    ti = 1;
+	}
+
+      dm->next_rx_queue_thread = rxq->rx_thread_index + 1;
       if (dm->next_rx_queue_thread >= n_threads)
 	dm->next_rx_queue_thread = 1;
     }
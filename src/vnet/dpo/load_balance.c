@@ -100,28 +100,26 @@ load_balance_alloc_i (void)
     vlib_main_t *vm = vlib_get_main();
     ASSERT (vm->thread_index == 0);
 
-    need_barrier_sync = pool_get_will_expand (load_balance_pool);
-
-    if (need_barrier_sync)
-        vlib_worker_thread_barrier_sync (vm);
-
-    pool_get_aligned(load_balance_pool, lb, CLIB_CACHE_LINE_BYTES);
+    /*
+     * The pool grows without a barrier; the old copy is freed once the
+     * workers have moved on. The workers increment the counters, so those
+     * still need the barrier if they will expand.
+     */
+    vlib_pool_get_aligned_mt_safe(load_balance_pool, lb,
+                                  CLIB_CACHE_LINE_BYTES);
     clib_memset(lb, 0, sizeof(*lb));
 
     lb->lb_map = INDEX_INVALID;
     lb->lb_urpf = INDEX_INVALID;
 
-    if (need_barrier_sync == 0)
-    {
-        need_barrier_sync += vlib_validate_combined_counter_will_expand
-            (&(load_balance_main.lbm_to_counters),
-             load_balance_get_index(lb));
-        need_barrier_sync += vlib_validate_combined_counter_will_expand
-            (&(load_balance_main.lbm_via_counters),
-             load_balance_get_index(lb));
-        if (need_barrier_sync)
-            vlib_worker_thread_barrier_sync (vm);
-    }
+    need_barrier_sync += vlib_validate_combined_counter_will_expand
+        (&(load_balance_main.lbm_to_counters),
+         load_balance_get_index(lb));
+    need_barrier_sync += vlib_validate_combined_counter_will_expand
+        (&(load_balance_main.lbm_via_counters),
+         load_balance_get_index(lb));
+    if (need_barrier_sync)
+        vlib_worker_thread_barrier_sync (vm);
 
     vlib_validate_combined_counter(&(load_balance_main.lbm_to_counters),
                                    load_balance_get_index(lb));
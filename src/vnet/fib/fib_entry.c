@@ -537,17 +537,10 @@ fib_entry_alloc (u32 fib_index,
 {
     fib_entry_t *fib_entry;
     fib_prefix_t *fep;
-    u8 need_barrier_sync = pool_get_will_expand (fib_entry_pool);
-    vlib_main_t *vm = vlib_get_main();
-    ASSERT (vm->thread_index == 0);
+    ASSERT (vlib_get_thread_index () == 0);
 
-    if (need_barrier_sync)
-        vlib_worker_thread_barrier_sync (vm);
-
-    pool_get(fib_entry_pool, fib_entry);
-
-    if (need_barrier_sync)
-        vlib_worker_thread_barrier_release (vm);
+    /* workers may be reading the pool; grow it without the barrier */
+    vlib_pool_get_aligned_mt_safe(fib_entry_pool, fib_entry, 0);
 
     clib_memset(fib_entry, 0, sizeof(*fib_entry));
 
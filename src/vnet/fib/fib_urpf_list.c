@@ -55,17 +55,10 @@ index_t
 fib_urpf_list_alloc_and_lock (void)
 {
     fib_urpf_list_t *urpf;
-    u8 need_barrier_sync = pool_get_will_expand (fib_urpf_list_pool);
-    vlib_main_t *vm = vlib_get_main();
-    ASSERT (vm->thread_index == 0);
+    ASSERT (vlib_get_thread_index () == 0);
 
-    if (need_barrier_sync)
-        vlib_worker_thread_barrier_sync (vm);
-
-    pool_get(fib_urpf_list_pool, urpf);
-
-    if (need_barrier_sync)
-        vlib_worker_thread_barrier_release (vm);
+    /* workers may be reading the pool; grow it without the barrier */
+    vlib_pool_get_aligned_mt_safe(fib_urpf_list_pool, urpf, 0);
 
     clib_memset(urpf, 0, sizeof(*urpf));
 
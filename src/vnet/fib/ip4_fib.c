@@ -333,6 +333,7 @@ ip4_show_fib (vlib_main_t * vm,
     ip4_main_t * im4 = &ip4_main;
     u64 total_mtrie_memory, total_hash_memory;
     int verbose, matching, mtrie, memory;
+    uword mtrie_size;
     ip4_address_t matching_address;
     u32 fib_index, matching_mask = 32;
     int i, table_id = -1, user_fib_index = ~0;
@@ -387,7 +388,7 @@ ip4_show_fib (vlib_main_t * vm,
 
         if (memory)
         {
-            uword mtrie_size, hash_size;
+            uword hash_size;
 
 
             mtrie_size = ip4_mtrie_memory_usage(&fib->mtrie);
@@ -450,6 +451,10 @@ ip4_show_fib (vlib_main_t * vm,
 		if (n_elts > 0)
 		    vlib_cli_output (vm, "%20d%16d", i, n_elts);
 	    }
+            mtrie_size = ip4_mtrie_memory_usage(&fib->mtrie);
+            total_mtrie_memory += mtrie_size;
+            vlib_cli_output (vm, "  mtrie memory: %U", format_memory_size,
+                             mtrie_size);
 	    continue;
 	}
 
@@ -471,6 +476,13 @@ ip4_show_fib (vlib_main_t * vm,
                          total_hash_memory,
                          total_mtrie_memory + total_hash_memory);
     }
+    else if (!verbose && !mtrie)
+    {
+        vlib_cli_output (vm, "mtrie memory: %U, ply pool: %d in use, %d free",
+                         format_memory_size, total_mtrie_memory,
+                         pool_elts (ip4_ply_pool),
+                         pool_free_elts (ip4_ply_pool));
+    }
     return 0;
 }
 
@@ -610,12 +622,15 @@ ip4_show_fib (vlib_main_t * vm,
  *                    0               1
  *                    8               2
  *                   32               4
+ *   mtrie memory: 320.00k
  * ipv4-VRF:7, fib_index 1, flow hash: src dst sport dport proto
  *     Prefix length         Count
  *                    0               1
  *                    8               2
  *                   24               2
  *                   32               4
+ *   mtrie memory: 324.06k
+ * mtrie memory: 644.06k, ply pool: 3 in use, 0 free
  * @cliexend
  ?*/
 VLIB_CLI_COMMAND (ip4_show_fib_command, static) = {
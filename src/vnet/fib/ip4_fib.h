@@ -313,4 +313,44 @@ ip4_fib_forwarding_lookup_x4 (u32 fib_index0,
 
 #endif
 
+#ifdef IP4_MTRIE_HAVE_LOOKUP_X8
+/**
+ * @brief Forwarding lookup of eight destinations at once.
+ *
+ * The root stride is taken per lane, since each lane may use a different
+ * FIB, the remaining strides walk all eight lanes with gathers from the
+ * shared ply pool. Callers must check ip4_mtrie_lookup_x8_ok() first.
+ */
+static_always_inline void
+ip4_fib_forwarding_lookup_x8 (const u32 *fib_index,
+                              const ip4_address_t **addr,
+                              index_t *lb)
+{
+    u32x8 leaf, dst;
+    int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        dst[i] = addr[i]->as_u32;
+#ifdef VPP_IP_FIB_MTRIE_16
+        leaf[i] = ip4_mtrie_16_lookup_step_one (
+            &ip4_fib_get(fib_index[i])->mtrie, addr[i]);
+#else
+        leaf[i] = ip4_mtrie_8_lookup_step_one (
+            &ip4_fib_get(fib_index[i])->mtrie, addr[i]);
+#endif
+    }
+
+    /* network order: byte N of the address is bits [8N, 8N + 8) */
+#ifndef VPP_IP_FIB_MTRIE_16
+    leaf = ip4_mtrie_lookup_step_x8 (leaf, (dst >> 8) & 0xff);
+#endif
+    leaf = ip4_mtrie_lookup_step_x8 (leaf, (dst >> 16) & 0xff);
+    leaf = ip4_mtrie_lookup_step_x8 (leaf, dst >> 24);
+
+    ASSERT (u32x8_is_all_equal (leaf & 1, 1));
+    u32x8_store_unaligned (leaf >> 1, lb);
+}
+#endif
+
 #endif
@@ -19,11 +19,17 @@
 #include <vlib/threads.h>
 #include <vnet/feature/feature.h>
 
+/* indirection table size used by most NICs, filled round robin */
+#define HANDOFF_RSS_TABLE_SIZE 128
+
 typedef struct
 {
   vnet_hash_fn_t hash_fn;
   uword *workers_bitmap;
   u32 *workers;
+
+  /* rss emulation, hash to index into workers */
+  u16 *rss_table;
 } per_inteface_handoff_data_t;
 
 typedef struct
@@ -113,36 +119,57 @@ VLIB_NODE_FN (worker_handoff_node) (vlib_main_t * vm,
 {
   handoff_main_t *hm = &handoff_main;
   vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
-  u32 n_enq, n_left_from, *from;
+  per_inteface_handoff_data_t *ihd = 0;
+  void *data[VLIB_FRAME_SIZE];
+  u32 hashes[VLIB_FRAME_SIZE], *h;
+  u32 n_enq, n_left_from, *from, sw_if_index, i;
   u16 thread_indices[VLIB_FRAME_SIZE], *ti;
 
   from = vlib_frame_vector_args (frame);
   n_left_from = frame->n_vectors;
   vlib_get_buffers (vm, from, bufs, n_left_from);
 
+  /* frames usually come from a single interface, hash them in one call so
+     hash functions can work on several packets at once */
+  sw_if_index = vnet_buffer (bufs[0])->sw_if_index[VLIB_RX];
+  for (i = 0; i < n_left_from; i++)
+    {
+      data[i] = vlib_buffer_get_current (bufs[i]);
+      if (vnet_buffer (bufs[i])->sw_if_index[VLIB_RX] != sw_if_index)
+	sw_if_index = ~0;
+    }
+
+  if (PREDICT_TRUE (sw_if_index != ~0))
+    {
+      ihd = vec_elt_at_index (hm->if_data, sw_if_index);
+      ihd->hash_fn (data, hashes, n_left_from);
+    }
+
   b = bufs;
   ti = thread_indices;
+  h = hashes;
+  i = 0;
 
   while (n_left_from > 0)
     {
-      per_inteface_handoff_data_t *ihd0;
-      u32 sw_if_index0, hash, index0;
-      void *data;
+      per_inteface_handoff_data_t *ihd0 = ihd;
+      u32 index0;
 
-      sw_if_index0 = vnet_buffer (b[0])->sw_if_index[VLIB_RX];
-      ihd0 = vec_elt_at_index (hm->if_data, sw_if_index0);
-
-      /* Compute ingress LB hash */
-      data = vlib_buffer_get_current (b[0]);
-      ihd0->hash_fn (&data, &hash, 1);
+      if (PREDICT_FALSE (ihd0 == 0))
+	{
+	  u32 sw_if_index0 = vnet_buffer (b[0])->sw_if_index[VLIB_RX];
+	  ihd0 = vec_elt_at_index (hm->if_data, sw_if_index0);
 
-      /* if input node did not specify next index, then packet
-         should go to ethernet-input */
+	  /* Compute ingress LB hash */
+	  ihd0->hash_fn (data + i, h, 1);
+	}
 
-      if (PREDICT_TRUE (is_pow2 (vec_len (ihd0->workers))))
-	index0 = hash & (vec_len (ihd0->workers) - 1);
+      if (ihd0->rss_table)
+	index0 = ihd0->rss_table[h[0] & (HANDOFF_RSS_TABLE_SIZE - 1)];
+      else if (PREDICT_TRUE (is_pow2 (vec_len (ihd0->workers))))
+	index0 = h[0] & (vec_len (ihd0->workers) - 1);
       else
-	index0 = hash % vec_len (ihd0->workers);
+	index0 = h[0] % vec_len (ihd0->workers);
 
       ti[0] = hm->first_worker_index + ihd0->workers[index0];
 
@@ -150,6 +177,8 @@ VLIB_NODE_FN (worker_handoff_node) (vlib_main_t * vm,
       n_left_from -= 1;
       ti += 1;
       b += 1;
+      h += 1;
+      i += 1;
     }
 
   if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE))
@@ -185,7 +214,7 @@ VLIB_REGISTER_NODE (worker_handoff_node) = {
 int
 interface_handoff_enable_disable (vlib_main_t *vm, u32 sw_if_index,
 				  uword *bitmap, u8 is_sym, int is_l4,
-				  int enable_disable)
+				  int is_rss, int enable_disable)
 {
   handoff_main_t *hm = &handoff_main;
   vnet_sw_interface_t *sw;
@@ -214,6 +243,7 @@ interface_handoff_enable_disable (vlib_main_t *vm, u32 sw_if_index,
 
   vec_free (d->workers);
   vec_free (d->workers_bitmap);
+  vec_free (d->rss_table);
 
   if (enable_disable)
     {
@@ -223,7 +253,20 @@ interface_handoff_enable_disable (vlib_main_t *vm, u32 sw_if_index,
 	  vec_add1(d->workers, i);
 	}
 
-      if (is_sym)
+      if (is_rss)
+	{
+	  /* same hash and queue selection as a NIC with default RSS config,
+	     so flows land on the same worker with or without hardware RSS */
+	  if (is_sym)
+	    return VNET_API_ERROR_UNIMPLEMENTED;
+
+	  d->hash_fn = vnet_hash_function_from_name (
+	    "toeplitz", VNET_HASH_FN_TYPE_ETHERNET);
+	  vec_validate (d->rss_table, HANDOFF_RSS_TABLE_SIZE - 1);
+	  for (i = 0; i < HANDOFF_RSS_TABLE_SIZE; i++)
+	    d->rss_table[i] = i % vec_len (d->workers);
+	}
+      else if (is_sym)
 	{
 	  if (is_l4)
 	    return VNET_API_ERROR_UNIMPLEMENTED;
@@ -254,7 +297,7 @@ set_interface_handoff_command_fn (vlib_main_t * vm,
 				  unformat_input_t * input,
 				  vlib_cli_command_t * cmd)
 {
-  u32 sw_if_index = ~0, is_sym = 0, is_l4 = 0;
+  u32 sw_if_index = ~0, is_sym = 0, is_l4 = 0, is_rss = 0;
   int enable_disable = 1;
   uword *bitmap = 0;
   int rv = 0;
@@ -274,6 +317,8 @@ set_interface_handoff_command_fn (vlib_main_t * vm,
 	is_sym = 0;
       else if (unformat (input, "l4"))
 	is_l4 = 1;
+      else if (unformat (input, "rss"))
+	is_rss = 1;
       else
 	break;
     }
@@ -285,7 +330,7 @@ set_interface_handoff_command_fn (vlib_main_t * vm,
     return clib_error_return (0, "Please specify list of workers...");
 
   rv = interface_handoff_enable_disable (vm, sw_if_index, bitmap, is_sym,
-					 is_l4, enable_disable);
+					 is_l4, is_rss, enable_disable);
 
   switch (rv)
     {
@@ -301,6 +346,8 @@ set_interface_handoff_command_fn (vlib_main_t * vm,
       break;
 
     case VNET_API_ERROR_UNIMPLEMENTED:
+      if (is_rss)
+	return clib_error_return (0, "rss is not symmetrical");
       return clib_error_return (0,
 				"Device driver doesn't support redirection");
       break;
@@ -315,7 +362,7 @@ set_interface_handoff_command_fn (vlib_main_t * vm,
 VLIB_CLI_COMMAND (set_interface_handoff_command, static) = {
   .path = "set interface handoff",
   .short_help = "set interface handoff <interface-name> workers <workers-list>"
-		" [symmetrical|asymmetrical]",
+		" [symmetrical|asymmetrical] [rss]",
   .function = set_interface_handoff_command_fn,
 };
 
@@ -0,0 +1,204 @@
+/* SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Toeplitz hash over the same fields NICs use for RSS: IPv4 or IPv6
+ * source and destination address, followed by TCP or UDP ports unless the
+ * packet is a fragment. With the default (Microsoft) key the result is the
+ * same as the hash computed by hardware RSS with its default key, so
+ * software and hardware steering agree on the flow to queue mapping.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/ethernet/ethernet.h>
+#include <vnet/ip/ip4_packet.h>
+#include <vnet/ip/ip6_packet.h>
+#include <vnet/hash/hash.h>
+#include <vppinfra/vector/toeplitz.h>
+
+/* addresses and ports of an IPv6 packet */
+#define TOEPLITZ_TUPLE_MAX_BYTES 36
+
+typedef struct
+{
+  u8 data[TOEPLITZ_TUPLE_MAX_BYTES];
+  u8 n_bytes;
+} vnet_toeplitz_tuple_t;
+
+extern clib_toeplitz_hash_key_t *vnet_toeplitz_hash_key;
+
+static_always_inline u8
+toeplitz_l4_has_ports (u8 protocol)
+{
+  return protocol == IP_PROTOCOL_TCP || protocol == IP_PROTOCOL_UDP;
+}
+
+static_always_inline void
+toeplitz_tuple_ip4 (ip4_header_t *ip, vnet_toeplitz_tuple_t *t)
+{
+  clib_memcpy_fast (t->data, &ip->src_address, 8);
+  t->n_bytes = 8;
+
+  if (toeplitz_l4_has_ports (ip->protocol) && !ip4_is_fragment (ip))
+    {
+      clib_memcpy_fast (t->data + 8, ip4_next_header (ip), 4);
+      t->n_bytes = 12;
+    }
+}
+
+static_always_inline void
+toeplitz_tuple_ip6 (ip6_header_t *ip, vnet_toeplitz_tuple_t *t)
+{
+  clib_memcpy_fast (t->data, &ip->src_address, 32);
+  t->n_bytes = 32;
+
+  if (toeplitz_l4_has_ports (ip->protocol))
+    {
+      clib_memcpy_fast (t->data + 32, ip6_next_header (ip), 4);
+      t->n_bytes = 36;
+    }
+}
+
+static_always_inline void
+toeplitz_tuple_ip (void *p, vnet_toeplitz_tuple_t *t)
+{
+  t->n_bytes = 0;
+  if ((((u8 *) p)[0] & 0xf0) == 0x40)
+    toeplitz_tuple_ip4 (p, t);
+  else if ((((u8 *) p)[0] & 0xf0) == 0x60)
+    toeplitz_tuple_ip6 (p, t);
+}
+
+static_always_inline void
+toeplitz_tuple_ethernet (void *p, vnet_toeplitz_tuple_t *t)
+{
+  ethernet_header_t *eh = p;
+  u16 ethertype = clib_net_to_host_u16 (eh->type);
+  u16 l2hdr_sz = sizeof (ethernet_header_t);
+
+  if (ethernet_frame_is_tagged (ethertype))
+    {
+      ethernet_vlan_header_t *vlan = (ethernet_vlan_header_t *) (eh + 1);
+
+      ethertype = clib_net_to_host_u16 (vlan->type);
+      l2hdr_sz += sizeof (*vlan);
+      while (ethernet_frame_is_tagged (ethertype))
+	{
+	  vlan++;
+	  ethertype = clib_net_to_host_u16 (vlan->type);
+	  l2hdr_sz += sizeof (*vlan);
+	}
+    }
+
+  t->n_bytes = 0;
+  if (ethertype == ETHERNET_TYPE_IP4)
+    toeplitz_tuple_ip4 (p + l2hdr_sz, t);
+  else if (ethertype == ETHERNET_TYPE_IP6)
+    toeplitz_tuple_ip6 (p + l2hdr_sz, t);
+}
+
+static_always_inline u32
+toeplitz_hash_one (clib_toeplitz_hash_key_t *k, vnet_toeplitz_tuple_t *t)
+{
+  return t->n_bytes ? clib_toeplitz_hash (k, t->data, t->n_bytes) : 0;
+}
+
+static_always_inline void
+toeplitz_hash_inline (void **p, u32 *hash, u32 n_packets, int is_ethernet)
+{
+  clib_toeplitz_hash_key_t *k = vnet_toeplitz_hash_key;
+  vnet_toeplitz_tuple_t t[4];
+  u32 n_left = n_packets;
+
+  while (n_left >= 4)
+    {
+      if (n_left >= 8)
+	{
+	  clib_prefetch_load (p[4]);
+	  clib_prefetch_load (p[5]);
+	  clib_prefetch_load (p[6]);
+	  clib_prefetch_load (p[7]);
+	}
+
+      for (int i = 0; i < 4; i++)
+	if (is_ethernet)
+	  toeplitz_tuple_ethernet (p[i], t + i);
+	else
+	  toeplitz_tuple_ip (p[i], t + i);
+
+      /* flows of one frame are mostly of the same type, so all four
+	 tuples usually have the same length and are hashed together */
+      if (t[0].n_bytes && t[0].n_bytes == t[1].n_bytes &&
+	  t[0].n_bytes == t[2].n_bytes && t[0].n_bytes == t[3].n_bytes)
+	clib_toeplitz_hash_x4 (k, t[0].data, t[1].data, t[2].data, t[3].data,
+			       hash, hash + 1, hash + 2, hash + 3,
+			       t[0].n_bytes);
+      else
+	for (int i = 0; i < 4; i++)
+	  hash[i] = toeplitz_hash_one (k, t + i);
+
+      hash += 4;
+      n_left -= 4;
+      p += 4;
+    }
+
+  while (n_left > 0)
+    {
+      if (is_ethernet)
+	toeplitz_tuple_ethernet (p[0], t);
+      else
+	toeplitz_tuple_ip (p[0], t);
+      hash[0] = toeplitz_hash_one (k, t);
+
+      hash += 1;
+      n_left -= 1;
+      p += 1;
+    }
+}
+
+CLIB_MARCH_FN (vnet_toeplitz_hash_ethernet, void, void **p, u32 *hash,
+	       u32 n_packets)
+{
+  toeplitz_hash_inline (p, hash, n_packets, 1 /* is_ethernet */);
+}
+
+CLIB_MARCH_FN (vnet_toeplitz_hash_ip, void, void **p, u32 *hash,
+	       u32 n_packets)
+{
+  toeplitz_hash_inline (p, hash, n_packets, 0 /* is_ethernet */);
+}
+
+#ifndef CLIB_MARCH_VARIANT
+
+clib_toeplitz_hash_key_t *vnet_toeplitz_hash_key;
+
+static void
+vnet_toeplitz_ethernet_func (void **p, u32 *hash, u32 n_packets)
+{
+  CLIB_MARCH_FN_SELECT (vnet_toeplitz_hash_ethernet) (p, hash, n_packets);
+}
+
+static void
+vnet_toeplitz_ip_func (void **p, u32 *hash, u32 n_packets)
+{
+  CLIB_MARCH_FN_SELECT (vnet_toeplitz_hash_ip) (p, hash, n_packets);
+}
+
+VNET_REGISTER_HASH_FUNCTION (toeplitz, static) = {
+  .name = "toeplitz",
+  .description = "RSS compatible Toeplitz hash with the default key",
+  .priority = 10,
+  .function[VNET_HASH_FN_TYPE_ETHERNET] = vnet_toeplitz_ethernet_func,
+  .function[VNET_HASH_FN_TYPE_IP] = vnet_toeplitz_ip_func,
+};
+
+static clib_error_t *
+vnet_toeplitz_hash_init (vlib_main_t *vm)
+{
+  vnet_toeplitz_hash_key = clib_toeplitz_hash_key_init (0, 0);
+  return 0;
+}
+
+VLIB_INIT_FUNCTION (vnet_toeplitz_hash_init);
+
+#endif
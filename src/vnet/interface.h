@@ -609,6 +609,21 @@ typedef struct
 
   /* mode */
   vnet_hw_if_rx_mode mode : 8;
+
+  /* rx placement balancer is allowed to move this queue */
+  u8 auto_placement;
+
+  /* interrupt coalescing window, the queue is polled at most once per
+     window while it is set */
+  u32 coalesce_usec;
+  volatile u8 coalescing;
+  volatile u8 coalesce_pending;
+  f64 coalesce_deadline;
+
+  /* balancer estimates for the last interval */
+  u64 n_balance_packets;
+  u64 n_balance_clocks;
+  f64 last_balance_move;
 #define VNET_HW_IF_RXQ_THREAD_ANY      ~0
 #define VNET_HW_IF_RXQ_NO_RX_INTERRUPT ~0
 } vnet_hw_if_rx_queue_t;
@@ -269,6 +269,16 @@ vnet_hw_if_update_runtime_data (vnet_main_t *vnm, u32 hw_if_index)
 
       if (something_changed_on_rx)
 	{
+	  /* open coalescing windows belong to the old runtimes, their held
+	     back interrupts are set pending again below */
+	  for (int i = 0; i < vec_len (hi->rx_queue_indices); i++)
+	    {
+	      rxq = vnet_hw_if_get_rx_queue (vnm, hi->rx_queue_indices[i]);
+	      rxq->coalescing = 0;
+	      rxq->coalesce_pending = 0;
+	      rxq->coalesce_deadline = 0;
+	    }
+
 	  for (int i = 0; i < n_threads; i++)
 	    {
 	      vlib_main_t *vm = vlib_get_main_by_index (i);
@@ -0,0 +1,325 @@
+/* SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Rx queue placement balancer. Every interval the clocks each worker spent
+ * in nodes which processed packets are split between the rx queues placed
+ * on that worker, by their share of received packets. If the busiest and
+ * the least busy worker differ by more than the threshold, one queue with
+ * auto placement is moved to the worker where it lowers the peak load the
+ * most, trying workers on the numa node of the device first. A moved queue
+ * stays on its new worker for a few intervals.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/devices/devices.h>
+#include <vnet/interface/rx_queue_funcs.h>
+#include <vlib/stats/stats.h>
+
+VLIB_REGISTER_LOG_CLASS (if_rx_balance_log, static) = {
+  .class_name = "interface",
+  .subclass_name = "rx-balance",
+};
+
+#define log_debug(fmt, ...)                                                   \
+  vlib_log_debug (if_rx_balance_log.class, fmt, __VA_ARGS__)
+#define log_notice(fmt, ...)                                                  \
+  vlib_log_notice (if_rx_balance_log.class, fmt, __VA_ARGS__)
+
+/* a moved queue is not moved again for this many intervals */
+#define RX_BALANCE_HOLD_INTERVALS 3
+
+vnet_hw_if_rx_balance_main_t vnet_hw_if_rx_balance_main = {
+  .interval = 5.0,
+  .threshold = 20,
+};
+
+extern vlib_node_registration_t rx_balance_process_node;
+
+static u64
+rx_balance_rx_packets (vnet_main_t *vnm, u32 thread_index, u32 sw_if_index)
+{
+  vlib_combined_counter_main_t *cm =
+    vnm->interface_main.combined_sw_if_counters + VNET_INTERFACE_COUNTER_RX;
+  vlib_counter_t *c = cm->counters[thread_index];
+
+  return sw_if_index < vec_len (c) ? c[sw_if_index].packets : 0;
+}
+
+static void
+rx_balance_sample (vnet_main_t *vnm)
+{
+  vnet_hw_if_rx_balance_main_t *bm = &vnet_hw_if_rx_balance_main;
+  vnet_interface_main_t *im = &vnm->interface_main;
+  u32 n_threads = vlib_get_n_threads ();
+  u64 now = clib_cpu_time_now ();
+  u64 *n_packets = 0;
+  vnet_hw_interface_t *hi;
+  vnet_hw_if_rx_queue_t *rxq;
+
+  vec_validate (bm->busy_clocks, n_threads - 1);
+  vec_validate (bm->last_busy_clocks, n_threads - 1);
+  vec_validate (bm->last_rx_packets, n_threads - 1);
+  vec_validate (n_packets, n_threads - 1);
+
+  bm->interval_clocks = bm->last_cpu_time ? now - bm->last_cpu_time : 0;
+  bm->last_cpu_time = now;
+
+  for (u32 ti = 0; ti < n_threads; ti++)
+    {
+      u64 busy = vlib_get_main_by_index (ti)->cpu_time_busy;
+      bm->busy_clocks[ti] = busy - bm->last_busy_clocks[ti];
+      bm->last_busy_clocks[ti] = busy;
+    }
+
+  /* interface counters are per thread, so queues of one interface placed
+     on the same thread share their packets equally */
+  pool_foreach (hi, im->hw_interfaces)
+    {
+      u32 *qi;
+
+      vec_foreach (qi, hi->rx_queue_indices)
+	vnet_hw_if_get_rx_queue (vnm, qi[0])->n_balance_packets = 0;
+
+      for (u32 ti = 0; ti < n_threads && vec_len (hi->rx_queue_indices); ti++)
+	{
+	  u64 *last, cur, delta;
+	  u32 n = 0;
+
+	  vec_validate (bm->last_rx_packets[ti], hi->sw_if_index);
+	  last = bm->last_rx_packets[ti] + hi->sw_if_index;
+	  cur = rx_balance_rx_packets (vnm, ti, hi->sw_if_index);
+	  delta = cur < last[0] ? cur : cur - last[0];
+	  last[0] = cur;
+
+	  vec_foreach (qi, hi->rx_queue_indices)
+	    n += vnet_hw_if_get_rx_queue (vnm, qi[0])->thread_index == ti;
+
+	  if (n == 0 || delta == 0)
+	    continue;
+
+	  vec_foreach (qi, hi->rx_queue_indices)
+	    {
+	      rxq = vnet_hw_if_get_rx_queue (vnm, qi[0]);
+	      if (rxq->thread_index == ti)
+		rxq->n_balance_packets = delta / n;
+	    }
+	  n_packets[ti] += delta;
+	}
+    }
+
+  pool_foreach (rxq, im->hw_if_rx_queues)
+    {
+      u64 total = n_packets[rxq->thread_index];
+      rxq->n_balance_clocks =
+	total ? (f64) bm->busy_clocks[rxq->thread_index] *
+		  rxq->n_balance_packets / total :
+		0;
+    }
+
+  vec_free (n_packets);
+}
+
+/* returns the index of the queue to move in the queues pool, or ~0 */
+u32
+vnet_hw_if_rx_balance_pick (vnet_main_t *vnm, vnet_hw_if_rx_balance_main_t *bm,
+			    vnet_hw_if_rx_queue_t *queues, u32 first, u32 last,
+			    f64 now, u32 *thread_index)
+{
+  u64 *busy = bm->busy_clocks;
+  u32 hot = first, cold = first, best_thread = ~0, best_queue = ~0;
+  u64 min_gain, best_gain = 0;
+  u8 best_local = 0;
+  vnet_hw_if_rx_queue_t *rxq;
+
+  for (u32 ti = first; ti <= last; ti++)
+    {
+      if (busy[ti] > busy[hot])
+	hot = ti;
+      if (busy[ti] < busy[cold])
+	cold = ti;
+    }
+
+  bm->imbalance = (busy[hot] - busy[cold]) * 100 / bm->interval_clocks;
+
+  if (bm->imbalance < bm->threshold)
+    return ~0;
+
+  /* moves which shave off less than half of the threshold are not worth
+     the disruption and could swing back on the next round */
+  min_gain = bm->interval_clocks * bm->threshold / 200;
+
+  pool_foreach (rxq, queues)
+    {
+      vnet_hw_interface_t *hi;
+      u64 q = rxq->n_balance_clocks;
+
+      if (!rxq->auto_placement || rxq->thread_index != hot || q == 0)
+	continue;
+
+      if (rxq->last_balance_move &&
+	  now - rxq->last_balance_move <
+	    bm->interval * RX_BALANCE_HOLD_INTERVALS)
+	continue;
+
+      hi = vnet_get_hw_interface (vnm, rxq->hw_if_index);
+
+      for (u32 ti = first; ti <= last; ti++)
+	{
+	  u64 peak = clib_max (busy[hot] - q, busy[ti] + q);
+	  u8 is_local;
+
+	  if (ti == hot || peak + min_gain > busy[hot])
+	    continue;
+
+	  is_local = vlib_get_main_by_index (ti)->numa_node == hi->numa_node;
+	  if (is_local < best_local ||
+	      (is_local == best_local && busy[hot] - peak <= best_gain))
+	    continue;
+
+	  best_gain = busy[hot] - peak;
+	  best_local = is_local;
+	  best_thread = ti;
+	  best_queue = rxq - queues;
+	}
+    }
+
+  *thread_index = best_thread;
+  return best_queue;
+}
+
+static void
+rx_balance_move (vlib_main_t *vm, vnet_main_t *vnm)
+{
+  vnet_hw_if_rx_balance_main_t *bm = &vnet_hw_if_rx_balance_main;
+  vnet_device_main_t *vdm = &vnet_device_main;
+  vnet_hw_if_rx_queue_t *rxq;
+  u32 queue_index, thread_index, from;
+  f64 now = vlib_time_now (vm);
+
+  if (vdm->first_worker_thread_index == 0 || bm->interval_clocks == 0)
+    return;
+
+  queue_index = vnet_hw_if_rx_balance_pick (
+    vnm, bm, vnm->interface_main.hw_if_rx_queues,
+    vdm->first_worker_thread_index, vdm->last_worker_thread_index, now,
+    &thread_index);
+  vlib_stats_set_gauge (bm->stats_imbalance_index, bm->imbalance);
+
+  if (queue_index == ~0)
+    return;
+
+  rxq = vnet_hw_if_get_rx_queue (vnm, queue_index);
+  from = rxq->thread_index;
+  log_notice ("moving %U queue %u from thread %u to %u (imbalance %u%%)",
+	      format_vnet_hw_if_index_name, vnm, rxq->hw_if_index,
+	      rxq->queue_id, from, thread_index, bm->imbalance);
+
+  vnet_hw_if_set_rx_queue_thread_index (vnm, queue_index, thread_index);
+  vnet_hw_if_update_runtime_data (vnm, rxq->hw_if_index);
+  rxq->last_balance_move = now;
+
+  bm->n_migrations++;
+  vlib_stats_set_gauge (bm->stats_migrations_index, bm->n_migrations);
+}
+
+static int
+rx_balance_is_enabled (vnet_main_t *vnm)
+{
+  vnet_hw_if_rx_queue_t *rxq;
+
+  if (vnet_hw_if_rx_balance_main.auto_all)
+    return 1;
+
+  pool_foreach (rxq, vnm->interface_main.hw_if_rx_queues)
+    if (rxq->auto_placement)
+      return 1;
+
+  return 0;
+}
+
+static uword
+rx_balance_process_fn (vlib_main_t *vm, vlib_node_runtime_t *rt,
+		       vlib_frame_t *f)
+{
+  vnet_hw_if_rx_balance_main_t *bm = &vnet_hw_if_rx_balance_main;
+  vnet_main_t *vnm = vnet_get_main ();
+
+  while (1)
+    {
+      if (rx_balance_is_enabled (vnm))
+	vlib_process_wait_for_event_or_clock (vm, bm->interval);
+      else
+	{
+	  bm->interval_clocks = 0;
+	  vlib_process_wait_for_event (vm);
+	  bm->last_cpu_time = 0;
+	}
+      vlib_process_get_events (vm, 0);
+
+      rx_balance_sample (vnm);
+      rx_balance_move (vm, vnm);
+    }
+
+  return 0;
+}
+
+VLIB_REGISTER_NODE (rx_balance_process_node) = {
+  .function = rx_balance_process_fn,
+  .type = VLIB_NODE_TYPE_PROCESS,
+  .name = "rx-placement-balance-process",
+};
+
+void
+vnet_hw_if_set_rx_queue_auto_placement (vnet_main_t *vnm, u32 queue_index,
+					u8 enable)
+{
+  vnet_hw_if_rx_queue_t *rxq = vnet_hw_if_get_rx_queue (vnm, queue_index);
+
+  log_debug ("%s auto placement for %U queue %u",
+	     enable ? "enable" : "disable", format_vnet_hw_if_index_name, vnm,
+	     rxq->hw_if_index, rxq->queue_id);
+
+  rxq->auto_placement = enable;
+  vlib_process_signal_event (vlib_get_main (), rx_balance_process_node.index,
+			     0, 0);
+}
+
+void
+vnet_hw_if_rx_balance_config (vnet_main_t *vnm, u8 enable_all,
+			      u8 disable_all, f64 interval, u32 threshold)
+{
+  vnet_hw_if_rx_balance_main_t *bm = &vnet_hw_if_rx_balance_main;
+  vnet_hw_if_rx_queue_t *rxq;
+
+  if (enable_all || disable_all)
+    {
+      bm->auto_all = enable_all;
+      pool_foreach (rxq, vnm->interface_main.hw_if_rx_queues)
+	rxq->auto_placement = enable_all;
+    }
+
+  if (interval > 0)
+    bm->interval = interval;
+
+  if (threshold != ~0)
+    bm->threshold = threshold;
+
+  vlib_process_signal_event (vlib_get_main (), rx_balance_process_node.index,
+			     0, 0);
+}
+
+static clib_error_t *
+rx_balance_init (vlib_main_t *vm)
+{
+  vnet_hw_if_rx_balance_main_t *bm = &vnet_hw_if_rx_balance_main;
+
+  bm->stats_migrations_index =
+    vlib_stats_add_gauge ("/sys/rx-placement/migrations");
+  bm->stats_imbalance_index =
+    vlib_stats_add_gauge ("/sys/rx-placement/imbalance");
+
+  return 0;
+}
+
+VLIB_INIT_FUNCTION (rx_balance_init);
@@ -27,16 +27,34 @@ VLIB_REGISTER_LOG_CLASS (if_rxq_log, static) = {
 #define log_err(fmt, ...)   vlib_log_err (if_rxq_log.class, fmt, __VA_ARGS__)
 
 static u32
-next_thread_index (vnet_main_t *vnm, u32 thread_index)
+next_thread_index (vnet_main_t *vnm, vnet_hw_interface_t *hi, u32 thread_index)
 {
   vnet_device_main_t *vdm = &vnet_device_main;
+  u32 i, ti, n_workers;
+
   if (vdm->first_worker_thread_index == 0)
     return 0;
 
   if (thread_index != 0 && (thread_index < vdm->first_worker_thread_index ||
 			    thread_index > vdm->last_worker_thread_index))
     {
-      thread_index = vdm->next_worker_thread_index++;
+      n_workers =
+	vdm->last_worker_thread_index - vdm->first_worker_thread_index + 1;
+      thread_index = ti = vdm->next_worker_thread_index;
+
+      /* prefer the next worker on the numa node of the device */
+      for (i = 0; i < n_workers; i++)
+	{
+	  if (vlib_worker_threads[ti].numa_id == hi->numa_node)
+	    {
+	      thread_index = ti;
+	      break;
+	    }
+	  if (++ti > vdm->last_worker_thread_index)
+	    ti = vdm->first_worker_thread_index;
+	}
+
+      vdm->next_worker_thread_index = thread_index + 1;
       if (vdm->next_worker_thread_index > vdm->last_worker_thread_index)
 	vdm->next_worker_thread_index = vdm->first_worker_thread_index;
     }
@@ -75,7 +93,7 @@ vnet_hw_if_register_rx_queue (vnet_main_t *vnm, u32 hw_if_index, u32 queue_id,
 		"interface %v\n",
 		queue_id, hi->name);
 
-  thread_index = next_thread_index (vnm, thread_index);
+  thread_index = next_thread_index (vnm, hi, thread_index);
 
   pool_get_zero (im->hw_if_rx_queues, rxq);
   queue_index = rxq - im->hw_if_rx_queues;
@@ -88,6 +106,7 @@ vnet_hw_if_register_rx_queue (vnet_main_t *vnm, u32 hw_if_index, u32 queue_id,
   rxq->thread_index = thread_index;
   rxq->mode = VNET_HW_IF_RX_MODE_POLLING;
   rxq->file_index = ~0;
+  rxq->auto_placement = vnet_hw_if_rx_balance_main.auto_all;
 
   log_debug ("register: interface %v queue-id %u thread %u", hi->name,
 	     queue_id, thread_index);
@@ -211,6 +230,8 @@ vnet_hw_if_set_rx_queue_mode (vnet_main_t *vnm, u32 queue_index,
     }
 
   rxq->mode = mode;
+  if (mode != VNET_HW_IF_RX_MODE_INTERRUPT)
+    rxq->coalesce_usec = 0;
   log_debug ("set_rx_queue_mode: interface %v queue-id %u mode set to %U",
 	     hi->name, rxq->queue_id, format_vnet_hw_if_rx_mode, mode);
   return 0;
@@ -247,6 +268,7 @@ vnet_hw_if_generate_rxq_int_poll_vector (vlib_main_t *vm,
   vnet_hw_if_rx_node_runtime_t *rt = (void *) node->runtime_data;
   vnet_main_t *vnm = vnet_get_main ();
   int int_num = -1;
+  f64 now = 0;
 
   ASSERT (node->state == VLIB_NODE_STATE_INTERRUPT);
 
@@ -258,13 +280,68 @@ vnet_hw_if_generate_rxq_int_poll_vector (vlib_main_t *vm,
       vnet_hw_if_rx_queue_t *rxq = vnet_hw_if_get_rx_queue (vnm, int_num);
       vnet_hw_if_rxq_poll_vector_t *pv;
 
+      if (PREDICT_FALSE (rxq->coalesce_usec))
+	{
+	  f64 window = rxq->coalesce_usec * 1e-6;
+
+	  if (now == 0)
+	    now = vlib_time_now (vm);
+
+	  if (rxq->coalescing && now < rxq->coalesce_deadline)
+	    {
+	      clib_interrupt_set (rt->rxq_interrupts, int_num);
+	      continue;
+	    }
+
+	  /* no interrupts during the window, nothing to poll unless one
+	     arrives while the window closes, see set_int_pending */
+	  if (rxq->coalescing)
+	    {
+	      __atomic_store_n (&rxq->coalescing, 0, __ATOMIC_SEQ_CST);
+	      if (__atomic_load_n (&rxq->coalesce_pending, __ATOMIC_SEQ_CST) ==
+		  0)
+		continue;
+	    }
+
+	  /* poll now and open a new window, interrupts raised during the
+	     window only mark the queue pending and it is polled once more
+	     when the window ends */
+	  rxq->coalescing = 1;
+	  rxq->coalesce_pending = 0;
+	  rxq->coalesce_deadline = now + window;
+	  clib_interrupt_set (rt->rxq_interrupts, int_num);
+	  vlib_node_schedule_interrupt (vm, node->node_index, window);
+	}
+
       vec_add2 (rt->rxq_vector_int, pv, 1);
       pv->dev_instance = rxq->dev_instance;
       pv->queue_id = rxq->queue_id;
     }
+
   return rt->rxq_vector_int;
 }
 
+void
+vnet_hw_if_set_rx_queue_coalesce (vnet_main_t *vnm, u32 queue_index,
+				  u32 coalesce_usec)
+{
+  vnet_hw_if_rx_queue_t *rxq = vnet_hw_if_get_rx_queue (vnm, queue_index);
+  vnet_hw_interface_t *hi = vnet_get_hw_interface (vnm, rxq->hw_if_index);
+  u8 was_coalescing = rxq->coalescing;
+
+  rxq->coalesce_usec = coalesce_usec;
+  rxq->coalescing = 0;
+  rxq->coalesce_pending = 0;
+  rxq->coalesce_deadline = 0;
+
+  /* interrupts held back by an open window */
+  if (was_coalescing)
+    vnet_hw_if_rx_queue_set_int_pending (vnm, queue_index);
+
+  log_debug ("set_rx_queue_coalesce: interface %v queue-id %u coalesce %uus",
+	     hi->name, rxq->queue_id, coalesce_usec);
+}
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
@@ -15,6 +15,36 @@
 
 #include <vnet/vnet.h>
 
+typedef struct
+{
+  /* seconds between balancing rounds */
+  f64 interval;
+
+  /* minimum busy difference between workers, in percent */
+  u32 threshold;
+
+  /* new rx queues are placed automatically */
+  u8 auto_all;
+
+  /* per thread busy clocks over the last interval */
+  u64 *busy_clocks;
+  u64 *last_busy_clocks;
+  u64 last_cpu_time;
+  u64 interval_clocks;
+
+  /* last rx packet counter, per thread and sw_if_index */
+  u64 **last_rx_packets;
+
+  /* busiest minus least busy worker in the last interval, in percent */
+  u32 imbalance;
+  u64 n_migrations;
+
+  u32 stats_migrations_index;
+  u32 stats_imbalance_index;
+} vnet_hw_if_rx_balance_main_t;
+
+extern vnet_hw_if_rx_balance_main_t vnet_hw_if_rx_balance_main;
+
 /* funciton declarations */
 
 u32 vnet_hw_if_get_rx_queue_index_by_id (vnet_main_t *vnm, u32 hw_if_index,
@@ -33,6 +63,17 @@ vnet_hw_if_rx_mode vnet_hw_if_get_rx_queue_mode (vnet_main_t *vnm,
 						 u32 queue_index);
 void vnet_hw_if_set_rx_queue_thread_index (vnet_main_t *vnm, u32 queue_index,
 					   u32 thread_index);
+void vnet_hw_if_set_rx_queue_auto_placement (vnet_main_t *vnm,
+					     u32 queue_index, u8 enable);
+void vnet_hw_if_set_rx_queue_coalesce (vnet_main_t *vnm, u32 queue_index,
+				       u32 coalesce_usec);
+void vnet_hw_if_rx_balance_config (vnet_main_t *vnm, u8 enable_all,
+				   u8 disable_all, f64 interval,
+				   u32 threshold);
+u32 vnet_hw_if_rx_balance_pick (vnet_main_t *vnm,
+				vnet_hw_if_rx_balance_main_t *bm,
+				vnet_hw_if_rx_queue_t *queues, u32 first,
+				u32 last, f64 now, u32 *thread_index);
 vnet_hw_if_rxq_poll_vector_t *
 vnet_hw_if_generate_rxq_int_poll_vector (vlib_main_t *vm,
 					 vlib_node_runtime_t *node);
@@ -63,6 +104,14 @@ vnet_hw_if_rx_queue_set_int_pending (vnet_main_t *vnm, u32 queue_index)
     clib_interrupt_set (rt->rxq_interrupts, queue_index);
   else
     clib_interrupt_set_atomic (rt->rxq_interrupts, queue_index);
+  /* the queue is polled when its coalescing window ends, unless the
+     window closed before it could see coalesce_pending */
+  if (rxq->coalescing)
+    {
+      __atomic_store_n (&rxq->coalesce_pending, 1, __ATOMIC_SEQ_CST);
+      if (__atomic_load_n (&rxq->coalescing, __ATOMIC_SEQ_CST))
+	return;
+    }
   vlib_node_set_interrupt_pending (vm, hi->input_node_index);
 }
 
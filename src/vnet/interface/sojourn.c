@@ -0,0 +1,312 @@
+/* SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Packet sojourn time, the time a packet spends inside vpp between
+ * reception and transmission. The sojourn-stamp feature on the
+ * device-input arc stores the cpu time in one of every n received packets
+ * and the sojourn-collect feature on the interface-output arc records the
+ * age of stamped packets in a per interface histogram, exported to the
+ * stats segment as /interfaces/<name>/sojourn. Time spent in the driver
+ * before the device-input arc and in the tx queue is not included.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/feature/feature.h>
+#include <vlib/stats/stats.h>
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  /* packets left until the next one is stamped */
+  u32 countdown;
+} vnet_sojourn_per_thread_t;
+
+typedef struct
+{
+  /* one of every sample_interval received packets is stamped */
+  u32 *sample_interval_by_sw_if_index;
+
+  /* sojourn histograms of transmitted packets, see vlib_time_ns_hist_bucket */
+  vlib_simple_counter_main_t *hist_by_sw_if_index;
+
+  vnet_sojourn_per_thread_t *per_thread;
+} vnet_sojourn_main_t;
+
+extern vnet_sojourn_main_t vnet_sojourn_main;
+
+#ifndef CLIB_MARCH_VARIANT
+vnet_sojourn_main_t vnet_sojourn_main;
+#endif
+
+VLIB_NODE_FN (sojourn_stamp_node)
+(vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
+{
+  vnet_sojourn_main_t *sm = &vnet_sojourn_main;
+  vnet_sojourn_per_thread_t *ptd =
+    vec_elt_at_index (sm->per_thread, vm->thread_index);
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b = bufs;
+  u16 nexts[VLIB_FRAME_SIZE], *next = nexts;
+  u32 *from = vlib_frame_vector_args (frame);
+  u32 n_left = frame->n_vectors;
+  u64 now = clib_cpu_time_now ();
+
+  vlib_get_buffers (vm, from, bufs, n_left);
+
+  while (n_left)
+    {
+      if (ptd->countdown)
+	ptd->countdown--;
+      else
+	{
+	  u32 sw_if_index = vnet_buffer (b[0])->sw_if_index[VLIB_RX];
+	  ptd->countdown =
+	    sm->sample_interval_by_sw_if_index[sw_if_index] - 1;
+	  b[0]->flags |= VNET_BUFFER_F_RX_TIMESTAMP;
+	  vnet_buffer2 (b[0])->rx_timestamp = now;
+	}
+
+      vnet_feature_next_u16 (next, b[0]);
+
+      b += 1;
+      next += 1;
+      n_left -= 1;
+    }
+
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
+  return frame->n_vectors;
+}
+
+VLIB_NODE_FN (sojourn_collect_node)
+(vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
+{
+  vnet_sojourn_main_t *sm = &vnet_sojourn_main;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b = bufs;
+  u16 nexts[VLIB_FRAME_SIZE], *next = nexts;
+  u32 *from = vlib_frame_vector_args (frame);
+  u32 n_left = frame->n_vectors;
+  u64 now = clib_cpu_time_now ();
+  f64 ns_per_clock = vm->clib_time.seconds_per_clock * 1e9;
+
+  vlib_get_buffers (vm, from, bufs, n_left);
+
+  while (n_left)
+    {
+      if (PREDICT_FALSE (b[0]->flags & VNET_BUFFER_F_RX_TIMESTAMP))
+	{
+	  u32 sw_if_index = vnet_buffer (b[0])->sw_if_index[VLIB_TX];
+	  u64 stamp = vnet_buffer2 (b[0])->rx_timestamp;
+	  u64 ns = now > stamp ? (now - stamp) * ns_per_clock : 0;
+
+	  vlib_increment_simple_counter (
+	    vec_elt_at_index (sm->hist_by_sw_if_index, sw_if_index),
+	    vm->thread_index, vlib_time_ns_hist_bucket (ns), 1);
+
+	  /* count each packet once, even if it is transmitted again */
+	  b[0]->flags &= ~VNET_BUFFER_F_RX_TIMESTAMP;
+	}
+
+      vnet_feature_next_u16 (next, b[0]);
+
+      b += 1;
+      next += 1;
+      n_left -= 1;
+    }
+
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
+  return frame->n_vectors;
+}
+
+VLIB_REGISTER_NODE (sojourn_stamp_node) = {
+  .vector_size = sizeof (u32),
+  .type = VLIB_NODE_TYPE_INTERNAL,
+  .name = "sojourn-stamp",
+};
+
+VLIB_REGISTER_NODE (sojourn_collect_node) = {
+  .vector_size = sizeof (u32),
+  .type = VLIB_NODE_TYPE_INTERNAL,
+  .name = "sojourn-collect",
+};
+
+VNET_FEATURE_INIT (sojourn_stamp, static) = {
+  .arc_name = "device-input",
+  .node_name = "sojourn-stamp",
+  .runs_before = VNET_FEATURES ("ethernet-input"),
+};
+
+VNET_FEATURE_INIT (sojourn_collect, static) = {
+  .arc_name = "interface-output",
+  .node_name = "sojourn-collect",
+  .runs_before = VNET_FEATURES ("interface-output-arc-end"),
+};
+
+#ifndef CLIB_MARCH_VARIANT
+static int
+sojourn_is_enabled (u32 sw_if_index)
+{
+  vnet_sojourn_main_t *sm = &vnet_sojourn_main;
+
+  return sw_if_index < vec_len (sm->hist_by_sw_if_index) &&
+	 sm->hist_by_sw_if_index[sw_if_index].stat_segment_name != 0;
+}
+
+static void
+sojourn_hist_free (vlib_simple_counter_main_t *cm)
+{
+  vlib_free_simple_counter (cm);
+  vec_free (cm->stat_segment_name);
+}
+
+int
+vnet_sw_interface_sojourn_enable_disable (u32 sw_if_index,
+					  u32 sample_interval, u8 enable)
+{
+  vnet_sojourn_main_t *sm = &vnet_sojourn_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  vlib_simple_counter_main_t *cm;
+
+  if (!vnet_sw_interface_is_valid (vnm, sw_if_index))
+    return VNET_API_ERROR_INVALID_SW_IF_INDEX;
+
+  if (enable && sample_interval == 0)
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  if (enable == sojourn_is_enabled (sw_if_index))
+    {
+      if (enable)
+	sm->sample_interval_by_sw_if_index[sw_if_index] = sample_interval;
+      return 0;
+    }
+
+  vec_validate (sm->sample_interval_by_sw_if_index, sw_if_index);
+  vec_validate (sm->hist_by_sw_if_index, sw_if_index);
+  vec_validate_aligned (sm->per_thread, vlib_get_n_threads () - 1,
+			CLIB_CACHE_LINE_BYTES);
+  cm = vec_elt_at_index (sm->hist_by_sw_if_index, sw_if_index);
+
+  if (enable)
+    {
+      u8 *name = format (0, "%U", format_vnet_sw_if_index_name, vnm,
+			 sw_if_index);
+      sm->sample_interval_by_sw_if_index[sw_if_index] = sample_interval;
+      cm->stat_segment_name =
+	(char *) format (0, "/interfaces/%U/sojourn%c",
+			 format_vlib_stats_symlink, name, 0);
+      vlib_validate_simple_counter (cm, VLIB_TIME_NS_HIST_N_BUCKETS - 1);
+      vec_free (name);
+    }
+
+  vnet_feature_enable_disable ("device-input", "sojourn-stamp", sw_if_index,
+			       enable, 0, 0);
+  vnet_feature_enable_disable ("interface-output", "sojourn-collect",
+			       sw_if_index, enable, 0, 0);
+
+  /* the collect node is gone from the arc, so the histogram can go too */
+  if (!enable)
+    {
+      sojourn_hist_free (cm);
+      clib_memset (cm, 0, sizeof (*cm));
+    }
+
+  return 0;
+}
+
+static clib_error_t *
+sojourn_sw_interface_add_del (vnet_main_t *vnm, u32 sw_if_index, u32 is_add)
+{
+  if (!is_add && sojourn_is_enabled (sw_if_index))
+    vnet_sw_interface_sojourn_enable_disable (sw_if_index, 0, 0);
+
+  return 0;
+}
+
+VNET_SW_INTERFACE_ADD_DEL_FUNCTION (sojourn_sw_interface_add_del);
+
+static clib_error_t *
+set_interface_sojourn (vlib_main_t *vm, unformat_input_t *input,
+		       vlib_cli_command_t *cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  vnet_main_t *vnm = vnet_get_main ();
+  u32 sw_if_index = ~0, sample_interval = 1;
+  clib_error_t *error = 0;
+  u8 enable = 1;
+  int rv;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return clib_error_return (0, "please specify an interface");
+
+  while (unformat_check_input (line_input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "sample %u", &sample_interval))
+	;
+      else if (unformat (line_input, "disable"))
+	enable = 0;
+      else if (unformat (line_input, "%U", unformat_vnet_sw_interface, vnm,
+			 &sw_if_index))
+	;
+      else
+	{
+	  error = clib_error_return (0, "unknown input '%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (sw_if_index == ~0)
+    {
+      error = clib_error_return (0, "please specify an interface");
+      goto done;
+    }
+
+  rv = vnet_sw_interface_sojourn_enable_disable (sw_if_index,
+						 sample_interval, enable);
+  if (rv == VNET_API_ERROR_INVALID_VALUE)
+    error = clib_error_return (0, "sample interval must be at least 1");
+  else if (rv)
+    error = clib_error_return (0, "failed with error %d", rv);
+
+done:
+  unformat_free (line_input);
+  return error;
+}
+
+/*?
+ * Stamp one of every <n> packets received on an interface with the time
+ * of reception, and record how long ago stamped packets transmitted on
+ * the interface were received. Enable it on both the rx and the tx
+ * interface of the path to measure.
+ *
+ * @cliexpar
+ * @cliexcmd{set interface sojourn GigabitEthernet2/0/0 sample 64}
+ ?*/
+VLIB_CLI_COMMAND (set_interface_sojourn_command, static) = {
+  .path = "set interface sojourn",
+  .short_help = "set interface sojourn <interface> [sample <n>] [disable]",
+  .function = set_interface_sojourn,
+};
+
+static clib_error_t *
+show_interface_sojourn (vlib_main_t *vm, unformat_input_t *input,
+			vlib_cli_command_t *cmd)
+{
+  vnet_sojourn_main_t *sm = &vnet_sojourn_main;
+  vnet_main_t *vnm = vnet_get_main ();
+
+  for (u32 i = 0; i < vec_len (sm->hist_by_sw_if_index); i++)
+    if (sojourn_is_enabled (i))
+      vlib_cli_output (vm, "%-30U sample 1/%u %U",
+		       format_vnet_sw_if_index_name, vnm, i,
+		       sm->sample_interval_by_sw_if_index[i],
+		       format_vlib_time_ns_hist, sm->hist_by_sw_if_index + i);
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_interface_sojourn_command, static) = {
+  .path = "show interface sojourn",
+  .short_help = "show interface sojourn",
+  .function = show_interface_sojourn,
+};
+#endif /* CLIB_MARCH_VARIANT */
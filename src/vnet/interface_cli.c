@@ -1507,7 +1507,7 @@ set_hw_interface_change_rx_mode (vnet_main_t * vnm, u32 hw_if_index,
       queue_index =
 	vnet_hw_if_get_rx_queue_index_by_id (vnm, hw_if_index, queue_id);
       if (queue_index == ~0)
-	return clib_error_return (0, "unknown queue %u on interface %s",
+	return clib_error_return (0, "unknown queue %u on interface %v",
 				  queue_id, hw->name);
       vec_add1 (queue_indices, queue_index);
     }
@@ -1544,6 +1544,7 @@ set_interface_rx_mode (vlib_main_t * vm, unformat_input_t * input,
   u32 queue_id = (u32) ~ 0;
   vnet_hw_if_rx_mode mode = VNET_HW_IF_RX_MODE_UNKNOWN;
   u8 queue_id_valid = 0;
+  u32 coalesce_usec = 0;
 
   if (!unformat_user (input, unformat_line_input, line_input))
     return 0;
@@ -1559,6 +1560,8 @@ set_interface_rx_mode (vlib_main_t * vm, unformat_input_t * input,
 	mode = VNET_HW_IF_RX_MODE_POLLING;
       else if (unformat (line_input, "interrupt"))
 	mode = VNET_HW_IF_RX_MODE_INTERRUPT;
+      else if (unformat (line_input, "coalesce %u", &coalesce_usec))
+	;
       else if (unformat (line_input, "adaptive"))
 	mode = VNET_HW_IF_RX_MODE_ADAPTIVE;
       else
@@ -1578,9 +1581,25 @@ set_interface_rx_mode (vlib_main_t * vm, unformat_input_t * input,
   if (mode == VNET_HW_IF_RX_MODE_UNKNOWN)
     return clib_error_return (0, "please specify valid rx-mode");
 
+  if (coalesce_usec && mode != VNET_HW_IF_RX_MODE_INTERRUPT)
+    return clib_error_return (0, "coalesce requires interrupt rx-mode");
+
   error = set_hw_interface_change_rx_mode (vnm, hw_if_index, queue_id_valid,
 					   queue_id, mode);
 
+  if (error == 0 && mode == VNET_HW_IF_RX_MODE_INTERRUPT)
+    {
+      vnet_hw_interface_t *hw = vnet_get_hw_interface (vnm, hw_if_index);
+
+      for (int i = 0; i < vec_len (hw->rx_queue_indices); i++)
+	{
+	  u32 qi = hw->rx_queue_indices[i];
+	  if (!queue_id_valid ||
+	      vnet_hw_if_get_rx_queue (vnm, qi)->queue_id == queue_id)
+	    vnet_hw_if_set_rx_queue_coalesce (vnm, qi, coalesce_usec);
+	}
+    }
+
   return (error);
 }
 
@@ -1597,6 +1616,10 @@ set_interface_rx_mode (vlib_main_t * vm, unformat_input_t * input,
  * @cliexcmd{set interface rx-mode VirtualEthernet0/0/12 polling}
  * Example of how to assign rx-mode to one queue of an interface:
  * @cliexcmd{set interface rx-mode VirtualEthernet0/0/12 queue 0 interrupt}
+ * In interrupt mode, '<em>coalesce</em>' polls a queue at most once per
+ * window of the given number of microseconds, interrupts raised in
+ * between are handled together when the window ends:
+ * @cliexcmd{set interface rx-mode VirtualEthernet0/0/12 interrupt coalesce 50}
  * Example of how to display the rx-mode of all interfaces:
  * @cliexstart{show interface rx-placement}
  * Thread 1 (vpp_wk_0):
@@ -1619,7 +1642,7 @@ set_interface_rx_mode (vlib_main_t * vm, unformat_input_t * input,
 ?*/
 VLIB_CLI_COMMAND (cmd_set_if_rx_mode,static) = {
     .path = "set interface rx-mode",
-    .short_help = "set interface rx-mode <interface> [queue <n>] [polling | interrupt | adaptive]",
+    .short_help = "set interface rx-mode <interface> [queue <n>] [polling | interrupt [coalesce <usec>] | adaptive]",
     .function = set_interface_rx_mode,
 };
 
@@ -1629,9 +1652,11 @@ show_interface_rx_placement_fn (vlib_main_t * vm, unformat_input_t * input,
 {
   u8 *s = 0;
   vnet_main_t *vnm = vnet_get_main ();
+  vnet_hw_if_rx_balance_main_t *bm = &vnet_hw_if_rx_balance_main;
   vnet_hw_if_rx_queue_t **all_queues = 0;
   vnet_hw_if_rx_queue_t **qptr;
   vnet_hw_if_rx_queue_t *q;
+  u64 interval_clocks = bm->interval_clocks;
   pool_foreach (q, vnm->interface_main.hw_if_rx_queues)
     vec_add1 (all_queues, q);
   vec_sort_with_function (all_queues, vnet_hw_if_rxq_cmp_cli_api);
@@ -1645,18 +1670,40 @@ show_interface_rx_placement_fn (vlib_main_t * vm, unformat_input_t * input,
       u32 current_node = hw_if->input_node_index;
       if (current_node != prev_node)
 	s = format (s, " node %U:\n", format_vlib_node_name, vm, current_node);
-      s = format (s, "    %U queue %u (%U)\n", format_vnet_sw_if_index_name,
+      s = format (s, "    %U queue %u (%U)", format_vnet_sw_if_index_name,
 		  vnm, hw_if->sw_if_index, qptr[0]->queue_id,
 		  format_vnet_hw_if_rx_mode, qptr[0]->mode);
+      if (qptr[0]->coalesce_usec)
+	s = format (s, " coalesce %uus", qptr[0]->coalesce_usec);
+      if (qptr[0]->auto_placement && interval_clocks)
+	s = format (s, " auto, load %u%%",
+		    qptr[0]->n_balance_clocks * 100 / interval_clocks);
+      else if (qptr[0]->auto_placement)
+	s = format (s, " auto");
+      vec_add1 (s, '\n');
       if (qptr == all_queues + vec_len (all_queues) - 1 ||
 	  current_thread != qptr[1]->thread_index)
 	{
-	  vlib_cli_output (vm, "Thread %u (%s):\n%v", current_thread,
-			   vlib_worker_threads[current_thread].name, s);
+	  if (interval_clocks && current_thread < vec_len (bm->busy_clocks))
+	    vlib_cli_output (vm, "Thread %u (%s): busy %u%%\n%v",
+			     current_thread,
+			     vlib_worker_threads[current_thread].name,
+			     bm->busy_clocks[current_thread] * 100 /
+			       interval_clocks,
+			     s);
+	  else
+	    vlib_cli_output (vm, "Thread %u (%s):\n%v", current_thread,
+			     vlib_worker_threads[current_thread].name, s);
 	  vec_reset_length (s);
 	}
       prev_node = current_node;
     }
+  if (interval_clocks)
+    vlib_cli_output (vm,
+		     "Auto placement: interval %.2fs threshold %u%% "
+		     "imbalance %u%% migrations %lu",
+		     bm->interval, bm->threshold, bm->imbalance,
+		     bm->n_migrations);
   vec_free (s);
   vec_free (all_queues);
   return 0;
@@ -1715,13 +1762,39 @@ set_hw_interface_rx_placement (u32 hw_if_index, u32 queue_id,
   queue_index =
     vnet_hw_if_get_rx_queue_index_by_id (vnm, hw_if_index, queue_id);
   if (queue_index == ~0)
-    return clib_error_return (0, "unknown queue %u on interface %s", queue_id,
+    return clib_error_return (0, "unknown queue %u on interface %v", queue_id,
 			      hw->name);
+  /* explicit placement takes the queue out of auto placement */
+  vnet_hw_if_get_rx_queue (vnm, queue_index)->auto_placement = 0;
   vnet_hw_if_set_rx_queue_thread_index (vnm, queue_index, thread_index);
   vnet_hw_if_update_runtime_data (vnm, hw_if_index);
   return 0;
 }
 
+static clib_error_t *
+set_hw_interface_rx_placement_auto (u32 hw_if_index, u32 queue_id,
+				    u8 enable)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_hw_interface_t *hw = vnet_get_hw_interface (vnm, hw_if_index);
+  u32 queue_index, *qi;
+
+  if (queue_id == ~0)
+    {
+      vec_foreach (qi, hw->rx_queue_indices)
+	vnet_hw_if_set_rx_queue_auto_placement (vnm, qi[0], enable);
+      return 0;
+    }
+
+  queue_index =
+    vnet_hw_if_get_rx_queue_index_by_id (vnm, hw_if_index, queue_id);
+  if (queue_index == ~0)
+    return clib_error_return (0, "unknown queue %u on interface %v", queue_id,
+			      hw->name);
+  vnet_hw_if_set_rx_queue_auto_placement (vnm, queue_index, enable);
+  return 0;
+}
+
 static clib_error_t *
 set_interface_rx_placement (vlib_main_t *vm, unformat_input_t *input,
 			    vlib_cli_command_t *cmd)
@@ -1732,7 +1805,9 @@ set_interface_rx_placement (vlib_main_t *vm, unformat_input_t *input,
   u32 hw_if_index = (u32) ~ 0;
   u32 queue_id = (u32) 0;
   u32 thread_index = (u32) ~ 0;
-  u8 is_main = 0;
+  u32 threshold = ~0;
+  f64 interval = 0;
+  u8 is_main = 0, is_auto = 0, is_disable = 0, queue_set = 0;
 
   if (!unformat_user (input, unformat_line_input, line_input))
     return 0;
@@ -1743,11 +1818,19 @@ set_interface_rx_placement (vlib_main_t *vm, unformat_input_t *input,
 	  (line_input, "%U", unformat_vnet_hw_interface, vnm, &hw_if_index))
 	;
       else if (unformat (line_input, "queue %d", &queue_id))
-	;
+	queue_set = 1;
       else if (unformat (line_input, "main", &thread_index))
 	is_main = 1;
       else if (unformat (line_input, "worker %d", &thread_index))
 	;
+      else if (unformat (line_input, "auto"))
+	is_auto = 1;
+      else if (unformat (line_input, "disable"))
+	is_disable = 1;
+      else if (unformat (line_input, "interval %f", &interval))
+	;
+      else if (unformat (line_input, "threshold %u", &threshold))
+	;
       else
 	{
 	  error = clib_error_return (0, "parse error: '%U'",
@@ -1759,9 +1842,33 @@ set_interface_rx_placement (vlib_main_t *vm, unformat_input_t *input,
 
   unformat_free (line_input);
 
+  if (!is_auto && (is_disable || interval != 0 || threshold != ~0))
+    return clib_error_return (0, "'disable', 'interval' and 'threshold' "
+				 "only apply to auto placement");
+
+  if (threshold != ~0 && threshold > 100)
+    return clib_error_return (0, "threshold is in percent");
+
+  if (is_auto && (is_main || thread_index != ~0))
+    return clib_error_return (0, "auto placement does not take a thread");
+
+  if (is_auto && hw_if_index == (u32) ~0)
+    {
+      vnet_hw_if_rx_balance_config (vnm, !is_disable, is_disable, interval,
+				    threshold);
+      return 0;
+    }
+
   if (hw_if_index == (u32) ~ 0)
     return clib_error_return (0, "please specify valid interface name");
 
+  if (is_auto)
+    {
+      vnet_hw_if_rx_balance_config (vnm, 0, 0, interval, threshold);
+      return set_hw_interface_rx_placement_auto (
+	hw_if_index, queue_set ? queue_id : ~0, !is_disable);
+    }
+
   error = set_hw_interface_rx_placement (hw_if_index, queue_id, thread_index,
 					 is_main);
 
@@ -1815,11 +1922,22 @@ set_interface_rx_placement (vlib_main_t *vm, unformat_input_t *input,
  *     VirtualEthernet0/0/13 queue 1 (polling)
  *     VirtualEthernet0/0/13 queue 3 (polling)
  * @cliexend
+ *
+ * With '<em>auto</em>' the queues are moved between workers at runtime.
+ * Every '<em>interval</em>' seconds (default 5) the load of each worker is
+ * measured, and if the busiest and the least busy worker differ by more
+ * than '<em>threshold</em>' percent (default 20), one queue is moved off
+ * the busiest worker. Workers on the numa node of the device are preferred.
+ * Without an interface, auto placement applies to all current and future
+ * queues. Placing a queue on a given thread turns auto placement off for it.
+ * @cliexcmd{set interface rx-placement auto interval 2 threshold 10}
+ * @cliexcmd{set interface rx-placement VirtualEthernet0/0/12 auto disable}
 ?*/
 VLIB_CLI_COMMAND (cmd_set_if_rx_placement,static) = {
     .path = "set interface rx-placement",
-    .short_help = "set interface rx-placement <interface> [queue <n>] "
-      "[worker <n> | main]",
+    .short_help = "set interface rx-placement [<interface>] [queue <n>] "
+      "[worker <n> | main | auto [disable] [interval <sec>] "
+      "[threshold <percent>]]",
     .function = set_interface_rx_placement,
     .is_mp_safe = 1,
 };
@@ -1912,7 +2030,7 @@ set_interface_tx_queue (vlib_main_t *vm, unformat_input_t *input,
       break;
     case VNET_API_ERROR_INVALID_QUEUE:
       error = clib_error_return (
-	0, "unknown queue %u on interface %s", queue_id,
+	0, "unknown queue %u on interface %v", queue_id,
 	vnet_get_hw_interface (vnet_get_main (), hw_if_index)->name);
       break;
     default:
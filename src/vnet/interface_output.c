@@ -1151,7 +1151,9 @@ pcap_drop_trace (vlib_main_t * vm,
 	 * only if we can do that without allocating a new buffer.
 	 */
 	if (PREDICT_TRUE ((last->current_data + last->current_length) <
-			  (VLIB_BUFFER_DEFAULT_DATA_SIZE - drop_string_len)))
+			  (vlib_buffer_get_pool_data_size (
+			     vm, last->buffer_pool_index) -
+			   drop_string_len)))
 	  {
 	    clib_memcpy_fast (last->data + last->current_data +
 				last->current_length,
@@ -52,6 +52,66 @@
  * This file contains the source code for IPv4 forwarding.
  */
 
+/**
+ * Set the FIB a buffer is looked up in, from its tx interface override
+ * or its rx interface, and return it
+ */
+static_always_inline u32
+ip4_lookup_buffer_fib_index (ip4_main_t *im, vlib_buffer_t *b)
+{
+  ip_lookup_set_buffer_fib_index (im->fib_index_by_sw_if_index, b);
+  return vnet_buffer (b)->ip.fib_index;
+}
+
+#ifdef IP4_MTRIE_HAVE_LOOKUP_X8
+/**
+ * Resolve the load-balance index of every buffer in the frame, eight
+ * destinations per mtrie step.
+ */
+static_always_inline void
+ip4_lookup_resolve_x8 (ip4_main_t *im, vlib_buffer_t **b, index_t *lbi,
+		       u32 n_left)
+{
+  const ip4_address_t *dst_addr[8];
+  u32 fib_index[8];
+  ip4_header_t *ip;
+  int i;
+
+  while (n_left >= 8)
+    {
+      if (n_left >= 16)
+	for (i = 8; i < 16; i++)
+	  {
+	    vlib_prefetch_buffer_header (b[i], LOAD);
+	    CLIB_PREFETCH (b[i]->data, sizeof (ip[0]), LOAD);
+	  }
+
+      for (i = 0; i < 8; i++)
+	{
+	  ip = vlib_buffer_get_current (b[i]);
+	  fib_index[i] = ip4_lookup_buffer_fib_index (im, b[i]);
+	  dst_addr[i] = &ip->dst_address;
+	}
+
+      ip4_fib_forwarding_lookup_x8 (fib_index, dst_addr, lbi);
+
+      b += 8;
+      lbi += 8;
+      n_left -= 8;
+    }
+
+  while (n_left > 0)
+    {
+      ip = vlib_buffer_get_current (b[0]);
+      lbi[0] = ip4_fib_forwarding_lookup (ip4_lookup_buffer_fib_index (im, b[0]),
+					  &ip->dst_address);
+      b += 1;
+      lbi += 1;
+      n_left -= 1;
+    }
+}
+#endif
+
 always_inline uword
 ip4_lookup_inline (vlib_main_t * vm,
 		   vlib_node_runtime_t * node, vlib_frame_t * frame)
@@ -69,6 +129,16 @@ ip4_lookup_inline (vlib_main_t * vm,
   next = nexts;
   vlib_get_buffers (vm, from, bufs, n_left);
 
+#ifdef IP4_MTRIE_HAVE_LOOKUP_X8
+  index_t lb_indices[VLIB_FRAME_SIZE], *lbi = 0;
+
+  if (PREDICT_TRUE (ip4_mtrie_lookup_x8_ok ()))
+    {
+      ip4_lookup_resolve_x8 (im, bufs, lb_indices, n_left);
+      lbi = lb_indices;
+    }
+#endif
+
 #if (CLIB_N_PREFETCHES >= 8)
   while (n_left >= 4)
     {
@@ -105,16 +175,24 @@ ip4_lookup_inline (vlib_main_t * vm,
       dst_addr2 = &ip2->dst_address;
       dst_addr3 = &ip3->dst_address;
 
-      ip_lookup_set_buffer_fib_index (im->fib_index_by_sw_if_index, b[0]);
-      ip_lookup_set_buffer_fib_index (im->fib_index_by_sw_if_index, b[1]);
-      ip_lookup_set_buffer_fib_index (im->fib_index_by_sw_if_index, b[2]);
-      ip_lookup_set_buffer_fib_index (im->fib_index_by_sw_if_index, b[3]);
-
-      ip4_fib_forwarding_lookup_x4 (
-	vnet_buffer (b[0])->ip.fib_index, vnet_buffer (b[1])->ip.fib_index,
-	vnet_buffer (b[2])->ip.fib_index, vnet_buffer (b[3])->ip.fib_index,
-	dst_addr0, dst_addr1, dst_addr2, dst_addr3, &lb_index0, &lb_index1,
-	&lb_index2, &lb_index3);
+#ifdef IP4_MTRIE_HAVE_LOOKUP_X8
+      /* ip4_lookup_resolve_x8 has set the fib index already */
+      if (lbi)
+	{
+	  lb_index0 = lbi[b - bufs + 0];
+	  lb_index1 = lbi[b - bufs + 1];
+	  lb_index2 = lbi[b - bufs + 2];
+	  lb_index3 = lbi[b - bufs + 3];
+	}
+      else
+#endif
+	ip4_fib_forwarding_lookup_x4 (
+	  ip4_lookup_buffer_fib_index (im, b[0]),
+	  ip4_lookup_buffer_fib_index (im, b[1]),
+	  ip4_lookup_buffer_fib_index (im, b[2]),
+	  ip4_lookup_buffer_fib_index (im, b[3]), dst_addr0, dst_addr1,
+	  dst_addr2, dst_addr3, &lb_index0, &lb_index1, &lb_index2,
+	  &lb_index3);
 
       ASSERT (lb_index0 && lb_index1 && lb_index2 && lb_index3);
       lb0 = load_balance_get (lb_index0);
@@ -245,12 +323,19 @@ ip4_lookup_inline (vlib_main_t * vm,
       dst_addr0 = &ip0->dst_address;
       dst_addr1 = &ip1->dst_address;
 
-      ip_lookup_set_buffer_fib_index (im->fib_index_by_sw_if_index, b[0]);
-      ip_lookup_set_buffer_fib_index (im->fib_index_by_sw_if_index, b[1]);
-
-      ip4_fib_forwarding_lookup_x2 (
-	vnet_buffer (b[0])->ip.fib_index, vnet_buffer (b[1])->ip.fib_index,
-	dst_addr0, dst_addr1, &lb_index0, &lb_index1);
+#ifdef IP4_MTRIE_HAVE_LOOKUP_X8
+      /* ip4_lookup_resolve_x8 has set the fib index already */
+      if (lbi)
+	{
+	  lb_index0 = lbi[b - bufs + 0];
+	  lb_index1 = lbi[b - bufs + 1];
+	}
+      else
+#endif
+	ip4_fib_forwarding_lookup_x2 (ip4_lookup_buffer_fib_index (im, b[0]),
+				      ip4_lookup_buffer_fib_index (im, b[1]),
+				      dst_addr0, dst_addr1, &lb_index0,
+				      &lb_index1);
 
       ASSERT (lb_index0 && lb_index1);
       lb0 = load_balance_get (lb_index0);
@@ -322,10 +407,15 @@ ip4_lookup_inline (vlib_main_t * vm,
 
       ip0 = vlib_buffer_get_current (b[0]);
       dst_addr0 = &ip0->dst_address;
-      ip_lookup_set_buffer_fib_index (im->fib_index_by_sw_if_index, b[0]);
 
-      lbi0 = ip4_fib_forwarding_lookup (vnet_buffer (b[0])->ip.fib_index,
-					dst_addr0);
+#ifdef IP4_MTRIE_HAVE_LOOKUP_X8
+      /* ip4_lookup_resolve_x8 has set the fib index already */
+      if (lbi)
+	lbi0 = lbi[b - bufs];
+      else
+#endif
+	lbi0 = ip4_fib_forwarding_lookup (ip4_lookup_buffer_fib_index (im, b[0]),
+					  dst_addr0);
 
       ASSERT (lbi0);
       lb0 = load_balance_get (lbi0);
@@ -706,7 +706,8 @@ ip4_mtrie_8_memory_usage (ip4_mtrie_8_t *m)
   ip4_mtrie_8_ply_t *root = pool_elt_at_index (ip4_ply_pool, m->root_ply);
   uword bytes, i;
 
-  bytes = sizeof (*m);
+  /* the root ply lives in the ply pool, not in the mtrie */
+  bytes = sizeof (*m) + sizeof (*root);
   for (i = 0; i < ARRAY_LEN (root->leaves); i++)
     {
       ip4_mtrie_leaf_t l = root->leaves[i];
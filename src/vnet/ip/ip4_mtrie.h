@@ -263,6 +263,41 @@ ip4_mtrie_8_lookup_step_one (const ip4_mtrie_8_t *m,
   return next_leaf;
 }
 
+#if defined(CLIB_HAVE_VEC256) && defined(__x86_64__)
+#define IP4_MTRIE_HAVE_LOOKUP_X8 1
+
+/**
+ * The x8 steps gather leaves with 32-bit element indices relative to the
+ * ply pool, which limits the number of plies they can address.
+ */
+#define IP4_MTRIE_X8_MAX_PLIES                                                \
+  ((1ULL << 31) / (sizeof (ip4_mtrie_8_ply_t) / sizeof (ip4_mtrie_leaf_t)))
+
+always_inline int
+ip4_mtrie_lookup_x8_ok (void)
+{
+  return vec_len (ip4_ply_pool) < IP4_MTRIE_X8_MAX_PLIES;
+}
+
+/**
+ * Take one 8-bit stride for eight lookups at once. Lanes whose leaf is
+ * not terminal load the next leaf from their ply with a masked gather;
+ * terminal lanes keep their leaf.
+ */
+static_always_inline u32x8
+ip4_mtrie_lookup_step_x8 (u32x8 leaf, u32x8 dst_address_byte)
+{
+  u32x8 is_ply = (u32x8) ((leaf & 1) == 0);
+  u32x8 index;
+
+  index = (leaf >> 1) * (sizeof (ip4_mtrie_8_ply_t) / sizeof (leaf[0])) +
+	  dst_address_byte;
+
+  return u32x8_mask_gather_u32 (leaf, ip4_ply_pool->leaves, index, is_ply,
+				sizeof (leaf[0]));
+}
+#endif
+
 #endif /* included_ip_ip4_fib_h */
 
 /*
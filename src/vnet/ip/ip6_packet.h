@@ -553,7 +553,8 @@ vlib_object_within_buffer_data (vlib_main_t * vm, vlib_buffer_t * b,
 {
   u8 *o = obj;
   if (o < b->data ||
-      o + len > b->data + vlib_buffer_get_default_data_size (vm))
+      o + len >
+	b->data + vlib_buffer_get_pool_data_size (vm, b->buffer_pool_index))
     return 0;
   return 1;
 }
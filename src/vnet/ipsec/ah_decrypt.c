@@ -119,7 +119,6 @@ ah_decrypt_inline (vlib_main_t * vm,
 {
   u32 n_left, *from;
   u32 thread_index = vm->thread_index;
-  u16 buffer_data_size = vlib_buffer_get_default_data_size (vm);
   ah_decrypt_packet_data_t pkt_data[VLIB_FRAME_SIZE], *pd = pkt_data;
   vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b = bufs;
   u16 nexts[VLIB_FRAME_SIZE], *next = nexts;
@@ -227,9 +226,12 @@ ah_decrypt_inline (vlib_main_t * vm,
       pd->nexthdr_cached = ah0->nexthdr;
       if (PREDICT_TRUE (sa0->integ_alg != IPSEC_INTEG_ALG_NONE))
 	{
+	  u32 data_size =
+	    vlib_buffer_get_pool_data_size (vm, b[0]->buffer_pool_index);
 	  if (PREDICT_FALSE (ipsec_sa_is_set_USE_ESN (sa0) &&
-			     pd->current_data + b[0]->current_length
-			     + sizeof (u32) > buffer_data_size))
+			     pd->current_data + b[0]->current_length +
+				 sizeof (u32) >
+			       data_size))
 	    {
 	      ah_decrypt_set_next_index (
 		b[0], node, vm->thread_index, AH_DECRYPT_ERROR_NO_TAIL_SPACE,
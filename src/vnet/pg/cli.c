@@ -192,11 +192,17 @@ format_pg_stream (u8 * s, va_list * va)
 
   s = format (s, "limit %Ld, ", t->n_packets_limit);
   s = format (s, "rate %.2e pps, ", t->rate_packets_per_second);
-  s = format (s, "size %d%c%d, ",
-	      t->min_packet_bytes,
-	      t->packet_size_edit_type == PG_EDIT_RANDOM ? '+' : '-',
-	      t->max_packet_bytes);
+  if (vec_len (t->packet_sizes))
+    s = format (s, "size imix %d-%d, ", t->min_packet_bytes,
+		t->max_packet_bytes);
+  else
+    s = format (s, "size %d%c%d, ", t->min_packet_bytes,
+		t->packet_size_edit_type == PG_EDIT_RANDOM ? '+' : '-',
+		t->max_packet_bytes);
   s = format (s, "buffer-size %d, ", t->buffer_bytes);
+  if (t->flags & PG_STREAM_FLAGS_FAST)
+    s = format (s, "fast %d templates %d-byte segments, ",
+		t->n_fast_templates, t->fast_segment_bytes);
   s = format (s, "worker %d, ", t->worker_index);
 
   if (verbose)
@@ -272,6 +278,70 @@ pg_pcap_read (pg_stream_t * s, char *file_name)
 #endif /* CLIB_UNIX */
 }
 
+/* Parse "size imix [<size>:<weight> ...]", 7:4:1 of 64, 570 and 1518
+   byte frames by default. Smooth weighted round robin spreads the sizes
+   evenly over a sequence of sum of weights packets. */
+static uword
+pg_stream_parse_imix (unformat_input_t *input, pg_stream_t *s)
+{
+  u32 sizes[16], weights[16];
+  i32 current[16] = {};
+  u32 n = 0, size, weight, total = 0, i, j;
+
+  while (n < ARRAY_LEN (sizes) &&
+	 unformat (input, "%u:%u", &size, &weight))
+    {
+      if (size == 0 || weight == 0)
+	return 0;
+      sizes[n] = size;
+      weights[n++] = weight;
+      total += weight;
+    }
+
+  if (n == 0)
+    {
+      u32 default_sizes[] = { 64, 570, 1518 }, default_weights[] = { 7, 4, 1 };
+
+      for (n = 0; n < ARRAY_LEN (default_sizes); n++)
+	{
+	  sizes[n] = default_sizes[n];
+	  weights[n] = default_weights[n];
+	  total += weights[n];
+	}
+    }
+
+  if (total > 1024)
+    return 0;
+
+  vec_reset_length (s->packet_sizes);
+  s->min_packet_bytes = ~0;
+  s->max_packet_bytes = 0;
+
+  for (i = 0; i < total; i++)
+    {
+      u32 best = 0;
+
+      for (j = 0; j < n; j++)
+	{
+	  current[j] += weights[j];
+	  if (current[j] > current[best])
+	    best = j;
+	}
+      current[best] -= total;
+      vec_add1 (s->packet_sizes, sizes[best]);
+    }
+
+  for (j = 0; j < n; j++)
+    {
+      s->min_packet_bytes = clib_min (s->min_packet_bytes, sizes[j]);
+      s->max_packet_bytes = clib_max (s->max_packet_bytes, sizes[j]);
+    }
+
+  /* anything but fixed, so the sizes are not taken from the packet data */
+  s->packet_size_edit_type = PG_EDIT_INCREMENT;
+  return 1;
+}
+
 static uword
 unformat_pg_stream_parameter (unformat_input_t * input, va_list * args)
 {
@@ -284,13 +354,22 @@ unformat_pg_stream_parameter (unformat_input_t * input, va_list * args)
   else if (unformat (input, "rate %f", &x))
     s->rate_packets_per_second = x;
 
+  else if (unformat (input, "size imix"))
+    return pg_stream_parse_imix (input, s);
+
   else if (unformat (input, "size %d-%d", &s->min_packet_bytes,
 		     &s->max_packet_bytes))
-    s->packet_size_edit_type = PG_EDIT_INCREMENT;
+    {
+      s->packet_size_edit_type = PG_EDIT_INCREMENT;
+      vec_reset_length (s->packet_sizes);
+    }
 
   else if (unformat (input, "size %d+%d", &s->min_packet_bytes,
 		     &s->max_packet_bytes))
-    s->packet_size_edit_type = PG_EDIT_RANDOM;
+    {
+      s->packet_size_edit_type = PG_EDIT_RANDOM;
+      vec_reset_length (s->packet_sizes);
+    }
 
   else if (unformat (input, "buffer-size %d", &s->buffer_bytes))
     ;
@@ -307,7 +386,11 @@ validate_stream (pg_stream_t * s)
   if (s->max_packet_bytes < s->min_packet_bytes)
     return clib_error_create ("max-size < min-size");
 
-  u32 hdr_size = pg_edit_group_n_bytes (s, 0);
+  pg_edit_group_t *g;
+  u32 hdr_size = 0;
+  vec_foreach (g, s->edit_groups)
+    if (!g->is_payload)
+      hdr_size += g->n_packet_bytes;
   if (s->min_packet_bytes < hdr_size)
     return clib_error_create ("min-size < total header size %d", hdr_size);
   if (s->buffer_bytes == 0)
@@ -316,6 +399,9 @@ validate_stream (pg_stream_t * s)
   if (s->rate_packets_per_second < 0)
     return clib_error_create ("negative rate");
 
+  if ((s->flags & PG_STREAM_FLAGS_FAST) && s->n_fast_templates == 0)
+    return clib_error_create ("fast stream needs at least one template");
+
   return 0;
 }
 
@@ -392,6 +478,13 @@ new_stream (vlib_main_t * vm,
 	s.n_max_frame = s.n_max_frame < maxframe ? s.n_max_frame : maxframe;
       else if (unformat (input, "worker %u", &s.worker_index))
 	;
+      else if (unformat (input, "fast %u", &s.n_fast_templates))
+	s.flags |= PG_STREAM_FLAGS_FAST;
+      else if (unformat (input, "fast"))
+	{
+	  s.n_fast_templates = PG_STREAM_N_FAST_TEMPLATES_DEFAULT;
+	  s.flags |= PG_STREAM_FLAGS_FAST;
+	}
 
       else if (unformat (input, "interface %U",
 			 unformat_vnet_sw_interface, vnm,
@@ -506,7 +599,10 @@ VLIB_CLI_COMMAND (new_stream_cli, static) = {
   "data STRING          specifies packet data\n"
   "pcap FILENAME        read packet data from pcap file\n"
   "rate PPS             rate to transfer packet data\n"
-  "maxframe NPKTS       maximum number of packets per frame\n",
+  "maxframe NPKTS       maximum number of packets per frame\n"
+  "size imix [S:W ...]  packet sizes S in the ratio of weights W\n"
+  "fast [NPKTS]         clone NPKTS pre-built packets instead of editing\n"
+  "                     each packet, buffer-size sets the segment size\n",
 };
 
 static clib_error_t *
@@ -550,6 +646,10 @@ change_stream_parameters (vlib_main_t * vm,
   s = pool_elt_at_index (pg->streams, stream_index);
   s_new = s[0];
 
+  /* buffer_bytes was reset to the default when the stream was added,
+     start from the segment size in use so only buffer-size changes it */
+  s_new.buffer_bytes = s->fast_segment_bytes;
+
   while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
     {
       if (unformat_user (input, unformat_pg_stream_parameter, &s_new))
@@ -129,7 +129,7 @@ unformat_pg_payload (unformat_input_t * input, va_list * args)
   pg_stream_t *s = va_arg (*args, pg_stream_t *);
   vlib_main_t *vm = vlib_get_main ();
   pg_edit_t *e;
-  u32 i, node_index, len, max_len;
+  u32 i, node_index, len, max_len, group_index;
   u8 *v;
 
   v = 0;
@@ -169,7 +169,8 @@ unformat_pg_payload (unformat_input_t * input, va_list * args)
 
   vec_resize (v, len);
 
-  e = pg_create_edit_group (s, sizeof (e[0]), len, 0);
+  e = pg_create_edit_group (s, sizeof (e[0]), len, &group_index);
+  pg_stream_get_group (s, group_index)->is_payload = 1;
 
   e->type = PG_EDIT_FIXED;
   e->n_bits = len * BITS (v[0]);
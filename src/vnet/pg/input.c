@@ -861,6 +861,20 @@ done:
 }
 
 static void
+pg_increment_rx_counter (pg_stream_t *s, u32 n_packets, u64 n_bytes)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  vnet_interface_main_t *im = &vnm->interface_main;
+  vnet_sw_interface_t *si =
+    vnet_get_sw_interface (vnm, s->sw_if_index[VLIB_RX]);
+
+  vlib_increment_combined_counter (im->combined_sw_if_counters
+				   + VNET_INTERFACE_COUNTER_RX,
+				   vlib_get_thread_index (),
+				   si->sw_if_index, n_packets, n_bytes);
+}
+
+static u64
 pg_generate_set_lengths (pg_main_t * pg,
 			 pg_stream_t * s, u32 * buffers, u32 n_buffers)
 {
@@ -871,7 +885,27 @@ pg_generate_set_lengths (pg_main_t * pg,
   v_max = s->max_packet_bytes;
   edit_type = s->packet_size_edit_type;
 
-  if (edit_type == PG_EDIT_INCREMENT)
+  if (vec_len (s->packet_sizes))
+    {
+      vlib_main_t *vm = vlib_get_main ();
+      u32 i = s->packet_size_index;
+
+      length_sum = 0;
+      while (n_buffers > 0)
+	{
+	  vlib_buffer_t *b0 = vlib_get_buffer (vm, buffers[0]);
+
+	  b0->current_length = s->packet_sizes[i];
+	  length_sum += b0->current_length;
+	  i = i + 1 == vec_len (s->packet_sizes) ? 0 : i + 1;
+
+	  buffers += 1;
+	  n_buffers -= 1;
+	}
+      s->packet_size_index = i;
+    }
+
+  else if (edit_type == PG_EDIT_INCREMENT)
     s->last_increment_packet_size
       = do_set_increment (pg, s, buffers, n_buffers,
 			  8 * STRUCT_SIZE_OF (vlib_buffer_t, current_length),
@@ -898,18 +932,7 @@ pg_generate_set_lengths (pg_main_t * pg,
       length_sum = v_min * n_buffers;
     }
 
-  {
-    vnet_main_t *vnm = vnet_get_main ();
-    vnet_interface_main_t *im = &vnm->interface_main;
-    vnet_sw_interface_t *si =
-      vnet_get_sw_interface (vnm, s->sw_if_index[VLIB_RX]);
-
-    vlib_increment_combined_counter (im->combined_sw_if_counters
-				     + VNET_INTERFACE_COUNTER_RX,
-				     vlib_get_thread_index (),
-				     si->sw_if_index, n_buffers, length_sum);
-  }
-
+  return length_sum;
 }
 
 static void
@@ -1184,7 +1207,8 @@ pg_stream_fill_helper (pg_main_t * pg,
 
   if (is_start_of_packet)
     {
-      pg_generate_set_lengths (pg, s, buffers, n_alloc);
+      u64 n_bytes = pg_generate_set_lengths (pg, s, buffers, n_alloc);
+      pg_increment_rx_counter (s, n_alloc, n_bytes);
       if (vec_len (s->buffer_indices) > 1)
 	pg_generate_fix_multi_buffer_lengths (pg, s, buffers, n_alloc);
 
@@ -1194,42 +1218,41 @@ pg_stream_fill_helper (pg_main_t * pg,
   return n_alloc;
 }
 
+/* Copy packet templates, starting at *template_index, into n_alloc
+   packets made of segment_bytes sized buffers and add them to the
+   stream fifo. */
 static u32
-pg_stream_fill_replay (pg_main_t * pg, pg_stream_t * s, u32 n_alloc)
+pg_stream_fill_from_templates (pg_main_t *pg, pg_stream_t *s, u8 **templates,
+			       u32 *template_index, u32 segment_bytes,
+			       u32 n_alloc)
 {
-  pg_buffer_index_t *bi;
+  pg_buffer_index_t *bi = s->buffer_indices;
   u32 n_left, i, l;
   u32 buffer_alloc_request = 0;
   u32 buffer_alloc_result;
-  u32 current_buffer_index;
-  u32 *buffers;
+  u32 *buffers, *b;
+  u64 n_bytes = 0;
+  vlib_buffer_t bt;
   vlib_main_t *vm = vlib_get_main ();
-  vnet_main_t *vnm = vnet_get_main ();
-  u32 buf_sz = vlib_buffer_get_default_data_size (vm);
-  vnet_interface_main_t *im = &vnm->interface_main;
-  vnet_sw_interface_t *si;
+
+  if (n_alloc == 0)
+    return 0;
 
   buffers = pg->replay_buffers_by_thread[vm->thread_index];
   vec_reset_length (buffers);
-  bi = s->buffer_indices;
 
-  n_left = n_alloc;
-  i = s->current_replay_packet_index;
-  l = vec_len (s->replay_packet_templates);
+  l = vec_len (templates);
 
   /* Figure out how many buffers we need */
-  while (n_left > 0)
+  for (n_left = n_alloc, i = *template_index; n_left > 0; n_left--)
     {
-      u8 *d0;
-
-      d0 = vec_elt (s->replay_packet_templates, i);
-      buffer_alloc_request += (vec_len (d0) + (buf_sz - 1)) / buf_sz;
+      u32 n_data = vec_len (templates[i]);
 
+      buffer_alloc_request +=
+	n_data ? (n_data + (segment_bytes - 1)) / segment_bytes : 1;
       i = ((i + 1) == l) ? 0 : i + 1;
-      n_left--;
     }
 
-  ASSERT (buffer_alloc_request > 0);
   vec_validate (buffers, buffer_alloc_request - 1);
 
   /* Allocate that many buffers */
@@ -1243,74 +1266,178 @@ pg_stream_fill_replay (pg_main_t * pg, pg_stream_t * s, u32 n_alloc)
       return 0;
     }
 
-  /* Now go generate the buffers, and add them to the FIFO */
-  n_left = n_alloc;
+  /* All buffers get the same metadata: set it up once and copy it into
+     each buffer with a few vector stores */
+  vlib_buffer_copy_template (&bt, vlib_get_buffer (vm, buffers[0]));
+  bt.current_data = 0;
+  bt.flags = s->buffer_flags;
+  vnet_buffer (&bt)->sw_if_index[VLIB_RX] = s->sw_if_index[VLIB_RX];
+  vnet_buffer (&bt)->sw_if_index[VLIB_TX] = s->sw_if_index[VLIB_TX];
 
-  current_buffer_index = 0;
-  i = s->current_replay_packet_index;
-  l = vec_len (s->replay_packet_templates);
-  while (n_left > 0)
+  /* Now go generate the buffers, and add them to the FIFO */
+  b = buffers;
+  for (n_left = n_alloc, i = *template_index; n_left > 0; n_left--)
     {
-      u8 *d0;
-      int not_last;
-      u32 data_offset;
-      u32 bytes_to_copy, bytes_this_chunk;
-      vlib_buffer_t *b;
-
-      d0 = vec_elt (s->replay_packet_templates, i);
-      data_offset = 0;
-      bytes_to_copy = vec_len (d0);
+      u8 *data = templates[i];
+      u32 n_data = vec_len (data);
+      vlib_buffer_t *b0, *first, *prev = 0;
 
       /* Add head chunk to pg fifo */
-      clib_fifo_add1 (bi->buffer_fifo, buffers[current_buffer_index]);
+      clib_fifo_add1 (bi->buffer_fifo, b[0]);
+      n_bytes += n_data;
+      first = vlib_get_buffer (vm, b[0]);
 
       /* Copy the data */
-      while (bytes_to_copy)
+      do
 	{
-	  bytes_this_chunk = clib_min (bytes_to_copy, buf_sz);
-	  ASSERT (current_buffer_index < vec_len (buffers));
-	  b = vlib_get_buffer (vm, buffers[current_buffer_index]);
-	  clib_memcpy_fast (b->data, d0 + data_offset, bytes_this_chunk);
-	  vnet_buffer (b)->sw_if_index[VLIB_RX] = s->sw_if_index[VLIB_RX];
-	  vnet_buffer (b)->sw_if_index[VLIB_TX] = s->sw_if_index[VLIB_TX];
-	  b->flags = s->buffer_flags;
-	  b->next_buffer = 0;
-	  b->current_data = 0;
-	  b->current_length = bytes_this_chunk;
-
-	  not_last = bytes_this_chunk < bytes_to_copy;
-	  if (not_last)
+	  u32 bytes_this_chunk = clib_min (n_data, segment_bytes);
+
+	  if (b + 4 < vec_end (buffers))
+	    vlib_prefetch_buffer_with_index (vm, b[4], STORE);
+
+	  b0 = vlib_get_buffer (vm, b[0]);
+	  vlib_buffer_copy_template (b0, &bt);
+	  b0->current_length = bytes_this_chunk;
+	  clib_memcpy_fast (b0->data, data, bytes_this_chunk);
+
+	  if (prev)
 	    {
-	      ASSERT (current_buffer_index < (vec_len (buffers) - 1));
-	      b->flags |= VLIB_BUFFER_NEXT_PRESENT;
-	      b->next_buffer = buffers[current_buffer_index + 1];
+	      prev->flags |= VLIB_BUFFER_NEXT_PRESENT;
+	      prev->next_buffer = b[0];
 	    }
-	  bytes_to_copy -= bytes_this_chunk;
-	  data_offset += bytes_this_chunk;
-	  current_buffer_index++;
+
+	  prev = b0;
+	  data += bytes_this_chunk;
+	  n_data -= bytes_this_chunk;
+	  b++;
+	}
+      while (n_data);
+
+      if (prev != first)
+	{
+	  first->total_length_not_including_first_buffer =
+	    vec_len (templates[i]) - first->current_length;
+	  first->flags |= VLIB_BUFFER_TOTAL_LENGTH_VALID;
 	}
 
       i = ((i + 1) == l) ? 0 : i + 1;
-      n_left--;
     }
 
   /* Update the interface counters */
-  si = vnet_get_sw_interface (vnm, s->sw_if_index[VLIB_RX]);
-  l = 0;
-  for (i = 0; i < n_alloc; i++)
-    l += vlib_buffer_index_length_in_chain (vm, buffers[i]);
-  vlib_increment_combined_counter (im->combined_sw_if_counters
-				   + VNET_INTERFACE_COUNTER_RX,
-				   vlib_get_thread_index (),
-				   si->sw_if_index, n_alloc, l);
+  pg_increment_rx_counter (s, n_alloc, n_bytes);
 
-  s->current_replay_packet_index += n_alloc;
-  s->current_replay_packet_index %= vec_len (s->replay_packet_templates);
+  *template_index = i;
 
   pg->replay_buffers_by_thread[vm->thread_index] = buffers;
   return n_alloc;
 }
 
+static u32
+pg_stream_fill_replay (pg_main_t * pg, pg_stream_t * s, u32 n_alloc)
+{
+  vlib_main_t *vm = vlib_get_main ();
+
+  return pg_stream_fill_from_templates (
+    pg, s, s->replay_packet_templates, &s->current_replay_packet_index,
+    vlib_buffer_get_default_data_size (vm), n_alloc);
+}
+
+/* Number of distinct packets a fast stream needs: one unless something
+   changes from packet to packet. */
+static u32
+pg_stream_n_fast_templates (pg_stream_t *s)
+{
+  pg_edit_t *e;
+
+  if (s->packet_size_edit_type != PG_EDIT_FIXED ||
+      vec_len (s->packet_sizes) > 1)
+    return s->n_fast_templates;
+
+  vec_foreach (e, s->non_fixed_edits)
+    if (e->type == PG_EDIT_INCREMENT || e->type == PG_EDIT_RANDOM)
+      return s->n_fast_templates;
+
+  return 1;
+}
+
+/* Run the regular fill and edit code once over the template packets of a
+   fast stream and keep their contents. */
+static int
+pg_stream_build_fast_templates (pg_main_t *pg, pg_stream_t *s)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  u32 n_levels = vec_len (s->buffer_indices);
+  u32 n_templates = pg_stream_n_fast_templates (s);
+  u32 *buffers = 0;
+  u8 **templates = 0;
+  int i;
+
+  vec_validate (buffers, n_levels * VLIB_FRAME_SIZE - 1);
+
+  while (vec_len (templates) < n_templates)
+    {
+      u32 n = clib_min (n_templates - vec_len (templates), VLIB_FRAME_SIZE);
+      u32 n_alloc = vlib_buffer_alloc (vm, buffers, n * n_levels);
+
+      if (n_alloc < n * n_levels)
+	{
+	  vlib_buffer_free_no_next (vm, buffers, n_alloc);
+	  goto done;
+	}
+
+      /* Same as pg_stream_fill: last buffer of the chain first */
+      for (i = n_levels - 1; i >= 0; i--)
+	{
+	  init_buffers_inline (vm, s, buffers + i * n, n,
+			       i * s->buffer_bytes /* data offset */,
+			       s->buffer_bytes, /* set_data */ 1);
+	  if (i < n_levels - 1)
+	    pg_set_next_buffer_pointers (pg, s, buffers + i * n,
+					 buffers + (i + 1) * n, n);
+	}
+
+      pg_generate_set_lengths (pg, s, buffers, n);
+      if (n_levels > 1)
+	pg_generate_fix_multi_buffer_lengths (pg, s, buffers, n);
+      pg_generate_edit (pg, s, buffers, n);
+
+      for (i = 0; i < n; i++)
+	{
+	  u8 *t = 0;
+
+	  vec_resize (t, vlib_buffer_length_in_chain (
+			   vm, vlib_get_buffer (vm, buffers[i])));
+	  vlib_buffer_contents (vm, buffers[i], t);
+	  vec_add1 (templates, t);
+	}
+
+      vlib_buffer_free (vm, buffers, n);
+    }
+
+  s->fast_packet_templates = templates;
+  s->current_fast_template_index = 0;
+  templates = 0;
+
+done:
+  for (i = 0; i < vec_len (templates); i++)
+    vec_free (templates[i]);
+  vec_free (templates);
+  vec_free (buffers);
+  return s->fast_packet_templates != 0;
+}
+
+static u32
+pg_stream_fill_fast (pg_main_t *pg, pg_stream_t *s, u32 n_alloc)
+{
+  if (PREDICT_FALSE (s->fast_packet_templates == 0) &&
+      !pg_stream_build_fast_templates (pg, s))
+    return 0;
+
+  return pg_stream_fill_from_templates (
+    pg, s, s->fast_packet_templates, &s->current_fast_template_index,
+    s->fast_segment_bytes, n_alloc);
+}
+
 
 static u32
 pg_stream_fill (pg_main_t * pg, pg_stream_t * s, u32 n_buffers)
@@ -1344,6 +1471,9 @@ pg_stream_fill (pg_main_t * pg, pg_stream_t * s, u32 n_buffers)
   if (s->replay_packet_templates)
     return pg_stream_fill_replay (pg, s, n_alloc);
 
+  if (s->flags & PG_STREAM_FLAGS_FAST)
+    return n_in_fifo + pg_stream_fill_fast (pg, s, n_alloc);
+
   /* All buffer fifos should have the same size. */
   if (CLIB_DEBUG > 0)
     {
@@ -1702,7 +1832,8 @@ pg_generate_packets (vlib_node_runtime_t * node,
 	  vlib_buffer_copy_indices (to_next + n, start, n_this_frame - n);
 	}
 
-      if (s->replay_packet_templates == 0)
+      if (s->replay_packet_templates == 0
+	  && !(s->flags & PG_STREAM_FLAGS_FAST))
 	{
 	  vec_foreach (bi, s->buffer_indices)
 	    clib_fifo_advance_head (bi->buffer_fifo, n_this_frame);
@@ -71,6 +71,9 @@ typedef struct pg_edit_group_t
   /* Number of packet bytes for this edit group. */
   u32 n_packet_bytes;
 
+  /* Group is the payload, which is cut short in smaller packets. */
+  u8 is_payload;
+
   /* Function to perform miscellaneous edits (e.g. set IP checksum, ...). */
   void (*edit_function) (struct pg_main_t * pg,
 			 struct pg_stream_t * s,
@@ -103,6 +106,9 @@ typedef struct pg_stream_t
   /* Stream is currently enabled. */
 #define PG_STREAM_FLAGS_IS_ENABLED (1 << 0)
 
+  /* Stream clones packets from a pool of pre-built templates. */
+#define PG_STREAM_FLAGS_FAST (1 << 1)
+
   /* Edit groups are created by each protocol level (e.g. ethernet,
      ip4, tcp, ...). */
   pg_edit_group_t *edit_groups;
@@ -134,6 +140,10 @@ typedef struct pg_stream_t
   /* Last packet length if packet size edit type is increment. */
   u32 last_increment_packet_size;
 
+  /* Packet sizes used in turn instead of the size edit (e.g. imix). */
+  u32 *packet_sizes;
+  u32 packet_size_index;
+
   /* Index into main interface pool for this stream. */
   u32 pg_if_index;
 
@@ -179,8 +189,17 @@ typedef struct pg_stream_t
   u8 **replay_packet_templates;
   u64 *replay_packet_timestamps;
   u32 current_replay_packet_index;
+
+  /* Fast streams run the edits once over n_fast_templates packets and
+     then only copy the results into fresh buffers of fast_segment_bytes. */
+  u8 **fast_packet_templates;
+  u32 n_fast_templates;
+  u32 fast_segment_bytes;
+  u32 current_fast_template_index;
 } pg_stream_t;
 
+#define PG_STREAM_N_FAST_TEMPLATES_DEFAULT 1024
+
 always_inline void
 pg_buffer_index_free (pg_buffer_index_t * bi)
 {
@@ -198,6 +217,16 @@ pg_edit_group_free (pg_edit_group_t * g)
   vec_free (g->fixed_packet_data_mask);
 }
 
+always_inline void
+pg_stream_free_fast_templates (pg_stream_t *s)
+{
+  int i;
+  for (i = 0; i < vec_len (s->fast_packet_templates); i++)
+    vec_free (s->fast_packet_templates[i]);
+  vec_free (s->fast_packet_templates);
+  s->current_fast_template_index = 0;
+}
+
 always_inline void
 pg_stream_free (pg_stream_t * s)
 {
@@ -215,6 +244,8 @@ pg_stream_free (pg_stream_t * s)
     vec_free (s->replay_packet_templates[i]);
   vec_free (s->replay_packet_templates);
   vec_free (s->replay_packet_timestamps);
+  pg_stream_free_fast_templates (s);
+  vec_free (s->packet_sizes);
 
   {
     pg_buffer_index_t *bi;
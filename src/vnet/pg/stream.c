@@ -478,6 +478,32 @@ perform_fixed_edits (pg_stream_t * s)
   }
 }
 
+/* Fast streams copy packets into buffers of the given buffer size, so
+   chained packets can be generated on purpose. The regular fill always
+   uses full buffers. */
+static void
+pg_stream_set_buffer_bytes (vlib_main_t *vm, pg_stream_t *s)
+{
+  s->fast_segment_bytes = vlib_buffer_get_default_data_size (vm);
+  if (s->buffer_bytes && s->buffer_bytes < s->fast_segment_bytes)
+    s->fast_segment_bytes =
+      clib_max (s->buffer_bytes, VLIB_BUFFER_MIN_CHAIN_SEG_SIZE);
+
+  s->buffer_bytes = vlib_buffer_get_default_data_size (vm);
+}
+
+/* Templates are sent in a loop, so they hold whole rounds of the packet
+   size sequence, or the size mix would be off at every wrap. */
+static void
+pg_stream_round_fast_templates (pg_stream_t *s)
+{
+  u32 n_sizes = vec_len (s->packet_sizes);
+
+  if (n_sizes > 1)
+    s->n_fast_templates =
+      (s->n_fast_templates + n_sizes - 1) / n_sizes * n_sizes;
+}
+
 void
 pg_stream_add (pg_main_t * pg, pg_stream_t * s_init)
 {
@@ -531,10 +557,12 @@ pg_stream_add (pg_main_t * pg, pg_stream_t * s_init)
 
   s->last_increment_packet_size = s->min_packet_bytes;
 
+  pg_stream_set_buffer_bytes (vm, s);
+  pg_stream_round_fast_templates (s);
+
   {
     int n;
 
-    s->buffer_bytes = vlib_buffer_get_default_data_size (vm);
     n = s->max_packet_bytes / s->buffer_bytes;
     n += (s->max_packet_bytes % s->buffer_bytes) != 0;
 
@@ -590,6 +618,8 @@ pg_stream_del (pg_main_t * pg, uword index)
 void
 pg_stream_change (pg_main_t * pg, pg_stream_t * s)
 {
+  vlib_main_t *vm = vlib_get_main ();
+
   /* Determine packet size. */
   switch (s->packet_size_edit_type)
     {
@@ -610,6 +640,13 @@ pg_stream_change (pg_main_t * pg, pg_stream_t * s)
     }
 
   s->last_increment_packet_size = s->min_packet_bytes;
+  s->packet_size_index = 0;
+
+  pg_stream_set_buffer_bytes (vm, s);
+  pg_stream_round_fast_templates (s);
+
+  /* Templates are rebuilt with the new parameters on next use. */
+  pg_stream_free_fast_templates (s);
 }
 
 
@@ -168,8 +168,7 @@ segment_manager_add_segment_inline (segment_manager_t *sm, uword segment_size,
   /*
    * Set watermarks in segment
    */
-  fs->high_watermark = sm->high_watermark;
-  fs->low_watermark = sm->low_watermark;
+  fifo_segment_set_watermarks (fs, sm->high_watermark, sm->low_watermark);
   fs->flags = flags;
   fs->flags &= ~FIFO_SEGMENT_F_MEM_LIMIT;
   fs->h->pct_first_alloc = props->pct_first_alloc;
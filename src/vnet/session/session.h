@@ -549,7 +549,7 @@ always_inline u32
 transport_max_rx_enqueue (transport_connection_t * tc)
 {
   session_t *s = session_get (tc->s_index, tc->thread_index);
-  return svm_fifo_max_enqueue_prod (s->rx_fifo);
+  return svm_fifo_max_enqueue_window (s->rx_fifo);
 }
 
 always_inline u32
@@ -282,24 +282,31 @@ session_lookup_add_connection (transport_connection_t * tc, u64 value)
   session_table_t *st;
   session_kv4_t kv4;
   session_kv6_t kv6;
+  int rv;
 
   st = session_table_get_or_alloc_for_connection (tc);
   if (!st)
     return -1;
+
+  /* Account for key before it becomes visible to lookups */
+  session_table_port_filter_add_del (st, tc->proto, tc->lcl_port, 1);
   if (tc->is_ip4)
     {
       make_v4_ss_kv_from_tc (&kv4, tc);
       kv4.value = value;
-      return clib_bihash_add_del_16_8 (&st->v4_session_hash, &kv4,
-				       1 /* is_add */ );
+      rv = clib_bihash_add_del_16_8 (&st->v4_session_hash, &kv4,
+				     1 /* is_add */ );
     }
   else
     {
       make_v6_ss_kv_from_tc (&kv6, tc);
       kv6.value = value;
-      return clib_bihash_add_del_48_8 (&st->v6_session_hash, &kv6,
-				       1 /* is_add */ );
+      rv = clib_bihash_add_del_48_8 (&st->v6_session_hash, &kv6,
+				     1 /* is_add */ );
     }
+  if (rv)
+    session_table_port_filter_add_del (st, tc->proto, tc->lcl_port, 0);
+  return rv;
 }
 
 int
@@ -309,24 +316,31 @@ session_lookup_add_session_endpoint (u32 table_index,
   session_table_t *st;
   session_kv4_t kv4;
   session_kv6_t kv6;
+  int rv;
 
   st = session_table_get (table_index);
   if (!st)
     return -1;
+
+  session_table_port_filter_add_del (st, sep->transport_proto, sep->port, 1);
   if (sep->is_ip4)
     {
       make_v4_listener_kv (&kv4, &sep->ip.ip4, sep->port,
 			   sep->transport_proto);
       kv4.value = value;
-      return clib_bihash_add_del_16_8 (&st->v4_session_hash, &kv4, 1);
+      rv = clib_bihash_add_del_16_8 (&st->v4_session_hash, &kv4, 1);
     }
   else
     {
       make_v6_listener_kv (&kv6, &sep->ip.ip6, sep->port,
 			   sep->transport_proto);
       kv6.value = value;
-      return clib_bihash_add_del_48_8 (&st->v6_session_hash, &kv6, 1);
+      rv = clib_bihash_add_del_48_8 (&st->v6_session_hash, &kv6, 1);
     }
+  if (rv)
+    session_table_port_filter_add_del (st, sep->transport_proto, sep->port,
+				       0);
+  return rv;
 }
 
 int
@@ -336,6 +350,7 @@ session_lookup_del_session_endpoint (u32 table_index,
   session_table_t *st;
   session_kv4_t kv4;
   session_kv6_t kv6;
+  int rv;
 
   st = session_table_get (table_index);
   if (!st)
@@ -344,14 +359,18 @@ session_lookup_del_session_endpoint (u32 table_index,
     {
       make_v4_listener_kv (&kv4, &sep->ip.ip4, sep->port,
 			   sep->transport_proto);
-      return clib_bihash_add_del_16_8 (&st->v4_session_hash, &kv4, 0);
+      rv = clib_bihash_add_del_16_8 (&st->v4_session_hash, &kv4, 0);
     }
   else
     {
       make_v6_listener_kv (&kv6, &sep->ip.ip6, sep->port,
 			   sep->transport_proto);
-      return clib_bihash_add_del_48_8 (&st->v6_session_hash, &kv6, 0);
+      rv = clib_bihash_add_del_48_8 (&st->v6_session_hash, &kv6, 0);
     }
+  if (!rv)
+    session_table_port_filter_add_del (st, sep->transport_proto, sep->port,
+				       0);
+  return rv;
 }
 
 int
@@ -361,6 +380,7 @@ session_lookup_del_session_endpoint2 (session_endpoint_t * sep)
   session_table_t *st;
   session_kv4_t kv4;
   session_kv6_t kv6;
+  int rv;
 
   fib_proto = sep->is_ip4 ? FIB_PROTOCOL_IP4 : FIB_PROTOCOL_IP6;
   st = session_table_get_for_fib_index (fib_proto, sep->fib_index);
@@ -370,14 +390,18 @@ session_lookup_del_session_endpoint2 (session_endpoint_t * sep)
     {
       make_v4_listener_kv (&kv4, &sep->ip.ip4, sep->port,
 			   sep->transport_proto);
-      return clib_bihash_add_del_16_8 (&st->v4_session_hash, &kv4, 0);
+      rv = clib_bihash_add_del_16_8 (&st->v4_session_hash, &kv4, 0);
     }
   else
     {
       make_v6_listener_kv (&kv6, &sep->ip.ip6, sep->port,
 			   sep->transport_proto);
-      return clib_bihash_add_del_48_8 (&st->v6_session_hash, &kv6, 0);
+      rv = clib_bihash_add_del_48_8 (&st->v6_session_hash, &kv6, 0);
     }
+  if (!rv)
+    session_table_port_filter_add_del (st, sep->transport_proto, sep->port,
+				       0);
+  return rv;
 }
 
 /**
@@ -394,6 +418,7 @@ session_lookup_del_connection (transport_connection_t * tc)
   session_table_t *st;
   session_kv4_t kv4;
   session_kv6_t kv6;
+  int rv;
 
   st = session_table_get_for_connection (tc);
   if (!st)
@@ -401,15 +426,18 @@ session_lookup_del_connection (transport_connection_t * tc)
   if (tc->is_ip4)
     {
       make_v4_ss_kv_from_tc (&kv4, tc);
-      return clib_bihash_add_del_16_8 (&st->v4_session_hash, &kv4,
-				       0 /* is_add */ );
+      rv = clib_bihash_add_del_16_8 (&st->v4_session_hash, &kv4,
+				     0 /* is_add */ );
     }
   else
     {
       make_v6_ss_kv_from_tc (&kv6, tc);
-      return clib_bihash_add_del_48_8 (&st->v6_session_hash, &kv6,
-				       0 /* is_add */ );
+      rv = clib_bihash_add_del_48_8 (&st->v6_session_hash, &kv6,
+				     0 /* is_add */ );
     }
+  if (!rv)
+    session_table_port_filter_add_del (st, tc->proto, tc->lcl_port, 0);
+  return rv;
 }
 
 int
@@ -832,24 +860,30 @@ session_lookup_add_half_open (transport_connection_t * tc, u64 value)
   session_table_t *st;
   session_kv4_t kv4;
   session_kv6_t kv6;
+  int rv;
 
   st = session_table_get_or_alloc_for_connection (tc);
   if (!st)
     return 0;
+
+  session_table_port_filter_add_del (st, tc->proto, tc->lcl_port, 1);
   if (tc->is_ip4)
     {
       make_v4_ss_kv_from_tc (&kv4, tc);
       kv4.value = value;
-      return clib_bihash_add_del_16_8 (&st->v4_half_open_hash, &kv4,
-				       1 /* is_add */ );
+      rv = clib_bihash_add_del_16_8 (&st->v4_half_open_hash, &kv4,
+				     1 /* is_add */ );
     }
   else
     {
       make_v6_ss_kv_from_tc (&kv6, tc);
       kv6.value = value;
-      return clib_bihash_add_del_48_8 (&st->v6_half_open_hash, &kv6,
-				       1 /* is_add */ );
+      rv = clib_bihash_add_del_48_8 (&st->v6_half_open_hash, &kv6,
+				     1 /* is_add */ );
     }
+  if (rv)
+    session_table_port_filter_add_del (st, tc->proto, tc->lcl_port, 0);
+  return rv;
 }
 
 int
@@ -858,6 +892,7 @@ session_lookup_del_half_open (transport_connection_t * tc)
   session_table_t *st;
   session_kv4_t kv4;
   session_kv6_t kv6;
+  int rv;
 
   st = session_table_get_for_connection (tc);
   if (!st)
@@ -865,15 +900,18 @@ session_lookup_del_half_open (transport_connection_t * tc)
   if (tc->is_ip4)
     {
       make_v4_ss_kv_from_tc (&kv4, tc);
-      return clib_bihash_add_del_16_8 (&st->v4_half_open_hash, &kv4,
-				       0 /* is_add */ );
+      rv = clib_bihash_add_del_16_8 (&st->v4_half_open_hash, &kv4,
+				     0 /* is_add */ );
     }
   else
     {
       make_v6_ss_kv_from_tc (&kv6, tc);
-      return clib_bihash_add_del_48_8 (&st->v6_half_open_hash, &kv6,
-				       0 /* is_add */ );
+      rv = clib_bihash_add_del_48_8 (&st->v6_half_open_hash, &kv6,
+				     0 /* is_add */ );
     }
+  if (!rv)
+    session_table_port_filter_add_del (st, tc->proto, tc->lcl_port, 0);
+  return rv;
 }
 
 u64
@@ -954,12 +992,21 @@ session_lookup_connection_wt4 (u32 fib_index, ip4_address_t * lcl,
   session_kv4_t kv4;
   session_t *s;
   u32 action_index;
+  u8 maybe_match;
   int rv;
 
   st = session_table_get_for_fib_index (FIB_PROTOCOL_IP4, fib_index);
   if (PREDICT_FALSE (!st))
     return 0;
 
+  /*
+   * Skip table lookups if no key uses the local port, e.g., scans or
+   * floods towards closed ports. Only session rules may match.
+   */
+  maybe_match = session_table_port_filter_test (st, proto, lcl_port);
+  if (PREDICT_FALSE (!maybe_match))
+    goto rules;
+
   /*
    * Lookup session amongst established ones
    */
@@ -984,6 +1031,7 @@ session_lookup_connection_wt4 (u32 fib_index, ip4_address_t * lcl,
   if (rv == 0)
     return transport_get_half_open (proto, kv4.value & 0xFFFFFFFF);
 
+rules:
   /*
    * Check the session rules table
    */
@@ -1005,6 +1053,8 @@ session_lookup_connection_wt4 (u32 fib_index, ip4_address_t * lcl,
   /*
    * If nothing is found, check if any listener is available
    */
+  if (PREDICT_FALSE (!maybe_match))
+    return 0;
   s = session_lookup_listener4_i (st, lcl, lcl_port, proto, 1);
   if (s)
     return transport_get_listener (proto, s->connection_index);
@@ -1012,6 +1062,31 @@ session_lookup_connection_wt4 (u32 fib_index, ip4_address_t * lcl,
   return 0;
 }
 
+/**
+ * Prefetch established sessions table bucket for ip4 connection
+ *
+ * Meant to be called for packets a few positions ahead of the one looked up
+ * with @ref session_lookup_connection_wt4. Nothing is prefetched if the
+ * port filter shows that no key can match.
+ */
+void
+session_lookup_prefetch4 (u32 fib_index, ip4_address_t *lcl,
+			  ip4_address_t *rmt, u16 lcl_port, u16 rmt_port,
+			  u8 proto)
+{
+  session_table_t *st;
+  session_kv4_t kv4;
+
+  st = session_table_get_for_fib_index (FIB_PROTOCOL_IP4, fib_index);
+  if (PREDICT_FALSE (!st) ||
+      !session_table_port_filter_test (st, proto, lcl_port))
+    return;
+
+  make_v4_ss_kv (&kv4, lcl, rmt, lcl_port, rmt_port, proto);
+  clib_bihash_prefetch_bucket_16_8 (&st->v4_session_hash,
+				    clib_bihash_hash_16_8 (&kv4));
+}
+
 /**
  * Lookup connection with ip4 and transport layer information
  *
@@ -1036,12 +1111,21 @@ session_lookup_connection4 (u32 fib_index, ip4_address_t * lcl,
   session_kv4_t kv4;
   session_t *s;
   u32 action_index;
+  u8 maybe_match;
   int rv;
 
   st = session_table_get_for_fib_index (FIB_PROTOCOL_IP4, fib_index);
   if (PREDICT_FALSE (!st))
     return 0;
 
+  /*
+   * Skip table lookups if no key uses the local port, e.g., scans or
+   * floods towards closed ports. Only session rules may match.
+   */
+  maybe_match = session_table_port_filter_test (st, proto, lcl_port);
+  if (PREDICT_FALSE (!maybe_match))
+    goto rules;
+
   /*
    * Lookup session amongst established ones
    */
@@ -1061,6 +1145,7 @@ session_lookup_connection4 (u32 fib_index, ip4_address_t * lcl,
   if (rv == 0)
     return transport_get_half_open (proto, kv4.value & 0xFFFFFFFF);
 
+rules:
   /*
    * Check the session rules table
    */
@@ -1079,6 +1164,8 @@ session_lookup_connection4 (u32 fib_index, ip4_address_t * lcl,
   /*
    * If nothing is found, check if any listener is available
    */
+  if (PREDICT_FALSE (!maybe_match))
+    return 0;
   s = session_lookup_listener4_i (st, lcl, lcl_port, proto, 1);
   if (s)
     return transport_get_listener (proto, s->connection_index);
@@ -1105,12 +1192,21 @@ session_lookup_safe4 (u32 fib_index, ip4_address_t * lcl, ip4_address_t * rmt,
   session_kv4_t kv4;
   session_t *s;
   u32 action_index;
+  u8 maybe_match;
   int rv;
 
   st = session_table_get_for_fib_index (FIB_PROTOCOL_IP4, fib_index);
   if (PREDICT_FALSE (!st))
     return 0;
 
+  /*
+   * Skip table lookups if no key uses the local port, e.g., scans or
+   * floods towards closed ports. Only session rules may match.
+   */
+  maybe_match = session_table_port_filter_test (st, proto, lcl_port);
+  if (PREDICT_FALSE (!maybe_match))
+    goto rules;
+
   /*
    * Lookup session amongst established ones
    */
@@ -1119,6 +1215,7 @@ session_lookup_safe4 (u32 fib_index, ip4_address_t * lcl, ip4_address_t * rmt,
   if (rv == 0)
     return session_get_from_handle_safe (kv4.value);
 
+rules:
   /*
    * Check the session rules table
    */
@@ -1135,6 +1232,8 @@ session_lookup_safe4 (u32 fib_index, ip4_address_t * lcl, ip4_address_t * rmt,
   /*
    *  If nothing is found, check if any listener is available
    */
+  if (PREDICT_FALSE (!maybe_match))
+    return 0;
   if ((s = session_lookup_listener4_i (st, lcl, lcl_port, proto, 1)))
     return s;
 
@@ -1176,12 +1275,18 @@ session_lookup_connection_wt6 (u32 fib_index, ip6_address_t * lcl,
   session_t *s;
   session_kv6_t kv6;
   u32 action_index;
+  u8 maybe_match;
   int rv;
 
   st = session_table_get_for_fib_index (FIB_PROTOCOL_IP6, fib_index);
   if (PREDICT_FALSE (!st))
     return 0;
 
+  /* Only session rules may match if no key uses the local port */
+  maybe_match = session_table_port_filter_test (st, proto, lcl_port);
+  if (PREDICT_FALSE (!maybe_match))
+    goto rules;
+
   make_v6_ss_kv (&kv6, lcl, rmt, lcl_port, rmt_port, proto);
   rv = clib_bihash_search_inline_48_8 (&st->v6_session_hash, &kv6);
   if (rv == 0)
@@ -1201,6 +1306,7 @@ session_lookup_connection_wt6 (u32 fib_index, ip6_address_t * lcl,
   if (rv == 0)
     return transport_get_half_open (proto, kv6.value & 0xFFFFFFFF);
 
+rules:
   /* Check the session rules table */
   action_index = session_rules_table_lookup6 (&st->session_rules[proto], lcl,
 					      rmt, lcl_port, rmt_port);
@@ -1218,6 +1324,8 @@ session_lookup_connection_wt6 (u32 fib_index, ip6_address_t * lcl,
     }
 
   /* If nothing is found, check if any listener is available */
+  if (PREDICT_FALSE (!maybe_match))
+    return 0;
   s = session_lookup_listener6_i (st, lcl, lcl_port, proto, 1);
   if (s)
     return transport_get_listener (proto, s->connection_index);
@@ -1225,6 +1333,29 @@ session_lookup_connection_wt6 (u32 fib_index, ip6_address_t * lcl,
   return 0;
 }
 
+/**
+ * Prefetch established sessions table bucket for ip6 connection
+ *
+ * See @ref session_lookup_prefetch4
+ */
+void
+session_lookup_prefetch6 (u32 fib_index, ip6_address_t *lcl,
+			  ip6_address_t *rmt, u16 lcl_port, u16 rmt_port,
+			  u8 proto)
+{
+  session_table_t *st;
+  session_kv6_t kv6;
+
+  st = session_table_get_for_fib_index (FIB_PROTOCOL_IP6, fib_index);
+  if (PREDICT_FALSE (!st) ||
+      !session_table_port_filter_test (st, proto, lcl_port))
+    return;
+
+  make_v6_ss_kv (&kv6, lcl, rmt, lcl_port, rmt_port, proto);
+  clib_bihash_prefetch_bucket_48_8 (&st->v6_session_hash,
+				    clib_bihash_hash_48_8 (&kv6));
+}
+
 /**
  * Lookup connection with ip6 and transport layer information
  *
@@ -1250,12 +1381,18 @@ session_lookup_connection6 (u32 fib_index, ip6_address_t * lcl,
   session_t *s;
   session_kv6_t kv6;
   u32 action_index;
+  u8 maybe_match;
   int rv;
 
   st = session_table_get_for_fib_index (FIB_PROTOCOL_IP6, fib_index);
   if (PREDICT_FALSE (!st))
     return 0;
 
+  /* Only session rules may match if no key uses the local port */
+  maybe_match = session_table_port_filter_test (st, proto, lcl_port);
+  if (PREDICT_FALSE (!maybe_match))
+    goto rules;
+
   make_v6_ss_kv (&kv6, lcl, rmt, lcl_port, rmt_port, proto);
   rv = clib_bihash_search_inline_48_8 (&st->v6_session_hash, &kv6);
   if (rv == 0)
@@ -1270,6 +1407,7 @@ session_lookup_connection6 (u32 fib_index, ip6_address_t * lcl,
   if (rv == 0)
     return transport_get_half_open (proto, kv6.value & 0xFFFFFFFF);
 
+rules:
   /* Check the session rules table */
   action_index = session_rules_table_lookup6 (&st->session_rules[proto], lcl,
 					      rmt, lcl_port, rmt_port);
@@ -1284,6 +1422,8 @@ session_lookup_connection6 (u32 fib_index, ip6_address_t * lcl,
     }
 
   /* If nothing is found, check if any listener is available */
+  if (PREDICT_FALSE (!maybe_match))
+    return 0;
   s = session_lookup_listener6_i (st, lcl, lcl_port, proto, 1);
   if (s)
     return transport_get_listener (proto, s->connection_index);
@@ -1312,17 +1452,24 @@ session_lookup_safe6 (u32 fib_index, ip6_address_t * lcl, ip6_address_t * rmt,
   session_kv6_t kv6;
   session_t *s;
   u32 action_index;
+  u8 maybe_match;
   int rv;
 
   st = session_table_get_for_fib_index (FIB_PROTOCOL_IP6, fib_index);
   if (PREDICT_FALSE (!st))
     return 0;
 
+  /* Only session rules may match if no key uses the local port */
+  maybe_match = session_table_port_filter_test (st, proto, lcl_port);
+  if (PREDICT_FALSE (!maybe_match))
+    goto rules;
+
   make_v6_ss_kv (&kv6, lcl, rmt, lcl_port, rmt_port, proto);
   rv = clib_bihash_search_inline_48_8 (&st->v6_session_hash, &kv6);
   if (rv == 0)
     return session_get_from_handle_safe (kv6.value);
 
+rules:
   /* Check the session rules table */
   action_index = session_rules_table_lookup6 (&st->session_rules[proto], lcl,
 					      rmt, lcl_port, rmt_port);
@@ -1335,6 +1482,8 @@ session_lookup_safe6 (u32 fib_index, ip6_address_t * lcl, ip6_address_t * rmt,
     }
 
   /* If nothing is found, check if any listener is available */
+  if (PREDICT_FALSE (!maybe_match))
+    return 0;
   if ((s = session_lookup_listener6_i (st, lcl, lcl_port, proto, 1)))
     return s;
   return 0;
@@ -48,6 +48,12 @@ transport_connection_t *session_lookup_connection_wt4 (u32 fib_index,
 						       u16 rmt_port, u8 proto,
 						       u32 thread_index,
 						       u8 * is_filtered);
+void session_lookup_prefetch4 (u32 fib_index, ip4_address_t *lcl,
+			       ip4_address_t *rmt, u16 lcl_port, u16 rmt_port,
+			       u8 proto);
+void session_lookup_prefetch6 (u32 fib_index, ip6_address_t *lcl,
+			       ip6_address_t *rmt, u16 lcl_port, u16 rmt_port,
+			       u8 proto);
 transport_connection_t *session_lookup_connection4 (u32 fib_index,
 						    ip4_address_t * lcl,
 						    ip4_address_t * rmt,
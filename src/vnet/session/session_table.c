@@ -70,6 +70,7 @@ session_table_free (session_table_t *slt, u8 fib_proto)
     session_rules_table_free (&slt->session_rules[i]);
 
   vec_free (slt->session_rules);
+  vec_free (slt->lcl_port_filter);
 
   if (fib_proto == FIB_PROTOCOL_IP4 || all)
     {
@@ -157,6 +158,10 @@ session_table_init (session_table_t * slt, u8 fib_proto)
   vec_validate (slt->session_rules, TRANSPORT_N_PROTOS - 1);
   for (i = 0; i < TRANSPORT_N_PROTOS; i++)
     session_rules_table_init (&slt->session_rules[i]);
+
+  vec_validate_aligned (slt->lcl_port_filter,
+			(1 << SESSION_TABLE_PORT_FILTER_LOG2_SIZE) - 1,
+			CLIB_CACHE_LINE_BYTES);
 }
 
 typedef struct _ip4_session_table_walk_ctx_t
@@ -39,6 +39,12 @@ typedef struct _session_lookup_table
    */
   session_rules_table_t *session_rules;
 
+  /**
+   * Counts of lookup table keys per hashed local port and transport
+   * proto. Zero means no established, half-open or listen key can match
+   */
+  u32 *lcl_port_filter;
+
   /** Flag that indicates if table has local scope */
   u8 is_local;
 
@@ -54,6 +60,7 @@ typedef struct _session_lookup_table
 } session_table_t;
 
 #define SESSION_TABLE_INVALID_INDEX ((u32)~0)
+#define SESSION_TABLE_PORT_FILTER_LOG2_SIZE 14
 #define SESSION_LOCAL_TABLE_PREFIX ((u32)~0)
 #define SESSION_DROP_HANDLE (((u64)~0) - 1)
 
@@ -80,6 +87,44 @@ session_table_t *_get_session_tables ();
 
 void session_lookup_table_cleanup (u32 fib_proto, u32 fib_index);
 
+always_inline u32
+session_table_port_filter_index (u8 proto, u16 lcl_port)
+{
+  u32 key = ((u32) proto << 16) | lcl_port;
+  return (key * 0x9e3779b1) >> (32 - SESSION_TABLE_PORT_FILTER_LOG2_SIZE);
+}
+
+always_inline void
+session_table_port_filter_add_del (session_table_t *st, u8 proto,
+				   u16 lcl_port, u8 is_add)
+{
+  u32 *cnt;
+
+  cnt = &st->lcl_port_filter[session_table_port_filter_index (proto,
+							      lcl_port)];
+  if (is_add)
+    clib_atomic_fetch_add_rel (cnt, 1);
+  else
+    clib_atomic_fetch_sub_rel (cnt, 1);
+}
+
+/**
+ * Check if any established, half-open or listen key may match local port
+ *
+ * Proxy listeners are keyed with port 0 and match all ports. False
+ * positives are possible, false negatives are not.
+ */
+always_inline u8
+session_table_port_filter_test (session_table_t *st, u8 proto, u16 lcl_port)
+{
+  u32 *filter = st->lcl_port_filter;
+
+  return (clib_atomic_load_acq_n (
+	    &filter[session_table_port_filter_index (proto, lcl_port)]) ||
+	  clib_atomic_load_acq_n (
+	    &filter[session_table_port_filter_index (proto, 0)]));
+}
+
 #endif /* SRC_VNET_SESSION_SESSION_TABLE_H_ */
 /*
  * fd.io coding-style-patch-verification: ON
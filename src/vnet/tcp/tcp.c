@@ -266,7 +266,7 @@ tcp_connection_cleanup (tcp_connection_t * tc)
       vec_free (tc->snd_sacks);
       vec_free (tc->snd_sacks_fl);
       vec_free (tc->rcv_opts.sacks);
-      pool_free (tc->sack_sb.holes);
+      scoreboard_free (&tc->sack_sb);
 
       if (tc->cfg_flags & TCP_CFG_F_RATE_SAMPLE)
 	tcp_bt_cleanup (tc);
@@ -329,6 +329,7 @@ void
 tcp_connection_free (tcp_connection_t * tc)
 {
   tcp_worker_ctx_t *wrk = tcp_get_worker (tc->c_thread_index);
+  tcp_connection_embryonic_done (tc);
   if (CLIB_DEBUG)
     {
       clib_memset (tc, 0xFA, sizeof (*tc));
@@ -764,6 +765,10 @@ tcp_connection_init_vars (tcp_connection_t * tc)
       || tcp_cfg.enable_tx_pacing)
     tcp_enable_pacing (tc);
 
+  /* RACK relies on the byte tracker for segment tx times */
+  if (tcp_cfg.enable_rack)
+    tc->cfg_flags |= TCP_CFG_F_RACK | TCP_CFG_F_RATE_SAMPLE;
+
   if (tc->cfg_flags & TCP_CFG_F_RATE_SAMPLE)
     tcp_bt_init (tc);
 
@@ -943,8 +948,7 @@ tcp_set_attribute (tcp_connection_t *tc, transport_endpt_attr_t *attr)
 	tc->cfg_flags &= ~TCP_CFG_F_NO_CSUM_OFFLOAD;
       if (attr->flags & TRANSPORT_ENDPT_ATTR_F_GSO)
 	{
-	  if (!(tc->cfg_flags & TCP_CFG_F_TSO))
-	    tcp_check_gso (tc);
+	  tcp_check_gso (tc);
 	  tc->cfg_flags &= ~TCP_CFG_F_NO_TSO;
 	}
       else
@@ -962,7 +966,7 @@ tcp_set_attribute (tcp_connection_t *tc, transport_endpt_attr_t *attr)
 	{
 	  if (tc->cfg_flags & TCP_CFG_F_RATE_SAMPLE)
 	    tcp_bt_cleanup (tc);
-	  tc->cfg_flags &= ~TCP_CFG_F_RATE_SAMPLE;
+	  tc->cfg_flags &= ~(TCP_CFG_F_RATE_SAMPLE | TCP_CFG_F_RACK);
 	}
       break;
     case TRANSPORT_ENDPT_ATTR_CC_ALGO:
@@ -1033,10 +1037,14 @@ tcp_session_attribute (u32 conn_index, u32 thread_index, u8 is_get,
 static u16
 tcp_session_cal_goal_size (tcp_connection_t * tc)
 {
-  u16 goal_size = tc->snd_mss;
+  u32 goal_size;
 
-  goal_size = tcp_cfg.max_gso_size - tc->snd_mss % tcp_cfg.max_gso_size;
+  /* Super-segment and its headers must fit in an ip packet. Keep it a
+   * multiple of mss, otherwise every super-segment ends in a runt */
+  goal_size = clib_min (tcp_cfg.max_gso_size, TCP_MAX_GSO_SZ - 1
+			- sizeof (ip6_header_t) - TCP_HDR_LEN_MAX);
   goal_size = clib_min (goal_size, tc->snd_wnd / 2);
+  goal_size -= goal_size % tc->snd_mss;
 
   return goal_size > tc->snd_mss ? goal_size : tc->snd_mss;
 }
@@ -1122,6 +1130,12 @@ tcp_session_send_params (transport_connection_t * trans_conn,
    * the current state of the connection. */
   tcp_update_burst_snd_vars (tc);
 
+  /* Route or egress interface may have changed since the last burst. If
+   * the new egress has neither hw tso nor the gso feature, fall back to
+   * mss sized segments */
+  if (PREDICT_FALSE (!(tc->cfg_flags & TCP_CFG_F_NO_TSO)))
+    tcp_check_gso (tc);
+
   if (PREDICT_FALSE (tc->cfg_flags & TCP_CFG_F_TSO))
     sp->snd_mss = tcp_session_cal_goal_size (tc);
   else
@@ -1636,6 +1650,7 @@ tcp_configuration_init (void)
   tcp_cfg.cc_algo = TCP_CC_CUBIC;
   tcp_cfg.rwnd_min_update_ack = 1;
   tcp_cfg.max_gso_size = TCP_MAX_GSO_SZ;
+  tcp_cfg.syncookie_threshold = 4096;
 
   /* Time constants defined as timer tick (100us) multiples */
   tcp_cfg.closewait_time = 20000;	/* 2s */
@@ -109,6 +109,9 @@ typedef struct tcp_worker_ctx_
   /* Max timers to be handled per dispatch loop */
   u32 max_timers_per_loop;
 
+  /** Number of passive opens in syn-rcvd state */
+  u32 n_embryonic;
+
   /* Fifo of pending timer expirations */
   u32 *pending_timers;
 
@@ -165,6 +168,9 @@ typedef struct tcp_configuration_
   /** Allow use of TSO whenever available */
   u8 allow_tso;
 
+  /** Enable RACK loss detection for new connections */
+  u8 enable_rack;
+
   /** Set if csum offloading is enabled */
   u8 csum_offload;
 
@@ -202,6 +208,11 @@ typedef struct tcp_configuration_
   /** Time to wait (tcp ticks) for syn-rcvd connection to establish */
   u32 syn_rcvd_time;
 
+  /** Number of per worker embryonic connections above which listeners
+   *  answer SYNs with cookies instead of allocating connections. Zero
+   *  disables syn cookies */
+  u32 syncookie_threshold;
+
   /** Number of preallocated connections */
   u32 preallocated_connections;
 
@@ -326,6 +337,7 @@ void tcp_program_retransmit (tcp_connection_t * tc);
 
 void tcp_update_burst_snd_vars (tcp_connection_t * tc);
 u32 tcp_snd_space (tcp_connection_t * tc);
+u32 tcp_initial_window_to_advertise (tcp_connection_t *tc);
 int tcp_fastrecovery_prr_snd_space (tcp_connection_t * tc);
 void tcp_reschedule (tcp_connection_t * tc);
 fib_node_index_t tcp_lookup_rmt_in_fib (tcp_connection_t * tc);
@@ -344,6 +356,9 @@ void tcp_program_cleanup (tcp_worker_ctx_t * wrk, tcp_connection_t * tc);
 void tcp_check_gso (tcp_connection_t *tc);
 
 int tcp_buffer_make_reset (vlib_main_t *vm, vlib_buffer_t *b, u8 is_ip4);
+void tcp_buffer_make_syncookie_synack (vlib_main_t *vm, vlib_buffer_t *b,
+				       tcp_options_t *opts, u32 iss,
+				       u8 is_ip4);
 void tcp_punt_unknown (vlib_main_t * vm, u8 is_ip4, u8 is_add);
 int tcp_configure_v4_source_address_range (vlib_main_t * vm,
 					   ip4_address_t * start,
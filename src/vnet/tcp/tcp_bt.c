@@ -469,6 +469,25 @@ tcp_bt_track_rxt (tcp_connection_t * tc, u32 start, u32 end)
     }
 }
 
+static inline void
+tcp_bt_rack_update (tcp_connection_t * tc, tcp_bt_sample_t * bts)
+{
+  f64 rtt = tc->delivered_time - bts->tx_time;
+
+  /* Ack might be for the original transmission of retransmitted bytes */
+  if ((bts->flags & TCP_BTS_IS_RXT) && rtt < tc->rack_min_rtt)
+    return;
+
+  if (!tc->rack_min_rtt || rtt < tc->rack_min_rtt)
+    tc->rack_min_rtt = rtt;
+
+  if (bts->tx_time >= tc->rack_xmit_time)
+    {
+      tc->rack_xmit_time = bts->tx_time;
+      tc->rack_rtt = rtt;
+    }
+}
+
 static void
 tcp_bt_sample_to_rate_sample (tcp_connection_t * tc, tcp_bt_sample_t * bts,
 			      tcp_rate_sample_t * rs)
@@ -476,6 +495,9 @@ tcp_bt_sample_to_rate_sample (tcp_connection_t * tc, tcp_bt_sample_t * bts,
   if (bts->flags & TCP_BTS_IS_SACKED)
     return;
 
+  if (tc->cfg_flags & TCP_CFG_F_RACK)
+    tcp_bt_rack_update (tc, bts);
+
   if (rs->prior_delivered && rs->prior_delivered >= bts->delivered)
     return;
 
@@ -628,6 +650,50 @@ tcp_bt_sample_delivery_rate (tcp_connection_t * tc, tcp_rate_sample_t * rs)
   rs->lost = tc->lost - rs->tx_lost;
 }
 
+void
+tcp_bt_rack_detect_loss (tcp_connection_t * tc, tcp_rate_sample_t * rs)
+{
+  sack_scoreboard_t *sb = &tc->sack_sb;
+  sack_scoreboard_hole_t *hole;
+  tcp_bt_sample_t *bts;
+  f64 now, reo_wnd;
+  u32 lost;
+
+  hole = scoreboard_last_hole (sb);
+  if (!hole || !tc->rack_xmit_time)
+    return;
+
+  /* Reordering window is a quarter of min rtt, doubled if reordering was
+   * observed, but never more than srtt */
+  reo_wnd = tc->rack_min_rtt / 4;
+  if (sb->reorder > TCP_DUPACK_THRESHOLD)
+    reo_wnd *= 2;
+  reo_wnd = clib_min (reo_wnd, tc->srtt * TCP_TICK);
+  now = tcp_time_now_us (tc->c_thread_index);
+
+  /* Lost holes are a prefix of the scoreboard, so only holes after the
+   * last one marked lost need to be checked. First hole found lost, walking
+   * back from the tail, implies all before it are lost as well */
+  while (hole && !hole->is_lost)
+    {
+      if (seq_lt (hole->start, sb->high_sacked)
+	  && (bts = bt_lookup_seq (tc->bt, hole->start))
+	  && bts->tx_time < tc->rack_xmit_time
+	  && bts->tx_time + tc->rack_rtt + reo_wnd <= now)
+	{
+	  /* Rate sample was already generated, so account for the loss
+	   * there as well */
+	  lost = scoreboard_mark_lost (sb, hole);
+	  sb->last_lost_bytes += lost;
+	  tc->lost += lost;
+	  rs->last_lost += lost;
+	  rs->lost += lost;
+	  break;
+	}
+      hole = scoreboard_prev_hole (sb, hole);
+    }
+}
+
 void
 tcp_bt_flush_samples (tcp_connection_t * tc)
 {
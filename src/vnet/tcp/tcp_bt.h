@@ -63,6 +63,18 @@ void tcp_bt_track_rxt (tcp_connection_t * tc, u32 start, u32 end);
  */
 void tcp_bt_sample_delivery_rate (tcp_connection_t * tc,
 				  tcp_rate_sample_t * rs);
+/**
+ * RACK loss detection
+ *
+ * Marks as lost scoreboard holes that were sent sufficiently earlier than
+ * the most recently delivered segment, as per RFC 8985. Relies on the tx
+ * times recorded by the byte tracker. Bytes marked lost are added to the
+ * scoreboard's last lost bytes and to the rate sample of the ack.
+ *
+ * @param tc	tcp connection
+ * @param rs	rate sample of the ack being processed
+ */
+void tcp_bt_rack_detect_loss (tcp_connection_t * tc, tcp_rate_sample_t * rs);
 /**
  * Check if sample to be generated is app limited
  *
@@ -774,6 +774,7 @@ tcp_scoreboard_replay (u8 * s, tcp_connection_t * tc, u8 verbose)
     }
   s =
     format (s, "result: %U", format_tcp_scoreboard, &placeholder_tc->sack_sb);
+  scoreboard_free (&placeholder_tc->sack_sb);
 
   return s;
 }
@@ -855,6 +856,7 @@ format_tcp_cfg (u8 *s, va_list *args)
   s = format (s, "tx pacing: %s\n",
 	      tm_cfg.enable_tx_pacing ? "enabled" : "disabled");
   s = format (s, "tso: %s\n", tm_cfg.allow_tso ? "allowed" : "disallowed");
+  s = format (s, "rack: %s\n", tm_cfg.enable_rack ? "enabled" : "disabled");
   s = format (s, "checksum offload: %s\n",
 	      tm_cfg.csum_offload ? "enabled" : "disabled");
   s = format (s, "congestion control algorithm: %s\n",
@@ -876,6 +878,7 @@ format_tcp_cfg (u8 *s, va_list *args)
 	      (u32) (tm_cfg.closing_time * TCP_TIMER_TICK));
   s = format (s, "syn_rcvd time: %u sec\n",
 	      (u32) (tm_cfg.syn_rcvd_time * TCP_TICK));
+  s = format (s, "syn cookie threshold: %u\n", tm_cfg.syncookie_threshold);
   s = format (s, "tcp allocation error cleanup time: %0.2f sec\n",
 	      (f32) (tm_cfg.alloc_err_timeout * TCP_TIMER_TICK));
   s = format (s, "connection cleanup time: %.2f sec\n", tm_cfg.cleanup_time);
@@ -1067,6 +1070,8 @@ tcp_config_fn (vlib_main_t * vm, unformat_input_t * input)
 	tcp_cfg.enable_tx_pacing = 0;
       else if (unformat (input, "tso"))
 	tcp_cfg.allow_tso = 1;
+      else if (unformat (input, "rack"))
+	tcp_cfg.enable_rack = 1;
       else if (unformat (input, "no-csum-offload"))
 	tcp_cfg.csum_offload = 0;
       else if (unformat (input, "max-gso-size %u", &max_gso_size))
@@ -1094,6 +1099,11 @@ tcp_config_fn (vlib_main_t * vm, unformat_input_t * input)
 	tcp_cfg.cleanup_time = tmp_time / 1000.0;
       else if (unformat (input, "syn-rcvd-time %u", &tmp_time))
 	tcp_cfg.syn_rcvd_time = tmp_time * THZ;
+      else if (unformat (input, "syncookie-threshold %u",
+			 &tcp_cfg.syncookie_threshold))
+	;
+      else if (unformat (input, "no-syncookies"))
+	tcp_cfg.syncookie_threshold = 0;
       else
 	return clib_error_return (0, "unknown input `%U'",
 				  format_unformat_error, input);
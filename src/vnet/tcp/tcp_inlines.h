@@ -76,9 +76,28 @@ tcp_connection_get_if_valid (u32 conn_index, u32 thread_index)
   return pool_elt_at_index (wrk->connections, conn_index);
 }
 
+/**
+ * Stop accounting connection as embryonic, i.e., passive open that has not
+ * yet left syn-rcvd state. Used to decide when to switch to syn cookies.
+ */
+always_inline void
+tcp_connection_embryonic_done (tcp_connection_t *tc)
+{
+  if (PREDICT_TRUE (!(tc->flags & TCP_CONN_EMBRYONIC)))
+    return;
+  tc->flags &= ~TCP_CONN_EMBRYONIC;
+  tcp_get_worker (tc->c_thread_index)->n_embryonic -= 1;
+}
+
+/**
+ * All state changes go through here, so every exit from syn-rcvd, e.g.,
+ * establish, reset, close or establish timeout, stops the embryonic
+ * accounting. Connections freed in syn-rcvd are handled on free.
+ */
 always_inline void
 tcp_connection_set_state (tcp_connection_t * tc, tcp_state_t state)
 {
+  tcp_connection_embryonic_done (tc);
   tc->state = state;
   TCP_EVT (TCP_EVT_STATE_CHANGE, tc);
 }
@@ -256,6 +275,36 @@ tcp_update_time_now (tcp_worker_ctx_t *wrk)
   tcp_set_time_now (wrk, now);
 }
 
+/**
+ * Prefetch session table bucket for buffer that will be looked up soon
+ *
+ * Buffer data must have been prefetched already. Headers are not
+ * validated, that is left to @ref tcp_input_lookup_buffer.
+ */
+always_inline void
+tcp_input_lookup_prefetch (vlib_buffer_t *b, u8 is_ip4)
+{
+  u32 fib_index = vnet_buffer (b)->ip.fib_index;
+  tcp_header_t *tcp;
+
+  if (is_ip4)
+    {
+      ip4_header_t *ip4 = vlib_buffer_get_current (b);
+      tcp = ip4_next_header (ip4);
+      session_lookup_prefetch4 (fib_index, &ip4->dst_address,
+				&ip4->src_address, tcp->dst_port,
+				tcp->src_port, TRANSPORT_PROTO_TCP);
+    }
+  else
+    {
+      ip6_header_t *ip6 = vlib_buffer_get_current (b);
+      tcp = ip6_next_header (ip6);
+      session_lookup_prefetch6 (fib_index, &ip6->dst_address,
+				&ip6->src_address, tcp->dst_port,
+				tcp->src_port, TRANSPORT_PROTO_TCP);
+    }
+}
+
 always_inline tcp_connection_t *
 tcp_input_lookup_buffer (vlib_buffer_t * b, u8 thread_index, u32 * error,
 			 u8 is_ip4, u8 is_nolookup)
@@ -435,6 +484,153 @@ tcp_is_descheduled (tcp_connection_t * tc)
  *
  * @return - pointer to start of TCP header
  */
+/*
+ * SYN cookies
+ *
+ * Sequence number chosen for stateless SYN-ACKs. Layout, similar to the
+ * classic scheme, is hash1 + peer isn + (count << 24) + (hash2 << 7 | data)
+ * where count is a coarse time counter, data encodes the options that
+ * would have otherwise been stored in the connection and hash2, which
+ * covers count and data, is truncated to 17 bits.
+ */
+#define TCP_SYNCOOKIE_COUNT_SHIFT	6	/**< 64s per count */
+#define TCP_SYNCOOKIE_MAX_AGE		2	/**< valid counts */
+#define TCP_SYNCOOKIE_COUNT_BITS	24
+#define TCP_SYNCOOKIE_DATA_BITS		7
+#define TCP_SYNCOOKIE_DATA_MASK		((1 << TCP_SYNCOOKIE_DATA_BITS) - 1)
+#define TCP_SYNCOOKIE_HASH_MASK						\
+  ((1 << (TCP_SYNCOOKIE_COUNT_BITS - TCP_SYNCOOKIE_DATA_BITS)) - 1)
+#define TCP_SYNCOOKIE_MSS_MASK		0x3
+#define TCP_SYNCOOKIE_SACK		(1 << 2)
+#define TCP_SYNCOOKIE_WSCALE_SHIFT	3
+#define TCP_SYNCOOKIE_WSCALE_NONE	0xf
+
+static const u16 tcp_syncookie_mss[] = { 536, 1220, 1440, 1460 };
+
+always_inline u8
+tcp_syncookies_active (tcp_worker_ctx_t *wrk)
+{
+  return (tcp_cfg.syncookie_threshold
+	  && wrk->n_embryonic >= tcp_cfg.syncookie_threshold);
+}
+
+always_inline u32
+tcp_syncookie_count (u32 thread_index)
+{
+  return (u32) tcp_time_now_us (thread_index) >> TCP_SYNCOOKIE_COUNT_SHIFT;
+}
+
+always_inline u32
+tcp_syncookie_hash (vlib_buffer_t *b, u64 salt, u32 count, u32 data,
+		    u8 is_ip4)
+{
+  tcp_header_t *th = tcp_buffer_hdr (b);
+  u64 tmp;
+
+  if (is_ip4)
+    {
+      ip4_header_t *ih4 = vlib_buffer_get_current (b);
+      tmp = (u64) ih4->dst_address.as_u32 << 32 | ih4->src_address.as_u32;
+    }
+  else
+    {
+      ip6_header_t *ih6 = vlib_buffer_get_current (b);
+      tmp = ih6->dst_address.as_u64[0] ^ ih6->dst_address.as_u64[1]
+	^ ih6->src_address.as_u64[0] ^ ih6->src_address.as_u64[1];
+    }
+
+  tmp = clib_xxhash (tmp ^ salt) ^ ((u64) count << 32 | data);
+  tmp = clib_xxhash (tmp ^ ((u64) th->dst_port << 16 | th->src_port));
+  return ((tmp >> 32) ^ (tmp & 0xffffffff));
+}
+
+/**
+ * Generate syn cookie for SYN in buffer
+ *
+ * @param b		buffer with SYN, current data pointing at ip
+ * @param opts		options parsed from the SYN
+ * @param thread_index	thread handling the SYN
+ * @param is_ip4	flag set to 1 if using ip4
+ * @return		iss to be used for SYN-ACK
+ */
+always_inline u32
+tcp_syncookie_make (vlib_buffer_t *b, tcp_options_t *opts, u32 thread_index,
+		    u8 is_ip4)
+{
+  tcp_iss_seed_t *seed = &tcp_main.iss_seed;
+  u32 count, isn, data, hash, i;
+
+  count = tcp_syncookie_count (thread_index);
+  isn = vnet_buffer (b)->tcp.seq_number;
+
+  for (i = ARRAY_LEN (tcp_syncookie_mss) - 1; i > 0; i--)
+    if (tcp_syncookie_mss[i] <= opts->mss)
+      break;
+  data = i;
+  if (tcp_opts_sack_permitted (opts))
+    data |= TCP_SYNCOOKIE_SACK;
+  data |= (tcp_opts_wscale (opts) ? opts->wscale : TCP_SYNCOOKIE_WSCALE_NONE)
+	  << TCP_SYNCOOKIE_WSCALE_SHIFT;
+
+  hash = tcp_syncookie_hash (b, seed->second, count, data, is_ip4);
+  return (tcp_syncookie_hash (b, seed->first, 0, 0, is_ip4) + isn +
+	  (count << TCP_SYNCOOKIE_COUNT_BITS) +
+	  ((hash & TCP_SYNCOOKIE_HASH_MASK) << TCP_SYNCOOKIE_DATA_BITS | data));
+}
+
+/**
+ * Validate syn cookie acked by segment in buffer
+ *
+ * On success, the options initially provided in the SYN are restored.
+ *
+ * @param b		buffer with ACK, current data pointing at ip
+ * @param opts		options to be initialized from the cookie
+ * @param thread_index	thread handling the ACK
+ * @param is_ip4	flag set to 1 if using ip4
+ * @return		0 if cookie is valid, -1 otherwise
+ */
+always_inline int
+tcp_syncookie_check (vlib_buffer_t *b, tcp_options_t *opts, u32 thread_index,
+		     u8 is_ip4)
+{
+  tcp_iss_seed_t *seed = &tcp_main.iss_seed;
+  u32 cookie, count, diff, data, hash;
+  u8 wscale;
+
+  cookie = vnet_buffer (b)->tcp.ack_number - 1;
+  cookie -= tcp_syncookie_hash (b, seed->first, 0, 0, is_ip4);
+  cookie -= vnet_buffer (b)->tcp.seq_number - 1;
+
+  count = tcp_syncookie_count (thread_index);
+  diff = (count - (cookie >> TCP_SYNCOOKIE_COUNT_BITS)) &
+	 (0xffffffff >> TCP_SYNCOOKIE_COUNT_BITS);
+  if (diff >= TCP_SYNCOOKIE_MAX_AGE)
+    return -1;
+
+  count -= diff;
+  data = cookie & TCP_SYNCOOKIE_DATA_MASK;
+  hash = tcp_syncookie_hash (b, seed->second, count, data, is_ip4);
+  if (((cookie >> TCP_SYNCOOKIE_DATA_BITS) & TCP_SYNCOOKIE_HASH_MASK) !=
+      (hash & TCP_SYNCOOKIE_HASH_MASK))
+    return -1;
+
+  wscale = data >> TCP_SYNCOOKIE_WSCALE_SHIFT;
+  if (wscale != TCP_SYNCOOKIE_WSCALE_NONE && wscale > TCP_MAX_WND_SCALE)
+    return -1;
+
+  opts->flags = TCP_OPTS_FLAG_MSS;
+  opts->mss = tcp_syncookie_mss[data & TCP_SYNCOOKIE_MSS_MASK];
+  if (data & TCP_SYNCOOKIE_SACK)
+    opts->flags |= TCP_OPTS_FLAG_SACK_PERMITTED;
+  if (wscale != TCP_SYNCOOKIE_WSCALE_NONE)
+    {
+      opts->flags |= TCP_OPTS_FLAG_WSCALE;
+      opts->wscale = wscale;
+    }
+
+  return 0;
+}
+
 always_inline void *
 vlib_buffer_push_tcp_net_order (vlib_buffer_t * b, u16 sp, u16 dp, u32 seq,
 				u32 ack, u8 tcp_hdr_opts_len, u8 flags,
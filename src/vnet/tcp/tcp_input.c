@@ -976,6 +976,10 @@ tcp_rcv_ack (tcp_worker_ctx_t * wrk, tcp_connection_t * tc, vlib_buffer_t * b,
     rs.delivered = tc->bytes_acked + tc->sack_sb.last_sacked_bytes -
 		   tc->sack_sb.last_bytes_delivered;
 
+  if ((tc->cfg_flags & TCP_CFG_F_RACK) && tc->sack_sb.head !=
+      TCP_INVALID_SACK_HOLE_INDEX)
+    tcp_bt_rack_detect_loss (tc, &rs);
+
   if (tc->bytes_acked + tc->sack_sb.last_sacked_bytes)
     {
       tcp_update_rtt (tc, &rs, vnet_buffer (b)->tcp.ack_number);
@@ -1653,6 +1657,9 @@ tcp_check_tx_offload (tcp_connection_t * tc, int is_ipv4)
   vnet_hw_interface_t *hw_if;
   u32 sw_if_idx, lb_idx;
 
+  /* Only keep tso if the current egress can still segment */
+  tc->cfg_flags &= ~TCP_CFG_F_TSO;
+
   if (is_ipv4)
     {
       ip4_address_t *dst_addr = &(tc->c_rmt_ip.ip4);
@@ -1676,6 +1683,13 @@ tcp_check_tx_offload (tcp_connection_t * tc, int is_ipv4)
   hw_if = vnet_get_sup_hw_interface (vnm, sw_if_idx);
   if (hw_if->caps & VNET_HW_IF_CAP_TCP_GSO)
     tc->cfg_flags |= TCP_CFG_F_TSO;
+  /* No hardware support but software gso enabled on output interface.
+   * Super-segments are cheaper to build and are segmented only once, by
+   * the gso node */
+  else if (vnet_feature_is_enabled (is_ipv4 ? "ip4-output" : "ip6-output",
+				    is_ipv4 ? "gso-ip4" : "gso-ip6",
+				    sw_if_idx) > 0)
+    tc->cfg_flags |= TCP_CFG_F_TSO;
 }
 
 static void
@@ -2121,8 +2135,7 @@ tcp46_rcv_process_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	  tcp_connection_tx_pacer_update (tc);
 
 	  /* Switch state to ESTABLISHED */
-	  tc->state = TCP_STATE_ESTABLISHED;
-	  TCP_EVT (TCP_EVT_STATE_CHANGE, tc);
+	  tcp_connection_set_state (tc, TCP_STATE_ESTABLISHED);
 
 	  if (!(tc->cfg_flags & TCP_CFG_F_NO_TSO))
 	    tcp_check_tx_offload (tc, is_ip4);
@@ -2515,16 +2528,104 @@ syn_during_timewait (tcp_connection_t *tc, vlib_buffer_t *b, u32 *iss)
     }
 }
 
+typedef enum _tcp_listen_next
+{
+  TCP_LISTEN_NEXT_DROP,
+  TCP_LISTEN_NEXT_RESET,
+  TCP_LISTEN_NEXT_IP_LOOKUP,
+  TCP_LISTEN_N_NEXT,
+} tcp_listen_next_t;
+
+#define foreach_tcp4_listen_next                                              \
+  _ (DROP, "tcp4-drop")                                                       \
+  _ (RESET, "tcp4-reset")                                                     \
+  _ (IP_LOOKUP, "ip4-lookup")
+
+#define foreach_tcp6_listen_next                                              \
+  _ (DROP, "tcp6-drop")                                                       \
+  _ (RESET, "tcp6-reset")                                                     \
+  _ (IP_LOOKUP, "ip6-lookup")
+
+/**
+ * Create connection for ACK that carries a valid syn cookie
+ *
+ * Connection goes straight to ESTABLISHED as the handshake was completed
+ * without any state kept for the SYN. Data carried by the ACK, if any, is
+ * not enqueued and will be retransmitted by the peer.
+ */
+static tcp_error_t
+tcp_listen_syncookie_accept (tcp_connection_t *lc, vlib_buffer_t *b,
+			     tcp_options_t *opts, u32 thread_index, u8 is_ip4)
+{
+  tcp_connection_t *child;
+
+  child = tcp_connection_alloc (thread_index);
+  child->rcv_opts = *opts;
+
+  tcp_init_w_buffer (child, b, is_ip4);
+
+  /* ACK carries peer's isn + 1 */
+  child->irs = vnet_buffer (b)->tcp.seq_number - 1;
+  child->rcv_nxt = vnet_buffer (b)->tcp.seq_number;
+  child->rcv_las = child->rcv_nxt;
+
+  child->state = TCP_STATE_SYN_RCVD;
+  child->c_fib_index = lc->c_fib_index;
+  child->cc_algo = lc->cc_algo;
+  child->iss = vnet_buffer (b)->tcp.ack_number - 1;
+  tcp_connection_init_vars (child);
+  child->rto = TCP_RTO_MIN;
+
+  TCP_EVT (TCP_EVT_SYN_RCVD, child, 1);
+
+  if (session_stream_accept (&child->connection, lc->c_s_index,
+			     lc->c_thread_index, 0 /* notify */))
+    {
+      tcp_connection_cleanup (child);
+      return TCP_ERROR_CREATE_SESSION_FAIL;
+    }
+
+  transport_fifos_init_ooo (&child->connection);
+  child->tx_fifo_size = transport_tx_fifo_size (&child->connection);
+  tcp_initial_window_to_advertise (child);
+
+  /* Switch state to ESTABLISHED */
+  child->state = TCP_STATE_ESTABLISHED;
+  TCP_EVT (TCP_EVT_STATE_CHANGE, child);
+
+  if (!(child->cfg_flags & TCP_CFG_F_NO_TSO))
+    tcp_check_tx_offload (child, is_ip4);
+
+  child->snd_una = vnet_buffer (b)->tcp.ack_number;
+  tcp_connection_tx_pacer_update (child);
+
+  if (session_stream_accept_notify (&child->connection))
+    {
+      tcp_send_reset (child);
+      session_transport_delete_notify (&child->connection);
+      tcp_connection_cleanup (child);
+      return TCP_ERROR_MSG_QUEUE_FULL;
+    }
+
+  return TCP_ERROR_SYNCOOKIES_RCVD;
+}
+
 /**
  * LISTEN state processing as per RFC 793 p. 65
+ *
+ * Once the number of embryonic connections on the worker crosses the
+ * configured threshold, SYNs are answered statelessly with syn cookies and
+ * connections are created only for ACKs that return a valid cookie.
  */
 always_inline uword
 tcp46_listen_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 		     vlib_frame_t *frame, int is_ip4)
 {
-  u32 n_left_from, *from, n_syns = 0;
+  u32 n_left_from, *from, n_syns = 0, n_cookies = 0;
   vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  u16 nexts[VLIB_FRAME_SIZE], *next;
   u32 thread_index = vm->thread_index;
+  tcp_worker_ctx_t *wrk = tcp_get_worker (thread_index);
   u32 tw_iss = 0;
 
   from = vlib_frame_vector_args (frame);
@@ -2535,10 +2636,45 @@ tcp46_listen_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 
   vlib_get_buffers (vm, from, bufs, n_left_from);
   b = bufs;
+  next = nexts;
 
   while (n_left_from > 0)
     {
       tcp_connection_t *lc, *child;
+      tcp_options_t opts = {};
+      tcp_error_t error;
+      tcp_header_t *th;
+
+      next[0] = TCP_LISTEN_NEXT_DROP;
+      th = tcp_buffer_hdr (b[0]);
+
+      /* ACKs reach the node only in listen state. Accept them if they
+       * carry a syn cookie, otherwise reset */
+      if (PREDICT_FALSE (!tcp_syn (th)))
+	{
+	  lc = tcp_listener_get (vnet_buffer (b[0])->tcp.connection_index);
+	  if (!tcp_cfg.syncookie_threshold
+	      || tcp_syncookie_check (b[0], &opts, thread_index, is_ip4))
+	    {
+	      tcp_inc_counter (listen, tcp_cfg.syncookie_threshold ?
+					 TCP_ERROR_SYNCOOKIES_FAILED :
+					 TCP_ERROR_ACK_INVALID,
+			       1);
+	      next[0] = TCP_LISTEN_NEXT_RESET;
+	      goto done;
+	    }
+	  child = tcp_lookup_connection (lc->c_fib_index, b[0], thread_index,
+					 is_ip4);
+	  if (PREDICT_FALSE (child->state != TCP_STATE_LISTEN))
+	    {
+	      tcp_inc_counter (listen, TCP_ERROR_CREATE_EXISTS, 1);
+	      goto done;
+	    }
+	  error = tcp_listen_syncookie_accept (lc, b[0], &opts, thread_index,
+					       is_ip4);
+	  tcp_inc_counter (listen, error, 1);
+	  goto done;
+	}
 
       /* Flags initialized with connection state after lookup */
       if (vnet_buffer (b[0])->tcp.flags == TCP_STATE_LISTEN)
@@ -2588,14 +2724,33 @@ tcp46_listen_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 
       /* 1. first check for an RST: handled by input dispatch */
 
-      /* 2. second check for an ACK: handled by input dispatch */
+      /* 2. second check for an ACK: handled above */
 
       /* 3. check for a SYN (did that already) */
 
+      /* Too many embryonic connections, reply with syn cookie and reuse
+       * the SYN's buffer for the SYN-ACK */
+      if (PREDICT_FALSE (tcp_syncookies_active (wrk)))
+	{
+	  if (tcp_options_parse (th, &opts, 1))
+	    {
+	      tcp_inc_counter (listen, TCP_ERROR_OPTIONS, 1);
+	      goto done;
+	    }
+	  tcp_buffer_make_syncookie_synack (
+	    vm, b[0], &opts,
+	    tcp_syncookie_make (b[0], &opts, thread_index, is_ip4), is_ip4);
+	  vnet_buffer (b[0])->sw_if_index[VLIB_TX] = lc->c_fib_index;
+	  b[0]->flags |= VNET_BUFFER_F_LOCALLY_ORIGINATED;
+	  next[0] = TCP_LISTEN_NEXT_IP_LOOKUP;
+	  n_cookies += 1;
+	  goto done;
+	}
+
       /* Create child session and send SYN-ACK */
       child = tcp_connection_alloc (thread_index);
 
-      if (tcp_options_parse (tcp_buffer_hdr (b[0]), &child->rcv_opts, 1))
+      if (tcp_options_parse (th, &child->rcv_opts, 1))
 	{
 	  tcp_inc_counter (listen, TCP_ERROR_OPTIONS, 1);
 	  tcp_connection_free (child);
@@ -2605,6 +2760,8 @@ tcp46_listen_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
       tcp_init_w_buffer (child, b[0], is_ip4);
 
       child->state = TCP_STATE_SYN_RCVD;
+      child->flags |= TCP_CONN_EMBRYONIC;
+      wrk->n_embryonic += 1;
       child->c_fib_index = lc->c_fib_index;
       child->cc_algo = lc->cc_algo;
 
@@ -2639,11 +2796,14 @@ tcp46_listen_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 
     done:
       b += 1;
+      next += 1;
       n_left_from -= 1;
     }
 
-  tcp_inc_counter (listen, TCP_ERROR_SYNS_RCVD, n_syns);
-  vlib_buffer_free (vm, from, frame->n_vectors);
+  tcp_inc_counter (listen, TCP_ERROR_SYNS_RCVD, n_syns + n_cookies);
+  if (n_cookies)
+    tcp_inc_counter (listen, TCP_ERROR_SYNCOOKIES_SENT, n_cookies);
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
 
   return frame->n_vectors;
 }
@@ -2666,6 +2826,12 @@ VLIB_REGISTER_NODE (tcp4_listen_node) = {
   .vector_size = sizeof (u32),
   .n_errors = TCP_N_ERROR,
   .error_counters = tcp_input_error_counters,
+  .n_next_nodes = TCP_LISTEN_N_NEXT,
+  .next_nodes = {
+#define _(s,n) [TCP_LISTEN_NEXT_##s] = n,
+    foreach_tcp4_listen_next
+#undef _
+  },
   .format_trace = format_tcp_rx_trace_short,
 };
 
@@ -2675,6 +2841,12 @@ VLIB_REGISTER_NODE (tcp6_listen_node) = {
   .vector_size = sizeof (u32),
   .n_errors = TCP_N_ERROR,
   .error_counters = tcp_input_error_counters,
+  .n_next_nodes = TCP_LISTEN_N_NEXT,
+  .next_nodes = {
+#define _(s,n) [TCP_LISTEN_NEXT_##s] = n,
+    foreach_tcp6_listen_next
+#undef _
+  },
   .format_trace = format_tcp_rx_trace_short,
 };
 
@@ -2806,18 +2978,35 @@ tcp46_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
   b = bufs;
   next = nexts;
 
+  if (n_left_from >= 4)
+    {
+      vlib_prefetch_buffer_header (b[2], STORE);
+      CLIB_PREFETCH (b[2]->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
+
+      vlib_prefetch_buffer_header (b[3], STORE);
+      CLIB_PREFETCH (b[3]->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
+    }
+
   while (n_left_from >= 4)
     {
       u32 error0 = TCP_ERROR_NO_LISTENER, error1 = TCP_ERROR_NO_LISTENER;
       tcp_connection_t *tc0, *tc1;
 
-      {
-	vlib_prefetch_buffer_header (b[2], STORE);
-	CLIB_PREFETCH (b[2]->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
+      /* Buffers are prefetched four ahead and their session table
+       * buckets two ahead, once headers are likely in cache */
+      if (n_left_from >= 6)
+	{
+	  vlib_prefetch_buffer_header (b[4], STORE);
+	  CLIB_PREFETCH (b[4]->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
 
-	vlib_prefetch_buffer_header (b[3], STORE);
-	CLIB_PREFETCH (b[3]->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
-      }
+	  vlib_prefetch_buffer_header (b[5], STORE);
+	  CLIB_PREFETCH (b[5]->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
+	}
+      if (!is_nolookup)
+	{
+	  tcp_input_lookup_prefetch (b[2], is_ip4);
+	  tcp_input_lookup_prefetch (b[3], is_ip4);
+	}
 
       next[0] = next[1] = TCP_INPUT_NEXT_DROP;
 
@@ -3037,7 +3226,7 @@ do {                                                       	\
 
   /* RFC 793: In LISTEN if RST drop and if ACK return RST */
   _(LISTEN, 0, TCP_INPUT_NEXT_DROP, TCP_ERROR_SEGMENT_INVALID);
-  _(LISTEN, TCP_FLAG_ACK, TCP_INPUT_NEXT_RESET, TCP_ERROR_ACK_INVALID);
+  _(LISTEN, TCP_FLAG_ACK, TCP_INPUT_NEXT_LISTEN, TCP_ERROR_NONE);
   _(LISTEN, TCP_FLAG_RST, TCP_INPUT_NEXT_DROP, TCP_ERROR_INVALID_CONNECTION);
   _(LISTEN, TCP_FLAG_SYN, TCP_INPUT_NEXT_LISTEN, TCP_ERROR_NONE);
   _(LISTEN, TCP_FLAG_SYN | TCP_FLAG_ACK, TCP_INPUT_NEXT_RESET,
@@ -641,6 +641,105 @@ tcp_buffer_make_reset (vlib_main_t *vm, vlib_buffer_t *b, u8 is_ip4)
   return 0;
 }
 
+/**
+ * Convert SYN in buffer to SYN-ACK that carries a syn cookie
+ *
+ * No connection state is needed. Options are the ones we would advertise
+ * for a connection created with the SYN's options, except timestamps, which
+ * are not negotiated when cookies are used.
+ */
+void
+tcp_buffer_make_syncookie_synack (vlib_main_t *vm, vlib_buffer_t *b,
+				  tcp_options_t *opts, u32 iss, u8 is_ip4)
+{
+  ip4_address_t src_ip4 = {}, dst_ip4 = {};
+  ip6_address_t src_ip6, dst_ip6;
+  tcp_options_t _snd_opts = {}, *snd_opts = &_snd_opts;
+  u8 tcp_opts_len, tcp_hdr_opts_len;
+  u16 src_port, dst_port, wnd;
+  ip4_header_t *ih4;
+  ip6_header_t *ih6;
+  tcp_header_t *th;
+  u32 ack;
+
+  th = tcp_buffer_hdr (b);
+
+  if (is_ip4)
+    {
+      ih4 = vlib_buffer_get_current (b);
+      src_ip4.as_u32 = ih4->src_address.as_u32;
+      dst_ip4.as_u32 = ih4->dst_address.as_u32;
+      snd_opts->mss = tcp_cfg.default_mtu - sizeof (tcp_header_t) -
+		      sizeof (ip4_header_t);
+    }
+  else
+    {
+      ih6 = vlib_buffer_get_current (b);
+      clib_memcpy_fast (&src_ip6, &ih6->src_address, sizeof (ip6_address_t));
+      clib_memcpy_fast (&dst_ip6, &ih6->dst_address, sizeof (ip6_address_t));
+      snd_opts->mss = tcp_cfg.default_mtu - sizeof (tcp_header_t) -
+		      sizeof (ip6_header_t);
+    }
+
+  src_port = th->src_port;
+  dst_port = th->dst_port;
+  ack = vnet_buffer (b)->tcp.seq_number + 1;
+
+  snd_opts->flags = TCP_OPTS_FLAG_MSS;
+  tcp_opts_len = TCP_OPTION_LEN_MSS;
+  if (tcp_opts_wscale (opts))
+    {
+      snd_opts->flags |= TCP_OPTS_FLAG_WSCALE;
+      snd_opts->wscale = tcp_window_compute_scale (tcp_cfg.max_rx_fifo);
+      tcp_opts_len += TCP_OPTION_LEN_WINDOW_SCALE;
+    }
+  if (tcp_opts_sack_permitted (opts))
+    {
+      snd_opts->flags |= TCP_OPTS_FLAG_SACK_PERMITTED;
+      tcp_opts_len += TCP_OPTION_LEN_SACK_PERMITTED;
+    }
+  tcp_opts_len += (TCP_OPTS_ALIGN - tcp_opts_len % TCP_OPTS_ALIGN) %
+		  TCP_OPTS_ALIGN;
+  tcp_hdr_opts_len = tcp_opts_len + sizeof (tcp_header_t);
+  wnd = clib_min (tcp_cfg.min_rx_fifo, TCP_WND_MAX);
+
+  /*
+   * Clear and reuse current buffer for syn-ack
+   */
+  if (b->flags & VLIB_BUFFER_NEXT_PRESENT)
+    vlib_buffer_free_one (vm, b->next_buffer);
+
+  /* Zero all flags but free list index and trace flag */
+  b->flags &= VLIB_BUFFER_NEXT_PRESENT - 1;
+  /* Make sure new tcp header comes after current ip */
+  b->current_data = ((u8 *) th - b->data) + tcp_hdr_opts_len;
+  b->current_length = 0;
+  b->total_length_not_including_first_buffer = 0;
+  vnet_buffer (b)->tcp.flags = 0;
+
+  /*
+   * Add TCP and IP headers
+   */
+  th = vlib_buffer_push_tcp (b, dst_port, src_port, iss, ack,
+			     tcp_hdr_opts_len, TCP_FLAG_SYN | TCP_FLAG_ACK,
+			     wnd);
+  tcp_options_write ((u8 *) (th + 1), snd_opts);
+
+  if (is_ip4)
+    {
+      ih4 = vlib_buffer_push_ip4 (vm, b, &dst_ip4, &src_ip4,
+				  IP_PROTOCOL_TCP, 1);
+      th->checksum = ip4_tcp_udp_compute_checksum (vm, b, ih4);
+    }
+  else
+    {
+      int bogus = ~0;
+      ih6 = vlib_buffer_push_ip6 (vm, b, &dst_ip6, &src_ip6, IP_PROTOCOL_TCP);
+      th->checksum = ip6_tcp_udp_icmp_compute_checksum (vm, b, ih6, &bogus);
+      ASSERT (!bogus);
+    }
+}
+
 /**
  *  Send reset without reusing existing buffer
  *
@@ -659,7 +758,7 @@ tcp_send_reset_w_pkt (tcp_connection_t * tc, vlib_buffer_t * pkt,
   ip4_header_t *pkt_ih4;
   ip6_header_t *pkt_ih6;
 
-  if (PREDICT_FALSE (!vlib_buffer_alloc (vm, &bi, 1)))
+  if (PREDICT_FALSE (!vlib_buffer_alloc_small (vm, &bi, 1)))
     {
       tcp_worker_stats_inc (wrk, no_buffer, 1);
       return;
@@ -721,7 +820,7 @@ tcp_send_reset (tcp_connection_t * tc)
   u16 tcp_hdr_opts_len, advertise_wnd, opts_write_len;
   u8 flags;
 
-  if (PREDICT_FALSE (!vlib_buffer_alloc (vm, &bi, 1)))
+  if (PREDICT_FALSE (!vlib_buffer_alloc_small (vm, &bi, 1)))
     {
       tcp_worker_stats_inc (wrk, no_buffer, 1);
       return;
@@ -769,7 +868,7 @@ tcp_send_syn (tcp_connection_t * tc)
   tcp_timer_update (&wrk->timer_wheel, tc, TCP_TIMER_RETRANSMIT_SYN,
 		    (u32) tc->rto * TCP_TO_TIMER_TICK);
 
-  if (PREDICT_FALSE (!vlib_buffer_alloc (vm, &bi, 1)))
+  if (PREDICT_FALSE (!vlib_buffer_alloc_small (vm, &bi, 1)))
     {
       tcp_timer_update (&wrk->timer_wheel, tc, TCP_TIMER_RETRANSMIT_SYN,
 			tcp_cfg.alloc_err_timeout);
@@ -801,7 +900,7 @@ tcp_send_synack (tcp_connection_t * tc)
   ASSERT (tc->snd_una != tc->snd_nxt);
   tcp_retransmit_timer_update (&wrk->timer_wheel, tc);
 
-  if (PREDICT_FALSE (!vlib_buffer_alloc (vm, &bi, 1)))
+  if (PREDICT_FALSE (!vlib_buffer_alloc_small (vm, &bi, 1)))
     {
       tcp_timer_update (&wrk->timer_wheel, tc, TCP_TIMER_RETRANSMIT,
 			tcp_cfg.alloc_err_timeout);
@@ -833,7 +932,7 @@ tcp_send_fin (tcp_connection_t * tc)
   if (fin_snt)
     tc->snd_nxt -= 1;
 
-  if (PREDICT_FALSE (!vlib_buffer_alloc (vm, &bi, 1)))
+  if (PREDICT_FALSE (!vlib_buffer_alloc_small (vm, &bi, 1)))
     {
       /* Out of buffers so program fin retransmit ASAP */
       tcp_timer_update (&wrk->timer_wheel, tc, TCP_TIMER_RETRANSMIT,
@@ -1006,7 +1105,7 @@ tcp_send_ack (tcp_connection_t * tc)
   vlib_buffer_t *b;
   u32 bi;
 
-  if (PREDICT_FALSE (!vlib_buffer_alloc (vm, &bi, 1)))
+  if (PREDICT_FALSE (!vlib_buffer_alloc_small (vm, &bi, 1)))
     {
       tcp_update_rcv_wnd (tc);
       tcp_worker_stats_inc (wrk, no_buffer, 1);
@@ -1400,7 +1499,7 @@ tcp_timer_retransmit_handler (tcp_connection_t * tc)
 	  return;
 	}
 
-      if (PREDICT_FALSE (!vlib_buffer_alloc (vm, &bi, 1)))
+      if (PREDICT_FALSE (!vlib_buffer_alloc_small (vm, &bi, 1)))
 	{
 	  tcp_timer_update (&wrk->timer_wheel, tc, TCP_TIMER_RETRANSMIT,
 			    tcp_cfg.alloc_err_timeout);
@@ -1468,7 +1567,7 @@ tcp_timer_retransmit_syn_handler (tcp_connection_t * tc)
       return;
     }
 
-  if (PREDICT_FALSE (!vlib_buffer_alloc (vm, &bi, 1)))
+  if (PREDICT_FALSE (!vlib_buffer_alloc_small (vm, &bi, 1)))
     {
       tcp_timer_update (&wrk->timer_wheel, tc, TCP_TIMER_RETRANSMIT_SYN,
 			tcp_cfg.alloc_err_timeout);
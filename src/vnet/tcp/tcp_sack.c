@@ -15,6 +15,86 @@
 
 #include <vnet/tcp/tcp_sack.h>
 
+static int
+scoreboard_seq_lt (u32 a, u32 b)
+{
+  return seq_lt (a, b);
+}
+
+/**
+ * Find first hole that ends after seq
+ *
+ * Uses the rbtree index to avoid walking the list of holes, which can be
+ * long for connections with large windows and heavy loss.
+ */
+static sack_scoreboard_hole_t *
+scoreboard_lookup_hole (sack_scoreboard_t * sb, u32 seq)
+{
+  rb_tree_t *rt = &sb->hole_lookup;
+  rb_node_t *cur, *prev = 0;
+  sack_scoreboard_hole_t *hole;
+
+  cur = rb_node (rt, rt->root);
+  while (!rb_node_is_tnil (rt, cur))
+    {
+      if (seq_leq (cur->key, seq))
+	{
+	  prev = cur;
+	  cur = rb_node_right (rt, cur);
+	}
+      else
+	cur = rb_node_left (rt, cur);
+    }
+
+  if (!prev)
+    return scoreboard_first_hole (sb);
+
+  hole = scoreboard_get_hole (sb, prev->opaque);
+  if (seq_leq (hole->end, seq))
+    return scoreboard_next_hole (sb, hole);
+
+  return hole;
+}
+
+/**
+ * Move hole start forward. Order of holes is unchanged so the key of the
+ * lookup node can be updated in place.
+ */
+static inline void
+scoreboard_hole_set_start (sack_scoreboard_t * sb,
+			   sack_scoreboard_hole_t * hole, u32 start)
+{
+  u32 delta = start - hole->start;
+
+  ASSERT (seq_geq (start, hole->start) && seq_leq (start, hole->end));
+
+  sb->hole_bytes -= delta;
+  if (hole->is_lost)
+    sb->lost_bytes -= delta;
+  hole->start = start;
+  rb_node (&sb->hole_lookup, hole->lookup_node)->key = start;
+}
+
+static inline void
+scoreboard_hole_set_end (sack_scoreboard_t * sb,
+			 sack_scoreboard_hole_t * hole, u32 end)
+{
+  /* Unsigned arithmetic handles both growing and shrinking */
+  sb->hole_bytes += end - hole->end;
+  if (hole->is_lost)
+    sb->lost_bytes += end - hole->end;
+  hole->end = end;
+}
+
+static inline void
+scoreboard_hole_mark_lost (sack_scoreboard_t * sb,
+			   sack_scoreboard_hole_t * hole)
+{
+  ASSERT (!hole->is_lost);
+  hole->is_lost = 1;
+  sb->lost_bytes += scoreboard_hole_bytes (hole);
+}
+
 static void
 scoreboard_remove_hole (sack_scoreboard_t * sb, sack_scoreboard_hole_t * hole)
 {
@@ -43,6 +123,12 @@ scoreboard_remove_hole (sack_scoreboard_t * sb, sack_scoreboard_hole_t * hole)
   if (scoreboard_hole_index (sb, hole) == sb->cur_rxt_hole)
     sb->cur_rxt_hole = TCP_INVALID_SACK_HOLE_INDEX;
 
+  sb->hole_bytes -= scoreboard_hole_bytes (hole);
+  if (hole->is_lost)
+    sb->lost_bytes -= scoreboard_hole_bytes (hole);
+  rb_tree_del_node (&sb->hole_lookup,
+		    rb_node (&sb->hole_lookup, hole->lookup_node));
+
   /* Poison the entry */
   if (CLIB_DEBUG > 0)
     clib_memset (hole, 0xfe, sizeof (*hole));
@@ -63,6 +149,9 @@ scoreboard_insert_hole (sack_scoreboard_t * sb, u32 prev_index,
   hole->start = start;
   hole->end = end;
   hole_index = scoreboard_hole_index (sb, hole);
+  hole->lookup_node = rb_tree_add_custom (&sb->hole_lookup, start,
+					  hole_index, scoreboard_seq_lt);
+  sb->hole_bytes += end - start;
 
   prev = scoreboard_get_hole (sb, prev_index);
   if (prev)
@@ -120,8 +209,6 @@ scoreboard_update_bytes (sack_scoreboard_t * sb, u32 ack, u32 snd_mss)
   old_sacked = sb->sacked_bytes;
 
   sb->last_lost_bytes = 0;
-  sb->lost_bytes = 0;
-  sb->sacked_bytes = 0;
 
   right = scoreboard_last_hole (sb);
   if (!right)
@@ -132,6 +219,12 @@ scoreboard_update_bytes (sack_scoreboard_t * sb, u32 ack, u32 snd_mss)
       return;
     }
 
+  /* Bytes not in holes up to the highest of high sacked and last hole end
+   * were sacked. Lost and hole bytes are maintained as holes change */
+  ASSERT (scoreboard_first_hole (sb)->start == ack || sb->is_reneging);
+  sb->sacked_bytes = seq_max (sb->high_sacked, right->end) - ack
+    - sb->hole_bytes;
+
   if (seq_gt (sb->high_sacked, right->end))
     {
       sacked = sb->high_sacked - right->end;
@@ -147,14 +240,9 @@ scoreboard_update_bytes (sack_scoreboard_t * sb, u32 ack, u32 snd_mss)
    */
   while (sacked <= (sb->reorder - 1) * snd_mss && blks < sb->reorder)
     {
-      if (right->is_lost)
-	sb->lost_bytes += scoreboard_hole_bytes (right);
-
       left = scoreboard_prev_hole (sb, right);
       if (!left)
 	{
-	  ASSERT (right->start == ack || sb->is_reneging);
-	  sacked += right->start - ack;
 	  right = 0;
 	  break;
 	}
@@ -164,25 +252,17 @@ scoreboard_update_bytes (sack_scoreboard_t * sb, u32 ack, u32 snd_mss)
       right = left;
     }
 
-  /* right is first lost */
-  while (right)
+  /* right is first lost. Lost holes always form a prefix of the list so
+   * stop at the first hole already marked */
+  while (right && !right->is_lost)
     {
-      sb->lost_bytes += scoreboard_hole_bytes (right);
-      sb->last_lost_bytes += right->is_lost ? 0 : (right->end - right->start);
-      right->is_lost = 1;
-      left = scoreboard_prev_hole (sb, right);
-      if (!left)
-	{
-	  ASSERT (right->start == ack || sb->is_reneging);
-	  sacked += right->start - ack;
-	  break;
-	}
-      sacked += right->start - left->end;
-      right = left;
+      scoreboard_hole_mark_lost (sb, right);
+      sb->last_lost_bytes += scoreboard_hole_bytes (right);
+      right = scoreboard_prev_hole (sb, right);
     }
 
-  sb->sacked_bytes = sacked;
-  sb->last_sacked_bytes = sacked - (old_sacked - sb->last_bytes_delivered);
+  sb->last_sacked_bytes = sb->sacked_bytes
+    - (old_sacked - sb->last_bytes_delivered);
 }
 
 /**
@@ -281,8 +361,22 @@ scoreboard_rxt_mark_lost (sack_scoreboard_t *sb, u32 snd_una, u32 snd_nxt)
   if (hole->is_lost)
     return;
 
-  hole->is_lost = 1;
-  sb->lost_bytes += scoreboard_hole_bytes (hole);
+  scoreboard_hole_mark_lost (sb, hole);
+}
+
+u32
+scoreboard_mark_lost (sack_scoreboard_t *sb, sack_scoreboard_hole_t *hole)
+{
+  u32 lost = 0;
+
+  /* Keep lost holes a prefix of the scoreboard */
+  while (hole && !hole->is_lost)
+    {
+      scoreboard_hole_mark_lost (sb, hole);
+      lost += scoreboard_hole_bytes (hole);
+      hole = scoreboard_prev_hole (sb, hole);
+    }
+  return lost;
 }
 
 void
@@ -292,6 +386,14 @@ scoreboard_init (sack_scoreboard_t * sb)
   sb->tail = TCP_INVALID_SACK_HOLE_INDEX;
   sb->cur_rxt_hole = TCP_INVALID_SACK_HOLE_INDEX;
   sb->reorder = TCP_DUPACK_THRESHOLD;
+  rb_tree_init (&sb->hole_lookup);
+}
+
+void
+scoreboard_free (sack_scoreboard_t * sb)
+{
+  pool_free (sb->holes);
+  rb_tree_free_nodes (&sb->hole_lookup);
 }
 
 void
@@ -304,6 +406,7 @@ scoreboard_clear (sack_scoreboard_t * sb)
     }
   ASSERT (sb->head == sb->tail && sb->head == TCP_INVALID_SACK_HOLE_INDEX);
   ASSERT (pool_elts (sb->holes) == 0);
+  ASSERT (sb->hole_bytes == 0 && sb->lost_bytes == 0);
   sb->sacked_bytes = 0;
   sb->last_sacked_bytes = 0;
   sb->last_bytes_delivered = 0;
@@ -322,7 +425,7 @@ scoreboard_clear_reneging (sack_scoreboard_t * sb, u32 start, u32 end)
   scoreboard_clear (sb);
   last_hole = scoreboard_insert_hole (sb, TCP_INVALID_SACK_HOLE_INDEX,
 				      start, end);
-  last_hole->is_lost = 1;
+  scoreboard_hole_mark_lost (sb, last_hole);
   sb->tail = scoreboard_hole_index (sb, last_hole);
   sb->high_sacked = start;
   scoreboard_init_rxt (sb, start);
@@ -354,6 +457,7 @@ tcp_rcv_sacks (tcp_connection_t * tc, u32 ack)
 
   sb->last_sacked_bytes = 0;
   sb->last_bytes_delivered = 0;
+  sb->last_lost_bytes = 0;
   sb->rxt_sacked = 0;
 
   if (!tcp_opts_sack (&tc->rcv_opts) && !sb->sacked_bytes
@@ -446,7 +550,7 @@ tcp_rcv_sacks (tcp_connection_t * tc, u32 ack)
 	{
 	  if (seq_geq (hole->start, sb->high_sacked))
 	    {
-	      hole->end = tc->snd_nxt;
+	      scoreboard_hole_set_end (sb, hole, tc->snd_nxt);
 	    }
 	  /* New hole after high sacked block */
 	  else if (seq_lt (sb->high_sacked, tc->snd_nxt))
@@ -509,7 +613,7 @@ tcp_rcv_sacks (tcp_connection_t * tc, u32 ack)
 		{
 		  scoreboard_update_sacked (sb, hole->start, blk->end,
 					    has_rxt, tc->snd_mss);
-		  hole->start = blk->end;
+		  scoreboard_hole_set_start (sb, hole, blk->end);
 		}
 	      blk_index++;
 	    }
@@ -524,8 +628,12 @@ tcp_rcv_sacks (tcp_connection_t * tc, u32 ack)
 						  hole->end);
 	      /* Pool might've moved */
 	      hole = scoreboard_get_hole (sb, hole_index);
-	      hole->end = blk->start;
-	      next_hole->is_lost = hole->is_lost;
+	      scoreboard_hole_set_end (sb, hole, blk->start);
+	      if (hole->is_lost)
+		{
+		  next_hole->is_lost = 1;
+		  sb->lost_bytes += scoreboard_hole_bytes (next_hole);
+		}
 
 	      scoreboard_update_sacked (sb, blk->start, blk->end,
 					has_rxt, tc->snd_mss);
@@ -537,7 +645,13 @@ tcp_rcv_sacks (tcp_connection_t * tc, u32 ack)
 	    {
 	      scoreboard_update_sacked (sb, blk->start, hole->end,
 					has_rxt, tc->snd_mss);
-	      hole->end = blk->start;
+	      scoreboard_hole_set_end (sb, hole, blk->start);
+	    }
+	  /* Hole does not overlap block. Skip to first hole that might */
+	  else
+	    {
+	      hole = scoreboard_lookup_hole (sb, blk->start);
+	      continue;
 	    }
 	  hole = scoreboard_next_hole (sb, hole);
 	}
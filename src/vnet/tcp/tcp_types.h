@@ -97,6 +97,7 @@ typedef enum _tcp_timers
   _(NO_TSO, "TSO off")				\
   _(TSO, "TSO")					\
   _(NO_ENDPOINT,"No endpoint")			\
+  _(RACK, "RACK loss detection")		\
 
 typedef enum tcp_cfg_flag_bits_
 {
@@ -129,6 +130,7 @@ typedef enum tcp_cfg_flag_
   _(PSH_PENDING, "PSH pending")			\
   _(FINRCVD, "FIN received")			\
   _(ZERO_RWND_SENT, "Zero RWND sent")		\
+  _(EMBRYONIC, "Embryonic")			\
 
 typedef enum tcp_connection_flag_bits_
 {
@@ -166,12 +168,14 @@ typedef struct _sack_scoreboard_hole
   u32 prev;		/**< Index for previous entry in linked list */
   u32 start;		/**< Start sequence number */
   u32 end;		/**< End sequence number */
+  u32 lookup_node;	/**< Node in hole lookup rbtree */
   u8 is_lost;		/**< Mark hole as lost */
 } sack_scoreboard_hole_t;
 
 typedef struct _sack_scoreboard
 {
   sack_scoreboard_hole_t *holes;	/**< Pool of holes */
+  rb_tree_t hole_lookup;		/**< Rbtree of holes keyed by start */
   u32 head;				/**< Index of first entry */
   u32 tail;				/**< Index of last entry */
   u32 sacked_bytes;			/**< Number of bytes sacked in sb */
@@ -181,6 +185,7 @@ typedef struct _sack_scoreboard
   u32 high_sacked;			/**< Highest byte sacked (fack) */
   u32 high_rxt;				/**< Highest retransmitted sequence */
   u32 rescue_rxt;			/**< Rescue sequence number */
+  u32 hole_bytes;			/**< Bytes in all holes */
   u32 lost_bytes;			/**< Bytes lost as per RFC6675 */
   u32 last_lost_bytes;			/**< Number of bytes last lost */
   u32 cur_rxt_hole;			/**< Retransmitting from this hole */
@@ -377,6 +382,11 @@ typedef struct _tcp_connection
   u64 lost;			/**< Total bytes lost */
   tcp_byte_tracker_t *bt;	/**< Tx byte tracker */
 
+  /* RACK loss detection */
+  f64 rack_xmit_time;		/**< Tx time of most recently delivered */
+  f64 rack_rtt;			/**< Rtt of most recently delivered */
+  f64 rack_min_rtt;		/**< Min rtt seen by rack */
+
   tcp_errors_t errors;	/**< Soft connection errors */
 
   u32 iss;		/**< initial sent sequence */
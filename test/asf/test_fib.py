@@ -43,6 +43,14 @@ class TestFIB(VppAsfTestCase):
             self.logger.critical(error)
         self.assertNotIn("Failed", error)
 
+    def test_ip4_lookup(self):
+        """IP4 lookup batches over mixed VRFs"""
+        error = self.vapi.cli("test ip4 lookup")
+
+        if error:
+            self.logger.info(error)
+        self.assertNotIn("Failed", error)
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -205,6 +205,27 @@ class QUICEchoIntMStreamTestCase(QUICEchoIntTestCase):
         self.client("nclients", "10", "mbytes", "1")
 
 
+@tag_fixme_vpp_workers
+class QUICEchoIntGsoTestCase(QUICEchoIntTestCase):
+    """QUIC Echo Internal GSO Transfer Test Case"""
+
+    def quic_counter(self, name):
+        for line in self.vapi.cli("show quic").splitlines():
+            if line.startswith(name):
+                return int(line.split(":")[1])
+        self.fail(f"no {name} in show quic")
+
+    def test_quic_int_gso_transfer(self):
+        """QUIC internal transfer with gso dgrams and vpp crypto"""
+        self.vapi.cli("quic set crypto api vpp")
+        self.server()
+        self.client("nclients", "4", "mbytes", "4")
+        n_packets = self.quic_counter("TX Total")
+        n_dgrams = self.quic_counter("TX GSO dgrams")
+        self.assertGreater(n_dgrams, 0)
+        self.assertGreaterEqual(n_packets, 2 * n_dgrams)
+
+
 class QUICEchoExtTestCase(QUICTestCase):
     quic_setup = "default"
     test_bytes = "test-bytes:assert"
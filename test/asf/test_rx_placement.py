@@ -0,0 +1,30 @@
+#!/usr/bin/env python3
+
+import unittest
+
+from asfframework import VppAsfTestCase, VppTestRunner
+
+
+class TestRxPlacement(VppAsfTestCase):
+    """Rx Placement Test Cases"""
+
+    vpp_worker_count = 2
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestRxPlacement, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestRxPlacement, cls).tearDownClass()
+
+    def test_rx_placement_balance(self):
+        """Auto rx placement moves one queue per round and holds it"""
+
+        r = self.vapi.cli_return_response("test interface rx-placement balance")
+        self.assertEqual(r.retval, 0, r.reply)
+        self.assertIn("round 4: imbalance 60%, queue moved", r.reply)
+
+
+if __name__ == "__main__":
+    unittest.main(testRunner=VppTestRunner)
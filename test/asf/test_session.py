@@ -199,6 +199,14 @@ class TestSvmFifoUnitTests(VppAsfTestCase):
             self.logger.critical(error)
         self.assertNotIn("failed", error)
 
+    def test_svm_queue(self):
+        """SVM Queue Unit Tests"""
+        error = self.vapi.cli("test svm queue all")
+
+        if error:
+            self.logger.critical(error)
+        self.assertNotIn("failed", error)
+
     def tearDown(self):
         super(TestSvmFifoUnitTests, self).tearDown()
 
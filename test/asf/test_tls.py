@@ -52,19 +52,11 @@ def checkAll():
     return ret
 
 
-class TestTLS(VppAsfTestCase):
-    """TLS Qat Test Case."""
-
-    @classmethod
-    def setUpClass(cls):
-        super(TestTLS, cls).setUpClass()
-
-    @classmethod
-    def tearDownClass(cls):
-        super(TestTLS, cls).tearDownClass()
+class TLSTestCase(VppAsfTestCase):
+    """TLS Test Case, echo apps in two namespaces"""
 
     def setUp(self):
-        super(TestTLS, self).setUp()
+        super(TLSTestCase, self).setUp()
 
         self.vapi.session_enable_disable(is_enable=1)
         self.create_loopback_interfaces(2)
@@ -102,7 +94,52 @@ class TestTLS(VppAsfTestCase):
             i.set_table_ip4(0)
             i.admin_down()
         self.vapi.session_enable_disable(is_enable=0)
-        super(TestTLS, self).tearDown()
+        super(TLSTestCase, self).tearDown()
+
+    def add_routes(self):
+        """Add inter-table routes"""
+        ip_t01 = VppIpRoute(
+            self,
+            self.loop1.local_ip4,
+            32,
+            [VppRoutePath("0.0.0.0", 0xFFFFFFFF, nh_table_id=1)],
+        )
+        ip_t10 = VppIpRoute(
+            self,
+            self.loop0.local_ip4,
+            32,
+            [VppRoutePath("0.0.0.0", 0xFFFFFFFF, nh_table_id=0)],
+            table_id=1,
+        )
+        ip_t01.add_vpp_config()
+        ip_t10.add_vpp_config()
+        return [ip_t01, ip_t10]
+
+    def echo(self, server_args, client_args):
+        uri = "tls://" + self.loop0.local_ip4 + "/1234"
+        error = self.vapi.cli(f"test echo server appns 0 {server_args} uri {uri}")
+        if error:
+            self.logger.critical(error)
+            self.assertNotIn("failed", error)
+        error = self.vapi.cli(
+            f"test echo client appns 1 {client_args} syn-timeout 2 uri {uri}"
+        )
+        if error:
+            self.logger.critical(error)
+            self.assertNotIn("failed", error)
+        return error
+
+
+class TestTLS(TLSTestCase):
+    """TLS Qat Test Case."""
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestTLS, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestTLS, cls).tearDownClass()
 
     @unittest.skipUnless(checkAll(), "QAT or OpenSSL not satisfied,skip.")
     def test_tls_transfer(self):
@@ -156,5 +193,50 @@ class TestTLS(VppAsfTestCase):
         ip_t10.remove_vpp_config()
 
 
+class TestTLSPicotls(TLSTestCase):
+    """TLS Picotls Test Case"""
+
+    engine = "tls-engine 4"
+
+    def test_tls_picotls_key_update(self):
+        """TLS picotls transfer with multi-record writes and key updates"""
+        routes = self.add_routes()
+
+        # 64k app fifos make writes span several 16k records. Send keys are
+        # updated every 256k so sealing batches see the aead contexts
+        # replaced in the middle of a write
+        self.vapi.cli("tls picotls set key-update 256k")
+        self.echo(
+            f"fifo-size 64k {self.engine}",
+            f"mbytes 10 fifo-size 64k test-bytes {self.engine}",
+        )
+        self.vapi.cli("tls picotls set key-update off")
+
+        for r in routes:
+            r.remove_vpp_config()
+
+
+class TestTLSPicotlsChunks(TLSTestCase):
+    """TLS Picotls Fifo Chunks Test Case"""
+
+    # Tls tcp fifos start with a 4k chunk and grow by chunks. Small app
+    # fifos wrap often, so records are sealed and opened across chunks
+    extra_vpp_config = ["tls", "{", "fifo-size", "48k", "}"]
+    engine = "tls-engine 4"
+
+    def test_tls_picotls_chunks(self):
+        """TLS picotls transfer with records across fifo chunks"""
+        routes = self.add_routes()
+
+        reply = self.echo(
+            f"fifo-size 12k {self.engine}",
+            f"mbytes 10 fifo-size 12k test-bytes {self.engine}",
+        )
+        self.logger.info(reply)
+
+        for r in routes:
+            r.remove_vpp_config()
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
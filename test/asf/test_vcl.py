@@ -463,6 +463,20 @@ class VCLCutThruTestCase(VCLTestCase):
             self.server_addr,
             self.server_port,
         ]
+        # 16 writes of 200kB in flight overflow the 1MB fifos, so writes
+        # are only partially enqueued and must be completed in order
+        self.client_ring_short_write_test_args = [
+            "-N",
+            "200",
+            "-T",
+            "200000",
+            "-B",
+            "-X",
+            "-a",
+            "16",
+            self.server_addr,
+            self.server_port,
+        ]
 
     def tearDown(self):
         super(VCLCutThruTestCase, self).tearDown()
@@ -503,6 +517,16 @@ class VCLCutThruTestCase(VCLTestCase):
             self.client_bi_dir_nsock_test_args,
         )
 
+    def test_vcl_cut_thru_ring_short_write(self):
+        """run VCL cut thru ring test with short writes"""
+
+        self.cut_thru_test(
+            "vcl_test_server",
+            self.server_args,
+            "vcl_test_client",
+            self.client_ring_short_write_test_args,
+        )
+
 
 @unittest.skipIf(
     "hs_apps" in config.excluded_plugins, "Exclude tests requiring hs_apps plugin"
@@ -1623,5 +1623,58 @@ class TestACLplugin(VppTestCase):
         self.logger.info("ACLP_TEST_FINISH_0315")
 
 
+@unittest.skipIf("acl" in config.excluded_plugins, "Exclude ACL plugin tests")
+class TestACLpluginApiThreads(VppTestCase):
+    """ACL plugin dumps on api threads"""
+
+    extra_vpp_config = ["api-queue", "{", "threads", "2", "}"]
+
+    def verify_dump(self, acls):
+        dump = self.vapi.acl_dump(acl_index=INVALID_INDEX)
+        self.assertEqual(
+            [d.acl_index for d in dump], sorted(a.acl_index for a in acls)
+        )
+        by_index = {a.acl_index: a for a in acls}
+        for d in dump:
+            acl = by_index[d.acl_index]
+            self.assertEqual(d.tag, acl.tag)
+            self.assertEqual(d.count, acl.count)
+            self.assertEqual(
+                [r.srcport_or_icmptype_first for r in d.r],
+                [r.sport_from for r in acl.rules],
+            )
+
+    def test_acl_dump_api_threads(self):
+        """acl dump on api threads, in order with other messages"""
+        acls = []
+        for i in range(400):
+            rules = [
+                AclRule(
+                    is_permit=1, proto=6, sport_from=i + j + 1, sport_to=i + j + 1
+                )
+                for j in range(1 + i % 4)
+            ]
+            acl = VppAcl(self, rules=rules, tag="acl-%d" % i)
+            acl.add_vpp_config()
+            acls.append(acl)
+
+        # The control ping after the details is handled on the main thread,
+        # a dump cut short by it would be seen as missing entries
+        for i in range(4):
+            self.verify_dump(acls)
+            acls.pop(i * 37).remove_vpp_config()
+            acls[i].modify_vpp_config(acls[i].rules[:1])
+        self.verify_dump(acls)
+
+        dump = self.vapi.macip_acl_dump(acl_index=INVALID_INDEX)
+        self.assertEqual(len(dump), 0)
+
+        out = self.vapi.cli("show api threads")
+        self.logger.info(out)
+        self.assertIn("2 api threads", out)
+        dispatched = int(out.split("threads: ")[1].split(" dispatched")[0])
+        self.assertGreaterEqual(dispatched, 6)
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+
+import unittest
+
+from scapy.layers.l2 import Ether
+from scapy.layers.inet import IP, UDP
+from scapy.packet import Raw
+
+from framework import VppTestCase
+from asfframework import VppTestRunner
+
+
+class TestSojourn(VppTestCase):
+    """Packet Sojourn Time Test Cases"""
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestSojourn, cls).setUpClass()
+
+        cls.create_pg_interfaces(range(2))
+        for i in cls.pg_interfaces:
+            i.admin_up()
+        cls.vapi.sw_interface_set_l2_xconnect(
+            cls.pg0.sw_if_index, cls.pg1.sw_if_index, enable=1
+        )
+
+    @classmethod
+    def tearDownClass(cls):
+        cls.vapi.sw_interface_set_l2_xconnect(
+            cls.pg0.sw_if_index, cls.pg1.sw_if_index, enable=0
+        )
+        for i in cls.pg_interfaces:
+            i.admin_down()
+
+        super(TestSojourn, cls).tearDownClass()
+
+    def send(self, n):
+        p = (
+            Ether(src=self.pg0.remote_mac, dst=self.pg1.remote_mac)
+            / IP(src="10.0.0.1", dst="10.0.0.2")
+            / UDP(sport=1234, dport=5678)
+            / Raw(b"\xa5" * 64)
+        )
+        self.send_and_expect(self.pg0, [p] * n, self.pg1)
+
+    def samples(self):
+        return self.statistics["/interfaces/pg1/sojourn"].sum()
+
+    def test_sojourn(self):
+        """Sojourn time of sampled packets"""
+
+        self.vapi.cli("set interface sojourn pg0 sample 4")
+        self.vapi.cli("set interface sojourn pg1")
+        self.assertIn("pg1", self.vapi.cli("show interface sojourn"))
+
+        # one of every 4 packets received on pg0 is stamped
+        self.send(100)
+        self.assertEqual(self.samples(), 25)
+        self.assertIn("samples 25 p50", self.vapi.cli("show interface sojourn"))
+
+        # no more stamps once disabled on the rx interface
+        self.vapi.cli("set interface sojourn pg0 disable")
+        self.send(100)
+        self.assertEqual(self.samples(), 25)
+        self.assertNotIn("pg0", self.vapi.cli("show interface sojourn"))
+
+        self.vapi.cli("set interface sojourn pg1 disable")
+        self.assertEqual(self.vapi.cli("show interface sojourn"), "")
+        self.send(10)
+
+
+if __name__ == "__main__":
+    unittest.main(testRunner=VppTestRunner)
@@ -146,6 +146,8 @@ class TestVlib(VppTestCase):
             "clear interfaces",
             "test vlib",
             "test vlib2",
+            "test vlib epoch",
+            "test vlib barrier-reader",
             "show memory api-segment stats-segment main-heap verbose",
             "leak-check { show memory }",
             "show cpu",
@@ -326,5 +328,114 @@ class TestVlibFrameLeak(VppTestCase):
             self.assertEqual(frame_allocated[key], alloc)
 
 
+class TestVlibHandoff(VppTestCase):
+    """Vlib Handoff Test Cases"""
+
+    vpp_worker_count = 1
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestVlibHandoff, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestVlibHandoff, cls).tearDownClass()
+
+    def test_vlib_handoff_aux(self):
+        """Handoff with per-buffer aux data"""
+
+        for n in (1, 10000):
+            r = self.vapi.cli_return_response("test vlib handoff-aux %u" % n)
+            self.assertEqual(r.retval, 0, r.reply)
+            self.assertIn("0 with bad aux, 0 on wrong thread", r.reply)
+
+
+class TestVlibTickless(VppTestCase):
+    """Vlib Tickless Worker Test Cases"""
+
+    vpp_worker_count = 1
+    extra_vpp_config = ["unix", "{", "tickless-sleep", "}"]
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestVlibTickless, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestVlibTickless, cls).tearDownClass()
+
+    def test_vlib_tickless_wakeup(self):
+        """Sleeping worker is woken by interrupts, handoffs and waits"""
+
+        r = self.vapi.cli_return_response("test vlib tickless")
+        self.assertEqual(r.retval, 0, r.reply)
+        self.assertIn("wait one loop: min", r.reply)
+
+
+class TestVlibDispatchTime(VppTestCase):
+    """Vlib Node Dispatch Time Test Cases"""
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestVlibDispatchTime, cls).setUpClass()
+
+        cls.create_pg_interfaces(range(2))
+        for i in cls.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+    @classmethod
+    def tearDownClass(cls):
+        for i in cls.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+
+        super(TestVlibDispatchTime, cls).tearDownClass()
+
+    def send(self, n):
+        p = (
+            Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac)
+            / IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4)
+            / ICMP()
+        )
+        self.send_and_expect(self.pg0, [p] * n, self.pg1)
+
+    def samples(self):
+        return self.statistics["/nodes/ip4-lookup/dispatch_time"].sum()
+
+    def test_vlib_time_hist(self):
+        """Dispatch time histogram buckets and percentiles"""
+
+        r = self.vapi.cli_return_response("test vlib time-hist")
+        self.assertEqual(r.retval, 0, r.reply)
+
+    def test_vlib_dispatch_time(self):
+        """Dispatch time histogram of a node"""
+
+        self.vapi.cli("set node dispatch-time ip4-lookup")
+        self.send(10)
+        n = self.samples()
+        self.assertGreater(n, 0)
+        reply = self.vapi.cli("show node dispatch-time ip4-lookup")
+        self.assertIn("on  sample 1/1 samples %u p50" % n, reply)
+
+        self.vapi.cli("clear runtime")
+        self.assertEqual(self.samples(), 0)
+
+        # each frame of a single packet is a dispatch of its own, one of
+        # every 4 is recorded
+        self.vapi.cli("set node dispatch-time ip4-lookup sample 4")
+        for i in range(8):
+            self.send(1)
+        self.assertEqual(self.samples(), 2)
+
+        self.vapi.cli("set node dispatch-time ip4-lookup disable")
+        self.send(10)
+        self.assertEqual(self.samples(), 2)
+        reply = self.vapi.cli("show node dispatch-time ip4-lookup")
+        self.assertIn("off sample 1/4 samples 2", reply)
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)